@@ -17,6 +17,8 @@ layout(std140, binding = 14) uniform TransformMatrices
 	mat4 ViewMatrix;
 	mat4 ProjectionMatrix;
 	mat4 NormalMatrix;
+	vec4 PositionScale;
+	vec4 PositionOffset;
 };
 
 layout(binding = 1) uniform sampler2D AlbedoTexture;
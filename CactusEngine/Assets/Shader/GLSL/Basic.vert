@@ -1,10 +1,9 @@
 #version 430
 
-layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inNormal;
+layout(location = 0) in vec3 inPosition; // Relative to mesh bounds, see PositionScale and PositionOffset
+layout(location = 1) in vec2 inNormal;   // Octahedral encoded
 layout(location = 2) in vec2 inTexCoord;
-layout(location = 3) in vec3 inTangent;
-layout(location = 4) in vec3 inBitangent;
+layout(location = 3) in vec3 inTangent;  // Octahedral encoded in xy, bitangent sign in z
 
 layout(location = 0) out vec2 v2fTexCoord;
 layout(location = 1) out vec3 v2fNormal;
@@ -16,14 +15,26 @@ layout(std140, binding = 14) uniform TransformMatrices
 	mat4 ViewMatrix;
 	mat4 ProjectionMatrix;
 	mat4 NormalMatrix;
+	vec4 PositionScale;
+	vec4 PositionOffset;
 };
 
+vec3 DecodeOctahedral(vec2 e)
+{
+	vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+	float t = max(-n.z, 0.0);
+	n.xy += mix(vec2(t), vec2(-t), greaterThanEqual(n.xy, vec2(0.0)));
+	return normalize(n);
+}
 
 void main(void)
 {
+	vec3 position = inPosition * PositionScale.xyz + PositionOffset.xyz;
+	vec3 normal = DecodeOctahedral(inNormal);
+
 	v2fTexCoord = inTexCoord;
-	v2fNormal = normalize(mat3(NormalMatrix) * inNormal);
-	v2fPosition = (ModelMatrix * vec4(inPosition, 1.0)).xyz;
+	v2fNormal = normalize(mat3(NormalMatrix) * normal);
+	v2fPosition = (ModelMatrix * vec4(position, 1.0)).xyz;
 
-	gl_Position = (ProjectionMatrix * ViewMatrix * ModelMatrix) * vec4(inPosition, 1.0);
+	gl_Position = (ProjectionMatrix * ViewMatrix * ModelMatrix) * vec4(position, 1.0);
 }
\ No newline at end of file
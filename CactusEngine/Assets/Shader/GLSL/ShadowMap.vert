@@ -1,10 +1,9 @@
 #version 430
 
-layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inNormal;
+layout(location = 0) in vec3 inPosition; // Relative to mesh bounds, see PositionScale and PositionOffset
+layout(location = 1) in vec2 inNormal;   // Octahedral encoded
 layout(location = 2) in vec2 inTexCoord;
-layout(location = 3) in vec3 inTangent;
-layout(location = 4) in vec3 inBitangent;
+layout(location = 3) in vec3 inTangent;  // Octahedral encoded in xy, bitangent sign in z
 
 layout(location = 0) out vec2 v2fTexCoord;
 
@@ -14,6 +13,8 @@ layout(std140, binding = 14) uniform TransformMatrices
 	mat4 ViewMatrix;
 	mat4 ProjectionMatrix;
 	mat4 NormalMatrix;
+	vec4 PositionScale;
+	vec4 PositionOffset;
 };
 
 layout(std140, binding = 15) uniform LightSpaceTransformMatrix
@@ -24,6 +25,8 @@ layout(std140, binding = 15) uniform LightSpaceTransformMatrix
 
 void main(void)
 {
+	vec3 position = inPosition * PositionScale.xyz + PositionOffset.xyz;
+
 	v2fTexCoord = inTexCoord;
-	gl_Position = LightSpaceMatrix * ModelMatrix * vec4(inPosition, 1.0);
+	gl_Position = LightSpaceMatrix * ModelMatrix * vec4(position, 1.0);
 }
\ No newline at end of file
@@ -17,6 +17,8 @@ layout(std140, binding = 14) uniform TransformMatrices
 	mat4 ViewMatrix;
 	mat4 ProjectionMatrix;
 	mat4 NormalMatrix;
+	vec4 PositionScale;
+	vec4 PositionOffset;
 };
 
 layout(binding = 1) uniform sampler2D AlbedoTexture;
@@ -39,6 +41,12 @@ layout(std140, binding = 17) uniform CameraProperties
 	float ImageDistance;
 };
 
+// Material features, constant IDs match EMaterialFeature
+layout(constant_id = 0) const bool HasAlbedoTexture = true;
+layout(constant_id = 2) const bool HasToneTexture = true;
+layout(constant_id = 3) const bool EnableAlphaTest = true;
+layout(constant_id = 4) const bool ReceiveShadow = true;
+
 const vec3  LightDirection = vec3(0.0f, 0.6f, -0.8f);
 const vec4  LightColor = vec4(1, 1, 1, 1);
 const float LightIntensity = 1.15f;
@@ -110,8 +118,8 @@ float ComputeShadow(vec4 fragPosLightSpace, vec3 normal)
 
 void main(void)
 {
-	vec4 colorFromAlbedoTexture = texture(AlbedoTexture, v2fTexCoord);
-	if (colorFromAlbedoTexture.a <= 0)
+	vec4 colorFromAlbedoTexture = HasAlbedoTexture ? texture(AlbedoTexture, v2fTexCoord) : vec4(1.0);
+	if (EnableAlphaTest && colorFromAlbedoTexture.a <= 0)
 	{
 		discard;
 	}
@@ -227,10 +235,10 @@ void main(void)
 	float fragDepth = (2.0f * CameraZNear * CameraZFar) / (CameraZNear + CameraZFar - (2.0f * gl_FragCoord.z - 1.0f) * (CameraZFar - CameraZNear));
 	float D = clamp(1.0f - log2(fragDepth / ZMin), 0, 1); // Scale factor (r) is set to 2
 	vec2 toonCoord = vec2(clamp(dot(v2fNormal, LightDirection), 0.01f, 1), D);
-	vec4 toneColor = texture(ToneTexture, toonCoord) * AlbedoColor * LightIntensity * LightColor;
+	vec4 toneColor = (HasToneTexture ? texture(ToneTexture, toonCoord) : vec4(1.0)) * AlbedoColor * LightIntensity * LightColor;
 
 	// Applying shadow map
-	float shadowValue = ComputeShadow(v2fLightSpacePosition, v2fNormal);
+	float shadowValue = ReceiveShadow ? ComputeShadow(v2fLightSpacePosition, v2fNormal) : 0.0f;
 
 	outColor = (I * toneColor * colorFromAlbedoTexture + specularColor) * (1.8f - shadowValue);
 	outColor.a = min(shadowValue, (1.0f - toonCoord.x));
@@ -12,6 +12,8 @@ layout(std140, binding = 14) uniform TransformMatrices
 	mat4 ViewMatrix;
 	mat4 ProjectionMatrix;
 	mat4 NormalMatrix;
+	vec4 PositionScale;
+	vec4 PositionOffset;
 };
 
 layout(std140, binding = 18) uniform SystemVariables
@@ -39,6 +41,10 @@ layout(std140, binding = 16) uniform MaterialNumericalProperties
 layout(binding = 4) uniform sampler2D DepthTexture_1;
 layout(binding = 6) uniform sampler2D ColorTexture_1;
 
+// Material features, constant IDs match EMaterialFeature
+layout(constant_id = 0) const bool HasAlbedoTexture = true;
+layout(constant_id = 3) const bool EnableAlphaTest = true;
+
 // TODO: replace Lambertian model with PBR
 const vec3  LightDirection = vec3(0.0f, 0.8660254f, -0.5f);
 const vec4  LightColor = vec4(1, 1, 1, 1);
@@ -48,8 +54,8 @@ const float AmbientIntensity = 0.05f;
 
 void main(void)
 {
-	vec4 colorFromAlbedoTexture = texture(AlbedoTexture, v2fTexCoord);
-	if (colorFromAlbedoTexture.a <= 0)
+	vec4 colorFromAlbedoTexture = HasAlbedoTexture ? texture(AlbedoTexture, v2fTexCoord) : vec4(1.0);
+	if (EnableAlphaTest && colorFromAlbedoTexture.a <= 0)
 	{
 		discard;
 	}
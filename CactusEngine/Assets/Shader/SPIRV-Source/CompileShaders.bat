@@ -0,0 +1,25 @@
+@echo off
+rem Compiles every shader source in this folder to ..\SPIRV\<Name>_<stage>.spv with the glslangValidator shipped in the Vulkan SDK
+rem Run it after editing a source, shader pack picks the new binaries up by their file stamps
+
+setlocal
+
+if not defined VULKAN_SDK goto NoSDK
+set GLSLANG="%VULKAN_SDK%\Bin\glslangValidator.exe"
+if not exist %GLSLANG% goto NoSDK
+
+cd /d "%~dp0"
+set RESULT=0
+
+for %%f in (*.vert) do (
+	%GLSLANG% -V "%%f" -o "..\SPIRV\%%~nf_vert.spv" || set RESULT=1
+)
+for %%f in (*.frag) do (
+	%GLSLANG% -V "%%f" -o "..\SPIRV\%%~nf_frag.spv" || set RESULT=1
+)
+
+exit /b %RESULT%
+
+:NoSDK
+echo Vulkan SDK not found, SPIR-V binaries are left as they are
+exit /b 0
\ No newline at end of file
@@ -24,11 +24,14 @@ layout(std140, binding = 14) uniform TransformMatrices
 	mat4 ViewMatrix;
 	mat4 ProjectionMatrix;
 	mat4 NormalMatrix;
+	vec4 PositionScale;
+	vec4 PositionOffset;
 };
 
 layout(std140, binding = 19) uniform ControlVariables
 {
-	int Bool_1;
+	int  Bool_1;
+	vec2 TexelSize; // Full resolution texel size, offsets stay the same when intermediate result is downscaled
 };
 
 layout(std140, binding = 17) uniform CameraProperties
@@ -49,7 +52,7 @@ vec3 LevelBlur(int level)
 	//return vec3(float(level)*0.1); // Visualize blur level
 	//return texture(ColorTexture_1, v2fTexCoord).rgb;
 
-	vec2 pixelOffset = 1.0 / textureSize(ColorTexture_1, 0);
+	vec2 pixelOffset = TexelSize;
 
 	if (level <= 0)
 	{
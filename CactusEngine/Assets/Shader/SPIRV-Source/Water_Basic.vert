@@ -1,10 +1,9 @@
 #version 430
 
-layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inNormal;
+layout(location = 0) in vec3 inPosition; // Relative to mesh bounds, see PositionScale and PositionOffset
+layout(location = 1) in vec2 inNormal;   // Octahedral encoded
 layout(location = 2) in vec2 inTexCoord;
-layout(location = 3) in vec3 inTangent;
-layout(location = 4) in vec3 inBitangent;
+layout(location = 3) in vec3 inTangent;  // Octahedral encoded in xy, bitangent sign in z
 
 layout(location = 0) out vec2 v2fTexCoord;
 layout(location = 1) out vec3 v2fNormal;
@@ -16,6 +15,8 @@ layout(std140, binding = 14) uniform TransformMatrices
 	mat4 ViewMatrix;
 	mat4 ProjectionMatrix;
 	mat4 NormalMatrix;
+	vec4 PositionScale;
+	vec4 PositionOffset;
 };
 
 layout(std140, binding = 18) uniform SystemVariables
@@ -38,6 +39,8 @@ const vec2  Direction = vec2(-0.7071068f, -0.7071068f);
 
 void main(void)
 {
+	vec3 position = inPosition * PositionScale.xyz + PositionOffset.xyz;
+
 	v2fTexCoord = inTexCoord + vec2(fract(-0.05f * Time));
 
 	vec2 noiseTexCoord = inTexCoord + vec2(fract(NoiseFrequency * Time)) * NoiseDirection;
@@ -49,11 +52,11 @@ void main(void)
 	float frequency = 2.0f / WaveLength;
 	float phi = Speed * frequency;
 	
-	float xWave = Steepness * Amplitude * Direction.x * cos(frequency * dot(Direction, inPosition.xy) + phi * noisedTime);
-	float yWave = Steepness * Amplitude * Direction.y * cos(frequency * dot(Direction, inPosition.xy) + phi * noisedTime);
-	float zWave = Amplitude * sin(frequency * dot(Direction, inPosition.xy) + phi * noisedTime);
+	float xWave = Steepness * Amplitude * Direction.x * cos(frequency * dot(Direction, position.xy) + phi * noisedTime);
+	float yWave = Steepness * Amplitude * Direction.y * cos(frequency * dot(Direction, position.xy) + phi * noisedTime);
+	float zWave = Amplitude * sin(frequency * dot(Direction, position.xy) + phi * noisedTime);
 
-	vec3 vPosition = vec3(xWave + inPosition.x, yWave + inPosition.y, zWave + inPosition.z);
+	vec3 vPosition = vec3(xWave + position.x, yWave + position.y, zWave + position.z);
 
 	// Normal
 	float xNormal = -(Direction.x * frequency * Amplitude * cos(frequency * dot(Direction, vPosition.xy) + phi * noisedTime));
@@ -6,6 +6,7 @@ using namespace Engine;
 void GraphicsApplication::Initialize()
 {
 	m_pECSWorld = std::make_shared<ECSWorld>();
+	m_pResourceManager = std::make_shared<ResourceManager>(); // Setup function may already load resources
 
 	InitWindow(); // Alert: since we are binding the init of GLAD with GLFW, this has to be done before InitECS()
 
@@ -16,6 +17,9 @@ void GraphicsApplication::Initialize()
 
 	InitECS();
 
+	m_pSceneLoader = std::make_shared<ECSSceneLoader>(m_pECSWorld, m_pDevice, m_pResourceManager);
+	m_pTextureStreamer = std::make_shared<TextureStreamer>(m_pECSWorld);
+
 	Timer::Initialize();
 }
 
@@ -23,6 +27,9 @@ void GraphicsApplication::Tick()
 {
 	Timer::FrameBegin();
 
+	m_pSceneLoader->Tick();
+	m_pTextureStreamer->Tick();
+	m_pResourceManager->Trim();
 	m_pECSWorld->Tick();
 	m_pWindow->Tick();
 
@@ -31,6 +38,9 @@ void GraphicsApplication::Tick()
 
 void GraphicsApplication::ShutDown()
 {
+	m_pSceneLoader = nullptr; // Waits for loading workers, so that no resource is created after this point
+	m_pTextureStreamer = nullptr;
+	m_pResourceManager->Clear();
 	m_pECSWorld->ShutDown();
 	m_pWindow->ShutDown();
 }
@@ -45,6 +55,21 @@ std::shared_ptr<ECSWorld> GraphicsApplication::GetECSWorld() const
 	return m_pECSWorld;
 }
 
+std::shared_ptr<ECSSceneLoader> GraphicsApplication::GetSceneLoader() const
+{
+	return m_pSceneLoader;
+}
+
+std::shared_ptr<TextureStreamer> GraphicsApplication::GetTextureStreamer() const
+{
+	return m_pTextureStreamer;
+}
+
+std::shared_ptr<ResourceManager> GraphicsApplication::GetResourceManager() const
+{
+	return m_pResourceManager;
+}
+
 std::shared_ptr<DrawingDevice> GraphicsApplication::GetDrawingDevice() const
 {
 	return m_pDevice;
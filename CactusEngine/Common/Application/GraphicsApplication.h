@@ -2,6 +2,9 @@
 #include "BaseApplication.h"
 #include "ECSWorld.h"
 #include "DrawingDevice.h"
+#include "ECSSceneLoader.h"
+#include "TextureStreamer.h"
+#include "ResourceManager.h"
 #if defined(GLFW_IMPLEMENTATION_CE)
 #include "GLFWWindow.h"
 #endif
@@ -21,6 +24,9 @@ namespace Engine
 		bool ShouldQuit() const override;
 
 		std::shared_ptr<ECSWorld> GetECSWorld() const;
+		std::shared_ptr<ECSSceneLoader> GetSceneLoader() const;
+		std::shared_ptr<TextureStreamer> GetTextureStreamer() const;
+		std::shared_ptr<ResourceManager> GetResourceManager() const;
 		std::shared_ptr<DrawingDevice> GetDrawingDevice() const;
 		std::shared_ptr<BaseWindow> GetWindow() const;
 		void* GetWindowHandle() const override;
@@ -34,6 +40,9 @@ namespace Engine
 
 	private:
 		std::shared_ptr<ECSWorld> m_pECSWorld;
+		std::shared_ptr<ECSSceneLoader> m_pSceneLoader;
+		std::shared_ptr<TextureStreamer> m_pTextureStreamer;
+		std::shared_ptr<ResourceManager> m_pResourceManager;
 		std::shared_ptr<DrawingDevice> m_pDevice;
 #if defined(GLFW_IMPLEMENTATION_CE)
 		std::shared_ptr<GLFWWindow> m_pWindow;
@@ -39,6 +39,14 @@ namespace Engine
 			m_windowWidth = 800;
 			m_windowHeight = 600;
 			m_enableVSync = false;
+			m_maxFramesInFlight = 2;
+			m_vertexFormat = EVertexFormat::Compact;
+			m_optimizeMeshOverdraw = true;
+			m_textureCompression = ETextureCompression::HighQuality;
+			m_textureStreamingBudget = 512;
+			m_resourceCacheBudget = 1024;
+			m_meshLODThreshold = 1.0f;
+			m_occlusionCulling = true;
 		}
 
 		void SetDeviceType(EGraphicsDeviceType type)
@@ -82,10 +90,106 @@ namespace Engine
 			return m_enableVSync;
 		}
 
+		// Number of frames the host can record ahead of the GPU
+		void SetMaxFramesInFlight(uint32_t count)
+		{
+			m_maxFramesInFlight = count;
+		}
+
+		uint32_t GetMaxFramesInFlight() const
+		{
+			return m_maxFramesInFlight;
+		}
+
+		// Shared by all meshes, since pipelines are created with a single vertex input layout
+		void SetVertexFormat(EVertexFormat format)
+		{
+			m_vertexFormat = format;
+		}
+
+		EVertexFormat GetVertexFormat() const
+		{
+			return m_vertexFormat;
+		}
+
+		// Imported meshes are always optimized for vertex cache, overdraw reordering trades a little of that efficiency
+		void SetMeshOverdrawOptimization(bool val)
+		{
+			m_optimizeMeshOverdraw = val;
+		}
+
+		bool GetMeshOverdrawOptimization() const
+		{
+			return m_optimizeMeshOverdraw;
+		}
+
+		// Image textures are cooked into block compressed mip chains on first load, unless the device lacks support
+		void SetTextureCompression(ETextureCompression compression)
+		{
+			m_textureCompression = compression;
+		}
+
+		ETextureCompression GetTextureCompression() const
+		{
+			return m_textureCompression;
+		}
+
+		// Device memory available to streamed texture mips in megabytes, 0 disables streaming and every texture is fully resident
+		void SetTextureStreamingBudget(uint32_t megabytes)
+		{
+			m_textureStreamingBudget = megabytes;
+		}
+
+		uint32_t GetTextureStreamingBudget() const
+		{
+			return m_textureStreamingBudget;
+		}
+
+		// Memory taken by cached meshes and textures in megabytes, above which unused ones are evicted
+		void SetResourceCacheBudget(uint32_t megabytes)
+		{
+			m_resourceCacheBudget = megabytes;
+		}
+
+		uint32_t GetResourceCacheBudget() const
+		{
+			return m_resourceCacheBudget;
+		}
+
+		// Geometric error of mesh LODs allowed on screen in pixels, 0 always draws full detail
+		void SetMeshLODThreshold(float pixels)
+		{
+			m_meshLODThreshold = pixels;
+		}
+
+		float GetMeshLODThreshold() const
+		{
+			return m_meshLODThreshold;
+		}
+
+		// Meshes hidden behind occluders marked on their mesh renderers are skipped by camera passes, tested on CPU every frame
+		void SetOcclusionCulling(bool val)
+		{
+			m_occlusionCulling = val;
+		}
+
+		bool GetOcclusionCulling() const
+		{
+			return m_occlusionCulling;
+		}
+
 	private:
 		EGraphicsDeviceType m_deviceType;
 		uint32_t m_windowWidth;
 		uint32_t m_windowHeight;
 		bool m_enableVSync;
+		uint32_t m_maxFramesInFlight;
+		EVertexFormat m_vertexFormat;
+		bool m_optimizeMeshOverdraw;
+		ETextureCompression m_textureCompression;
+		uint32_t m_textureStreamingBudget;
+		uint32_t m_resourceCacheBudget;
+		float m_meshLODThreshold;
+		bool m_occlusionCulling;
 	};
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <cstring>
 #include "GraphicsApplication.h"
 #include "Global.h"
 #include "DrawingSystem.h"
@@ -7,6 +8,7 @@
 #include "ScriptSystem.h"
 #include "ECSSceneWriter.h"
 #include "ECSSceneReader.h"
+#include "RenderGraphBenchmark.h"
 
 #include "LightComponent.h"
 #include "TransformComponent.h"
@@ -21,8 +23,15 @@ using namespace Engine;
 void ConfigSetup();
 void TestSetup(GraphicsApplication* pApp);
 
-int main()
+int main(int argc, char* argv[])
 {
+	// Compare render graph resource lookups by name and by handle, the application is not started
+	if (argc > 1 && strcmp(argv[1], "-benchmark-rendergraph") == 0)
+	{
+		RunRenderGraphResourceBenchmark(512, 4, 1000);
+		return 0;
+	}
+
 	if (gpGlobal == nullptr)
 	{
 		gpGlobal = new Global();
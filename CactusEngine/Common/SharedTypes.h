@@ -113,15 +113,53 @@ namespace Engine
 		Depth,
 		RGBA8_SRGB,
 		BGRA8_UNORM,
+		RGBA16F,
+		R11G11B10F,
+		RGBA8_UNORM,
 		UNDEFINED,
 
 		// For attribute input
 		RGB32F,
 		RG32F,
+		RG16F,
+		RGBA8_SNORM,
+		RG16_SNORM,
+		RGBA16_UNORM,
+
+		// Block compressed, for sampled textures
+		BC1_SRGB,
+		BC3_SRGB,
+		BC4_UNORM,
+		BC5_UNORM,
+		BC7_SRGB,
 
 		COUNT
 	};
 
+	// Decides how image textures are filtered and compressed
+	enum class ETextureContent
+	{
+		Color = 0, // sRGB encoded, alpha may be used
+		NormalMap, // Tangent space normals, compressed to BC7 with all channels kept
+		Mask,	   // Roughness, ambient occlusion and the like, compressed to BC1 with all channels kept
+		COUNT
+	};
+
+	enum class ETextureCompression
+	{
+		None = 0,
+		Compact,	 // Color textures are BC1, or BC3 if they have alpha
+		HighQuality, // Color textures are BC7
+		COUNT
+	};
+
+	enum class EVertexFormat
+	{
+		Full = 0, // All attributes are 32-bit floats, normals and tangents are still octahedral encoded
+		Compact,  // Positions are 16-bit normalized to mesh bounds, normals and tangents are 16-bit and 8-bit octahedral, texcoords are half precision
+		COUNT
+	};
+
 	enum class EDataType
 	{
 		Float32 = 0,
@@ -4,7 +4,7 @@
 using namespace Engine;
 
 Material::Material()
-	: m_useShaderType(EBuiltInShaderProgramType::Basic), m_transparentPass(false), m_albedoColor(Color4(1, 1, 1, 1)), m_anisotropy(0.0f), m_roughness(0.75f)
+	: m_useShaderType(EBuiltInShaderProgramType::Basic), m_transparentPass(false), m_alphaTest(true), m_receiveShadow(true), m_albedoColor(Color4(1, 1, 1, 1)), m_anisotropy(0.0f), m_roughness(0.75f)
 {
 }
 
@@ -77,6 +77,68 @@ bool Material::IsTransparent() const
 	return m_transparentPass;
 }
 
+void Material::SetAlphaTest(bool val)
+{
+	m_alphaTest = val;
+}
+
+bool Material::IsAlphaTested() const
+{
+	return m_alphaTest;
+}
+
+void Material::SetReceiveShadow(bool val)
+{
+	m_receiveShadow = val;
+}
+
+bool Material::ReceivesShadow() const
+{
+	return m_receiveShadow;
+}
+
+MaterialFeatureKey Material::GetFeatureKey() const
+{
+	MaterialFeatureKey key = 0;
+
+	if (GetTexture(EMaterialTextureType::Albedo))
+	{
+		key |= MaterialFeatureBit(EMaterialFeature::AlbedoTexture);
+	}
+	if (GetTexture(EMaterialTextureType::Normal))
+	{
+		key |= MaterialFeatureBit(EMaterialFeature::NormalTexture);
+	}
+	if (GetTexture(EMaterialTextureType::Tone))
+	{
+		key |= MaterialFeatureBit(EMaterialFeature::ToneTexture);
+	}
+	if (m_alphaTest)
+	{
+		key |= MaterialFeatureBit(EMaterialFeature::AlphaTest);
+	}
+	if (m_receiveShadow)
+	{
+		key |= MaterialFeatureBit(EMaterialFeature::ReceiveShadow);
+	}
+
+	return key;
+}
+
+ETextureContent Material::GetTextureContent(EMaterialTextureType type)
+{
+	switch (type)
+	{
+	case EMaterialTextureType::Normal:
+		return ETextureContent::NormalMap;
+	case EMaterialTextureType::Roughness:
+	case EMaterialTextureType::AO:
+		return ETextureContent::Mask;
+	default:
+		return ETextureContent::Color;
+	}
+}
+
 MaterialComponent::MaterialComponent()
 	: BaseComponent(EComponentType::Material)
 {
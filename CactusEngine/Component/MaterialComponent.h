@@ -31,9 +31,22 @@ namespace Engine
 		void SetTransparent(bool val);
 		bool IsTransparent() const;
 
+		void SetAlphaTest(bool val);
+		bool IsAlphaTested() const;
+		void SetReceiveShadow(bool val);
+		bool ReceivesShadow() const;
+
+		// Selects the pipeline variant this material is drawn with
+		MaterialFeatureKey GetFeatureKey() const;
+
+		// Decides how image files bound to given slot are encoded
+		static ETextureContent GetTextureContent(EMaterialTextureType type);
+
 	private:
 		EBuiltInShaderProgramType m_useShaderType;
 		bool m_transparentPass;
+		bool m_alphaTest;
+		bool m_receiveShadow;
 
 		MaterialTextureList m_Textures;
 
@@ -3,16 +3,46 @@
 using namespace Engine;
 
 MeshFilterComponent::MeshFilterComponent()
-	: BaseComponent(EComponentType::MeshFilter)
+	: BaseComponent(EComponentType::MeshFilter),
+	m_lodIndex(0),
+	m_isOccluded(false)
 {
 }
 
 void MeshFilterComponent::SetMesh(const std::shared_ptr<Mesh> pMesh)
 {
 	m_pMesh = pMesh;
+	m_lodIndex = 0;
+	m_clusterCullingResult.isValid = false;
+	m_isOccluded = false;
 }
 
 std::shared_ptr<Mesh> MeshFilterComponent::GetMesh() const
 {
 	return m_pMesh;
+}
+
+void MeshFilterComponent::SetLODIndex(uint32_t lod)
+{
+	m_lodIndex = lod;
+}
+
+uint32_t MeshFilterComponent::GetLODIndex() const
+{
+	return m_lodIndex;
+}
+
+ClusterCullingResult& MeshFilterComponent::GetClusterCullingResult()
+{
+	return m_clusterCullingResult;
+}
+
+void MeshFilterComponent::SetOccluded(bool isOccluded)
+{
+	m_isOccluded = isOccluded;
+}
+
+bool MeshFilterComponent::IsOccluded() const
+{
+	return m_isOccluded;
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 #include "BaseComponent.h"
 #include "Mesh.h"
+#include "MeshClusterCuller.h"
 
 namespace Engine
 {
@@ -13,7 +14,21 @@ namespace Engine
 		void SetMesh(const std::shared_ptr<Mesh> pMesh);
 		std::shared_ptr<Mesh> GetMesh() const;
 
+		// Level of detail drawn for this entity, updated by drawing system every frame
+		void SetLODIndex(uint32_t lod);
+		uint32_t GetLODIndex() const;
+
+		// Clusters of the full-detail level left visible to main camera, updated by drawing system every frame
+		ClusterCullingResult& GetClusterCullingResult();
+
+		// Hidden from main camera behind occluders this frame, updated by drawing system
+		void SetOccluded(bool isOccluded);
+		bool IsOccluded() const;
+
 	private:
 		std::shared_ptr<Mesh> m_pMesh;
+		uint32_t m_lodIndex;
+		ClusterCullingResult m_clusterCullingResult;
+		bool m_isOccluded;
 	};
 }
\ No newline at end of file
@@ -3,7 +3,8 @@
 using namespace Engine;
 
 MeshRendererComponent::MeshRendererComponent()
-	: BaseComponent(EComponentType::MeshRenderer)
+	: BaseComponent(EComponentType::MeshRenderer),
+	m_isOccluder(false)
 {
 }
 
@@ -15,4 +16,14 @@ void MeshRendererComponent::SetRenderer(ERendererType rendererType)
 ERendererType MeshRendererComponent::GetRendererType() const
 {
 	return m_rendererType;
+}
+
+void MeshRendererComponent::SetOccluder(bool isOccluder)
+{
+	m_isOccluder = isOccluder;
+}
+
+bool MeshRendererComponent::IsOccluder() const
+{
+	return m_isOccluder;
 }
\ No newline at end of file
@@ -14,8 +14,13 @@ namespace Engine
 		void SetRenderer(ERendererType rendererType);
 		ERendererType GetRendererType() const;
 
+		// Occluders are rasterized for occlusion culling at a simplified level pulled back inside their mesh's surface, they should be large and closed or single-sided
+		void SetOccluder(bool isOccluder);
+		bool IsOccluder() const;
+
 	private:
 		ERendererType m_rendererType; // TODO: deprecate this property
+		bool m_isOccluder;
 		// TODO: add additional render properties here
 	};
 }
\ No newline at end of file
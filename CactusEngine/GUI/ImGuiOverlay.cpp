@@ -2,7 +2,7 @@
 #include "Timer.h"
 #include "GraphicsApplication.h"
 #include "Global.h"
-#include "ECSSceneReader.h"
+#include "ECSSceneLoader.h"
 
 using namespace Engine;
 
@@ -18,28 +18,42 @@ void Engine::DrawImGui()
 
 	ImGui::Begin("Status", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
 	ImGui::TextColored(ImVec4(0.0, 1.0, 0.0, 1.0), "FPS: %u", Timer::GetAverageFPS());
+
+	auto pSceneLoader = std::static_pointer_cast<GraphicsApplication>(gpGlobal->GetCurrentApplication())->GetSceneLoader();
+	if (pSceneLoader->IsLoading())
+	{
+		ImGui::TextColored(ImVec4(1.0, 1.0, 0.0, 1.0), "Loading scene: %.0f%%", pSceneLoader->GetProgress() * 100.0f);
+	}
+
+	const float MB = 1024.0f * 1024.0f;
+
+	auto& streamingStatistics = std::static_pointer_cast<GraphicsApplication>(gpGlobal->GetCurrentApplication())->GetTextureStreamer()->GetStatistics();
+	if (streamingStatistics.streamedTextureCount > 0)
+	{
+		ImGui::Text("Texture streaming: %.1f / %.1f MB, %.1f MB required", streamingStatistics.residentSize / MB, streamingStatistics.budget / MB, streamingStatistics.requiredSize / MB);
+		ImGui::Text("%u textures, %u pending, %u over budget", streamingStatistics.streamedTextureCount, streamingStatistics.pendingTextureCount, streamingStatistics.unsatisfiedTextureCount);
+		ImGui::Text("%llu requests, %llu evictions", (unsigned long long)streamingStatistics.requestCount, (unsigned long long)streamingStatistics.evictionCount);
+	}
+
+	auto cacheStatistics = std::static_pointer_cast<GraphicsApplication>(gpGlobal->GetCurrentApplication())->GetResourceManager()->GetStatistics();
+	ImGui::Text("Resource cache: %.1f / %.1f MB, %u resources, %u in use", cacheStatistics.residentSize / MB, cacheStatistics.budget / MB, cacheStatistics.residentCount, cacheStatistics.referencedCount);
+	ImGui::Text("%llu hits, %llu misses, %llu evictions", (unsigned long long)cacheStatistics.hitCount, (unsigned long long)cacheStatistics.missCount, (unsigned long long)cacheStatistics.evictionCount);
 	ImGui::End();
 
 	ImGui::Begin("Scene", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
 	if (ImGui::Button("Unity Chan"))
 	{
-		auto pWorld = std::static_pointer_cast<GraphicsApplication>(gpGlobal->GetCurrentApplication())->GetECSWorld();
-		pWorld->ClearEntities();
-		ReadECSWorldFromJson(pWorld, "Assets/Scene/UnityChanScene.json");
+		pSceneLoader->LoadSceneAsync("Assets/Scene/UnityChanScene.json");
 	}
 	ImGui::SameLine();
 	if (ImGui::Button("Lucy"))
 	{
-		auto pWorld = std::static_pointer_cast<GraphicsApplication>(gpGlobal->GetCurrentApplication())->GetECSWorld();
-		pWorld->ClearEntities();
-		ReadECSWorldFromJson(pWorld, "Assets/Scene/LucyScene.json");
+		pSceneLoader->LoadSceneAsync("Assets/Scene/LucyScene.json");
 	}
 	ImGui::SameLine();
 	if (ImGui::Button("Serapis"))
 	{
-		auto pWorld = std::static_pointer_cast<GraphicsApplication>(gpGlobal->GetCurrentApplication())->GetECSWorld();
-		pWorld->ClearEntities();
-		ReadECSWorldFromJson(pWorld, "Assets/Scene/SerapisScene.json");
+		pSceneLoader->LoadSceneAsync("Assets/Scene/SerapisScene.json");
 	}
 	ImGui::End();
 
@@ -73,6 +73,16 @@ namespace Engine
 		virtual void GetSwapchainImages(std::vector<std::shared_ptr<Texture2D>>& outImages) const = 0;
 		virtual uint32_t GetSwapchainPresentImageIndex() const = 0;
 
+		// Whether the format can be rendered to and linearly filtered when sampled
+		virtual bool SupportColorAttachmentFormat(ETextureFormat format) const = 0;
+		// Whether BC1-BC7 formats can be sampled
+		virtual bool SupportTextureCompressionBC() const = 0;
+
+		// Creation of vertex buffers and textures with initial data returns before the data reaches the device
+		// Resources can be bound right away, these only tell whether the uploaded contents are in place yet
+		virtual bool IsVertexBufferUploaded(const std::shared_ptr<VertexBuffer> pVertexBuffer) = 0;
+		virtual bool IsTexture2DUploaded(const std::shared_ptr<Texture2D> pTexture) = 0;
+
 		virtual void CopyTexture2DToDataTransferBuffer(std::shared_ptr<Texture2D> pSrcTexture, std::shared_ptr<DataTransferBuffer> pDstBuffer, std::shared_ptr<DrawingCommandBuffer> pCommandBuffer) = 0;
 		virtual void CopyDataTransferBufferToTexture2D(std::shared_ptr<DataTransferBuffer> pSrcBuffer, std::shared_ptr<Texture2D> pDstTexture, std::shared_ptr<DrawingCommandBuffer> pCommandBuffer) = 0;
 		virtual void CopyDataTransferBufferCrossDevice(std::shared_ptr<DataTransferBuffer> pSrcBuffer, std::shared_ptr<DataTransferBuffer> pDstBuffer) = 0;
@@ -85,7 +95,6 @@ namespace Engine
 		static const uint32_t ATTRIB_NORMAL_LOCATION = 1;
 		static const uint32_t ATTRIB_TEXCOORD_LOCATION = 2;
 		static const uint32_t ATTRIB_TANGENT_LOCATION = 3;
-		static const uint32_t ATTRIB_BITANGENT_LOCATION = 4;
 	};
 
 	template<EGraphicsDeviceType>
@@ -1,6 +1,7 @@
 #include "DrawingDevice_OpenGL.h"
 #include "DrawingResources_OpenGL.h"
 #include "DrawingUtil_OpenGL.h"
+#include "VertexStreamBuilder.h"
 
 using namespace Engine;
 
@@ -43,46 +44,76 @@ bool DrawingDevice_OpenGL::CreateVertexBuffer(const VertexBufferCreateInfo& crea
 	// Index
 	glGenBuffers(1, &pVertexBuffer->m_vboIndices);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, pVertexBuffer->m_vboIndices);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(int) * createInfo.indexDataCount, createInfo.pIndexData, GL_STATIC_DRAW);
 
-	std::vector<float> interleavedVertices = createInfo.ConvertToInterleavedData();
+	size_t indexDataSize = (createInfo.useShortIndices ? sizeof(uint16_t) : sizeof(int)) * createInfo.indexDataCount;
+
+	if (createInfo.useShortIndices)
+	{
+		std::vector<uint16_t> shortIndices(createInfo.pIndexData, createInfo.pIndexData + createInfo.indexDataCount);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexDataSize, shortIndices.data(), GL_STATIC_DRAW);
+		pVertexBuffer->m_indexType = GL_UNSIGNED_SHORT;
+	}
+	else
+	{
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexDataSize, createInfo.pIndexData, GL_STATIC_DRAW);
+		pVertexBuffer->m_indexType = GL_UNSIGNED_INT;
+	}
 
 	glGenBuffers(1, &pVertexBuffer->m_vboVertices);
 	glBindBuffer(GL_ARRAY_BUFFER, pVertexBuffer->m_vboVertices);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(float) * interleavedVertices.size(), interleavedVertices.data(), GL_STATIC_DRAW);
 
-	// Position
-	glEnableVertexAttribArray(ATTRIB_POSITION_LOCATION);
-	glVertexAttribPointer(ATTRIB_POSITION_LOCATION, 3, GL_FLOAT, GL_FALSE, createInfo.interleavedStride, (void*)createInfo.positionOffset);
+	size_t vertexDataSize = VertexStreamBuilder::GetOutputSize(createInfo);
+	glBufferData(GL_ARRAY_BUFFER, vertexDataSize, nullptr, GL_STATIC_DRAW);
 
-	// Normal
-	glEnableVertexAttribArray(ATTRIB_NORMAL_LOCATION);
-	glVertexAttribPointer(ATTRIB_NORMAL_LOCATION, 3, GL_FLOAT, GL_FALSE, createInfo.interleavedStride, (void*)createInfo.normalOffset);
+	if (vertexDataSize > 0)
+	{
+		VertexStreamBuilder::Write(createInfo, glMapBufferRange(GL_ARRAY_BUFFER, 0, vertexDataSize, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+	}
 
-	// TexCoord
-	glEnableVertexAttribArray(ATTRIB_TEXCOORD_LOCATION);
-	glVertexAttribPointer(ATTRIB_TEXCOORD_LOCATION, 2, GL_FLOAT, GL_FALSE, createInfo.interleavedStride, (void*)createInfo.texcoordOffset);
+	if (createInfo.vertexFormat == EVertexFormat::Compact)
+	{
+		// Position
+		glEnableVertexAttribArray(ATTRIB_POSITION_LOCATION);
+		glVertexAttribPointer(ATTRIB_POSITION_LOCATION, 4, GL_UNSIGNED_SHORT, GL_TRUE, createInfo.compactInterleavedStride, (void*)createInfo.positionOffset);
 
-	// Tangent
-	glEnableVertexAttribArray(ATTRIB_TANGENT_LOCATION);
-	glVertexAttribPointer(ATTRIB_TANGENT_LOCATION, 3, GL_FLOAT, GL_FALSE, createInfo.interleavedStride, (void*)createInfo.tangentOffset);
+		// Normal
+		glEnableVertexAttribArray(ATTRIB_NORMAL_LOCATION);
+		glVertexAttribPointer(ATTRIB_NORMAL_LOCATION, 2, GL_SHORT, GL_TRUE, createInfo.compactInterleavedStride, (void*)createInfo.compactNormalOffset);
 
-	// Bitangent
-	glEnableVertexAttribArray(ATTRIB_BITANGENT_LOCATION);
-	glVertexAttribPointer(ATTRIB_BITANGENT_LOCATION, 3, GL_FLOAT, GL_FALSE, createInfo.interleavedStride, (void*)createInfo.bitangentOffset);
+		// TexCoord
+		glEnableVertexAttribArray(ATTRIB_TEXCOORD_LOCATION);
+		glVertexAttribPointer(ATTRIB_TEXCOORD_LOCATION, 2, GL_HALF_FLOAT, GL_FALSE, createInfo.compactInterleavedStride, (void*)createInfo.compactTexcoordOffset);
+
+		// Tangent
+		glEnableVertexAttribArray(ATTRIB_TANGENT_LOCATION);
+		glVertexAttribPointer(ATTRIB_TANGENT_LOCATION, 4, GL_BYTE, GL_TRUE, createInfo.compactInterleavedStride, (void*)createInfo.compactTangentOffset);
+	}
+	else
+	{
+		// Position
+		glEnableVertexAttribArray(ATTRIB_POSITION_LOCATION);
+		glVertexAttribPointer(ATTRIB_POSITION_LOCATION, 3, GL_FLOAT, GL_FALSE, createInfo.interleavedStride, (void*)createInfo.positionOffset);
+
+		// Normal
+		glEnableVertexAttribArray(ATTRIB_NORMAL_LOCATION);
+		glVertexAttribPointer(ATTRIB_NORMAL_LOCATION, 2, GL_FLOAT, GL_FALSE, createInfo.interleavedStride, (void*)createInfo.normalOffset);
+
+		// TexCoord
+		glEnableVertexAttribArray(ATTRIB_TEXCOORD_LOCATION);
+		glVertexAttribPointer(ATTRIB_TEXCOORD_LOCATION, 2, GL_FLOAT, GL_FALSE, createInfo.interleavedStride, (void*)createInfo.texcoordOffset);
+
+		// Tangent
+		glEnableVertexAttribArray(ATTRIB_TANGENT_LOCATION);
+		glVertexAttribPointer(ATTRIB_TANGENT_LOCATION, 3, GL_FLOAT, GL_FALSE, createInfo.interleavedStride, (void*)createInfo.tangentOffset);
+	}
 
 	glBindVertexArray(0);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
 	pVertexBuffer->SetNumberOfIndices(createInfo.indexDataCount);
-	pVertexBuffer->MarkSizeInByte(static_cast<uint32_t>(sizeof(int) * createInfo.indexDataCount 
-		+ sizeof(float) * createInfo.positionDataCount 
-		+ sizeof(float) * createInfo.normalDataCount 
-		+ sizeof(float) * createInfo.texcoordDataCount 
-		+ sizeof(float) * createInfo.tangentDataCount 
-		+ sizeof(float) * createInfo.bitangentDataCount
-		));
+	pVertexBuffer->MarkSizeInByte(static_cast<uint32_t>(indexDataSize + vertexDataSize));
 
 	pOutput = pVertexBuffer;
 	return true;
@@ -109,7 +140,32 @@ bool DrawingDevice_OpenGL::CreateTexture2D(const Texture2DCreateInfo& createInfo
 	GLuint texID = -1;
 	glGenTextures(1, &texID);
 	glBindTexture(GL_TEXTURE_2D, texID);
-	glTexImage2D(GL_TEXTURE_2D, 0, OpenGLFormat(createInfo.format), createInfo.textureWidth, createInfo.textureHeight, 0, OpenGLPixelFormat(OpenGLFormat(createInfo.format)), OpenGLDataType(createInfo.dataType), createInfo.pTextureData);
+
+	// Precomputed levels are tightly packed one after another, starting from the largest
+	uint32_t dataLevels = createInfo.generateMipmap ? 1 : std::max<uint32_t>(1, createInfo.mipLevels);
+	size_t dataOffset = 0;
+	for (uint32_t level = 0; level < dataLevels; ++level)
+	{
+		uint32_t levelWidth = std::max<uint32_t>(1, createInfo.textureWidth >> level);
+		uint32_t levelHeight = std::max<uint32_t>(1, createInfo.textureHeight >> level);
+		size_t levelSize = Texture2DCreateInfo::GetLevelDataSize(createInfo.format, levelWidth, levelHeight);
+		const uint8_t* pLevelData = createInfo.pTextureData ? static_cast<const uint8_t*>(createInfo.pTextureData) + dataOffset : nullptr;
+
+		if (Texture2DCreateInfo::IsBlockCompressed(createInfo.format))
+		{
+			glCompressedTexImage2D(GL_TEXTURE_2D, level, OpenGLFormat(createInfo.format), levelWidth, levelHeight, 0, (GLsizei)levelSize, pLevelData);
+		}
+		else
+		{
+			glTexImage2D(GL_TEXTURE_2D, level, OpenGLFormat(createInfo.format), levelWidth, levelHeight, 0, OpenGLPixelFormat(OpenGLFormat(createInfo.format)), OpenGLDataType(createInfo.dataType), pLevelData);
+		}
+		dataOffset += levelSize;
+	}
+	if (dataLevels > 1)
+	{
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, dataLevels - 1);
+	}
+
 	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
@@ -128,7 +184,9 @@ bool DrawingDevice_OpenGL::CreateTexture2D(const Texture2DCreateInfo& createInfo
 	pTexture->SetGLTextureID(texID);
 	pTexture->MarkTextureSize(createInfo.textureWidth, createInfo.textureHeight);
 	pTexture->SetTextureType(createInfo.textureType);
-	pTexture->MarkSizeInByte(static_cast<uint32_t>(createInfo.textureWidth * createInfo.textureHeight * OpenGLTypeSize(createInfo.dataType)));
+	pTexture->MarkSizeInByte(dataLevels > 1 || Texture2DCreateInfo::IsBlockCompressed(createInfo.format)
+		? static_cast<uint32_t>(dataOffset)
+		: static_cast<uint32_t>(createInfo.textureWidth * createInfo.textureHeight * OpenGLTypeSize(createInfo.dataType)));
 
 	return texID != -1;
 }
@@ -260,11 +318,13 @@ void DrawingDevice_OpenGL::SetVertexBuffer(const std::shared_ptr<VertexBuffer> p
 	}
 
 	glBindVertexArray(std::static_pointer_cast<VertexBuffer_OpenGL>(pVertexBuffer)->m_vao);
+	m_currentIndexType = std::static_pointer_cast<VertexBuffer_OpenGL>(pVertexBuffer)->m_indexType;
 }
 
 void DrawingDevice_OpenGL::DrawPrimitive(uint32_t indicesCount, uint32_t baseIndex, uint32_t baseVertex, std::shared_ptr<DrawingCommandBuffer> pCommandBuffer)
 {
-	glDrawElementsBaseVertex(m_primitiveTopologyMode, indicesCount, GL_UNSIGNED_INT, (void*)(sizeof(unsigned int)*baseIndex), baseVertex);
+	size_t indexSize = m_currentIndexType == GL_UNSIGNED_SHORT ? sizeof(unsigned short) : sizeof(unsigned int);
+	glDrawElementsBaseVertex(m_primitiveTopologyMode, indicesCount, m_currentIndexType, (void*)(indexSize * baseIndex), baseVertex);
 }
 
 void DrawingDevice_OpenGL::DrawFullScreenQuad(std::shared_ptr<DrawingCommandBuffer> pCommandBuffer)
@@ -500,6 +560,26 @@ uint32_t DrawingDevice_OpenGL::GetSwapchainPresentImageIndex() const
 	return -1;
 }
 
+bool DrawingDevice_OpenGL::SupportColorAttachmentFormat(ETextureFormat format) const
+{
+	return true; // All of them are required color-renderable formats since OpenGL 3.0
+}
+
+bool DrawingDevice_OpenGL::SupportTextureCompressionBC() const
+{
+	return true; // RGTC and BPTC are core since OpenGL 3.0 and 4.2, S3TC is available on all desktop implementations
+}
+
+bool DrawingDevice_OpenGL::IsVertexBufferUploaded(const std::shared_ptr<VertexBuffer> pVertexBuffer)
+{
+	return true; // Buffer data is uploaded synchronously
+}
+
+bool DrawingDevice_OpenGL::IsTexture2DUploaded(const std::shared_ptr<Texture2D> pTexture)
+{
+	return true;
+}
+
 void DrawingDevice_OpenGL::CopyTexture2DToDataTransferBuffer(std::shared_ptr<Texture2D> pSrcTexture, std::shared_ptr<DataTransferBuffer> pDstBuffer, std::shared_ptr<DrawingCommandBuffer> pCommandBuffer)
 {
 	std::cerr << "OpenGL: shouldn't call CopyTexture2DToDataTransferBuffer on OpenGL device.\n";
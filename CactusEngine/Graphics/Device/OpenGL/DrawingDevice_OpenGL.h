@@ -67,6 +67,11 @@ namespace Engine
 		void GetSwapchainImages(std::vector<std::shared_ptr<Texture2D>>& outImages) const override;
 		uint32_t GetSwapchainPresentImageIndex() const override;
 
+		bool SupportColorAttachmentFormat(ETextureFormat format) const override;
+		bool SupportTextureCompressionBC() const override;
+		bool IsVertexBufferUploaded(const std::shared_ptr<VertexBuffer> pVertexBuffer) override;
+		bool IsTexture2DUploaded(const std::shared_ptr<Texture2D> pTexture) override;
+
 		void CopyTexture2DToDataTransferBuffer(std::shared_ptr<Texture2D> pSrcTexture, std::shared_ptr<DataTransferBuffer> pDstBuffer, std::shared_ptr<DrawingCommandBuffer> pCommandBuffer) override;
 		void CopyDataTransferBufferToTexture2D(std::shared_ptr<DataTransferBuffer> pSrcBuffer, std::shared_ptr<Texture2D> pDstTexture, std::shared_ptr<DrawingCommandBuffer> pCommandBuffer) override;
 		void CopyDataTransferBufferCrossDevice(std::shared_ptr<DataTransferBuffer> pSrcBuffer, std::shared_ptr<DataTransferBuffer> pDstBuffer) override;
@@ -83,6 +88,7 @@ namespace Engine
 	private:
 		GLuint m_attributeless_vao = -1;
 		GLenum m_primitiveTopologyMode = GL_TRIANGLES;
+		GLenum m_currentIndexType = GL_UNSIGNED_INT; // Of the last bound vertex buffer
 	};
 
 	template<>
@@ -7,7 +7,7 @@
 using namespace Engine;
 
 VertexBuffer_OpenGL::VertexBuffer_OpenGL()
-	: m_vao(-1), m_vboIndices(-1), m_vboVertices(-1)
+	: m_vao(-1), m_vboIndices(-1), m_vboVertices(-1), m_indexType(GL_UNSIGNED_INT)
 {
 }
 
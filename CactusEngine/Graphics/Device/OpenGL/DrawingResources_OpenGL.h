@@ -14,6 +14,7 @@ namespace Engine
 		unsigned int m_vao;
 		unsigned int m_vboIndices;
 		unsigned int m_vboVertices;
+		unsigned int m_indexType;
 	};
 
 	class Texture2D_OpenGL : public Texture2D
@@ -5,6 +5,14 @@
 #include <fstream>
 #include <iostream>
 
+// S3TC is an extension that is not included in loader
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT 0x8C4D
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
 namespace Engine
 {
 	inline char* ReadSourceFileAsChar(const char* shaderFile)
@@ -55,6 +63,22 @@ namespace Engine
 			return GL_DEPTH_COMPONENT32F;
 		case ETextureFormat::RGBA8_SRGB:
 			return GL_SRGB8_ALPHA8;
+		case ETextureFormat::RGBA16F:
+			return GL_RGBA16F;
+		case ETextureFormat::R11G11B10F:
+			return GL_R11F_G11F_B10F;
+		case ETextureFormat::RGBA8_UNORM:
+			return GL_RGBA8;
+		case ETextureFormat::BC1_SRGB:
+			return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;
+		case ETextureFormat::BC3_SRGB:
+			return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+		case ETextureFormat::BC4_UNORM:
+			return GL_COMPRESSED_RED_RGTC1;
+		case ETextureFormat::BC5_UNORM:
+			return GL_COMPRESSED_RG_RGTC2;
+		case ETextureFormat::BC7_SRGB:
+			return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
 		default:
 			std::cerr << "Unhandled OpenGL format." << std::endl;
 			break;
@@ -69,7 +93,10 @@ namespace Engine
 		case GL_RGBA32F:
 		case GL_RGBA16F:
 		case GL_SRGB8_ALPHA8:
+		case GL_RGBA8:
 			return GL_RGBA;
+		case GL_R11F_G11F_B10F:
+			return GL_RGB;
 		case GL_DEPTH_COMPONENT24:
 		case GL_DEPTH_COMPONENT32F:
 			return GL_DEPTH_COMPONENT;
@@ -119,7 +119,7 @@ void DrawingCommandBuffer_Vulkan::UpdatePushConstant(const VkShaderStageFlags sh
 	vkCmdPushConstants(m_commandBuffer, m_pipelineLayout, shaderStage, offset, size, pData);
 }
 
-void DrawingCommandBuffer_Vulkan::BindDescriptorSets(const VkPipelineBindPoint bindPoint, const std::vector<std::shared_ptr<DrawingDescriptorSet_Vulkan>>& descriptorSets, uint32_t firstSet)
+void DrawingCommandBuffer_Vulkan::BindDescriptorSets(const VkPipelineBindPoint bindPoint, const std::vector<std::shared_ptr<DrawingDescriptorSet_Vulkan>>& descriptorSets, uint32_t firstSet, const std::vector<uint32_t>& dynamicOffsets)
 {
 	assert(m_isRecording);
 
@@ -130,8 +130,7 @@ void DrawingCommandBuffer_Vulkan::BindDescriptorSets(const VkPipelineBindPoint b
 		setHandles.emplace_back(pSet->m_descriptorSet);
 	}
 
-	vkCmdBindDescriptorSets(m_commandBuffer, bindPoint, m_pipelineLayout, firstSet, (uint32_t)setHandles.size(), setHandles.data(), 0, nullptr);
-	// Alert: dynamic offset is not handled
+	vkCmdBindDescriptorSets(m_commandBuffer, bindPoint, m_pipelineLayout, firstSet, (uint32_t)setHandles.size(), setHandles.data(), (uint32_t)dynamicOffsets.size(), dynamicOffsets.data());
 }
 
 void DrawingCommandBuffer_Vulkan::DrawPrimitiveIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, uint32_t vertexOffset, uint32_t firstInstance)
@@ -354,6 +353,89 @@ void DrawingCommandBuffer_Vulkan::CopyTexture2DToBuffer(std::shared_ptr<Texture2
 	vkCmdCopyImageToBuffer(m_commandBuffer, pSrcImage->m_image, pSrcImage->m_layout, pDstBuffer->m_buffer, (uint32_t)regions.size(), regions.data());
 }
 
+void DrawingCommandBuffer_Vulkan::ReleaseBufferOwnership(const std::shared_ptr<RawBuffer_Vulkan> pBuffer, uint32_t srcQueueFamily, uint32_t dstQueueFamily)
+{
+	assert(m_isRecording);
+
+	VkBufferMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = 0; // Ignored for release
+	barrier.srcQueueFamilyIndex = srcQueueFamily;
+	barrier.dstQueueFamilyIndex = dstQueueFamily;
+	barrier.buffer = pBuffer->m_buffer;
+	barrier.offset = 0;
+	barrier.size = VK_WHOLE_SIZE;
+
+	vkCmdPipelineBarrier(m_commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+}
+
+void DrawingCommandBuffer_Vulkan::AcquireBufferOwnership(const std::shared_ptr<RawBuffer_Vulkan> pBuffer, uint32_t srcQueueFamily, uint32_t dstQueueFamily, VkAccessFlags dstAccess, VkPipelineStageFlags dstStage)
+{
+	assert(m_isRecording);
+
+	// Within the same queue family it degrades to a barrier after transfer writes recorded on this queue
+	bool isOwnershipTransfer = srcQueueFamily != dstQueueFamily;
+
+	VkBufferMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	barrier.srcAccessMask = isOwnershipTransfer ? 0 : VK_ACCESS_TRANSFER_WRITE_BIT; // Ignored for acquire
+	barrier.dstAccessMask = dstAccess;
+	barrier.srcQueueFamilyIndex = isOwnershipTransfer ? srcQueueFamily : VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = isOwnershipTransfer ? dstQueueFamily : VK_QUEUE_FAMILY_IGNORED;
+	barrier.buffer = pBuffer->m_buffer;
+	barrier.offset = 0;
+	barrier.size = VK_WHOLE_SIZE;
+
+	VkPipelineStageFlags srcStage = isOwnershipTransfer ? VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT : VK_PIPELINE_STAGE_TRANSFER_BIT;
+	vkCmdPipelineBarrier(m_commandBuffer, srcStage, dstStage, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+}
+
+void DrawingCommandBuffer_Vulkan::ReleaseImageOwnership(std::shared_ptr<Texture2D_Vulkan> pImage, uint32_t srcQueueFamily, uint32_t dstQueueFamily)
+{
+	assert(m_isRecording);
+
+	// Layout is kept as is, following transitions are performed on destination queue
+	VkImageMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.oldLayout = pImage->m_layout;
+	barrier.newLayout = pImage->m_layout;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = 0;
+	barrier.srcQueueFamilyIndex = srcQueueFamily;
+	barrier.dstQueueFamilyIndex = dstQueueFamily;
+	barrier.image = pImage->m_image;
+	barrier.subresourceRange.aspectMask = pImage->m_aspect;
+	barrier.subresourceRange.baseMipLevel = 0;
+	barrier.subresourceRange.levelCount = pImage->m_mipLevels;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = 1;
+
+	vkCmdPipelineBarrier(m_commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+void DrawingCommandBuffer_Vulkan::AcquireImageOwnership(std::shared_ptr<Texture2D_Vulkan> pImage, uint32_t srcQueueFamily, uint32_t dstQueueFamily)
+{
+	assert(m_isRecording);
+
+	VkImageMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.oldLayout = pImage->m_layout;
+	barrier.newLayout = pImage->m_layout;
+	barrier.srcAccessMask = 0;
+	barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT; // Mipmap generation or layout transition comes next
+	barrier.srcQueueFamilyIndex = srcQueueFamily;
+	barrier.dstQueueFamilyIndex = dstQueueFamily;
+	barrier.image = pImage->m_image;
+	barrier.subresourceRange.aspectMask = pImage->m_aspect;
+	barrier.subresourceRange.baseMipLevel = 0;
+	barrier.subresourceRange.levelCount = pImage->m_mipLevels;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = 1;
+
+	vkCmdPipelineBarrier(m_commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
 void DrawingCommandBuffer_Vulkan::WaitPresentationSemaphore(const std::shared_ptr<DrawingSemaphore_Vulkan> pSemaphore)
 {
 	m_waitPresentationSemaphores.emplace_back(pSemaphore);
@@ -374,6 +456,11 @@ void DrawingCommandBuffer_Vulkan::SignalSemaphore(const std::shared_ptr<Timeline
 	m_signalSemaphores.emplace_back(pSemaphore);
 }
 
+void DrawingCommandBuffer_Vulkan::WaitTimelineValue(VkSemaphore semaphore, uint64_t value, VkPipelineStageFlags waitStage)
+{
+	m_waitTimelineValues.push_back({ semaphore, value, waitStage });
+}
+
 DrawingCommandPool_Vulkan::DrawingCommandPool_Vulkan(const std::shared_ptr<LogicalDevice_Vulkan> pDevice, VkCommandPool poolHandle, DrawingCommandManager_Vulkan* pManager)
 	: m_pDevice(pDevice), m_commandPool(poolHandle), m_allocatedCommandBufferCount(0), m_pManager(pManager)
 {
@@ -532,6 +619,12 @@ void DrawingCommandManager_Vulkan::SubmitCommandBuffers(std::shared_ptr <Timelin
 			pSubmitInfo->waitStages.emplace_back(pSemaphore->waitStage);
 			pSubmitInfo->waitSemaphoreValues.emplace_back(0); // This value should be ignored by driver implementation
 		}
+		for (auto& timelineWait : ptrCopy->m_waitTimelineValues)
+		{
+			pSubmitInfo->semaphoresToWait.emplace_back(timelineWait.semaphore);
+			pSubmitInfo->waitStages.emplace_back(timelineWait.waitStage);
+			pSubmitInfo->waitSemaphoreValues.emplace_back(timelineWait.value);
+		}
 
 		ptrCopy->m_pAssociatedSubmitSemaphore = pSubmitSemaphore;
 
@@ -714,10 +807,7 @@ void DrawingCommandManager_Vulkan::RecycleCommandBufferAsync()
 				{
 					for (auto& pCmdBuffer : timelineGroup.second)
 					{
-						for (auto& pSemaphore : pCmdBuffer->m_waitPresentationSemaphores)
-						{
-							m_pDevice->pSyncObjectManager->ReturnSemaphore(pSemaphore);
-						}
+						// Presentation semaphores are owned by swapchain and drawing device, which reuse them per frame in flight
 						for (auto& pSemaphore : pCmdBuffer->m_waitSemaphores)
 						{
 							m_pDevice->pSyncObjectManager->ReturnTimelineSemaphore(pSemaphore);
@@ -726,10 +816,14 @@ void DrawingCommandManager_Vulkan::RecycleCommandBufferAsync()
 						pCmdBuffer->m_signalPresentationSemaphores.clear();
 						pCmdBuffer->m_waitSemaphores.clear();
 						pCmdBuffer->m_signalSemaphores.clear();
+						pCmdBuffer->m_waitTimelineValues.clear();
 
 						while (!pCmdBuffer->m_boundDescriptorSets.empty())
 						{
-							pCmdBuffer->m_boundDescriptorSets.front()->m_isInUse = false;
+							if (!pCmdBuffer->m_boundDescriptorSets.front()->m_isCached)
+							{
+								pCmdBuffer->m_boundDescriptorSets.front()->m_isInUse = false;
+							}
 							pCmdBuffer->m_boundDescriptorSets.pop();
 						}
 
@@ -27,7 +27,16 @@ namespace Engine
 	{
 		Explicit = 0x1,
 		Implicit = 0x2,
-		COUNT = 2
+		Upload = 0x4, // Only submitted by upload manager
+		COUNT = 3
+	};
+
+	// Waits on a timeline semaphore owned outside of sync object manager, which is not returned to pool after execution
+	struct TimelineSemaphoreWait_Vulkan
+	{
+		VkSemaphore				semaphore;
+		uint64_t				value;
+		VkPipelineStageFlags	waitStage;
 	};
 
 	struct LogicalDevice_Vulkan;
@@ -54,7 +63,7 @@ namespace Engine
 		void BindPipeline(const VkPipelineBindPoint bindPoint, const VkPipeline pipeline);
 		void BindPipelineLayout(const VkPipelineLayout pipelineLayout); // TODO: integrate this function with BindPipeline
 		void UpdatePushConstant(const VkShaderStageFlags shaderStage, uint32_t size, const void* pData, uint32_t offset = 0);
-		void BindDescriptorSets(const VkPipelineBindPoint bindPoint, const std::vector<std::shared_ptr<DrawingDescriptorSet_Vulkan>>& descriptorSets, uint32_t firstSet = 0);
+		void BindDescriptorSets(const VkPipelineBindPoint bindPoint, const std::vector<std::shared_ptr<DrawingDescriptorSet_Vulkan>>& descriptorSets, uint32_t firstSet = 0, const std::vector<uint32_t>& dynamicOffsets = {});
 		void DrawPrimitiveIndexed(uint32_t indexCount, uint32_t instanceCount = 1, uint32_t firstIndex = 0, uint32_t vertexOffset = 0, uint32_t firstInstance = 0);
 		void DrawPrimitive(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex = 0, uint32_t firstInstance = 0);
 		void EndRenderPass();
@@ -66,6 +75,12 @@ namespace Engine
 		void CopyBufferToTexture2D(const std::shared_ptr<RawBuffer_Vulkan> pSrcBuffer, std::shared_ptr<Texture2D_Vulkan> pDstImage, const std::vector<VkBufferImageCopy>& regions);
 		void CopyTexture2DToBuffer(std::shared_ptr<Texture2D_Vulkan> pSrcImage, const std::shared_ptr<RawBuffer_Vulkan> pDstBuffer, const std::vector<VkBufferImageCopy>& regions);
 
+		// Queue family ownership transfer, release is recorded on source queue and acquire on destination queue
+		void ReleaseBufferOwnership(const std::shared_ptr<RawBuffer_Vulkan> pBuffer, uint32_t srcQueueFamily, uint32_t dstQueueFamily);
+		void AcquireBufferOwnership(const std::shared_ptr<RawBuffer_Vulkan> pBuffer, uint32_t srcQueueFamily, uint32_t dstQueueFamily, VkAccessFlags dstAccess, VkPipelineStageFlags dstStage);
+		void ReleaseImageOwnership(std::shared_ptr<Texture2D_Vulkan> pImage, uint32_t srcQueueFamily, uint32_t dstQueueFamily);
+		void AcquireImageOwnership(std::shared_ptr<Texture2D_Vulkan> pImage, uint32_t srcQueueFamily, uint32_t dstQueueFamily);
+
 		// For presentation only
 		void WaitPresentationSemaphore(const std::shared_ptr<DrawingSemaphore_Vulkan> pSemaphore);
 		void SignalPresentationSemaphore(const std::shared_ptr<DrawingSemaphore_Vulkan> pSemaphore);
@@ -73,6 +88,7 @@ namespace Engine
 		// For general purpose
 		void WaitSemaphore(const std::shared_ptr<TimelineSemaphore_Vulkan> pSemaphore);
 		void SignalSemaphore(const std::shared_ptr<TimelineSemaphore_Vulkan> pSemaphore);
+		void WaitTimelineValue(VkSemaphore semaphore, uint64_t value, VkPipelineStageFlags waitStage);
 
 	private:
 		VkCommandBuffer m_commandBuffer;
@@ -86,6 +102,7 @@ namespace Engine
 		std::vector<std::shared_ptr<DrawingSemaphore_Vulkan>> m_signalPresentationSemaphores;
 		std::vector<std::shared_ptr<TimelineSemaphore_Vulkan>> m_waitSemaphores;
 		std::vector<std::shared_ptr<TimelineSemaphore_Vulkan>> m_signalSemaphores;
+		std::vector<TimelineSemaphoreWait_Vulkan> m_waitTimelineValues;
 		std::shared_ptr<DrawingSyncObjectManager_Vulkan> m_pSyncObjectManager;
 
 		std::queue<std::shared_ptr<DrawingDescriptorSet_Vulkan>> m_boundDescriptorSets;
@@ -98,6 +115,7 @@ namespace Engine
 		friend class DrawingCommandPool_Vulkan;
 		friend class DrawingCommandManager_Vulkan;
 		friend class DrawingDevice_Vulkan;
+		friend class DrawingUploadManager_Vulkan;
 	};
 
 	class DrawingCommandPool_Vulkan : public NoCopy, public DrawingCommandPool, std::enable_shared_from_this<DrawingCommandPool_Vulkan>
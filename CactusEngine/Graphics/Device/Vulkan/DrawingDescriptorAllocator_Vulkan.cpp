@@ -1,12 +1,14 @@
 #include "DrawingDescriptorAllocator_Vulkan.h"
 #include "DrawingDevice_Vulkan.h"
+#include <algorithm>
 
 using namespace Engine;
 
 DrawingDescriptorSet_Vulkan::DrawingDescriptorSet_Vulkan(VkDescriptorSet descSet)
-	: m_descriptorSet(descSet)
+	: m_descriptorSet(descSet), m_lastUsedFrame(0)
 {
 	m_isInUse = false;
+	m_isCached = false;
 }
 
 DrawingDescriptorSetLayout_Vulkan::DrawingDescriptorSetLayout_Vulkan(const std::shared_ptr<LogicalDevice_Vulkan> pDevice, const std::vector<VkDescriptorSetLayoutBinding>& bindings)
@@ -23,6 +25,20 @@ DrawingDescriptorSetLayout_Vulkan::DrawingDescriptorSetLayout_Vulkan(const std::
 	{
 		std::cerr << "Vulkan: failed to create descriptor set layout.\n";
 	}
+
+	std::vector<VkDescriptorSetLayoutBinding> sortedBindings = bindings;
+	std::sort(sortedBindings.begin(), sortedBindings.end(),
+		[](const VkDescriptorSetLayoutBinding& lhs, const VkDescriptorSetLayoutBinding& rhs)
+		{
+			return lhs.binding < rhs.binding;
+		});
+
+	m_signature.reserve(sortedBindings.size() * 2);
+	for (auto& binding : sortedBindings)
+	{
+		m_signature.emplace_back(((uint64_t)binding.binding << 32) | binding.descriptorCount);
+		m_signature.emplace_back(((uint64_t)binding.descriptorType << 32) | binding.stageFlags);
+	}
 }
 
 DrawingDescriptorSetLayout_Vulkan::~DrawingDescriptorSetLayout_Vulkan()
@@ -35,6 +51,11 @@ const VkDescriptorSetLayout* DrawingDescriptorSetLayout_Vulkan::GetDescriptorSet
 	return &m_descriptorSetLayout;
 }
 
+const std::vector<uint64_t>& DrawingDescriptorSetLayout_Vulkan::GetSignature() const
+{
+	return m_signature;
+}
+
 DrawingDescriptorPool_Vulkan::DrawingDescriptorPool_Vulkan(const std::shared_ptr<LogicalDevice_Vulkan> pDevice, uint32_t maxSets)
 	: m_pDevice(pDevice), m_descriptorPool(VK_NULL_HANDLE), MAX_SETS(maxSets), m_allocatedSetsCount(0)
 {
@@ -133,10 +154,18 @@ void DrawingDescriptorPool_Vulkan::UpdateDescriptorSets(const std::vector<Descip
 	}
 }
 
+void DrawingDescriptorPool_Vulkan::UpdateDescriptorSetWithTemplate(VkDescriptorSet descriptorSet, VkDescriptorUpdateTemplate updateTemplate, const void* pData)
+{
+	assert(updateTemplate != VK_NULL_HANDLE);
+	vkUpdateDescriptorSetWithTemplate(m_pDevice->logicalDevice, descriptorSet, updateTemplate, pData);
+}
+
 DrawingDescriptorAllocator_Vulkan::DrawingDescriptorAllocator_Vulkan(const std::shared_ptr<LogicalDevice_Vulkan> pDevice)
 	: m_pDevice(pDevice)
 {
-
+	m_frameIndex = 0;
+	m_cacheHitCount = 0;
+	m_descriptorUpdateCount = 0;
 }
 
 std::shared_ptr<DrawingDescriptorPool_Vulkan> DrawingDescriptorAllocator_Vulkan::CreateDescriptorPool(uint32_t maxSets, const std::vector<VkDescriptorPoolSize>& poolSizes)
@@ -159,4 +188,48 @@ std::shared_ptr<DrawingDescriptorPool_Vulkan> DrawingDescriptorAllocator_Vulkan:
 		throw std::runtime_error("Vulkan: failed to create new descriptor pool.");
 		return nullptr;
 	}
+}
+
+void DrawingDescriptorAllocator_Vulkan::AdvanceFrame()
+{
+	uint64_t frameIndex = ++m_frameIndex;
+
+#if defined(_DEBUG)
+	if (frameIndex % CACHE_STATISTICS_REPORT_INTERVAL == 0)
+	{
+		auto statistics = GetCacheStatistics();
+		std::cout << "Vulkan: Descriptor set cache hit rate " << statistics.hitRate * 100.0f << "%, "
+			<< statistics.cacheHitCount << " hits, " << statistics.descriptorUpdateCount << " updates in last " << CACHE_STATISTICS_REPORT_INTERVAL << " frames.\n";
+
+		m_cacheHitCount = 0;
+		m_descriptorUpdateCount = 0;
+	}
+#endif
+}
+
+uint64_t DrawingDescriptorAllocator_Vulkan::GetCurrentFrame() const
+{
+	return m_frameIndex;
+}
+
+void DrawingDescriptorAllocator_Vulkan::RecordDescriptorSetCacheHit()
+{
+	m_cacheHitCount++;
+}
+
+void DrawingDescriptorAllocator_Vulkan::RecordDescriptorSetUpdate()
+{
+	m_descriptorUpdateCount++;
+}
+
+DescriptorSetCacheStatistics_Vulkan DrawingDescriptorAllocator_Vulkan::GetCacheStatistics() const
+{
+	DescriptorSetCacheStatistics_Vulkan statistics = {};
+	statistics.cacheHitCount = m_cacheHitCount;
+	statistics.descriptorUpdateCount = m_descriptorUpdateCount;
+
+	uint64_t totalRequests = statistics.cacheHitCount + statistics.descriptorUpdateCount;
+	statistics.hitRate = totalRequests > 0 ? (float)statistics.cacheHitCount / totalRequests : 0.0f;
+
+	return statistics;
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include <vulkan.h>
 #include <vector>
 #include <memory>
+#include <atomic>
+#include <functional>
 
 namespace Engine
 {
@@ -38,6 +40,49 @@ namespace Engine
 		uint32_t		descriptorCount;
 	};
 
+	// Raw descriptor payload laid out for vkUpdateDescriptorSetWithTemplate, one entry per binding
+	union DescriptorTemplateData_Vulkan
+	{
+		VkDescriptorBufferInfo	bufferInfo;
+		VkDescriptorImageInfo	imageInfo;
+		VkBufferView			texelBufferView;
+	};
+
+	// Identifies a descriptor set by its layout and the exact resources written into it
+	// Uniform buffer offsets are supplied dynamically at bind time and are not part of the key
+	struct DescriptorSetKey_Vulkan
+	{
+		VkDescriptorSetLayout	layout = VK_NULL_HANDLE;
+		std::vector<uint64_t>	contents;
+		size_t					hash = 0;
+
+		void Append(uint64_t value)
+		{
+			contents.emplace_back(value);
+			hash ^= std::hash<uint64_t>()(value) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		}
+
+		bool operator==(const DescriptorSetKey_Vulkan& other) const
+		{
+			return hash == other.hash && layout == other.layout && contents == other.contents;
+		}
+	};
+
+	struct DescriptorSetKeyHasher_Vulkan
+	{
+		size_t operator()(const DescriptorSetKey_Vulkan& key) const
+		{
+			return key.hash ^ std::hash<uint64_t>()((uint64_t)key.layout);
+		}
+	};
+
+	struct DescriptorSetCacheStatistics_Vulkan
+	{
+		uint64_t cacheHitCount;
+		uint64_t descriptorUpdateCount;
+		float	 hitRate;
+	};
+
 	struct LogicalDevice_Vulkan;
 
 	class DrawingDescriptorSet_Vulkan
@@ -49,6 +94,8 @@ namespace Engine
 	private:
 		VkDescriptorSet m_descriptorSet;
 		std::atomic<bool> m_isInUse;
+		std::atomic<bool> m_isCached; // Cached sets are owned by descriptor set cache and would not be recycled after execution
+		uint64_t m_lastUsedFrame;
 		
 		friend class DrawingDescriptorPool_Vulkan;
 		friend class DrawingDescriptorAllocator_Vulkan;
@@ -65,10 +112,12 @@ namespace Engine
 		~DrawingDescriptorSetLayout_Vulkan();
 
 		const VkDescriptorSetLayout* GetDescriptorSetLayout() const;
+		const std::vector<uint64_t>& GetSignature() const; // Identical signatures denote compatible layouts, used for pipeline layout sharing
 
 	private:
 		std::shared_ptr<LogicalDevice_Vulkan> m_pDevice;
 		VkDescriptorSetLayout m_descriptorSetLayout;
+		std::vector<uint64_t> m_signature;
 	};
 
 	class DrawingDescriptorPool_Vulkan
@@ -79,6 +128,7 @@ namespace Engine
 
 		bool AllocateDescriptorSets(const std::vector<VkDescriptorSetLayout>& layouts, std::vector<std::shared_ptr<DrawingDescriptorSet_Vulkan>>& outSets, bool clearPrev = false);
 		void UpdateDescriptorSets(const std::vector<DesciptorUpdateInfo_Vulkan>& updateInfos);
+		void UpdateDescriptorSetWithTemplate(VkDescriptorSet descriptorSet, VkDescriptorUpdateTemplate updateTemplate, const void* pData);
 		// TODO: add set copy support
 
 	private:
@@ -100,8 +150,22 @@ namespace Engine
 		std::shared_ptr<DrawingDescriptorPool_Vulkan> CreateDescriptorPool(uint32_t maxSets, const std::vector<VkDescriptorPoolSize>& poolSizes);
 		// TODO: add pool deletion support
 
+		// Frame tracking & statistics for descriptor set cache
+		void AdvanceFrame();
+		uint64_t GetCurrentFrame() const;
+		void RecordDescriptorSetCacheHit();
+		void RecordDescriptorSetUpdate();
+		DescriptorSetCacheStatistics_Vulkan GetCacheStatistics() const;
+
+	public:
+		const uint64_t CACHE_STATISTICS_REPORT_INTERVAL = 600; // Frames
+
 	private:
 		std::shared_ptr<LogicalDevice_Vulkan> m_pDevice;
 		std::vector<std::shared_ptr<DrawingDescriptorPool_Vulkan>> m_descriptorPools;
+
+		std::atomic<uint64_t> m_frameIndex;
+		std::atomic<uint64_t> m_cacheHitCount;
+		std::atomic<uint64_t> m_descriptorUpdateCount;
 	};
 }
\ No newline at end of file
@@ -2,11 +2,15 @@
 #include "DrawingDevice_Vulkan.h"
 #include "DrawingResources_Vulkan.h"
 #include "DrawingUtil_Vulkan.h"
+#include "BuiltInShaderType.h"
 #include "ImageTexture.h"
 #include "RenderTexture.h"
+#include "VertexStreamBuilder.h"
 #include "Timer.h"
 
 #include <set>
+#include <map>
+#include <array>
 #if defined(GLFW_IMPLEMENTATION_CE)
 #include <GLFW/glfw3.h>
 #endif
@@ -27,11 +31,16 @@ void DrawingDevice_Vulkan::Initialize()
 	SetupSyncObjectManager();
 	SetupUploadAllocator();
 	SetupDescriptorAllocator();
+	SetupUploadManager();
+	SetupPipelineCache();
+	SetupObjectCache();
+	SetupShaderPack();
 
+	m_currentFrame = 0;
+	SetupFramesInFlight();
 	SetupSwapchain();
 	CreateDefaultSampler();
 
-	m_currentFrame = 0;
 	m_isRunning = true;
 }
 
@@ -42,6 +51,21 @@ void DrawingDevice_Vulkan::ShutDown()
 		// TODO: correctly organize the sequence of resource release
 		// ...
 
+		for (unsigned int i = 0; i < m_framesInFlight.size(); i++)
+		{
+			WaitFrameInFlight(i);
+		}
+
+		if (m_pDevice_0->pPipelineCache)
+		{
+			m_pDevice_0->pPipelineCache->SaveToFile();
+		}
+
+		if (m_pDevice_0->pShaderPack)
+		{
+			m_pDevice_0->pShaderPack->SaveToFile();
+		}
+
 		vkDestroyDevice(m_pDevice_0->logicalDevice, nullptr);
 
 		if (m_enableValidationLayers)
@@ -58,22 +82,13 @@ void DrawingDevice_Vulkan::ShutDown()
 
 std::shared_ptr<ShaderProgram> DrawingDevice_Vulkan::CreateShaderProgramFromFile(const char* vertexShaderFilePath, const char* fragmentShaderFilePath)
 {
-	VkShaderModule vertexModule = VK_NULL_HANDLE;
-	VkShaderModule fragmentModule = VK_NULL_HANDLE;
-
-	std::vector<char> vertexRawCode;
-	std::vector<char> fragmentRawCode;
-
-	CreateShaderModuleFromFile(vertexShaderFilePath, m_pDevice_0, vertexModule, vertexRawCode);
-	CreateShaderModuleFromFile(fragmentShaderFilePath, m_pDevice_0, fragmentModule, fragmentRawCode);
-
-	auto pVertexShader = std::make_shared<VertexShader_Vulkan>(m_pDevice_0, vertexModule, vertexRawCode);
-	auto pFragmentShader = std::make_shared<FragmentShader_Vulkan>(m_pDevice_0, fragmentModule, fragmentRawCode);
+	auto pVertexShader = LoadShaderImpl(vertexShaderFilePath, VK_SHADER_STAGE_VERTEX_BIT);
+	auto pFragmentShader = LoadShaderImpl(fragmentShaderFilePath, VK_SHADER_STAGE_FRAGMENT_BIT);
 
 #if defined(_DEBUG)
-	auto pShaderProgram = std::make_shared<ShaderProgram_Vulkan>(this, m_pDevice_0, 2, pVertexShader->GetShaderImpl(), pFragmentShader->GetShaderImpl());
+	auto pShaderProgram = std::make_shared<ShaderProgram_Vulkan>(this, m_pDevice_0, 2, pVertexShader, pFragmentShader);
 #else
-	auto pShaderProgram = std::make_shared<ShaderProgram_Vulkan>(this, m_pDevice_0, pVertexShader->GetShaderImpl(), pFragmentShader->GetShaderImpl());
+	auto pShaderProgram = std::make_shared<ShaderProgram_Vulkan>(this, m_pDevice_0, pVertexShader, pFragmentShader);
 #endif
 
 	return pShaderProgram;
@@ -81,23 +96,14 @@ std::shared_ptr<ShaderProgram> DrawingDevice_Vulkan::CreateShaderProgramFromFile
 
 std::shared_ptr<ShaderProgram> DrawingDevice_Vulkan::CreateShaderProgramFromFile(const char* vertexShaderFilePath, const char* fragmentShaderFilePath, EGPUType gpuType)
 {
-	VkShaderModule vertexModule = VK_NULL_HANDLE;
-	VkShaderModule fragmentModule = VK_NULL_HANDLE;
-
-	std::vector<char> vertexRawCode;
-	std::vector<char> fragmentRawCode;
-
 	// GPU type specification is be ignored in this branch
-	CreateShaderModuleFromFile(vertexShaderFilePath, m_pDevice_0, vertexModule, vertexRawCode);
-	CreateShaderModuleFromFile(fragmentShaderFilePath, m_pDevice_0, fragmentModule, fragmentRawCode);
-
-	auto pVertexShader = std::make_shared<VertexShader_Vulkan>(m_pDevice_0, vertexModule, vertexRawCode);
-	auto pFragmentShader = std::make_shared<FragmentShader_Vulkan>(m_pDevice_0, fragmentModule, fragmentRawCode);
+	auto pVertexShader = LoadShaderImpl(vertexShaderFilePath, VK_SHADER_STAGE_VERTEX_BIT);
+	auto pFragmentShader = LoadShaderImpl(fragmentShaderFilePath, VK_SHADER_STAGE_FRAGMENT_BIT);
 
 #if defined(_DEBUG)
-	auto pShaderProgram = std::make_shared<ShaderProgram_Vulkan>(this, m_pDevice_0, 2, pVertexShader->GetShaderImpl(), pFragmentShader->GetShaderImpl());
+	auto pShaderProgram = std::make_shared<ShaderProgram_Vulkan>(this, m_pDevice_0, 2, pVertexShader, pFragmentShader);
 #else
-	auto pShaderProgram = std::make_shared<ShaderProgram_Vulkan>(this, m_pDevice_0, pVertexShader->GetShaderImpl(), pFragmentShader->GetShaderImpl());
+	auto pShaderProgram = std::make_shared<ShaderProgram_Vulkan>(this, m_pDevice_0, pVertexShader, pFragmentShader);
 #endif
 
 	return pShaderProgram;
@@ -111,66 +117,56 @@ bool DrawingDevice_Vulkan::CreateVertexBuffer(const VertexBufferCreateInfo& crea
 	RawBufferCreateInfo_Vulkan vertexBufferCreateInfo = {};
 	vertexBufferCreateInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
 	vertexBufferCreateInfo.memoryUsage = VMA_MEMORY_USAGE_GPU_ONLY;
-	vertexBufferCreateInfo.size = sizeof(float) * createInfo.positionDataCount
-		+ sizeof(float) * createInfo.normalDataCount
-		+ sizeof(float) * createInfo.texcoordDataCount
-		+ sizeof(float) * createInfo.tangentDataCount
-		+ sizeof(float) * createInfo.bitangentDataCount;
-	vertexBufferCreateInfo.stride = createInfo.interleavedStride * sizeof(float);
+	vertexBufferCreateInfo.size = VertexStreamBuilder::GetOutputSize(createInfo);
+	vertexBufferCreateInfo.stride = createInfo.GetInterleavedStride();
 
 	RawBufferCreateInfo_Vulkan indexBufferCreateInfo = {};
 	indexBufferCreateInfo.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
 	indexBufferCreateInfo.memoryUsage = VMA_MEMORY_USAGE_GPU_ONLY;
-	indexBufferCreateInfo.size = sizeof(int) * createInfo.indexDataCount;
-	indexBufferCreateInfo.indexFormat = VK_INDEX_TYPE_UINT32;
+	indexBufferCreateInfo.size = (createInfo.useShortIndices ? sizeof(uint16_t) : sizeof(int)) * createInfo.indexDataCount;
+	indexBufferCreateInfo.indexFormat = createInfo.useShortIndices ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
 
 	// By default vertex data will be created on discrete device, since integrated device will only handle post processing
 	// The alternative is to add a device specifier in VertexBufferCreateInfo
 	pOutput = std::make_shared<VertexBuffer_Vulkan>(m_pDevice_0, vertexBufferCreateInfo, indexBufferCreateInfo);
 
-	std::vector<float> interleavedVertices = createInfo.ConvertToInterleavedData();
-	void* ppIndexData;
-	void* ppVertexData;
-
-	RawBufferCreateInfo_Vulkan vertexStagingBufferCreateInfo = {};
-	vertexStagingBufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-	vertexStagingBufferCreateInfo.memoryUsage = VMA_MEMORY_USAGE_CPU_ONLY;
-	vertexStagingBufferCreateInfo.size = vertexBufferCreateInfo.size;
-
-	auto pVertexStagingBuffer = std::make_shared<RawBuffer_Vulkan>(m_pDevice_0, vertexStagingBufferCreateInfo);
-
-	m_pDevice_0->pUploadAllocator->MapMemory(pVertexStagingBuffer->m_allocation, &ppVertexData);
-	memcpy(ppVertexData, interleavedVertices.data(), vertexBufferCreateInfo.size);
-	m_pDevice_0->pUploadAllocator->UnmapMemory(pVertexStagingBuffer->m_allocation);
-
-	RawBufferCreateInfo_Vulkan indexStagingBufferCreateInfo = {};
-	indexStagingBufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-	indexStagingBufferCreateInfo.memoryUsage = VMA_MEMORY_USAGE_CPU_ONLY;
-	indexStagingBufferCreateInfo.size = indexBufferCreateInfo.size;
-
-	auto pIndexStagingBuffer = std::make_shared<RawBuffer_Vulkan>(m_pDevice_0, indexStagingBufferCreateInfo);
-
-	m_pDevice_0->pUploadAllocator->MapMemory(pIndexStagingBuffer->m_allocation, &ppIndexData);
-	memcpy(ppIndexData, createInfo.pIndexData, indexBufferCreateInfo.size);
-	m_pDevice_0->pUploadAllocator->UnmapMemory(pIndexStagingBuffer->m_allocation);
-
-	auto pCmdBuffer = m_pDevice_0->pGraphicsCommandManager->RequestPrimaryCommandBuffer();
+	StagingAllocation_Vulkan vertexStaging = {};
+	if (!m_pDevice_0->pUploadManager->AllocateStaging(vertexBufferCreateInfo.size, vertexStaging))
+	{
+		std::cerr << "Vulkan: failed to allocate staging memory for vertex buffer.\n";
+		pOutput = nullptr;
+		return false;
+	}
+	VertexStreamBuilder::Write(createInfo, vertexStaging.pMappedData);
 
-	VkBufferCopy vertexBufferCopyRegion = {};
-	vertexBufferCopyRegion.srcOffset = 0;
-	vertexBufferCopyRegion.dstOffset = 0;
-	vertexBufferCopyRegion.size = vertexBufferCreateInfo.size;
+	m_pDevice_0->pUploadManager->UploadBuffer(pOutput->GetResourceID(), vertexStaging, std::static_pointer_cast<VertexBuffer_Vulkan>(pOutput)->GetBufferImpl(), 0,
+		VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
 
-	pCmdBuffer->CopyBufferToBuffer(pVertexStagingBuffer, std::static_pointer_cast<VertexBuffer_Vulkan>(pOutput)->GetBufferImpl(), vertexBufferCopyRegion);
+	StagingAllocation_Vulkan indexStaging = {};
+	if (!m_pDevice_0->pUploadManager->AllocateStaging(indexBufferCreateInfo.size, indexStaging))
+	{
+		std::cerr << "Vulkan: failed to allocate staging memory for index buffer.\n";
+		pOutput = nullptr;
+		return false;
+	}
 
-	VkBufferCopy indexBufferCopyRegion = {};
-	indexBufferCopyRegion.srcOffset = 0;
-	indexBufferCopyRegion.dstOffset = 0;
-	indexBufferCopyRegion.size = indexBufferCreateInfo.size;
+	if (createInfo.useShortIndices)
+	{
+		uint16_t* pShortIndices = (uint16_t*)indexStaging.pMappedData;
+		for (uint32_t i = 0; i < createInfo.indexDataCount; ++i)
+		{
+			pShortIndices[i] = (uint16_t)createInfo.pIndexData[i];
+		}
+	}
+	else
+	{
+		memcpy(indexStaging.pMappedData, createInfo.pIndexData, indexBufferCreateInfo.size);
+	}
 
-	pCmdBuffer->CopyBufferToBuffer(pIndexStagingBuffer, std::static_pointer_cast<VertexBuffer_Vulkan>(pOutput)->GetIndexBufferImpl(), indexBufferCopyRegion);
+	m_pDevice_0->pUploadManager->UploadBuffer(pOutput->GetResourceID(), indexStaging, std::static_pointer_cast<VertexBuffer_Vulkan>(pOutput)->GetIndexBufferImpl(), 0,
+		VK_ACCESS_INDEX_READ_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
 
-	m_pDevice_0->pGraphicsCommandManager->SubmitSingleCommandBuffer_Immediate(pCmdBuffer);
+	pOutput->MarkSizeInByte(static_cast<uint32_t>(vertexBufferCreateInfo.size + indexBufferCreateInfo.size));
 
 	return true;
 }
@@ -185,62 +181,84 @@ bool DrawingDevice_Vulkan::CreateTexture2D(const Texture2DCreateInfo& createInfo
 	tex2dCreateInfo.memoryUsage = VMA_MEMORY_USAGE_GPU_ONLY;
 	tex2dCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
 	tex2dCreateInfo.aspect = createInfo.textureType == ETextureType::DepthAttachment ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
-	tex2dCreateInfo.mipLevels = createInfo.generateMipmap ? DetermineMipmapLevels_VK(std::max<uint32_t>(createInfo.textureWidth, createInfo.textureHeight)) : 1;
+	tex2dCreateInfo.mipLevels = createInfo.generateMipmap ? DetermineMipmapLevels_VK(std::max<uint32_t>(createInfo.textureWidth, createInfo.textureHeight)) : std::max<uint32_t>(1, createInfo.mipLevels);
+	tex2dCreateInfo.pAliasTexture = std::static_pointer_cast<Texture2D_Vulkan>(createInfo.pAliasTexture);
+
+	if (createInfo.isTransientAttachment)
+	{
+		assert(createInfo.pTextureData == nullptr && !createInfo.generateMipmap);
+
+		// Tile-based GPUs could keep transient attachments in on-chip memory without ever backing them
+		tex2dCreateInfo.usage = (tex2dCreateInfo.usage & ~VK_IMAGE_USAGE_SAMPLED_BIT) | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+		tex2dCreateInfo.memoryUsage = VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED;
+	}
 	
 	auto pDevice = m_pDevice_0;
 
 	pOutput = std::make_shared<Texture2D_Vulkan>(pDevice, tex2dCreateInfo);
 	auto pVkTexture2D = std::static_pointer_cast<Texture2D_Vulkan>(pOutput);
 
-	auto pCmdBuffer = pDevice->pGraphicsCommandManager->RequestPrimaryCommandBuffer();
-	std::shared_ptr<RawBuffer_Vulkan> pStagingBuffer = nullptr;
-
 	if (createInfo.pTextureData != nullptr)
 	{
-		RawBufferCreateInfo_Vulkan bufferCreateInfo = {};
-		bufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-		bufferCreateInfo.memoryUsage = VMA_MEMORY_USAGE_CPU_ONLY;
-		bufferCreateInfo.size = (VkDeviceSize)createInfo.textureWidth * createInfo.textureHeight * VulkanFormatUnitSize(createInfo.format);
-
-		pStagingBuffer = std::make_shared<RawBuffer_Vulkan>(pDevice, bufferCreateInfo);
-
-		void* ppData;
-		pDevice->pUploadAllocator->MapMemory(pStagingBuffer->m_allocation, &ppData);
-		memcpy(ppData, createInfo.pTextureData, bufferCreateInfo.size);
-		pDevice->pUploadAllocator->UnmapMemory(pStagingBuffer->m_allocation);
+		assert(!createInfo.generateMipmap || createInfo.mipLevels <= 1);
 
+		// Precomputed levels are copied one region each, without generating mipmap afterwards
+		uint32_t dataLevels = createInfo.generateMipmap ? 1 : tex2dCreateInfo.mipLevels;
 		std::vector<VkBufferImageCopy> copyRegions;
-		// Only has one level of data
-		VkBufferImageCopy region = {};
-		region.bufferOffset = 0;
-		region.bufferRowLength = 0;  // Tightly packed
-		region.bufferImageHeight = 0;// Tightly packed
-		region.imageSubresource.aspectMask = createInfo.format == ETextureFormat::Depth ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
-		region.imageSubresource.mipLevel = 0;
-		region.imageSubresource.baseArrayLayer = 0;
-		region.imageSubresource.layerCount = 1;
-		region.imageOffset = { 0, 0, 0 };
-		region.imageExtent = { createInfo.textureWidth, createInfo.textureHeight, 1 };
-		copyRegions.emplace_back(region);
+		VkDeviceSize dataSize = 0;
 
-		pCmdBuffer->TransitionImageLayout(pVkTexture2D, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0);
+		for (uint32_t level = 0; level < dataLevels; ++level)
+		{
+			uint32_t levelWidth = std::max<uint32_t>(1, createInfo.textureWidth >> level);
+			uint32_t levelHeight = std::max<uint32_t>(1, createInfo.textureHeight >> level);
+
+			VkBufferImageCopy region = {};
+			region.bufferOffset = dataSize;
+			region.bufferRowLength = 0;  // Tightly packed
+			region.bufferImageHeight = 0;// Tightly packed
+			region.imageSubresource.aspectMask = createInfo.format == ETextureFormat::Depth ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+			region.imageSubresource.mipLevel = level;
+			region.imageSubresource.baseArrayLayer = 0;
+			region.imageSubresource.layerCount = 1;
+			region.imageOffset = { 0, 0, 0 };
+			region.imageExtent = { levelWidth, levelHeight, 1 };
+			copyRegions.emplace_back(region);
+
+			dataSize += Texture2DCreateInfo::GetLevelDataSize(createInfo.format, levelWidth, levelHeight);
+		}
 
-		pCmdBuffer->CopyBufferToTexture2D(pStagingBuffer, pVkTexture2D, copyRegions);
-	}
+		StagingAllocation_Vulkan staging = {};
+		if (!pDevice->pUploadManager->AllocateStaging(dataSize, staging))
+		{
+			std::cerr << "Vulkan: failed to allocate staging memory for texture 2D.\n";
 
-	if (createInfo.generateMipmap)
-	{
-		assert(createInfo.pTextureData != nullptr);
+			// Texture is left without content, but still transitioned so that binding it stays valid
+			auto pCmdBuffer = pDevice->pGraphicsCommandManager->RequestPrimaryCommandBuffer();
+			pCmdBuffer->TransitionImageLayout(pVkTexture2D, VulkanImageLayout(createInfo.initialLayout), (uint32_t)EShaderType::Fragment);
+			pDevice->pGraphicsCommandManager->SubmitSingleCommandBuffer_Immediate(pCmdBuffer);
+			return false;
+		}
+		memcpy(staging.pMappedData, createInfo.pTextureData, dataSize);
+
+		// Layout transition for all levels are included in mipmap generation
+		pDevice->pUploadManager->UploadTexture2D(pOutput->GetResourceID(), staging, pVkTexture2D, copyRegions,
+			createInfo.generateMipmap, VulkanImageLayout(createInfo.initialLayout), (uint32_t)EShaderType::Fragment); // Alert: the applied stages may not limit to fragment shader
 
-		// Layout transition for all levels are included
-		pCmdBuffer->GenerateMipmap(pVkTexture2D, VulkanImageLayout(createInfo.initialLayout), (uint32_t)EShaderType::Fragment);
+		// Generated levels add roughly one third on top of the base level
+		pOutput->MarkSizeInByte(static_cast<uint32_t>(createInfo.generateMipmap ? dataSize * 4 / 3 : dataSize));
 	}
-	else if (createInfo.initialLayout != EImageLayout::Undefined)
+	else
 	{
-		pCmdBuffer->TransitionImageLayout(pVkTexture2D, VulkanImageLayout(createInfo.initialLayout), (uint32_t)EShaderType::Fragment); // Alert: the applied stages may not limit to fragment shader
-	}
+		assert(!createInfo.generateMipmap);
 
-	pDevice->pGraphicsCommandManager->SubmitSingleCommandBuffer_Immediate(pCmdBuffer); // Alert: could end up submitting an empty command buffer
+		// Attachments are expected to be usable as soon as they are created
+		if (createInfo.initialLayout != EImageLayout::Undefined)
+		{
+			auto pCmdBuffer = pDevice->pGraphicsCommandManager->RequestPrimaryCommandBuffer();
+			pCmdBuffer->TransitionImageLayout(pVkTexture2D, VulkanImageLayout(createInfo.initialLayout), (uint32_t)EShaderType::Fragment);
+			pDevice->pGraphicsCommandManager->SubmitSingleCommandBuffer_Immediate(pCmdBuffer);
+		}
+	}
 
 	if (createInfo.pSampler != nullptr)
 	{
@@ -254,6 +272,20 @@ bool DrawingDevice_Vulkan::CreateFrameBuffer(const FrameBufferCreateInfo& create
 {
 	assert(pOutput == nullptr);
 
+	ObjectCacheKey_Vulkan cacheKey(ECachedObjectType_Vulkan::FrameBuffer);
+	cacheKey.AppendPointer(createInfo.pRenderPass.get());
+	cacheKey.Append(((uint64_t)createInfo.framebufferWidth << 32) | createInfo.framebufferHeight);
+	for (const auto& pAttachment : createInfo.attachments)
+	{
+		cacheKey.AppendPointer(pAttachment.get());
+	}
+
+	if (auto pCachedObject = m_pDevice_0->pObjectCache->Find(cacheKey))
+	{
+		pOutput = std::static_pointer_cast<FrameBuffer>(pCachedObject);
+		return true;
+	}
+
 	pOutput = std::make_shared<FrameBuffer_Vulkan>(m_pDevice_0);
 
 	auto pFrameBuffer = std::static_pointer_cast<FrameBuffer_Vulkan>(pOutput);
@@ -277,13 +309,21 @@ bool DrawingDevice_Vulkan::CreateFrameBuffer(const FrameBufferCreateInfo& create
 	pFrameBuffer->m_width = createInfo.framebufferWidth;
 	pFrameBuffer->m_height = createInfo.framebufferHeight;
 
-	return vkCreateFramebuffer(pFrameBuffer->m_pDevice->logicalDevice, &frameBufferInfo, nullptr, &pFrameBuffer->m_frameBuffer) == VK_SUCCESS;
+	if (vkCreateFramebuffer(pFrameBuffer->m_pDevice->logicalDevice, &frameBufferInfo, nullptr, &pFrameBuffer->m_frameBuffer) != VK_SUCCESS)
+	{
+		return false;
+	}
+
+	// Framebuffer holds its attachments, so it is only shared while some node still uses it
+	pOutput = std::static_pointer_cast<FrameBuffer>(m_pDevice_0->pObjectCache->Insert(cacheKey, pOutput, sizeof(FrameBuffer_Vulkan), false));
+	return true;
 }
 
 bool DrawingDevice_Vulkan::CreateUniformBuffer(const UniformBufferCreateInfo& createInfo, std::shared_ptr<UniformBuffer>& pOutput)
 {
 	UniformBufferCreateInfo_Vulkan vkUniformBufferCreateInfo = {};
 	vkUniformBufferCreateInfo.size = createInfo.sizeInBytes;
+	vkUniformBufferCreateInfo.subBufferCount = createInfo.subBufferCount;
 	vkUniformBufferCreateInfo.appliedStages = VulkanShaderStageFlags(createInfo.appliedStages);
 	vkUniformBufferCreateInfo.type = EUniformBufferType_Vulkan::Uniform;
 
@@ -298,7 +338,12 @@ void DrawingDevice_Vulkan::UpdateShaderParameter(std::shared_ptr<ShaderProgram>
 	auto pVkShader = std::static_pointer_cast<ShaderProgram_Vulkan>(pShaderProgram);
 
 	std::vector<DesciptorUpdateInfo_Vulkan> updateInfos;
-	std::shared_ptr<DrawingDescriptorSet_Vulkan> pTargetDescriptorSet = pVkShader->GetDescriptorSet();
+	std::map<uint32_t, uint32_t> dynamicOffsets; // Binding to offset, offsets have to be provided in binding order
+
+	// Descriptor sets with identical content are reused across draws and frames
+	// Uniform buffers are bound with dynamic offsets, so per-frame regions and sub allocations do not change the key
+	DescriptorSetKey_Vulkan descSetKey = {};
+	descSetKey.layout = *pVkShader->GetDescriptorSetLayout()->GetDescriptorSetLayout();
 
 	for (auto& item : pTable->m_table)
 	{
@@ -307,17 +352,30 @@ void DrawingDevice_Vulkan::UpdateShaderParameter(std::shared_ptr<ShaderProgram>
 		updateInfo.infoType = VulkanDescriptorResourceType(item.type);
 		updateInfo.dstDescriptorType = VulkanDescriptorType(item.type);
 		updateInfo.dstDescriptorBinding = item.binding;
-		updateInfo.dstDescriptorSet = pTargetDescriptorSet->m_descriptorSet;
+		updateInfo.dstDescriptorSet = VK_NULL_HANDLE; // Assigned by shader program when the set is actually written
 		updateInfo.dstArrayElement = 0; // Alert: incorrect if it contains array
 
+		descSetKey.Append(item.binding);
+		descSetKey.Append((uint64_t)item.type);
+
 		switch (updateInfo.infoType)
 		{
 		case EDescriptorResourceType_Vulkan::Buffer:
 		{
 			VkDescriptorBufferInfo bufferInfo = {};
-			GetBufferInfoByDescriptorType(item.type, item.pResource, bufferInfo);
+			uint32_t dynamicOffset = 0;
+			GetBufferInfoByDescriptorType(item.type, item.pResource, bufferInfo, dynamicOffset);
 
 			updateInfo.bufferInfos.emplace_back(bufferInfo);
+			dynamicOffsets[item.binding] = dynamicOffset;
+
+			// Sub buffers are re-allocated every frame, so the parent buffer is used to identify the content
+			uint32_t resourceID = item.type == EDescriptorType::SubUniformBuffer ? 
+				std::static_pointer_cast<SubUniformBuffer_Vulkan>(item.pResource)->m_pParentBuffer->GetResourceID() : item.pResource->GetResourceID();
+
+			descSetKey.Append(resourceID);
+			descSetKey.Append((uint64_t)bufferInfo.buffer);
+			descSetKey.Append(bufferInfo.range);
 
 			break;
 		}
@@ -357,6 +415,11 @@ void DrawingDevice_Vulkan::UpdateShaderParameter(std::shared_ptr<ShaderProgram>
 
 			updateInfo.imageInfos.emplace_back(imageInfo);
 
+			descSetKey.Append(pImage->GetResourceID());
+			descSetKey.Append((uint64_t)imageInfo.imageView);
+			descSetKey.Append((uint64_t)imageInfo.imageLayout);
+			descSetKey.Append((uint64_t)imageInfo.sampler);
+
 			break;
 		}
 		case EDescriptorResourceType_Vulkan::TexelBuffer:
@@ -375,10 +438,16 @@ void DrawingDevice_Vulkan::UpdateShaderParameter(std::shared_ptr<ShaderProgram>
 		updateInfos.emplace_back(updateInfo);
 	}
 
-	pVkShader->UpdateDescriptorSets(updateInfos);
+	std::shared_ptr<DrawingDescriptorSet_Vulkan> pTargetDescriptorSet = pVkShader->GetCachedDescriptorSet(descSetKey, updateInfos);
+
+	std::vector<uint32_t> dynamicOffsetValues;
+	for (auto& offset : dynamicOffsets)
+	{
+		dynamicOffsetValues.emplace_back(offset.second);
+	}
 
 	std::vector<std::shared_ptr<DrawingDescriptorSet_Vulkan>> descSets = { pTargetDescriptorSet };
-	std::static_pointer_cast<DrawingCommandBuffer_Vulkan>(pCommandBuffer)->BindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, descSets);
+	std::static_pointer_cast<DrawingCommandBuffer_Vulkan>(pCommandBuffer)->BindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, descSets, 0, dynamicOffsetValues);
 }
 
 void DrawingDevice_Vulkan::SetVertexBuffer(const std::shared_ptr<VertexBuffer> pVertexBuffer, std::shared_ptr<DrawingCommandBuffer> pCommandBuffer)
@@ -500,6 +569,28 @@ bool DrawingDevice_Vulkan::CreateDataTransferBuffer(const DataTransferBufferCrea
 
 bool DrawingDevice_Vulkan::CreateRenderPassObject(const RenderPassCreateInfo& createInfo, std::shared_ptr<RenderPassObject>& pOutput)
 {
+	ObjectCacheKey_Vulkan cacheKey(ECachedObjectType_Vulkan::RenderPass);
+	for (auto& desc : createInfo.attachmentDescriptions)
+	{
+		cacheKey.Append(((uint64_t)desc.format << 32) | desc.sampleCount);
+		cacheKey.Append(((uint64_t)desc.loadOp << 48) | ((uint64_t)desc.storeOp << 32) | ((uint64_t)desc.stencilLoadOp << 16) | (uint64_t)desc.stencilStoreOp);
+		cacheKey.Append(((uint64_t)desc.initialLayout << 32) | (uint64_t)desc.usageLayout);
+		cacheKey.Append(((uint64_t)desc.finalLayout << 32) | (uint64_t)desc.type);
+		cacheKey.Append(desc.index);
+	}
+	cacheKey.AppendFloat(createInfo.clearColor.r);
+	cacheKey.AppendFloat(createInfo.clearColor.g);
+	cacheKey.AppendFloat(createInfo.clearColor.b);
+	cacheKey.AppendFloat(createInfo.clearColor.a);
+	cacheKey.AppendFloat(createInfo.clearDepth);
+	cacheKey.Append(createInfo.clearStencil);
+
+	if (auto pCachedObject = m_pDevice_0->pObjectCache->Find(cacheKey))
+	{
+		pOutput = std::static_pointer_cast<RenderPassObject>(pCachedObject);
+		return true;
+	}
+
 	pOutput = std::make_shared<RenderPass_Vulkan>(m_pDevice_0);
 
 	auto pRenderPass = std::static_pointer_cast<RenderPass_Vulkan>(pOutput);
@@ -569,10 +660,11 @@ bool DrawingDevice_Vulkan::CreateRenderPassObject(const RenderPassCreateInfo& cr
 	VkSubpassDependency subpassDependency = {};
 	subpassDependency.srcSubpass = VK_SUBPASS_EXTERNAL;
 	subpassDependency.dstSubpass = 0;
-	subpassDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-	subpassDependency.srcAccessMask = 0;
-	subpassDependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-	subpassDependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	// Attachments could be aliasing the memory of textures sampled or written by previous passes, wait for those accesses as well
+	subpassDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	subpassDependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	subpassDependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+	subpassDependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
 
 	VkRenderPassCreateInfo renderPassInfo = {};
 	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
@@ -588,6 +680,7 @@ bool DrawingDevice_Vulkan::CreateRenderPassObject(const RenderPassCreateInfo& cr
 		throw std::runtime_error("Vulkan: failed to create render pass.");
 	}
 
+	pOutput = std::static_pointer_cast<RenderPassObject>(m_pDevice_0->pObjectCache->Insert(cacheKey, pOutput, sizeof(RenderPass_Vulkan) + pRenderPass->m_clearValues.size() * sizeof(VkClearValue)));
 	return true;
 }
 
@@ -618,6 +711,25 @@ bool DrawingDevice_Vulkan::CreateSampler(const TextureSamplerCreateInfo& createI
 
 bool DrawingDevice_Vulkan::CreatePipelineVertexInputState(const PipelineVertexInputStateCreateInfo& createInfo, std::shared_ptr<PipelineVertexInputState>& pOutput)
 {
+	ObjectCacheKey_Vulkan cacheKey(ECachedObjectType_Vulkan::VertexInputState);
+	cacheKey.Append(createInfo.bindingDescs.size());
+	for (auto& desc : createInfo.bindingDescs)
+	{
+		cacheKey.Append(((uint64_t)desc.binding << 32) | desc.stride);
+		cacheKey.Append((uint64_t)desc.inputRate);
+	}
+	for (auto& desc : createInfo.attributeDescs)
+	{
+		cacheKey.Append(((uint64_t)desc.location << 32) | desc.binding);
+		cacheKey.Append(((uint64_t)desc.format << 32) | desc.offset);
+	}
+
+	if (auto pCachedObject = m_pDevice_0->pObjectCache->Find(cacheKey))
+	{
+		pOutput = std::static_pointer_cast<PipelineVertexInputState>(pCachedObject);
+		return true;
+	}
+
 	std::vector<VkVertexInputBindingDescription> bindingDescs;
 	std::vector<VkVertexInputAttributeDescription> attributeDescs;
 
@@ -642,18 +754,46 @@ bool DrawingDevice_Vulkan::CreatePipelineVertexInputState(const PipelineVertexIn
 		attributeDescs.emplace_back(attribDesc);
 	}
 
+	size_t objectSize = sizeof(PipelineVertexInputState_Vulkan) + bindingDescs.size() * sizeof(VkVertexInputBindingDescription) + attributeDescs.size() * sizeof(VkVertexInputAttributeDescription);
+
 	pOutput = std::make_shared<PipelineVertexInputState_Vulkan>(bindingDescs, attributeDescs);
+	pOutput = std::static_pointer_cast<PipelineVertexInputState>(m_pDevice_0->pObjectCache->Insert(cacheKey, pOutput, objectSize));
 	return pOutput != nullptr;
 }
 
 bool DrawingDevice_Vulkan::CreatePipelineInputAssemblyState(const PipelineInputAssemblyStateCreateInfo& createInfo, std::shared_ptr<PipelineInputAssemblyState>& pOutput)
 {
+	ObjectCacheKey_Vulkan cacheKey(ECachedObjectType_Vulkan::InputAssemblyState);
+	cacheKey.Append(((uint64_t)createInfo.topology << 32) | (uint64_t)createInfo.enablePrimitiveRestart);
+
+	if (auto pCachedObject = m_pDevice_0->pObjectCache->Find(cacheKey))
+	{
+		pOutput = std::static_pointer_cast<PipelineInputAssemblyState>(pCachedObject);
+		return true;
+	}
+
 	pOutput = std::make_shared<PipelineInputAssemblyState_Vulkan>(createInfo);
+	pOutput = std::static_pointer_cast<PipelineInputAssemblyState>(m_pDevice_0->pObjectCache->Insert(cacheKey, pOutput, sizeof(PipelineInputAssemblyState_Vulkan)));
 	return pOutput != nullptr;
 }
 
 bool DrawingDevice_Vulkan::CreatePipelineColorBlendState(const PipelineColorBlendStateCreateInfo& createInfo, std::shared_ptr<PipelineColorBlendState>& pOutput)
 {
+	ObjectCacheKey_Vulkan cacheKey(ECachedObjectType_Vulkan::ColorBlendState);
+	for (auto& desc : createInfo.blendStateDescs)
+	{
+		cacheKey.Append(((uint64_t)desc.enableBlend << 32) | (uint64_t)desc.colorBlendOp);
+		cacheKey.Append(((uint64_t)desc.srcColorBlendFactor << 32) | (uint64_t)desc.dstColorBlendFactor);
+		cacheKey.Append(((uint64_t)desc.srcAlphaBlendFactor << 32) | (uint64_t)desc.dstAlphaBlendFactor);
+		cacheKey.Append((uint64_t)desc.alphaBlendOp);
+	}
+
+	if (auto pCachedObject = m_pDevice_0->pObjectCache->Find(cacheKey))
+	{
+		pOutput = std::static_pointer_cast<PipelineColorBlendState>(pCachedObject);
+		return true;
+	}
+
 	std::vector<VkPipelineColorBlendAttachmentState> blendAttachmentStates;
 
 	// If the independent blending feature is not enabled on the device, 
@@ -675,38 +815,115 @@ bool DrawingDevice_Vulkan::CreatePipelineColorBlendState(const PipelineColorBlen
 	}
 
 	pOutput = std::make_shared<PipelineColorBlendState_Vulkan>(blendAttachmentStates);
+	pOutput = std::static_pointer_cast<PipelineColorBlendState>(m_pDevice_0->pObjectCache->Insert(cacheKey, pOutput, sizeof(PipelineColorBlendState_Vulkan) + blendAttachmentStates.size() * sizeof(VkPipelineColorBlendAttachmentState)));
 	return pOutput != nullptr;
 }
 
 bool DrawingDevice_Vulkan::CreatePipelineRasterizationState(const PipelineRasterizationStateCreateInfo& createInfo, std::shared_ptr<PipelineRasterizationState>& pOutput)
 {
+	ObjectCacheKey_Vulkan cacheKey(ECachedObjectType_Vulkan::RasterizationState);
+	cacheKey.Append(((uint64_t)createInfo.enableDepthClamp << 32) | (uint64_t)createInfo.discardRasterizerResults);
+	cacheKey.Append(((uint64_t)createInfo.polygonMode << 32) | (uint64_t)createInfo.cullMode);
+	cacheKey.Append((uint64_t)createInfo.frontFaceCounterClockwise);
+
+	if (auto pCachedObject = m_pDevice_0->pObjectCache->Find(cacheKey))
+	{
+		pOutput = std::static_pointer_cast<PipelineRasterizationState>(pCachedObject);
+		return true;
+	}
+
 	pOutput = std::make_shared<PipelineRasterizationState_Vulkan>(createInfo);
+	pOutput = std::static_pointer_cast<PipelineRasterizationState>(m_pDevice_0->pObjectCache->Insert(cacheKey, pOutput, sizeof(PipelineRasterizationState_Vulkan)));
 	return pOutput != nullptr;
 }
 
 bool DrawingDevice_Vulkan::CreatePipelineDepthStencilState(const PipelineDepthStencilStateCreateInfo& createInfo, std::shared_ptr<PipelineDepthStencilState>& pOutput)
 {
+	ObjectCacheKey_Vulkan cacheKey(ECachedObjectType_Vulkan::DepthStencilState);
+	cacheKey.Append(((uint64_t)createInfo.enableDepthTest << 48) | ((uint64_t)createInfo.enableDepthWrite << 40) | ((uint64_t)createInfo.enableStencilTest << 32) | (uint64_t)createInfo.depthCompareOP);
+
+	if (auto pCachedObject = m_pDevice_0->pObjectCache->Find(cacheKey))
+	{
+		pOutput = std::static_pointer_cast<PipelineDepthStencilState>(pCachedObject);
+		return true;
+	}
+
 	pOutput = std::make_shared<PipelineDepthStencilState_Vulkan>(createInfo);
+	pOutput = std::static_pointer_cast<PipelineDepthStencilState>(m_pDevice_0->pObjectCache->Insert(cacheKey, pOutput, sizeof(PipelineDepthStencilState_Vulkan)));
 	return pOutput != nullptr;
 }
 
 bool DrawingDevice_Vulkan::CreatePipelineMultisampleState(const PipelineMultisampleStateCreateInfo& createInfo, std::shared_ptr<PipelineMultisampleState>& pOutput)
 {
+	ObjectCacheKey_Vulkan cacheKey(ECachedObjectType_Vulkan::MultisampleState);
+	cacheKey.Append(((uint64_t)createInfo.sampleCount << 32) | (uint64_t)createInfo.enableSampleShading);
+
+	if (auto pCachedObject = m_pDevice_0->pObjectCache->Find(cacheKey))
+	{
+		pOutput = std::static_pointer_cast<PipelineMultisampleState>(pCachedObject);
+		return true;
+	}
+
 	pOutput = std::make_shared<PipelineMultisampleState_Vulkan>(createInfo);
+	pOutput = std::static_pointer_cast<PipelineMultisampleState>(m_pDevice_0->pObjectCache->Insert(cacheKey, pOutput, sizeof(PipelineMultisampleState_Vulkan)));
 	return pOutput != nullptr;
 }
 
 bool DrawingDevice_Vulkan::CreatePipelineViewportState(const PipelineViewportStateCreateInfo& createInfo, std::shared_ptr<PipelineViewportState>& pOutput)
 {
+	ObjectCacheKey_Vulkan cacheKey(ECachedObjectType_Vulkan::ViewportState);
+	cacheKey.Append(((uint64_t)createInfo.width << 32) | createInfo.height);
+
+	if (auto pCachedObject = m_pDevice_0->pObjectCache->Find(cacheKey))
+	{
+		pOutput = std::static_pointer_cast<PipelineViewportState>(pCachedObject);
+		return true;
+	}
+
 	pOutput = std::make_shared<PipelineViewportState_Vulkan>(createInfo);
+	pOutput = std::static_pointer_cast<PipelineViewportState>(m_pDevice_0->pObjectCache->Insert(cacheKey, pOutput, sizeof(PipelineViewportState_Vulkan)));
 	return pOutput != nullptr;
 }
 
 bool DrawingDevice_Vulkan::CreateGraphicsPipelineObject(const GraphicsPipelineCreateInfo& createInfo, std::shared_ptr<GraphicsPipelineObject>& pOutput)
 {
+	// State objects and render passes are deduplicated as well, so identical pipelines reference identical objects
+	ObjectCacheKey_Vulkan cacheKey(ECachedObjectType_Vulkan::GraphicsPipeline);
+	cacheKey.AppendPointer(createInfo.pShaderProgram.get());
+	cacheKey.AppendPointer(createInfo.pVertexInputState.get());
+	cacheKey.AppendPointer(createInfo.pInputAssemblyState.get());
+	cacheKey.AppendPointer(createInfo.pColorBlendState.get());
+	cacheKey.AppendPointer(createInfo.pRasterizationState.get());
+	cacheKey.AppendPointer(createInfo.pDepthStencilState.get());
+	cacheKey.AppendPointer(createInfo.pMultisampleState.get());
+	cacheKey.AppendPointer(createInfo.pViewportState.get());
+	cacheKey.AppendPointer(createInfo.pRenderPass.get());
+	cacheKey.Append(createInfo.featureKey);
+
+	if (auto pCachedObject = m_pDevice_0->pObjectCache->Find(cacheKey))
+	{
+		pOutput = std::static_pointer_cast<GraphicsPipelineObject>(pCachedObject);
+		return true;
+	}
+
 	auto pShaderProgram = std::static_pointer_cast<ShaderProgram_Vulkan>(createInfo.pShaderProgram);
 
-	VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+	// Pipelines with compatible descriptor set layouts and push constant ranges share the same pipeline layout
+	PipelineLayoutKey_Vulkan layoutKey;
+
+	auto& setSignature = pShaderProgram->GetDescriptorSetLayout()->GetSignature();
+	layoutKey.Append(setSignature.size());
+	for (auto& value : setSignature)
+	{
+		layoutKey.Append(value);
+	}
+
+	for (uint32_t i = 0; i < pShaderProgram->GetPushConstantRangeCount(); ++i)
+	{
+		auto& range = pShaderProgram->GetPushConstantRanges()[i];
+		layoutKey.Append(((uint64_t)range.stageFlags << 32) | range.offset);
+		layoutKey.Append(range.size);
+	}
 
 	VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {};
 	pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
@@ -715,17 +932,36 @@ bool DrawingDevice_Vulkan::CreateGraphicsPipelineObject(const GraphicsPipelineCr
 	pipelineLayoutCreateInfo.pPushConstantRanges = pShaderProgram->GetPushConstantRanges();
 	pipelineLayoutCreateInfo.pSetLayouts = pShaderProgram->GetDescriptorSetLayout()->GetDescriptorSetLayout();
 
-	if (vkCreatePipelineLayout(m_pDevice_0->logicalDevice, &pipelineLayoutCreateInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
-	{
-		throw std::runtime_error("Vulkan: failed to create graphics pipeline layout.\n");
-		return false;
-	}
+	VkPipelineLayout pipelineLayout = m_pDevice_0->pPipelineCache->RequestPipelineLayout(layoutKey, pipelineLayoutCreateInfo);
 
 	VkGraphicsPipelineCreateInfo pipelineCreateInfo = {};
 	pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
 
-	pipelineCreateInfo.stageCount = pShaderProgram->GetStageCount();
-	pipelineCreateInfo.pStages = pShaderProgram->GetShaderStageCreateInfos();
+	// Every feature bit is provided as a boolean constant, IDs not declared by a shader stage are ignored by driver
+	std::array<VkBool32, (uint32_t)EMaterialFeature::COUNT> specializationData;
+	std::array<VkSpecializationMapEntry, (uint32_t)EMaterialFeature::COUNT> specializationEntries;
+	for (uint32_t i = 0; i < (uint32_t)EMaterialFeature::COUNT; ++i)
+	{
+		specializationData[i] = (createInfo.featureKey & (1u << i)) != 0 ? VK_TRUE : VK_FALSE;
+		specializationEntries[i].constantID = i;
+		specializationEntries[i].offset = i * sizeof(VkBool32);
+		specializationEntries[i].size = sizeof(VkBool32);
+	}
+
+	VkSpecializationInfo specializationInfo = {};
+	specializationInfo.mapEntryCount = (uint32_t)specializationEntries.size();
+	specializationInfo.pMapEntries = specializationEntries.data();
+	specializationInfo.dataSize = sizeof(VkBool32) * specializationData.size();
+	specializationInfo.pData = specializationData.data();
+
+	std::vector<VkPipelineShaderStageCreateInfo> shaderStages(pShaderProgram->GetShaderStageCreateInfos(), pShaderProgram->GetShaderStageCreateInfos() + pShaderProgram->GetStageCount());
+	for (auto& stage : shaderStages)
+	{
+		stage.pSpecializationInfo = &specializationInfo;
+	}
+
+	pipelineCreateInfo.stageCount = (uint32_t)shaderStages.size();
+	pipelineCreateInfo.pStages = shaderStages.data();
 
 	pipelineCreateInfo.pVertexInputState = std::static_pointer_cast<PipelineVertexInputState_Vulkan>(createInfo.pVertexInputState)->GetVertexInputStateCreateInfo();
 	pipelineCreateInfo.pInputAssemblyState = std::static_pointer_cast<PipelineInputAssemblyState_Vulkan>(createInfo.pInputAssemblyState)->GetInputAssemblyStateCreateInfo();
@@ -744,6 +980,7 @@ bool DrawingDevice_Vulkan::CreateGraphicsPipelineObject(const GraphicsPipelineCr
 	pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
 
 	pOutput = std::make_shared<GraphicsPipeline_Vulkan>(m_pDevice_0, pShaderProgram, pipelineCreateInfo);
+	pOutput = std::static_pointer_cast<GraphicsPipelineObject>(m_pDevice_0->pObjectCache->Insert(cacheKey, pOutput, sizeof(GraphicsPipeline_Vulkan)));
 
 	return pOutput != nullptr;
 }
@@ -861,24 +1098,32 @@ void DrawingDevice_Vulkan::Present()
 	auto pRenderFinishSemaphore = m_pSwapchain->m_pDevice->pSyncObjectManager->RequestSemaphore();
 	m_pSwapchain->m_pDevice->pImplicitCmdBuffer->SignalPresentationSemaphore(pRenderFinishSemaphore);
 
+	// Frame semaphore is recycled once the submission completes, so only its handle and the value to reach are kept
 	auto pFrameSemaphore = m_pSwapchain->m_pDevice->pSyncObjectManager->RequestTimelineSemaphore();
-	m_pSwapchain->m_pDevice->pGraphicsCommandManager->SubmitCommandBuffers(pFrameSemaphore, cmdBufferSubmitMask);
+	m_framesInFlight[m_currentFrame].submitSemaphore = pFrameSemaphore->semaphore;
+	m_framesInFlight[m_currentFrame].submitValue = pFrameSemaphore->GetSignalValue();
+	m_framesInFlight[m_currentFrame].pRenderFinishSemaphore = pRenderFinishSemaphore;
 
-	if (pFrameSemaphore->Wait(FRAME_TIMEOUT) != VK_SUCCESS)
-	{
-		throw std::runtime_error("Vulkan: Frame timeline semaphore timeout.");
-	}
+	// Uploads requested during this frame are submitted together, their graphics queue side goes out with this frame
+	m_pSwapchain->m_pDevice->pUploadManager->Flush();
+	m_pSwapchain->m_pDevice->pGraphicsCommandManager->SubmitCommandBuffers(pFrameSemaphore, cmdBufferSubmitMask);
 
 	m_pSwapchain->m_pDevice->pImplicitCmdBuffer = m_pSwapchain->m_pDevice->pGraphicsCommandManager->RequestPrimaryCommandBuffer();
 
 	std::vector<std::shared_ptr<DrawingSemaphore_Vulkan>> presentWaitSemaphores = { pRenderFinishSemaphore };
 	m_pSwapchain->Present(presentWaitSemaphores);
 
-	m_pSwapchain->m_pDevice->pSyncObjectManager->ReturnSemaphore(pRenderFinishSemaphore);
-
 	// Preparation for next frame
 
-	m_currentFrame = (m_currentFrame + 1) % MAX_FRAME_IN_FLIGHT;
+	m_pSwapchain->m_pDevice->pDescriptorAllocator->AdvanceFrame();
+#if defined(_DEBUG)
+	m_pSwapchain->m_pDevice->pObjectCache->ReportStatistics();
+#endif
+
+	m_currentFrame = (m_currentFrame + 1) % m_framesInFlight.size();
+
+	// Only block when the oldest frame in flight still holds the slot, its per-frame resources are about to be overwritten
+	WaitFrameInFlight(m_currentFrame);
 
 	m_pSwapchain->UpdateBackBuffer(m_currentFrame);
 	m_pSwapchain->m_pDevice->pImplicitCmdBuffer->WaitPresentationSemaphore(m_pSwapchain->GetImageAvailableSemaphore(m_currentFrame));
@@ -890,6 +1135,7 @@ void DrawingDevice_Vulkan::FlushCommands(bool waitExecution, bool flushImplicitC
 	if (flushImplicitCommands)
 	{
 		cmdBufferSubmitMask |= (uint32_t)EDrawingCommandBufferUsageFlagBits_Vulkan::Implicit;
+		m_pDevice_0->pUploadManager->Flush();
 	}
 
 	auto pSemaphore = m_pDevice_0->pSyncObjectManager->RequestTimelineSemaphore();
@@ -958,6 +1204,51 @@ uint32_t DrawingDevice_Vulkan::GetSwapchainPresentImageIndex() const
 	return m_pSwapchain->GetTargetImageIndex();
 }
 
+bool DrawingDevice_Vulkan::SupportColorAttachmentFormat(ETextureFormat format) const
+{
+	VkFormatProperties formatProperties = {};
+	vkGetPhysicalDeviceFormatProperties(m_pDevice_0->physicalDevice, VulkanImageFormat(format), &formatProperties);
+
+	VkFormatFeatureFlags requiredFeatures = VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+	return (formatProperties.optimalTilingFeatures & requiredFeatures) == requiredFeatures;
+}
+
+bool DrawingDevice_Vulkan::SupportTextureCompressionBC() const
+{
+	return m_pDevice_0->supportTextureCompressionBC;
+}
+
+bool DrawingDevice_Vulkan::IsVertexBufferUploaded(const std::shared_ptr<VertexBuffer> pVertexBuffer)
+{
+	return m_pDevice_0->pUploadManager->IsResourceUploaded(pVertexBuffer->GetResourceID());
+}
+
+bool DrawingDevice_Vulkan::IsTexture2DUploaded(const std::shared_ptr<Texture2D> pTexture)
+{
+	std::shared_ptr<Texture2D> pDeviceTexture = nullptr;
+	switch (pTexture->QuerySource())
+	{
+	case ETexture2DSource::ImageTexture:
+		pDeviceTexture = std::static_pointer_cast<ImageTexture>(pTexture)->GetTexture();
+		break;
+
+	case ETexture2DSource::RenderTexture:
+		pDeviceTexture = std::static_pointer_cast<RenderTexture>(pTexture)->GetTexture();
+		break;
+
+	case ETexture2DSource::RawDeviceTexture:
+		pDeviceTexture = pTexture;
+		break;
+
+	default:
+		throw std::runtime_error("Vulkan: Unhandled texture 2D source type.");
+		return false;
+	}
+
+	// Upload manager tracks device textures by their own resource IDs
+	return m_pDevice_0->pUploadManager->IsResourceUploaded(pDeviceTexture->GetResourceID());
+}
+
 void DrawingDevice_Vulkan::CopyTexture2DToDataTransferBuffer(std::shared_ptr<Texture2D> pSrcTexture, std::shared_ptr<DataTransferBuffer> pDstBuffer, std::shared_ptr<DrawingCommandBuffer> pCommandBuffer)
 {
 	auto pVkTexture = std::static_pointer_cast<Texture2D_Vulkan>(pSrcTexture);
@@ -1302,9 +1593,14 @@ void DrawingDevice_Vulkan::CreateLogicalDevice(std::shared_ptr<LogicalDevice_Vul
 	timelineSemaphoreFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
 	timelineSemaphoreFeatures.timelineSemaphore = true;
 
+	VkPhysicalDeviceFeatures supportedFeatures = {};
+	vkGetPhysicalDeviceFeatures(pDevice->physicalDevice, &supportedFeatures);
+	pDevice->supportTextureCompressionBC = supportedFeatures.textureCompressionBC == VK_TRUE;
+
 	// TODO: configure device features by configuration settings
 	VkPhysicalDeviceFeatures deviceFeatures = {};
 	deviceFeatures.samplerAnisotropy = VK_TRUE;
+	deviceFeatures.textureCompressionBC = pDevice->supportTextureCompressionBC ? VK_TRUE : VK_FALSE;
 
 	VkPhysicalDeviceFeatures2 physicalDeviceFeatures2 = {};
 	physicalDeviceFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
@@ -1367,13 +1663,34 @@ void DrawingDevice_Vulkan::CreateLogicalDevice(std::shared_ptr<LogicalDevice_Vul
 
 #if defined(_DEBUG)
 	std::cout << "Vulkan: Logical device created on " << pDevice->deviceProperties.deviceName << "\n";
+	std::cout << "Vulkan: BC texture compression is " << (pDevice->supportTextureCompressionBC ? "enabled" : "unavailable, image textures are left uncompressed") << "\n";
 #endif
 }
 
+void DrawingDevice_Vulkan::SetupFramesInFlight()
+{
+	uint32_t framesInFlight = gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetMaxFramesInFlight();
+	if (framesInFlight == 0 || framesInFlight > MAX_FRAME_IN_FLIGHT)
+	{
+		std::cerr << "Vulkan: Unsupported frames in flight count " << framesInFlight << ", clamped to [1, " << MAX_FRAME_IN_FLIGHT << "].\n";
+		framesInFlight = framesInFlight == 0 ? 1 : MAX_FRAME_IN_FLIGHT;
+	}
+
+	m_pDevice_0->framesInFlight = framesInFlight;
+
+	m_framesInFlight.resize(framesInFlight);
+	for (auto& frame : m_framesInFlight)
+	{
+		frame.submitSemaphore = VK_NULL_HANDLE;
+		frame.submitValue = 0;
+		frame.pRenderFinishSemaphore = nullptr;
+	}
+}
+
 void DrawingDevice_Vulkan::SetupSwapchain()
 {
 	DrawingSwapchainCreateInfo_Vulkan createInfo = {};
-	createInfo.maxFramesInFlight = MAX_FRAME_IN_FLIGHT;
+	createInfo.maxFramesInFlight = m_pDevice_0->framesInFlight;
 	createInfo.presentMode = gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetVSync() ? VK_PRESENT_MODE_FIFO_KHR : VK_PRESENT_MODE_MAILBOX_KHR;
 	createInfo.queueFamilyIndices = FindQueueFamilies_VK(m_pDevice_0->physicalDevice, m_presentationSurface);
 	createInfo.supportDetails = QuerySwapchainSupport_VK(m_pDevice_0->physicalDevice, m_presentationSurface);
@@ -1466,6 +1783,38 @@ void DrawingDevice_Vulkan::CreateShaderModuleFromFile(const char* shaderFilePath
 	assert(outModule != VK_NULL_HANDLE && result == VK_SUCCESS);
 }
 
+std::shared_ptr<RawShader_Vulkan> DrawingDevice_Vulkan::LoadShaderImpl(const char* shaderFilePath, VkShaderStageFlagBits shaderStage)
+{
+	auto pShader = m_pDevice_0->pShaderPack->RequestShader(shaderFilePath, shaderStage);
+	if (pShader)
+	{
+		return pShader; // Module and reflection data are ready
+	}
+
+	VkShaderModule shaderModule = VK_NULL_HANDLE;
+	std::vector<char> rawCode;
+
+	CreateShaderModuleFromFile(shaderFilePath, m_pDevice_0, shaderModule, rawCode);
+
+	switch (shaderStage)
+	{
+	case VK_SHADER_STAGE_VERTEX_BIT:
+		pShader = std::make_shared<VertexShader_Vulkan>(m_pDevice_0, shaderModule, rawCode)->GetShaderImpl();
+		break;
+
+	case VK_SHADER_STAGE_FRAGMENT_BIT:
+		pShader = std::make_shared<FragmentShader_Vulkan>(m_pDevice_0, shaderModule, rawCode)->GetShaderImpl();
+		break;
+
+	default:
+		throw std::runtime_error("Vulkan: Unhandled shader stage.");
+		return nullptr;
+	}
+
+	m_pDevice_0->pShaderPack->RecordShader(shaderFilePath, pShader);
+	return pShader;
+}
+
 void DrawingDevice_Vulkan::SetupCommandManager()
 {
 	// Graphics queue by default must be supported
@@ -1498,6 +1847,26 @@ void DrawingDevice_Vulkan::SetupDescriptorAllocator()
 	m_pDevice_0->pDescriptorAllocator = std::make_shared<DrawingDescriptorAllocator_Vulkan>(m_pDevice_0);
 }
 
+void DrawingDevice_Vulkan::SetupUploadManager()
+{
+	m_pDevice_0->pUploadManager = std::make_shared<DrawingUploadManager_Vulkan>(m_pDevice_0);
+}
+
+void DrawingDevice_Vulkan::SetupPipelineCache()
+{
+	m_pDevice_0->pPipelineCache = std::make_shared<DrawingPipelineCache_Vulkan>(m_pDevice_0, PIPELINE_CACHE_FILE_PATH);
+}
+
+void DrawingDevice_Vulkan::SetupObjectCache()
+{
+	m_pDevice_0->pObjectCache = std::make_shared<DrawingObjectCache_Vulkan>();
+}
+
+void DrawingDevice_Vulkan::SetupShaderPack()
+{
+	m_pDevice_0->pShaderPack = std::make_shared<DrawingShaderPack_Vulkan>(m_pDevice_0, SHADER_PACK_FILE_PATH);
+}
+
 EDescriptorResourceType_Vulkan DrawingDevice_Vulkan::VulkanDescriptorResourceType(EDescriptorType type) const
 {
 	switch (type)
@@ -1523,7 +1892,7 @@ EDescriptorResourceType_Vulkan DrawingDevice_Vulkan::VulkanDescriptorResourceTyp
 	}
 }
 
-void DrawingDevice_Vulkan::GetBufferInfoByDescriptorType(EDescriptorType type, const std::shared_ptr<RawResource> pRes, VkDescriptorBufferInfo& outInfo)
+void DrawingDevice_Vulkan::GetBufferInfoByDescriptorType(EDescriptorType type, const std::shared_ptr<RawResource> pRes, VkDescriptorBufferInfo& outInfo, uint32_t& outDynamicOffset)
 {
 	switch (type)
 	{
@@ -1532,18 +1901,49 @@ void DrawingDevice_Vulkan::GetBufferInfoByDescriptorType(EDescriptorType type, c
 		auto pBuffer = std::static_pointer_cast<UniformBuffer_Vulkan>(pRes);
 		outInfo.buffer = pBuffer->GetBufferImpl()->m_buffer;
 		outInfo.offset = 0;
-		outInfo.range = VK_WHOLE_SIZE;
+		outInfo.range = pBuffer->GetSizeInByte();
+		outDynamicOffset = pBuffer->GetCurrentRegionOffset();
 		break;
 	}
 	case EDescriptorType::SubUniformBuffer:
 	{
 		auto pBuffer = std::static_pointer_cast<SubUniformBuffer_Vulkan>(pRes);
 		outInfo.buffer = pBuffer->m_buffer;
-		outInfo.offset = pBuffer->m_offset;
+		outInfo.offset = 0;
 		outInfo.range = pBuffer->m_size;
+		outDynamicOffset = pBuffer->m_offset;
 		break;
 	}
 	default:
 		throw std::runtime_error("Vulkan: Unhandled buffer descriptor type or misclassified buffer descriptor type.");
 	}
+}
+
+void DrawingDevice_Vulkan::WaitFrameInFlight(unsigned int frameSlot)
+{
+	assert(frameSlot < m_framesInFlight.size());
+	auto& frame = m_framesInFlight[frameSlot];
+
+	if (frame.submitSemaphore != VK_NULL_HANDLE)
+	{
+		VkSemaphoreWaitInfo waitInfo = {};
+		waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+		waitInfo.semaphoreCount = 1;
+		waitInfo.pSemaphores = &frame.submitSemaphore;
+		waitInfo.pValues = &frame.submitValue;
+
+		if (vkWaitSemaphores(m_pDevice_0->logicalDevice, &waitInfo, FRAME_TIMEOUT) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Vulkan: Frame timeline semaphore timeout.");
+		}
+
+		frame.submitSemaphore = VK_NULL_HANDLE;
+	}
+
+	// Presentation engine has no completion signal, render finish semaphore is only safe to reuse once the slot comes around again
+	if (frame.pRenderFinishSemaphore != nullptr)
+	{
+		m_pDevice_0->pSyncObjectManager->ReturnSemaphore(frame.pRenderFinishSemaphore);
+		frame.pRenderFinishSemaphore = nullptr;
+	}
 }
\ No newline at end of file
@@ -4,7 +4,11 @@
 #include "DrawingCommandManager_Vulkan.h"
 #include "DrawingResources_Vulkan.h"
 #include "DrawingUploadAllocator_Vulkan.h"
+#include "DrawingUploadManager_Vulkan.h"
 #include "DrawingDescriptorAllocator_Vulkan.h"
+#include "DrawingPipelineCache_Vulkan.h"
+#include "DrawingObjectCache_Vulkan.h"
+#include "DrawingShaderPack_Vulkan.h"
 
 namespace Engine
 {
@@ -14,6 +18,8 @@ namespace Engine
 		VkPhysicalDevice		   physicalDevice;
 		VkDevice				   logicalDevice;
 		VkPhysicalDeviceProperties deviceProperties;
+		bool					   supportTextureCompressionBC;
+		uint32_t				   framesInFlight; // Frames that can be recorded ahead of the GPU, per-frame resources are replicated by this count
 
 		DrawingCommandQueue_Vulkan presentQueue;
 		DrawingCommandQueue_Vulkan graphicsQueue;
@@ -22,8 +28,12 @@ namespace Engine
 		std::shared_ptr<DrawingCommandManager_Vulkan>		pGraphicsCommandManager;
 		std::shared_ptr<DrawingCommandManager_Vulkan>		pTransferCommandManager;
 		std::shared_ptr<DrawingUploadAllocator_Vulkan>		pUploadAllocator;
+		std::shared_ptr<DrawingUploadManager_Vulkan>		pUploadManager; // Vertex and texture data uploads, flushed once per frame
 		std::shared_ptr<DrawingDescriptorAllocator_Vulkan>	pDescriptorAllocator;
 		std::shared_ptr<DrawingSyncObjectManager_Vulkan>	pSyncObjectManager;
+		std::shared_ptr<DrawingPipelineCache_Vulkan>		pPipelineCache;
+		std::shared_ptr<DrawingObjectCache_Vulkan>			pObjectCache; // Deduplicates pipeline states, render passes, pipelines and framebuffers
+		std::shared_ptr<DrawingShaderPack_Vulkan>			pShaderPack;
 
 		std::shared_ptr<DrawingCommandBuffer_Vulkan>		pImplicitCmdBuffer; // Command buffer used implicitly inside drawing device, for graphics queue
 	};
@@ -105,6 +115,11 @@ namespace Engine
 		void GetSwapchainImages(std::vector<std::shared_ptr<Texture2D>>& outImages) const override;
 		uint32_t GetSwapchainPresentImageIndex() const override;
 
+		bool SupportColorAttachmentFormat(ETextureFormat format) const override;
+		bool SupportTextureCompressionBC() const override;
+		bool IsVertexBufferUploaded(const std::shared_ptr<VertexBuffer> pVertexBuffer) override;
+		bool IsTexture2DUploaded(const std::shared_ptr<Texture2D> pTexture) override;
+
 		void CopyTexture2DToDataTransferBuffer(std::shared_ptr<Texture2D> pSrcTexture, std::shared_ptr<DataTransferBuffer> pDstBuffer, std::shared_ptr<DrawingCommandBuffer> pCommandBuffer) override;
 		void CopyDataTransferBufferToTexture2D(std::shared_ptr<DataTransferBuffer> pSrcBuffer, std::shared_ptr<Texture2D> pDstTexture, std::shared_ptr<DrawingCommandBuffer> pCommandBuffer) override;
 		void CopyDataTransferBufferCrossDevice(std::shared_ptr<DataTransferBuffer> pSrcBuffer, std::shared_ptr<DataTransferBuffer> pDstBuffer) override;
@@ -121,26 +136,37 @@ namespace Engine
 		void SelectPhysicalDevice();
 		void CreateLogicalDevice();
 		void CreateLogicalDevice(std::shared_ptr<LogicalDevice_Vulkan> pDevice);
+		void SetupFramesInFlight();
 		void SetupSwapchain();
 		VkSurfaceFormatKHR ChooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats);
 		void CreateDefaultSampler();
 
 		// Shader-related functions
 		void CreateShaderModuleFromFile(const char* shaderFilePath, std::shared_ptr<LogicalDevice_Vulkan> pLogicalDevice, VkShaderModule& outModule, std::vector<char>& outRawCode);
+		std::shared_ptr<RawShader_Vulkan> LoadShaderImpl(const char* shaderFilePath, VkShaderStageFlagBits shaderStage);
 
 		// Manager setup functions
 		void SetupCommandManager();
 		void SetupSyncObjectManager();
 		void SetupUploadAllocator();
 		void SetupDescriptorAllocator();
+		void SetupUploadManager();
+		void SetupPipelineCache();
+		void SetupObjectCache();
+		void SetupShaderPack();
 
 		// Converter functions
 		EDescriptorResourceType_Vulkan VulkanDescriptorResourceType(EDescriptorType type) const;
-		void GetBufferInfoByDescriptorType(EDescriptorType type, const std::shared_ptr<RawResource> pRes, VkDescriptorBufferInfo& outInfo);
+		void GetBufferInfoByDescriptorType(EDescriptorType type, const std::shared_ptr<RawResource> pRes, VkDescriptorBufferInfo& outInfo, uint32_t& outDynamicOffset);
+
+		// Frame pacing
+		void WaitFrameInFlight(unsigned int frameSlot);
 
 	public:
 		const uint64_t FRAME_TIMEOUT = 5e9; // 5 seconds
-		const static unsigned int MAX_FRAME_IN_FLIGHT = 2;
+		const static unsigned int MAX_FRAME_IN_FLIGHT = 3; // Upper bound of configured frames in flight
+		const char* PIPELINE_CACHE_FILE_PATH = "PipelineCache_Vulkan.bin";
+		const char* SHADER_PACK_FILE_PATH = "Assets/Shader/SPIRV/ShaderPack_Vulkan.pack";
 
 	private:
 #if defined(_DEBUG)
@@ -165,6 +191,15 @@ namespace Engine
 		std::shared_ptr<DrawingSwapchain_Vulkan> m_pSwapchain;
 		unsigned int m_currentFrame;
 
+		// Submission of the last frame recorded in each slot, host only waits on it when the slot is about to be reused
+		struct FrameInFlight
+		{
+			VkSemaphore submitSemaphore;
+			uint64_t submitValue;
+			std::shared_ptr<DrawingSemaphore_Vulkan> pRenderFinishSemaphore;
+		};
+		std::vector<FrameInFlight> m_framesInFlight;
+
 		std::shared_ptr<Sampler_Vulkan> m_pDefaultSampler_0; // For main GPU
 		std::shared_ptr<Sampler_Vulkan> m_pDefaultSampler_1;
 		//... (Extend required GPU here)
@@ -0,0 +1,96 @@
+#include "DrawingObjectCache_Vulkan.h"
+#include <iostream>
+
+using namespace Engine;
+
+DrawingObjectCache_Vulkan::DrawingObjectCache_Vulkan()
+	: m_hasNewRequests(false)
+{
+	m_statistics = {};
+}
+
+std::shared_ptr<void> DrawingObjectCache_Vulkan::Find(const ObjectCacheKey_Vulkan& key)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_hasNewRequests = true;
+
+	auto itr = m_cachedObjects.find(key);
+	if (itr == m_cachedObjects.end())
+	{
+		return nullptr;
+	}
+
+	auto pObject = itr->second.pObject ? itr->second.pObject : itr->second.pWeakObject.lock();
+	if (!pObject)
+	{
+		m_cachedObjects.erase(itr); // Expired, would be recreated by caller
+		return nullptr;
+	}
+
+	m_statistics.hitCount[(uint32_t)key.type]++;
+	m_statistics.savedBytes += itr->second.objectSize;
+
+	return pObject;
+}
+
+std::shared_ptr<void> DrawingObjectCache_Vulkan::Insert(const ObjectCacheKey_Vulkan& key, const std::shared_ptr<void> pObject, size_t objectSize, bool retainObject)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto itr = m_cachedObjects.find(key);
+	if (itr != m_cachedObjects.end())
+	{
+		auto pCachedObject = itr->second.pObject ? itr->second.pObject : itr->second.pWeakObject.lock();
+		if (pCachedObject)
+		{
+			// Another thread created the same object first, the new one would be released by caller
+			return pCachedObject;
+		}
+	}
+
+	CacheEntry entry = {};
+	entry.pObject = retainObject ? pObject : nullptr;
+	entry.pWeakObject = pObject;
+	entry.objectSize = objectSize;
+
+	m_cachedObjects[key] = entry;
+	m_statistics.createdCount[(uint32_t)key.type]++;
+
+	return pObject;
+}
+
+ObjectCacheStatistics_Vulkan DrawingObjectCache_Vulkan::GetStatistics() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_statistics;
+}
+
+void DrawingObjectCache_Vulkan::ReportStatistics()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (!m_hasNewRequests)
+	{
+		return;
+	}
+	m_hasNewRequests = false;
+
+	const char* typeNames[(uint32_t)ECachedObjectType_Vulkan::COUNT] =
+	{
+		"vertex input", "input assembly", "color blend", "rasterization", "depth stencil",
+		"multisample", "viewport", "render pass", "graphics pipeline", "framebuffer"
+	};
+
+	uint32_t totalHits = 0;
+	uint32_t totalCreated = 0;
+
+	std::cout << "Vulkan: Device object cache (hits / created):";
+	for (uint32_t i = 0; i < (uint32_t)ECachedObjectType_Vulkan::COUNT; ++i)
+	{
+		std::cout << (i == 0 ? " " : ", ") << typeNames[i] << " " << m_statistics.hitCount[i] << "/" << m_statistics.createdCount[i];
+		totalHits += m_statistics.hitCount[i];
+		totalCreated += m_statistics.createdCount[i];
+	}
+	std::cout << ". " << totalHits << " of " << totalHits + totalCreated << " requests shared, " << m_statistics.savedBytes << " bytes saved.\n";
+}
\ No newline at end of file
@@ -0,0 +1,109 @@
+#pragma once
+#include "NoCopy.h"
+
+#include <vulkan.h>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <mutex>
+#include <cstring>
+
+namespace Engine
+{
+	enum class ECachedObjectType_Vulkan
+	{
+		VertexInputState = 0,
+		InputAssemblyState,
+		ColorBlendState,
+		RasterizationState,
+		DepthStencilState,
+		MultisampleState,
+		ViewportState,
+		RenderPass,
+		GraphicsPipeline,
+		FrameBuffer,
+		COUNT
+	};
+
+	// Identifies a device object by its type and the full content of its create info
+	struct ObjectCacheKey_Vulkan
+	{
+		ObjectCacheKey_Vulkan(ECachedObjectType_Vulkan objectType)
+			: type(objectType), hash(std::hash<uint32_t>()((uint32_t)objectType))
+		{
+		}
+
+		ECachedObjectType_Vulkan	type;
+		std::vector<uint64_t>		contents;
+		size_t						hash;
+
+		void Append(uint64_t value)
+		{
+			contents.emplace_back(value);
+			hash ^= std::hash<uint64_t>()(value) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		}
+
+		void AppendFloat(float value)
+		{
+			uint32_t bits = 0;
+			memcpy(&bits, &value, sizeof(float));
+			Append((uint64_t)bits);
+		}
+
+		void AppendPointer(const void* ptr)
+		{
+			Append((uint64_t)ptr);
+		}
+
+		bool operator==(const ObjectCacheKey_Vulkan& other) const
+		{
+			return hash == other.hash && type == other.type && contents == other.contents;
+		}
+	};
+
+	struct ObjectCacheKeyHasher_Vulkan
+	{
+		size_t operator()(const ObjectCacheKey_Vulkan& key) const
+		{
+			return key.hash;
+		}
+	};
+
+	struct ObjectCacheStatistics_Vulkan
+	{
+		uint32_t hitCount[(uint32_t)ECachedObjectType_Vulkan::COUNT];
+		uint32_t createdCount[(uint32_t)ECachedObjectType_Vulkan::COUNT];
+		size_t	 savedBytes; // Host memory of the wrapper objects that were not created
+	};
+
+	// Shares identical pipeline states, render passes, pipelines and framebuffers among all render nodes
+	class DrawingObjectCache_Vulkan : public NoCopy
+	{
+	public:
+		DrawingObjectCache_Vulkan();
+		~DrawingObjectCache_Vulkan() = default;
+
+		std::shared_ptr<void> Find(const ObjectCacheKey_Vulkan& key);
+		// Objects not retained are only shared while they are still referenced elsewhere, e.g. framebuffers keep their attachments alive
+		// Returns the object that ends up in cache, which could have been inserted by another thread
+		std::shared_ptr<void> Insert(const ObjectCacheKey_Vulkan& key, const std::shared_ptr<void> pObject, size_t objectSize, bool retainObject = true);
+
+		ObjectCacheStatistics_Vulkan GetStatistics() const;
+		void ReportStatistics(); // Only prints if there were new requests since last report, called in debug builds
+
+	private:
+		struct CacheEntry
+		{
+			std::shared_ptr<void>	pObject;
+			std::weak_ptr<void>		pWeakObject;
+			size_t					objectSize;
+		};
+
+		mutable std::mutex m_mutex;
+		std::unordered_map<ObjectCacheKey_Vulkan, CacheEntry, ObjectCacheKeyHasher_Vulkan> m_cachedObjects;
+
+		ObjectCacheStatistics_Vulkan m_statistics;
+		bool m_hasNewRequests;
+	};
+}
\ No newline at end of file
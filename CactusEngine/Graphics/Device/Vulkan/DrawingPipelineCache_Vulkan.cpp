@@ -0,0 +1,238 @@
+#include "DrawingPipelineCache_Vulkan.h"
+#include "DrawingDevice_Vulkan.h"
+
+#include <fstream>
+#include <chrono>
+#include <cstring>
+#include <assert.h>
+
+using namespace Engine;
+
+DrawingPipelineCache_Vulkan::DrawingPipelineCache_Vulkan(const std::shared_ptr<LogicalDevice_Vulkan> pDevice, const char* cacheFilePath)
+	: m_pDevice(pDevice), m_cacheFilePath(cacheFilePath), m_pipelineCache(VK_NULL_HANDLE), m_isDirty(false), m_hasReportedStartup(false)
+{
+	m_statistics = {};
+
+	std::vector<char> initialData;
+	LoadFromFile(initialData);
+
+	m_statistics.isWarmStart = !initialData.empty();
+	m_statistics.loadedDataSize = initialData.size();
+
+	VkPipelineCacheCreateInfo createInfo = {};
+	createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	createInfo.initialDataSize = initialData.size();
+	createInfo.pInitialData = initialData.empty() ? nullptr : initialData.data();
+
+	if (vkCreatePipelineCache(m_pDevice->logicalDevice, &createInfo, nullptr, &m_pipelineCache) != VK_SUCCESS)
+	{
+		std::cerr << "Vulkan: failed to create pipeline cache from " << m_cacheFilePath << ", falling back to an empty cache.\n";
+
+		createInfo.initialDataSize = 0;
+		createInfo.pInitialData = nullptr;
+		m_statistics.isWarmStart = false;
+		m_statistics.loadedDataSize = 0;
+
+		if (vkCreatePipelineCache(m_pDevice->logicalDevice, &createInfo, nullptr, &m_pipelineCache) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Vulkan: failed to create pipeline cache.");
+		}
+	}
+}
+
+DrawingPipelineCache_Vulkan::~DrawingPipelineCache_Vulkan()
+{
+	for (auto& entry : m_pipelineLayouts)
+	{
+		vkDestroyPipelineLayout(m_pDevice->logicalDevice, entry.second, nullptr);
+	}
+	m_pipelineLayouts.clear();
+
+	vkDestroyPipelineCache(m_pDevice->logicalDevice, m_pipelineCache, nullptr);
+}
+
+VkResult DrawingPipelineCache_Vulkan::CreateGraphicsPipeline(const VkGraphicsPipelineCreateInfo& createInfo, VkPipeline& outPipeline)
+{
+	auto creationStart = std::chrono::high_resolution_clock::now();
+
+	// Pipeline cache is internally synchronized, no need to hold the lock during creation
+	VkResult result = vkCreateGraphicsPipelines(m_pDevice->logicalDevice, m_pipelineCache, 1, &createInfo, nullptr, &outPipeline);
+
+	std::chrono::duration<float, std::milli> creationTime = std::chrono::high_resolution_clock::now() - creationStart;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (result == VK_SUCCESS)
+	{
+		m_statistics.pipelineCount++;
+		m_statistics.pipelineCreationTime += creationTime.count();
+		m_isDirty = true;
+	}
+
+	return result;
+}
+
+VkPipelineLayout DrawingPipelineCache_Vulkan::RequestPipelineLayout(const PipelineLayoutKey_Vulkan& key, const VkPipelineLayoutCreateInfo& createInfo)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_statistics.layoutRequestCount++;
+
+	auto itr = m_pipelineLayouts.find(key);
+	if (itr != m_pipelineLayouts.end())
+	{
+		return itr->second;
+	}
+
+	VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+	if (vkCreatePipelineLayout(m_pDevice->logicalDevice, &createInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Vulkan: failed to create graphics pipeline layout.");
+		return VK_NULL_HANDLE;
+	}
+
+	m_pipelineLayouts.emplace(key, pipelineLayout);
+	m_statistics.layoutCount = (uint32_t)m_pipelineLayouts.size();
+
+	return pipelineLayout;
+}
+
+bool DrawingPipelineCache_Vulkan::SaveToFile()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (!m_isDirty)
+	{
+		return true;
+	}
+
+	if (!m_hasReportedStartup)
+	{
+		std::cout << "Vulkan: Created " << m_statistics.pipelineCount << " graphics pipelines in " << m_statistics.pipelineCreationTime << " ms with "
+			<< (m_statistics.isWarmStart ? "warm" : "cold") << " pipeline cache (" << m_statistics.loadedDataSize << " bytes loaded), "
+			<< m_statistics.layoutCount << " pipeline layouts shared by " << m_statistics.layoutRequestCount << " requests.\n";
+		m_hasReportedStartup = true;
+	}
+
+	size_t dataSize = 0;
+	if (vkGetPipelineCacheData(m_pDevice->logicalDevice, m_pipelineCache, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0)
+	{
+		std::cerr << "Vulkan: failed to retrieve pipeline cache data.\n";
+		return false;
+	}
+
+	std::vector<char> data(dataSize);
+	if (vkGetPipelineCacheData(m_pDevice->logicalDevice, m_pipelineCache, &dataSize, data.data()) != VK_SUCCESS)
+	{
+		std::cerr << "Vulkan: failed to retrieve pipeline cache data.\n";
+		return false;
+	}
+
+	CacheFileHeader header = {};
+	header.magic = CACHE_FILE_MAGIC;
+	header.version = CACHE_FILE_VERSION;
+	header.driverVersion = m_pDevice->deviceProperties.driverVersion;
+	header.dataSize = dataSize;
+	header.checksum = ComputeChecksum(data.data(), dataSize);
+
+	std::ofstream file(m_cacheFilePath, std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		std::cerr << "Vulkan: failed to open pipeline cache file for writing: " << m_cacheFilePath << std::endl;
+		return false;
+	}
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(CacheFileHeader));
+	file.write(data.data(), dataSize);
+	file.close();
+
+	m_isDirty = false;
+	return true;
+}
+
+PipelineCacheStatistics_Vulkan DrawingPipelineCache_Vulkan::GetStatistics() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_statistics;
+}
+
+void DrawingPipelineCache_Vulkan::LoadFromFile(std::vector<char>& outData) const
+{
+	outData.clear();
+
+	std::ifstream file(m_cacheFilePath, std::ios::ate | std::ios::binary);
+	if (!file.is_open())
+	{
+		return; // Cold start
+	}
+
+	size_t fileSize = (size_t)file.tellg();
+	if (fileSize < sizeof(CacheFileHeader))
+	{
+		return;
+	}
+
+	CacheFileHeader header = {};
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(&header), sizeof(CacheFileHeader));
+
+	if (header.magic != CACHE_FILE_MAGIC || header.version != CACHE_FILE_VERSION || header.dataSize != fileSize - sizeof(CacheFileHeader))
+	{
+		std::cerr << "Vulkan: discarding malformed pipeline cache file " << m_cacheFilePath << std::endl;
+		return;
+	}
+
+	if (header.driverVersion != m_pDevice->deviceProperties.driverVersion)
+	{
+		std::cout << "Vulkan: driver version changed, discarding pipeline cache.\n";
+		return;
+	}
+
+	std::vector<char> data((size_t)header.dataSize);
+	file.read(data.data(), header.dataSize);
+	file.close();
+
+	if (ComputeChecksum(data.data(), data.size()) != header.checksum || !ValidateCacheData(data))
+	{
+		std::cerr << "Vulkan: discarding incompatible pipeline cache file " << m_cacheFilePath << std::endl;
+		return;
+	}
+
+	outData.swap(data);
+}
+
+bool DrawingPipelineCache_Vulkan::ValidateCacheData(const std::vector<char>& data) const
+{
+	// Version one header: length, version, vendor ID, device ID, pipeline cache UUID
+	const size_t vulkanHeaderSize = sizeof(uint32_t) * 4 + VK_UUID_SIZE;
+	if (data.size() < vulkanHeaderSize)
+	{
+		return false;
+	}
+
+	uint32_t headerFields[4];
+	memcpy(headerFields, data.data(), sizeof(headerFields));
+
+	if (headerFields[0] < vulkanHeaderSize || headerFields[1] != VK_PIPELINE_CACHE_HEADER_VERSION_ONE)
+	{
+		return false;
+	}
+
+	if (headerFields[2] != m_pDevice->deviceProperties.vendorID || headerFields[3] != m_pDevice->deviceProperties.deviceID)
+	{
+		return false;
+	}
+
+	return memcmp(data.data() + sizeof(headerFields), m_pDevice->deviceProperties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+uint64_t DrawingPipelineCache_Vulkan::ComputeChecksum(const char* pData, size_t size) const
+{
+	// FNV-1a
+	uint64_t checksum = 0xcbf29ce484222325ull;
+	for (size_t i = 0; i < size; ++i)
+	{
+		checksum ^= (uint8_t)pData[i];
+		checksum *= 0x100000001b3ull;
+	}
+	return checksum;
+}
\ No newline at end of file
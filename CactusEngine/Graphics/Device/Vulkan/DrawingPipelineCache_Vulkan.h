@@ -0,0 +1,99 @@
+#pragma once
+#include "NoCopy.h"
+
+#include <vulkan.h>
+#include <memory>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <functional>
+#include <mutex>
+
+namespace Engine
+{
+	struct LogicalDevice_Vulkan;
+
+	// Identifies a pipeline layout by the signatures of its descriptor set layouts and push constant ranges
+	struct PipelineLayoutKey_Vulkan
+	{
+		std::vector<uint64_t>	contents;
+		size_t					hash = 0;
+
+		void Append(uint64_t value)
+		{
+			contents.emplace_back(value);
+			hash ^= std::hash<uint64_t>()(value) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		}
+
+		bool operator==(const PipelineLayoutKey_Vulkan& other) const
+		{
+			return hash == other.hash && contents == other.contents;
+		}
+	};
+
+	struct PipelineLayoutKeyHasher_Vulkan
+	{
+		size_t operator()(const PipelineLayoutKey_Vulkan& key) const
+		{
+			return key.hash;
+		}
+	};
+
+	struct PipelineCacheStatistics_Vulkan
+	{
+		bool	 isWarmStart;			// Whether valid cache data was loaded from disk
+		size_t	 loadedDataSize;		// In bytes
+		uint32_t pipelineCount;
+		float	 pipelineCreationTime;	// In milliseconds, accumulated over all pipeline creations
+		uint32_t layoutRequestCount;
+		uint32_t layoutCount;
+	};
+
+	// Wraps a device-level VkPipelineCache persisted on disk, and owns pipeline layouts shared by compatible pipelines
+	class DrawingPipelineCache_Vulkan : public NoCopy
+	{
+	public:
+		DrawingPipelineCache_Vulkan(const std::shared_ptr<LogicalDevice_Vulkan> pDevice, const char* cacheFilePath);
+		~DrawingPipelineCache_Vulkan();
+
+		VkResult CreateGraphicsPipeline(const VkGraphicsPipelineCreateInfo& createInfo, VkPipeline& outPipeline);
+		VkPipelineLayout RequestPipelineLayout(const PipelineLayoutKey_Vulkan& key, const VkPipelineLayoutCreateInfo& createInfo);
+
+		// Writes cache data back to disk if new pipelines were created since last save, only called on device shutdown to keep file I/O out of frame loop
+		bool SaveToFile();
+
+		PipelineCacheStatistics_Vulkan GetStatistics() const;
+
+	private:
+		void LoadFromFile(std::vector<char>& outData) const;
+		bool ValidateCacheData(const std::vector<char>& data) const;
+		uint64_t ComputeChecksum(const char* pData, size_t size) const;
+
+	public:
+		const uint32_t CACHE_FILE_MAGIC = 0x43504356; // "VCPC"
+		const uint32_t CACHE_FILE_VERSION = 1;
+
+	private:
+		// Prepended to data retrieved from vkGetPipelineCacheData, since Vulkan header does not record driver version or data integrity
+		struct CacheFileHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t driverVersion;
+			uint32_t padding;
+			uint64_t dataSize;
+			uint64_t checksum;
+		};
+
+		std::shared_ptr<LogicalDevice_Vulkan> m_pDevice;
+		const std::string m_cacheFilePath;
+		VkPipelineCache m_pipelineCache;
+		mutable std::mutex m_mutex;
+
+		std::unordered_map<PipelineLayoutKey_Vulkan, VkPipelineLayout, PipelineLayoutKeyHasher_Vulkan> m_pipelineLayouts;
+
+		bool m_isDirty;
+		bool m_hasReportedStartup;
+		PipelineCacheStatistics_Vulkan m_statistics;
+	};
+}
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "BuiltInShaderType.h"
 
 #include <cstdarg>
+#include <algorithm>
 
 using namespace Engine;
 
@@ -29,6 +30,37 @@ RawBuffer_Vulkan::~RawBuffer_Vulkan()
 	}
 }
 
+static RawBufferCreateInfo_Vulkan StagingBufferCreateInfo_VK(VkDeviceSize size)
+{
+	RawBufferCreateInfo_Vulkan createInfo = {};
+	createInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+	createInfo.memoryUsage = VMA_MEMORY_USAGE_CPU_ONLY;
+	createInfo.size = size;
+	return createInfo;
+}
+
+StagingBuffer_Vulkan::StagingBuffer_Vulkan(const std::shared_ptr<LogicalDevice_Vulkan> pDevice, VkDeviceSize size)
+	: RawBuffer_Vulkan(pDevice, StagingBufferCreateInfo_VK(size)), m_pMappedData(nullptr)
+{
+	if (!m_pDevice->pUploadAllocator->MapMemory(m_allocation, &m_pMappedData))
+	{
+		std::cerr << "Vulkan: Failed to map staging buffer memory.\n";
+	}
+}
+
+StagingBuffer_Vulkan::~StagingBuffer_Vulkan()
+{
+	if (m_pMappedData != nullptr)
+	{
+		m_pDevice->pUploadAllocator->UnmapMemory(m_allocation);
+	}
+}
+
+void* StagingBuffer_Vulkan::GetMappedData() const
+{
+	return m_pMappedData;
+}
+
 DataTransferBuffer_Vulkan::DataTransferBuffer_Vulkan(const std::shared_ptr<LogicalDevice_Vulkan> pDevice, const RawBufferCreateInfo_Vulkan& createInfo)
 	: m_pDevice(pDevice), m_constantlyMapped(false), m_ppMappedData(nullptr)
 {
@@ -131,7 +163,14 @@ Texture2D_Vulkan::~Texture2D_Vulkan()
 {
 	if (m_allocatorType == EAllocatorType_Vulkan::VMA)
 	{
-		m_pDevice->pUploadAllocator->FreeImage(m_image, m_allocation);
+		if (m_pAliasedTexture != nullptr)
+		{
+			m_pDevice->pUploadAllocator->FreeAliasedImage(m_image);
+		}
+		else
+		{
+			m_pDevice->pUploadAllocator->FreeImage(m_image, m_allocation);
+		}
 	}
 
 	if (m_imageView != VK_NULL_HANDLE)
@@ -181,12 +220,23 @@ RenderTarget2D_Vulkan::~RenderTarget2D_Vulkan()
 }
 
 UniformBuffer_Vulkan::UniformBuffer_Vulkan(const std::shared_ptr<LogicalDevice_Vulkan> pDevice, const UniformBufferCreateInfo_Vulkan& createInfo)
-	: m_eType(createInfo.type), m_appliedShaderStage(createInfo.appliedStages), m_pHostData(nullptr), m_subAllocatedSize(0)
+	: m_eType(createInfo.type), m_appliedShaderStage(createInfo.appliedStages), m_pHostData(nullptr), m_subAllocatedSize(0), m_subAllocationCapacity(0), m_subAllocationAlignment(1),
+	m_regionSize(createInfo.size), m_regionCount(1)
 {
+	if (m_eType == EUniformBufferType_Vulkan::Uniform)
+	{
+		m_subAllocationAlignment = (uint32_t)pDevice->deviceProperties.limits.minUniformBufferOffsetAlignment;
+		m_subAllocationCapacity = AlignSubAllocation(createInfo.size) * createInfo.subBufferCount;
+
+		// Host writes of the next frames must not touch the data still read by frames in flight
+		m_regionSize = AlignSubAllocation(std::max(createInfo.size, m_subAllocationCapacity));
+		m_regionCount = std::max(pDevice->framesInFlight, 1u);
+	}
+
 	RawBufferCreateInfo_Vulkan bufferImplCreateInfo = {};
 	bufferImplCreateInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
 	bufferImplCreateInfo.memoryUsage = VMA_MEMORY_USAGE_CPU_TO_GPU;
-	bufferImplCreateInfo.size = createInfo.size;
+	bufferImplCreateInfo.size = (VkDeviceSize)m_regionSize * m_regionCount;
 
 	m_pBufferImpl = std::make_shared<RawBuffer_Vulkan>(pDevice, bufferImplCreateInfo);
 	m_sizeInBytes = createInfo.size;
@@ -222,7 +272,8 @@ void UniformBuffer_Vulkan::UpdateBufferSubData(const void* pData, uint32_t offse
 {
 	if (m_eType == EUniformBufferType_Vulkan::Uniform)
 	{
-		void* start = (unsigned char*)m_pHostData + offset;
+		assert(offset + size <= m_sizeInBytes);
+		void* start = (unsigned char*)m_pHostData + GetCurrentRegionOffset() + offset;
 		memcpy(start, pData, size);
 	}
 	else
@@ -234,10 +285,11 @@ void UniformBuffer_Vulkan::UpdateBufferSubData(const void* pData, uint32_t offse
 std::shared_ptr<SubUniformBuffer> UniformBuffer_Vulkan::AllocateSubBuffer(uint32_t size)
 {
 	std::lock_guard<std::mutex> lock(m_subAllocateMutex);
-	assert(m_subAllocatedSize + size <= m_sizeInBytes);
+	assert(m_subAllocatedSize + size <= m_subAllocationCapacity);
 
-	auto pSubBuffer = std::make_shared<SubUniformBuffer_Vulkan>(this, m_pBufferImpl->m_buffer, m_subAllocatedSize, size);
-	m_subAllocatedSize += size;
+	// Sub buffers are re-allocated every frame, so they always land in the region of current frame
+	auto pSubBuffer = std::make_shared<SubUniformBuffer_Vulkan>(this, m_pBufferImpl->m_buffer, GetCurrentRegionOffset() + m_subAllocatedSize, size);
+	m_subAllocatedSize += AlignSubAllocation(size);
 
 	return pSubBuffer;
 }
@@ -260,7 +312,7 @@ void UniformBuffer_Vulkan::UpdateToDevice(std::shared_ptr<DrawingCommandBuffer_V
 		break;
 
 	case EUniformBufferType_Vulkan::Uniform:
-		memcpy(m_pHostData, m_pRawData, m_sizeInBytes);
+		memcpy((unsigned char*)m_pHostData + GetCurrentRegionOffset(), m_pRawData, m_sizeInBytes);
 		break;
 
 	default:
@@ -279,6 +331,17 @@ EUniformBufferType_Vulkan UniformBuffer_Vulkan::GetType() const
 	return m_eType;
 }
 
+uint32_t UniformBuffer_Vulkan::GetCurrentRegionOffset() const
+{
+	uint64_t currentFrame = m_pBufferImpl->m_pDevice->pDescriptorAllocator->GetCurrentFrame();
+	return (uint32_t)(currentFrame % m_regionCount) * m_regionSize;
+}
+
+uint32_t UniformBuffer_Vulkan::AlignSubAllocation(uint32_t size) const
+{
+	return (size + m_subAllocationAlignment - 1) / m_subAllocationAlignment * m_subAllocationAlignment;
+}
+
 SubUniformBuffer_Vulkan::SubUniformBuffer_Vulkan(UniformBuffer_Vulkan* pParentBuffer, VkBuffer buffer, uint32_t offset, uint32_t size)
 	: m_pParentBuffer(pParentBuffer), m_buffer(buffer), m_offset(offset), m_size(size)
 {
@@ -287,8 +350,10 @@ SubUniformBuffer_Vulkan::SubUniformBuffer_Vulkan(UniformBuffer_Vulkan* pParentBu
 
 void SubUniformBuffer_Vulkan::UpdateSubBufferData(const void* pData)
 {
-	assert(m_pParentBuffer != nullptr);
-	m_pParentBuffer->UpdateBufferSubData(pData, m_offset, m_size);
+	assert(m_pParentBuffer != nullptr && m_pParentBuffer->m_pHostData != nullptr);
+
+	// Offset already points into the region of the frame it was allocated in
+	memcpy((unsigned char*)m_pParentBuffer->m_pHostData + m_offset, pData, m_size);
 }
 
 RenderPass_Vulkan::RenderPass_Vulkan(const std::shared_ptr<LogicalDevice_Vulkan> pDevice)
@@ -400,11 +465,13 @@ DrawingSwapchain_Vulkan::DrawingSwapchain_Vulkan(const std::shared_ptr<LogicalDe
 		m_renderTargets.emplace_back(std::make_shared<RenderTarget2D_Vulkan>(m_pDevice, swapchainImages[i], swapchainImageView, createInfo.swapExtent, createInfo.surfaceFormat.format));
 	}
 
-	m_imageAvailableSemaphores.resize(DrawingDevice_Vulkan::MAX_FRAME_IN_FLIGHT, nullptr);
-	for (unsigned int i = 0; i < DrawingDevice_Vulkan::MAX_FRAME_IN_FLIGHT; i++)
+	assert(createInfo.maxFramesInFlight > 0 && createInfo.maxFramesInFlight <= DrawingDevice_Vulkan::MAX_FRAME_IN_FLIGHT);
+	m_imageAvailableSemaphores.resize(createInfo.maxFramesInFlight, nullptr);
+	for (unsigned int i = 0; i < createInfo.maxFramesInFlight; i++)
 	{
 		m_imageAvailableSemaphores[i] = m_pDevice->pSyncObjectManager->RequestSemaphore();
-		m_imageAvailableSemaphores[i]->waitStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		// The whole frame is submitted in one batch, only hold back color writes until backbuffer is acquired
+		m_imageAvailableSemaphores[i]->waitStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
 	}
 
 	auto pCmdBuffer = m_pDevice->pGraphicsCommandManager->RequestPrimaryCommandBuffer();
@@ -425,7 +492,7 @@ DrawingSwapchain_Vulkan::~DrawingSwapchain_Vulkan()
 
 bool DrawingSwapchain_Vulkan::UpdateBackBuffer(unsigned int currentFrame)
 {
-	assert(currentFrame < DrawingDevice_Vulkan::MAX_FRAME_IN_FLIGHT);
+	assert(currentFrame < m_imageAvailableSemaphores.size());
 	return vkAcquireNextImageKHR(m_pDevice->logicalDevice, m_swapchain, ACQUIRE_IMAGE_TIMEOUT, m_imageAvailableSemaphores[currentFrame]->semaphore, VK_NULL_HANDLE, &m_targetImageIndex) == VK_SUCCESS;
 }
 
@@ -482,7 +549,7 @@ VkExtent2D DrawingSwapchain_Vulkan::GetSwapExtent() const
 
 std::shared_ptr<DrawingSemaphore_Vulkan> DrawingSwapchain_Vulkan::GetImageAvailableSemaphore(unsigned int currentFrame) const
 {
-	assert(currentFrame < DrawingDevice_Vulkan::MAX_FRAME_IN_FLIGHT);
+	assert(currentFrame < m_imageAvailableSemaphores.size());
 	return m_imageAvailableSemaphores[currentFrame];
 }
 
@@ -520,7 +587,7 @@ std::shared_ptr<RawShader_Vulkan> FragmentShader_Vulkan::GetShaderImpl() const
 }
 
 ShaderProgram_Vulkan::ShaderProgram_Vulkan(DrawingDevice_Vulkan* pDevice, const std::shared_ptr<LogicalDevice_Vulkan> pLogicalDevice, uint32_t shaderCount, const std::shared_ptr<RawShader_Vulkan> pShader...)
-	: ShaderProgram(0), m_pLogicalDevice(pLogicalDevice), m_descriptorSetAccessIndex(0)
+	: ShaderProgram(0), m_pLogicalDevice(pLogicalDevice), m_descriptorSetAccessIndex(0), m_descriptorUpdateTemplate(VK_NULL_HANDLE), m_lastEvictionFrame(0)
 {
 	m_pDevice = pDevice;
 
@@ -554,12 +621,13 @@ ShaderProgram_Vulkan::ShaderProgram_Vulkan(DrawingDevice_Vulkan* pDevice, const
 
 	CreateDescriptorSetLayout(descSetCreateInfo);
 	CreateDescriptorPool(descSetCreateInfo);
+	CreateDescriptorUpdateTemplate(descSetCreateInfo);
 
 	AllocateDescriptorSet(MAX_DESCRIPTOR_SET_COUNT / 2); // TODO: figure out the optimal allocation count in here
 }
 
 ShaderProgram_Vulkan::ShaderProgram_Vulkan(DrawingDevice_Vulkan* pDevice, const std::shared_ptr<LogicalDevice_Vulkan> pLogicalDevice, const std::shared_ptr<RawShader_Vulkan> pVertexShader, const std::shared_ptr<RawShader_Vulkan> pFragmentShader)
-	: ShaderProgram(0), m_pLogicalDevice(pLogicalDevice), m_descriptorSetAccessIndex(0)
+	: ShaderProgram(0), m_pLogicalDevice(pLogicalDevice), m_descriptorSetAccessIndex(0), m_descriptorUpdateTemplate(VK_NULL_HANDLE), m_lastEvictionFrame(0)
 {
 	m_pDevice = pDevice;
 
@@ -589,15 +657,22 @@ ShaderProgram_Vulkan::ShaderProgram_Vulkan(DrawingDevice_Vulkan* pDevice, const
 
 	CreateDescriptorSetLayout(descSetCreateInfo);
 	CreateDescriptorPool(descSetCreateInfo);
+	CreateDescriptorUpdateTemplate(descSetCreateInfo);
 
 	AllocateDescriptorSet(MAX_DESCRIPTOR_SET_COUNT / 2); // TODO: figure out the optimal allocation count in here
 }
 
 ShaderProgram_Vulkan::~ShaderProgram_Vulkan()
 {
+	if (m_descriptorUpdateTemplate != VK_NULL_HANDLE)
+	{
+		vkDestroyDescriptorUpdateTemplate(m_pLogicalDevice->logicalDevice, m_descriptorUpdateTemplate, nullptr);
+	}
+
 	for (auto& stageInfo : m_pipelineShaderStageCreateInfos)
 	{
-		if (stageInfo.module != VK_NULL_HANDLE)
+		// Modules created from shader pack are shared by all programs and released along with the pack
+		if (stageInfo.module != VK_NULL_HANDLE && !(m_pLogicalDevice->pShaderPack && m_pLogicalDevice->pShaderPack->OwnsShaderModule(stageInfo.module)))
 		{
 			vkDestroyShaderModule(m_pLogicalDevice->logicalDevice, stageInfo.module, nullptr);
 		}
@@ -674,7 +749,59 @@ const DrawingDescriptorSetLayout_Vulkan* ShaderProgram_Vulkan::GetDescriptorSetL
 	return m_pDescriptorSetLayout.get();
 }
 
+std::shared_ptr<DrawingDescriptorSet_Vulkan> ShaderProgram_Vulkan::GetCachedDescriptorSet(const DescriptorSetKey_Vulkan& key, std::vector<DesciptorUpdateInfo_Vulkan>& updateInfos)
+{
+	uint64_t currentFrame = m_pLogicalDevice->pDescriptorAllocator->GetCurrentFrame();
+
+	{
+		std::lock_guard<std::mutex> lock(m_descriptorSetCacheMutex);
+
+		if (currentFrame != m_lastEvictionFrame)
+		{
+			EvictStaleDescriptorSets(currentFrame);
+		}
+
+		auto itr = m_cachedDescriptorSets.find(key);
+		if (itr != m_cachedDescriptorSets.end())
+		{
+			itr->second->m_lastUsedFrame = currentFrame;
+			m_pLogicalDevice->pDescriptorAllocator->RecordDescriptorSetCacheHit();
+			return itr->second;
+		}
+	}
+
+	auto pDescriptorSet = GetDescriptorSet();
+	WriteDescriptorSet(pDescriptorSet, updateInfos);
+	m_pLogicalDevice->pDescriptorAllocator->RecordDescriptorSetUpdate();
+
+	{
+		std::lock_guard<std::mutex> lock(m_descriptorSetCacheMutex);
+
+		// If the cache is full or another thread has cached the same content, this set would be recycled after execution as usual
+		if (m_cachedDescriptorSets.size() < MAX_CACHED_DESCRIPTOR_SET_COUNT && m_cachedDescriptorSets.find(key) == m_cachedDescriptorSets.end())
+		{
+			pDescriptorSet->m_isCached = true;
+			pDescriptorSet->m_lastUsedFrame = currentFrame;
+			m_cachedDescriptorSets.emplace(key, pDescriptorSet);
+		}
+	}
+
+	return pDescriptorSet;
+}
+
 void ShaderProgram_Vulkan::ReflectResources(const std::shared_ptr<RawShader_Vulkan> pShader, DescriptorSetCreateInfo& descSetCreateInfo)
+{
+	// Shaders from shader pack come with precomputed reflection data
+	if (!pShader->m_pReflectionData)
+	{
+		pShader->m_pReflectionData = ReflectShader(pShader);
+	}
+
+	LoadResourceBinding(*pShader->m_pReflectionData);
+	LoadResourceDescriptor(*pShader->m_pReflectionData, ShaderStageBitsConvert(pShader->m_shaderStage), descSetCreateInfo);
+}
+
+std::shared_ptr<ShaderReflectionData_Vulkan> ShaderProgram_Vulkan::ReflectShader(const std::shared_ptr<RawShader_Vulkan> pShader)
 {
 	size_t wordCount = pShader->m_rawCode.size() * sizeof(char) / sizeof(uint32_t);
 	assert(wordCount > 0);
@@ -688,81 +815,73 @@ void ShaderProgram_Vulkan::ReflectResources(const std::shared_ptr<RawShader_Vulk
 	auto activeVars = spvCompiler.get_active_interface_variables();
 	spvCompiler.set_enabled_interface_variables(std::move(activeVars));
 
-	LoadResourceBinding(spvCompiler, shaderRes);
-	LoadResourceDescriptor(spvCompiler, shaderRes, ShaderStageBitsConvert(pShader->m_shaderStage), descSetCreateInfo);
-}
+	auto pReflectionData = std::make_shared<ShaderReflectionData_Vulkan>();
 
-void ShaderProgram_Vulkan::LoadResourceBinding(const spirv_cross::Compiler& spvCompiler, const spirv_cross::ShaderResources& shaderRes)
-{
 	for (auto& buffer : shaderRes.uniform_buffers)
 	{
-		ResourceDescription desc = {};
-		desc.type = EShaderResourceType_Vulkan::Uniform;
-		desc.binding = spvCompiler.get_decoration(buffer.id, spv::DecorationBinding);
-		desc.name = MatchShaderParamName(buffer.name.c_str());
-
-		m_resourceTable.emplace(desc.name, desc);
+		pReflectionData->resources.push_back({ EShaderResourceType_Vulkan::Uniform, spvCompiler.get_decoration(buffer.id, spv::DecorationBinding), buffer.name });
 	}
 
 	uint32_t accumulatePushConstSize = 0;
 	for (auto& constant : shaderRes.push_constant_buffers)
 	{
-		accumulatePushConstSize += (uint32_t)spvCompiler.get_declared_struct_size(spvCompiler.get_type(constant.base_type_id));
+		VkPushConstantRange range = {};
+		range.offset = spvCompiler.get_decoration(constant.id, spv::DecorationOffset);
+		range.size = (uint32_t)spvCompiler.get_declared_struct_size(spvCompiler.get_type(constant.base_type_id));
+		range.stageFlags = pShader->m_shaderStage;
+		pReflectionData->pushConstantRanges.emplace_back(range);
 
-		ResourceDescription desc = {};
-		desc.type = EShaderResourceType_Vulkan::PushConstant;
-		desc.binding = spvCompiler.get_decoration(constant.id, spv::DecorationBinding);
-		desc.name = MatchShaderParamName(spvCompiler.get_name(constant.id).c_str());
+		accumulatePushConstSize += range.size;
 
-		m_resourceTable.emplace(desc.name, desc);
+		pReflectionData->resources.push_back({ EShaderResourceType_Vulkan::PushConstant, spvCompiler.get_decoration(constant.id, spv::DecorationBinding), spvCompiler.get_name(constant.id) });
 	}
 	assert(accumulatePushConstSize < m_pLogicalDevice->deviceProperties.limits.maxPushConstantsSize);
 
 	for (auto& separateImage : shaderRes.separate_images)
 	{
-		ResourceDescription desc = {};
-		desc.type = EShaderResourceType_Vulkan::SeparateImage;
-		desc.binding = spvCompiler.get_decoration(separateImage.id, spv::DecorationBinding);
-		desc.name = MatchShaderParamName(spvCompiler.get_name(separateImage.id).c_str());
-
-		m_resourceTable.emplace(desc.name, desc);
+		pReflectionData->resources.push_back({ EShaderResourceType_Vulkan::SeparateImage, spvCompiler.get_decoration(separateImage.id, spv::DecorationBinding), spvCompiler.get_name(separateImage.id) });
 	}
 
 	for (auto& separateSampler : shaderRes.separate_samplers)
 	{
-		ResourceDescription desc = {};
-		desc.type = EShaderResourceType_Vulkan::SeparateSampler;
-		desc.binding = spvCompiler.get_decoration(separateSampler.id, spv::DecorationBinding);
-		desc.name = MatchShaderParamName(spvCompiler.get_name(separateSampler.id).c_str());
-
-		m_resourceTable.emplace(desc.name, desc);
+		pReflectionData->resources.push_back({ EShaderResourceType_Vulkan::SeparateSampler, spvCompiler.get_decoration(separateSampler.id, spv::DecorationBinding), spvCompiler.get_name(separateSampler.id) });
 	}
 
 	for (auto& sampledImage : shaderRes.sampled_images)
 	{
-		ResourceDescription desc = {};
-		desc.type = EShaderResourceType_Vulkan::SampledImage;
-		desc.binding = spvCompiler.get_decoration(sampledImage.id, spv::DecorationBinding);
-		desc.name = MatchShaderParamName(spvCompiler.get_name(sampledImage.id).c_str());
-
-		m_resourceTable.emplace(desc.name, desc);
+		pReflectionData->resources.push_back({ EShaderResourceType_Vulkan::SampledImage, spvCompiler.get_decoration(sampledImage.id, spv::DecorationBinding), spvCompiler.get_name(sampledImage.id) });
 	}
 
 	// TODO: handle storage buffers
 	// TODO: handle storage textures
 	// TODO: handle subpass inputs
 	// TODO: handle acceleration structures
+
+	return pReflectionData;
+}
+
+void ShaderProgram_Vulkan::LoadResourceBinding(const ShaderReflectionData_Vulkan& reflectionData)
+{
+	for (auto& resource : reflectionData.resources)
+	{
+		ResourceDescription desc = {};
+		desc.type = resource.type;
+		desc.binding = resource.binding;
+		desc.name = MatchShaderParamName(resource.name.c_str());
+
+		m_resourceTable.emplace(desc.name, desc);
+	}
 }
 
-void ShaderProgram_Vulkan::LoadResourceDescriptor(const spirv_cross::Compiler& spvCompiler, const spirv_cross::ShaderResources& shaderRes, EShaderType shaderType, DescriptorSetCreateInfo& descSetCreateInfo)
+void ShaderProgram_Vulkan::LoadResourceDescriptor(const ShaderReflectionData_Vulkan& reflectionData, EShaderType shaderType, DescriptorSetCreateInfo& descSetCreateInfo)
 {
 	// TODO: eliminate duplicate descriptor set create info
 
-	LoadUniformBuffer(spvCompiler, shaderRes, shaderType, descSetCreateInfo);
-	LoadSeparateSampler(spvCompiler, shaderRes, shaderType, descSetCreateInfo);
-	LoadSeparateImage(spvCompiler, shaderRes, shaderType, descSetCreateInfo);
-	LoadImageSampler(spvCompiler, shaderRes, shaderType, descSetCreateInfo);
-	LoadPushConstantBuffer(spvCompiler, shaderRes, shaderType, m_pushConstantRanges);
+	LoadDescriptorBinding(reflectionData, EShaderResourceType_Vulkan::Uniform, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, shaderType, descSetCreateInfo); // Per-frame regions are selected with dynamic offsets
+	LoadDescriptorBinding(reflectionData, EShaderResourceType_Vulkan::SeparateSampler, VK_DESCRIPTOR_TYPE_SAMPLER, shaderType, descSetCreateInfo);
+	LoadDescriptorBinding(reflectionData, EShaderResourceType_Vulkan::SeparateImage, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, shaderType, descSetCreateInfo); // https://github.com/KhronosGroup/SPIRV-Cross/wiki/Reflection-API-user-guide
+	LoadDescriptorBinding(reflectionData, EShaderResourceType_Vulkan::SampledImage, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, shaderType, descSetCreateInfo);
+	LoadPushConstantBuffer(reflectionData, shaderType, m_pushConstantRanges);
 
 	// TODO: handle storage buffers
 	// TODO: handle storage textures
@@ -770,17 +889,22 @@ void ShaderProgram_Vulkan::LoadResourceDescriptor(const spirv_cross::Compiler& s
 	// TODO: handle acceleration structures
 }
 
-void ShaderProgram_Vulkan::LoadUniformBuffer(const spirv_cross::Compiler& spvCompiler, const spirv_cross::ShaderResources& shaderRes, EShaderType shaderType, DescriptorSetCreateInfo& descSetCreateInfo)
+void ShaderProgram_Vulkan::LoadDescriptorBinding(const ShaderReflectionData_Vulkan& reflectionData, EShaderResourceType_Vulkan resourceType, VkDescriptorType descriptorType, EShaderType shaderType, DescriptorSetCreateInfo& descSetCreateInfo)
 {
 	uint32_t count = 0;
 
-	for (auto& buffer : shaderRes.uniform_buffers)
+	for (auto& resource : reflectionData.resources)
 	{
+		if (resource.type != resourceType)
+		{
+			continue;
+		}
+
 		VkDescriptorSetLayoutBinding binding = {};
 		binding.descriptorCount = 1; // Alert: not sure if this is correct for uniform blocks
-		binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		binding.descriptorType = descriptorType;
 		binding.stageFlags = ShaderTypeConvertToStageBits(shaderType);
-		binding.binding = spvCompiler.get_decoration(buffer.id, spv::DecorationBinding);
+		binding.binding = resource.binding;
 		binding.pImmutableSamplers = nullptr;
 
 		if (descSetCreateInfo.recordedLayoutBindings.find(binding.binding) == descSetCreateInfo.recordedLayoutBindings.end())
@@ -797,187 +921,165 @@ void ShaderProgram_Vulkan::LoadUniformBuffer(const spirv_cross::Compiler& spvCom
 
 	if (count > 0)
 	{
-		if (descSetCreateInfo.recordedPoolSizes.find(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER) == descSetCreateInfo.recordedPoolSizes.end())
+		if (descSetCreateInfo.recordedPoolSizes.find(descriptorType) == descSetCreateInfo.recordedPoolSizes.end())
 		{
 			VkDescriptorPoolSize poolSize = {};
-			poolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+			poolSize.type = descriptorType;
 			poolSize.descriptorCount = descSetCreateInfo.maxDescSetCount * count;
 
-			descSetCreateInfo.recordedPoolSizes[VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER] = descSetCreateInfo.descSetPoolSizes.size(); // Record index
+			descSetCreateInfo.recordedPoolSizes[descriptorType] = descSetCreateInfo.descSetPoolSizes.size(); // Record index
 			descSetCreateInfo.descSetPoolSizes.emplace_back(poolSize);
 		}
 		else
 		{
-			descSetCreateInfo.descSetPoolSizes[descSetCreateInfo.recordedPoolSizes.at(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER)].descriptorCount += descSetCreateInfo.maxDescSetCount * count;
+			descSetCreateInfo.descSetPoolSizes[descSetCreateInfo.recordedPoolSizes.at(descriptorType)].descriptorCount += descSetCreateInfo.maxDescSetCount * count;
 		}
 	}
 }
 
-void ShaderProgram_Vulkan::LoadSeparateSampler(const spirv_cross::Compiler& spvCompiler, const spirv_cross::ShaderResources& shaderRes, EShaderType shaderType, DescriptorSetCreateInfo& descSetCreateInfo)
+void ShaderProgram_Vulkan::LoadPushConstantBuffer(const ShaderReflectionData_Vulkan& reflectionData, EShaderType shaderType, std::vector<VkPushConstantRange>& outRanges)
 {
-	uint32_t count = 0;
-
-	for (auto& sampler : shaderRes.separate_samplers)
+	for (auto& constantRange : reflectionData.pushConstantRanges)
 	{
-		VkDescriptorSetLayoutBinding binding = {};
-		binding.descriptorCount = 1;
-		binding.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
-		binding.stageFlags = ShaderTypeConvertToStageBits(shaderType);
-		binding.binding = spvCompiler.get_decoration(sampler.id, spv::DecorationBinding);
-		binding.pImmutableSamplers = nullptr;
+		VkPushConstantRange range = constantRange;
+		range.stageFlags = ShaderTypeConvertToStageBits(shaderType); // ERROR: this would be incorrect if the push constant is bind with multiple shader stages
 
-		if (descSetCreateInfo.recordedLayoutBindings.find(binding.binding) == descSetCreateInfo.recordedLayoutBindings.end())
-		{
-			descSetCreateInfo.recordedLayoutBindings.emplace(binding.binding, descSetCreateInfo.descSetLayoutBindings.size());
-			descSetCreateInfo.descSetLayoutBindings.emplace_back(binding);
-			count++;
-		}
-		else
-		{
-			descSetCreateInfo.descSetLayoutBindings[descSetCreateInfo.recordedLayoutBindings.at(binding.binding)].stageFlags |= binding.stageFlags;
-		}
+		outRanges.emplace_back(range);
 	}
+}
 
-	if (count > 0)
-	{
-		if (descSetCreateInfo.recordedPoolSizes.find(VK_DESCRIPTOR_TYPE_SAMPLER) == descSetCreateInfo.recordedPoolSizes.end())
-		{
-			VkDescriptorPoolSize poolSize = {};
-			poolSize.type = VK_DESCRIPTOR_TYPE_SAMPLER;
-			poolSize.descriptorCount = descSetCreateInfo.maxDescSetCount * count;
-
-			descSetCreateInfo.recordedPoolSizes[VK_DESCRIPTOR_TYPE_SAMPLER] = descSetCreateInfo.descSetPoolSizes.size(); // Record index
-			descSetCreateInfo.descSetPoolSizes.emplace_back(poolSize);
-		}
-		else
-		{
-			descSetCreateInfo.descSetPoolSizes[descSetCreateInfo.recordedPoolSizes.at(VK_DESCRIPTOR_TYPE_SAMPLER)].descriptorCount += descSetCreateInfo.maxDescSetCount * count;
-		}
-	}
+void ShaderProgram_Vulkan::CreateDescriptorSetLayout(const DescriptorSetCreateInfo& descSetCreateInfo)
+{
+	m_pDescriptorSetLayout = std::make_shared<DrawingDescriptorSetLayout_Vulkan>(m_pLogicalDevice, descSetCreateInfo.descSetLayoutBindings);
 }
 
-void ShaderProgram_Vulkan::LoadSeparateImage(const spirv_cross::Compiler& spvCompiler, const spirv_cross::ShaderResources& shaderRes, EShaderType shaderType, DescriptorSetCreateInfo& descSetCreateInfo)
+void ShaderProgram_Vulkan::CreateDescriptorPool(const DescriptorSetCreateInfo& descSetCreateInfo)
 {
-	uint32_t count = 0;
+	m_pDescriptorPool = m_pLogicalDevice->pDescriptorAllocator->CreateDescriptorPool(descSetCreateInfo.maxDescSetCount, descSetCreateInfo.descSetPoolSizes);
+}
 
-	for (auto& image : shaderRes.separate_images)
+void ShaderProgram_Vulkan::CreateDescriptorUpdateTemplate(const DescriptorSetCreateInfo& descSetCreateInfo)
+{
+	if (descSetCreateInfo.descSetLayoutBindings.size() == 0)
 	{
-		VkDescriptorSetLayoutBinding binding = {};
-		binding.descriptorCount = 1;
-		binding.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE; // https://github.com/KhronosGroup/SPIRV-Cross/wiki/Reflection-API-user-guide
-		binding.stageFlags = ShaderTypeConvertToStageBits(shaderType);
-		binding.binding = spvCompiler.get_decoration(image.id, spv::DecorationBinding);
-		binding.pImmutableSamplers = nullptr;
-
-		if (descSetCreateInfo.recordedLayoutBindings.find(binding.binding) == descSetCreateInfo.recordedLayoutBindings.end())
-		{
-			descSetCreateInfo.recordedLayoutBindings.emplace(binding.binding, descSetCreateInfo.descSetLayoutBindings.size());
-			descSetCreateInfo.descSetLayoutBindings.emplace_back(binding);
-			count++;
-		}
-		else
-		{
-			descSetCreateInfo.descSetLayoutBindings[descSetCreateInfo.recordedLayoutBindings.at(binding.binding)].stageFlags |= binding.stageFlags;
-		}
+		return;
 	}
 
-	if (count > 0)
+	std::vector<VkDescriptorUpdateTemplateEntry> templateEntries;
+	for (auto& binding : descSetCreateInfo.descSetLayoutBindings)
 	{
-		if (descSetCreateInfo.recordedPoolSizes.find(VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE) == descSetCreateInfo.recordedPoolSizes.end())
-		{
-			VkDescriptorPoolSize poolSize = {};
-			poolSize.type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-			poolSize.descriptorCount = descSetCreateInfo.maxDescSetCount * count;
+		VkDescriptorUpdateTemplateEntry entry = {};
+		entry.dstBinding = binding.binding;
+		entry.dstArrayElement = 0;
+		entry.descriptorCount = 1; // Alert: incorrect if it contains array
+		entry.descriptorType = binding.descriptorType;
+		entry.offset = templateEntries.size() * sizeof(DescriptorTemplateData_Vulkan);
+		entry.stride = sizeof(DescriptorTemplateData_Vulkan);
+
+		m_templateEntryIndices[binding.binding] = (uint32_t)templateEntries.size();
+		templateEntries.emplace_back(entry);
+	}
 
-			descSetCreateInfo.recordedPoolSizes[VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE] = descSetCreateInfo.descSetPoolSizes.size(); // Record index
-			descSetCreateInfo.descSetPoolSizes.emplace_back(poolSize);
-		}
-		else
-		{
-			descSetCreateInfo.descSetPoolSizes[descSetCreateInfo.recordedPoolSizes.at(VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE)].descriptorCount += descSetCreateInfo.maxDescSetCount * count;
-		}
+	VkDescriptorUpdateTemplateCreateInfo createInfo = {};
+	createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+	createInfo.descriptorUpdateEntryCount = (uint32_t)templateEntries.size();
+	createInfo.pDescriptorUpdateEntries = templateEntries.data();
+	createInfo.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+	createInfo.descriptorSetLayout = *m_pDescriptorSetLayout->GetDescriptorSetLayout();
+
+	if (vkCreateDescriptorUpdateTemplate(m_pLogicalDevice->logicalDevice, &createInfo, nullptr, &m_descriptorUpdateTemplate) != VK_SUCCESS)
+	{
+		std::cerr << "Vulkan: failed to create descriptor update template, falling back to descriptor writes.\n";
+		m_descriptorUpdateTemplate = VK_NULL_HANDLE;
 	}
 }
 
-void ShaderProgram_Vulkan::LoadImageSampler(const spirv_cross::Compiler& spvCompiler, const spirv_cross::ShaderResources& shaderRes, EShaderType shaderType, DescriptorSetCreateInfo& descSetCreateInfo)
+void ShaderProgram_Vulkan::AllocateDescriptorSet(uint32_t count)
 {
-	uint32_t count = 0;
+	assert(m_pDescriptorPool);
+	assert(m_descriptorSets.size() + count <= MAX_DESCRIPTOR_SET_COUNT);
 
-	for (auto& sampledImage : shaderRes.sampled_images)
+	std::vector<VkDescriptorSetLayout> layouts(count, *m_pDescriptorSetLayout->GetDescriptorSetLayout());
+
+	m_pDescriptorPool->AllocateDescriptorSets(layouts, m_descriptorSets);
+}
+
+void ShaderProgram_Vulkan::UpdateDescriptorSets(const std::vector<DesciptorUpdateInfo_Vulkan>& updateInfos)
+{
+	m_pDescriptorPool->UpdateDescriptorSets(updateInfos);
+}
+
+void ShaderProgram_Vulkan::WriteDescriptorSet(const std::shared_ptr<DrawingDescriptorSet_Vulkan> pDescriptorSet, std::vector<DesciptorUpdateInfo_Vulkan>& updateInfos)
+{
+	for (auto& updateInfo : updateInfos)
 	{
-		VkDescriptorSetLayoutBinding binding = {};
-		binding.descriptorCount = 1;
-		binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		binding.stageFlags = ShaderTypeConvertToStageBits(shaderType);
-		binding.binding = spvCompiler.get_decoration(sampledImage.id, spv::DecorationBinding);
-		binding.pImmutableSamplers = nullptr;
+		updateInfo.dstDescriptorSet = pDescriptorSet->m_descriptorSet;
+	}
 
-		if (descSetCreateInfo.recordedLayoutBindings.find(binding.binding) == descSetCreateInfo.recordedLayoutBindings.end())
+	// Template update is only possible when every binding in the layout is provided
+	bool useTemplate = m_descriptorUpdateTemplate != VK_NULL_HANDLE;
+	std::vector<DescriptorTemplateData_Vulkan> templateData(m_templateEntryIndices.size());
+	uint32_t providedEntryCount = 0;
+
+	for (auto& updateInfo : updateInfos)
+	{
+		if (!useTemplate)
 		{
-			descSetCreateInfo.recordedLayoutBindings.emplace(binding.binding, descSetCreateInfo.descSetLayoutBindings.size());
-			descSetCreateInfo.descSetLayoutBindings.emplace_back(binding);
-			count++;
+			break;
 		}
-		else // Update stage flags
+
+		auto itr = m_templateEntryIndices.find(updateInfo.dstDescriptorBinding);
+		if (!updateInfo.hasContent || itr == m_templateEntryIndices.end())
 		{
-			descSetCreateInfo.descSetLayoutBindings[descSetCreateInfo.recordedLayoutBindings.at(binding.binding)].stageFlags |= binding.stageFlags;
+			useTemplate = false;
+			break;
 		}
-	}
 
-	if (count > 0)
-	{
-		if (descSetCreateInfo.recordedPoolSizes.find(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER) == descSetCreateInfo.recordedPoolSizes.end())
+		switch (updateInfo.infoType)
 		{
-			VkDescriptorPoolSize poolSize = {};
-			poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-			poolSize.descriptorCount = descSetCreateInfo.maxDescSetCount * count;
+		case EDescriptorResourceType_Vulkan::Buffer:
+			templateData[itr->second].bufferInfo = updateInfo.bufferInfos[0];
+			break;
 
-			descSetCreateInfo.recordedPoolSizes[VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER] = descSetCreateInfo.descSetPoolSizes.size(); // Record index
-			descSetCreateInfo.descSetPoolSizes.emplace_back(poolSize);
-		}
-		else
-		{
-			descSetCreateInfo.descSetPoolSizes[descSetCreateInfo.recordedPoolSizes.at(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)].descriptorCount += descSetCreateInfo.maxDescSetCount * count;
+		case EDescriptorResourceType_Vulkan::Image:
+			templateData[itr->second].imageInfo = updateInfo.imageInfos[0];
+			break;
+
+		default:
+			useTemplate = false;
+			break;
 		}
+		providedEntryCount++;
 	}
-}
 
-void ShaderProgram_Vulkan::LoadPushConstantBuffer(const spirv_cross::Compiler& spvCompiler, const spirv_cross::ShaderResources& shaderRes, EShaderType shaderType, std::vector<VkPushConstantRange>& outRanges)
-{
-	for (auto& constant : shaderRes.push_constant_buffers)
+	if (useTemplate && providedEntryCount == templateData.size())
 	{
-		VkPushConstantRange range = {};
-		range.offset = spvCompiler.get_decoration(constant.id, spv::DecorationOffset);
-		range.size = (uint32_t)spvCompiler.get_declared_struct_size(spvCompiler.get_type(constant.base_type_id));
-		range.stageFlags = ShaderTypeConvertToStageBits(shaderType); // ERROR: this would be incorrect if the push constant is bind with multiple shader stages
-
-		outRanges.emplace_back(range);
+		m_pDescriptorPool->UpdateDescriptorSetWithTemplate(pDescriptorSet->m_descriptorSet, m_descriptorUpdateTemplate, templateData.data());
+	}
+	else
+	{
+		m_pDescriptorPool->UpdateDescriptorSets(updateInfos);
 	}
 }
 
-void ShaderProgram_Vulkan::CreateDescriptorSetLayout(const DescriptorSetCreateInfo& descSetCreateInfo)
-{
-	m_pDescriptorSetLayout = std::make_shared<DrawingDescriptorSetLayout_Vulkan>(m_pLogicalDevice, descSetCreateInfo.descSetLayoutBindings);
-}
-
-void ShaderProgram_Vulkan::CreateDescriptorPool(const DescriptorSetCreateInfo& descSetCreateInfo)
-{
-	m_pDescriptorPool = m_pLogicalDevice->pDescriptorAllocator->CreateDescriptorPool(descSetCreateInfo.maxDescSetCount, descSetCreateInfo.descSetPoolSizes);
-}
-
-void ShaderProgram_Vulkan::AllocateDescriptorSet(uint32_t count)
+void ShaderProgram_Vulkan::EvictStaleDescriptorSets(uint64_t currentFrame)
 {
-	assert(m_pDescriptorPool);
-	assert(m_descriptorSets.size() + count <= MAX_DESCRIPTOR_SET_COUNT);
-
-	std::vector<VkDescriptorSetLayout> layouts(count, *m_pDescriptorSetLayout->GetDescriptorSetLayout());
-
-	m_pDescriptorPool->AllocateDescriptorSets(layouts, m_descriptorSets);
-}
+	// Sets that are not referenced for a few frames are no longer in execution, and can be returned to transient use
+	for (auto itr = m_cachedDescriptorSets.begin(); itr != m_cachedDescriptorSets.end();)
+	{
+		if (currentFrame - itr->second->m_lastUsedFrame > DESCRIPTOR_SET_CACHE_LIFETIME)
+		{
+			itr->second->m_isCached = false;
+			itr->second->m_isInUse = false;
+			itr = m_cachedDescriptorSets.erase(itr);
+		}
+		else
+		{
+			itr++;
+		}
+	}
 
-void ShaderProgram_Vulkan::UpdateDescriptorSets(const std::vector<DesciptorUpdateInfo_Vulkan>& updateInfos)
-{
-	m_pDescriptorPool->UpdateDescriptorSets(updateInfos);
+	m_lastEvictionFrame = currentFrame;
 }
 
 uint32_t ShaderProgram_Vulkan::GetParamTypeSize(const spirv_cross::SPIRType& type)
@@ -1133,11 +1235,11 @@ VkShaderStageFlagBits ShaderProgram_Vulkan::ShaderTypeConvertToStageBits(EShader
 GraphicsPipeline_Vulkan::GraphicsPipeline_Vulkan(const std::shared_ptr<LogicalDevice_Vulkan> pDevice, const std::shared_ptr<ShaderProgram_Vulkan> pShaderProgram, VkGraphicsPipelineCreateInfo& createInfo)
 	: m_pDevice(pDevice), m_pShaderProgram(pShaderProgram)
 {
-	// TODO: support creation from cache & batched creations to reduce startup time
-	m_pipelineLayout = createInfo.layout;
+	// TODO: support batched creations to reduce startup time
+	m_pipelineLayout = createInfo.layout; // Owned by pipeline cache, shared among compatible pipelines
 	m_pipeline = VK_NULL_HANDLE;
 
-	if (vkCreateGraphicsPipelines(pDevice->logicalDevice, VK_NULL_HANDLE, 1, &createInfo, nullptr, &m_pipeline) != VK_SUCCESS)
+	if (pDevice->pPipelineCache->CreateGraphicsPipeline(createInfo, m_pipeline) != VK_SUCCESS)
 	{
 		std::cerr << "Vulkan: failed to create graphics pipeline.\n";
 	}
@@ -1147,7 +1249,6 @@ GraphicsPipeline_Vulkan::~GraphicsPipeline_Vulkan()
 {
 	assert(m_pipeline != VK_NULL_HANDLE);
 
-	vkDestroyPipelineLayout(m_pDevice->logicalDevice, m_pipelineLayout, nullptr);
 	vkDestroyPipeline(m_pDevice->logicalDevice, m_pipeline, nullptr);
 }
 
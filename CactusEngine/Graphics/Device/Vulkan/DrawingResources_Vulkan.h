@@ -14,6 +14,7 @@ namespace Engine
 	struct LogicalDevice_Vulkan;
 	class  DrawingDevice_Vulkan;
 	class  DrawingCommandBuffer_Vulkan;	
+	struct ShaderReflectionData_Vulkan;
 
 	enum class EAllocatorType_Vulkan
 	{
@@ -38,11 +39,25 @@ namespace Engine
 
 		friend class DrawingCommandBuffer_Vulkan;
 		friend class DrawingUploadAllocator_Vulkan;
+		friend class DrawingUploadManager_Vulkan;
 		friend class DrawingDevice_Vulkan;
 		friend class UniformBuffer_Vulkan;
 		friend class DataTransferBuffer_Vulkan;
 	};
 
+	// Host visible transfer source that stays mapped for its whole lifetime
+	class StagingBuffer_Vulkan : public RawBuffer_Vulkan
+	{
+	public:
+		StagingBuffer_Vulkan(const std::shared_ptr<LogicalDevice_Vulkan> pDevice, VkDeviceSize size);
+		~StagingBuffer_Vulkan();
+
+		void* GetMappedData() const;
+
+	private:
+		void* m_pMappedData;
+	};
+
 	class DataTransferBuffer_Vulkan : public DataTransferBuffer
 	{
 	public:
@@ -116,6 +131,7 @@ namespace Engine
 		VkImageAspectFlags	m_aspect = VK_IMAGE_ASPECT_COLOR_BIT;
 
 		EAllocatorType_Vulkan m_allocatorType;
+		std::shared_ptr<Texture2D_Vulkan> m_pAliasedTexture; // Owner of the device memory this texture is bound to, if aliased
 
 		std::shared_ptr<Sampler_Vulkan> m_pSampler;
 
@@ -145,6 +161,7 @@ namespace Engine
 	{
 		EUniformBufferType_Vulkan	type;
 		uint32_t					size;
+		uint32_t					subBufferCount;
 		VkShaderStageFlags			appliedStages;
 	};
 
@@ -163,6 +180,10 @@ namespace Engine
 		std::shared_ptr<RawBuffer_Vulkan> GetBufferImpl() const;
 
 		EUniformBufferType_Vulkan GetType() const;
+		uint32_t GetCurrentRegionOffset() const;
+
+	private:
+		uint32_t AlignSubAllocation(uint32_t size) const;
 
 	private:
 		std::shared_ptr<RawBuffer_Vulkan> m_pBufferImpl;
@@ -172,7 +193,13 @@ namespace Engine
 		const void* m_pRawData;
 		void* m_pHostData; // Pointer to mapped host memory location
 
+		// Uniform data is replicated per frame in flight, each frame writes and binds its own region
+		uint32_t m_regionSize;
+		uint32_t m_regionCount;
+
 		uint32_t m_subAllocatedSize;
+		uint32_t m_subAllocationCapacity;
+		uint32_t m_subAllocationAlignment; // Dynamic offsets have to be multiples of min uniform buffer offset alignment
 		mutable std::mutex m_subAllocateMutex;
 
 		friend class SubUniformBuffer_Vulkan;
@@ -280,11 +307,13 @@ namespace Engine
 		VkShaderModule			m_shaderModule;
 		VkShaderStageFlagBits	m_shaderStage;
 		const char*				m_entryName;
-		std::vector<char>		m_rawCode; // For reflection
+		std::vector<char>		m_rawCode; // For reflection, empty if the shader is loaded from shader pack
+		std::shared_ptr<ShaderReflectionData_Vulkan> m_pReflectionData; // Precomputed by shader pack, or filled by the first program that reflects this shader
 
 		friend class ShaderProgram_Vulkan;
 		friend class VertexShader_Vulkan;
 		friend class FragmentShader_Vulkan;	
+		friend class DrawingShaderPack_Vulkan;
 	};
 
 	class VertexShader_Vulkan : public VertexShader
@@ -325,6 +354,20 @@ namespace Engine
 		COUNT
 	};
 
+	// Reflection results of a single shader stage, serialized into shader pack so that SPIRV-Cross is not needed at startup
+	struct ShaderReflectionData_Vulkan
+	{
+		struct Resource
+		{
+			EShaderResourceType_Vulkan	type;
+			uint32_t					binding;
+			std::string					name;
+		};
+
+		std::vector<Resource>				resources;
+		std::vector<VkPushConstantRange>	pushConstantRanges;
+	};
+
 	class ShaderProgram_Vulkan : public ShaderProgram
 	{
 	public:
@@ -345,9 +388,14 @@ namespace Engine
 		const DrawingDescriptorSetLayout_Vulkan* GetDescriptorSetLayout() const;
 		void UpdateDescriptorSets(const std::vector<DesciptorUpdateInfo_Vulkan>& updateInfos);
 
+		// Returns a set already written with the same resources if possible, otherwise writes a new one and caches it
+		std::shared_ptr<DrawingDescriptorSet_Vulkan> GetCachedDescriptorSet(const DescriptorSetKey_Vulkan& key, std::vector<DesciptorUpdateInfo_Vulkan>& updateInfos);
+
 	private:
 
 		const uint32_t MAX_DESCRIPTOR_SET_COUNT = 1024; // TODO: figure out the proper value for this limit
+		const uint32_t MAX_CACHED_DESCRIPTOR_SET_COUNT = MAX_DESCRIPTOR_SET_COUNT / 4; // Rest of the sets are left for transient use
+		const uint64_t DESCRIPTOR_SET_CACHE_LIFETIME = 8; // Frames, must be larger than max frames in flight
 
 		struct ResourceDescription
 		{
@@ -370,13 +418,11 @@ namespace Engine
 	private:
 		// Shader reflection functions
 		void ReflectResources(const std::shared_ptr<RawShader_Vulkan> pShader, DescriptorSetCreateInfo& descSetCreateInfo);
-		void LoadResourceBinding(const spirv_cross::Compiler& spvCompiler, const spirv_cross::ShaderResources& shaderRes);
-		void LoadResourceDescriptor(const spirv_cross::Compiler& spvCompiler, const spirv_cross::ShaderResources& shaderRes, EShaderType shaderType,  DescriptorSetCreateInfo& descSetCreateInfo);
-		void LoadUniformBuffer(const spirv_cross::Compiler& spvCompiler, const spirv_cross::ShaderResources& shaderRes, EShaderType shaderType, DescriptorSetCreateInfo& descSetCreateInfo);
-		void LoadSeparateSampler(const spirv_cross::Compiler& spvCompiler, const spirv_cross::ShaderResources& shaderRes, EShaderType shaderType, DescriptorSetCreateInfo& descSetCreateInfo);
-		void LoadSeparateImage(const spirv_cross::Compiler& spvCompiler, const spirv_cross::ShaderResources& shaderRes, EShaderType shaderType, DescriptorSetCreateInfo& descSetCreateInfo);
-		void LoadImageSampler(const spirv_cross::Compiler& spvCompiler, const spirv_cross::ShaderResources& shaderRes, EShaderType shaderType, DescriptorSetCreateInfo& descSetCreateInfo);
-		void LoadPushConstantBuffer(const spirv_cross::Compiler& spvCompiler, const spirv_cross::ShaderResources& shaderRes, EShaderType shaderType, std::vector<VkPushConstantRange>& outRanges);
+		std::shared_ptr<ShaderReflectionData_Vulkan> ReflectShader(const std::shared_ptr<RawShader_Vulkan> pShader); // Runs SPIRV-Cross on raw code
+		void LoadResourceBinding(const ShaderReflectionData_Vulkan& reflectionData);
+		void LoadResourceDescriptor(const ShaderReflectionData_Vulkan& reflectionData, EShaderType shaderType, DescriptorSetCreateInfo& descSetCreateInfo);
+		void LoadDescriptorBinding(const ShaderReflectionData_Vulkan& reflectionData, EShaderResourceType_Vulkan resourceType, VkDescriptorType descriptorType, EShaderType shaderType, DescriptorSetCreateInfo& descSetCreateInfo);
+		void LoadPushConstantBuffer(const ShaderReflectionData_Vulkan& reflectionData, EShaderType shaderType, std::vector<VkPushConstantRange>& outRanges);
 		// TODO: handle storage buffers
 		// TODO: handle storage textures
 		// TODO: handle subpass inputs
@@ -385,7 +431,10 @@ namespace Engine
 		// Descriptor functions
 		void CreateDescriptorSetLayout(const DescriptorSetCreateInfo& descSetCreateInfo);
 		void CreateDescriptorPool(const DescriptorSetCreateInfo& descSetCreateInfo);
+		void CreateDescriptorUpdateTemplate(const DescriptorSetCreateInfo& descSetCreateInfo);
 		void AllocateDescriptorSet(uint32_t count);
+		void WriteDescriptorSet(const std::shared_ptr<DrawingDescriptorSet_Vulkan> pDescriptorSet, std::vector<DesciptorUpdateInfo_Vulkan>& updateInfos);
+		void EvictStaleDescriptorSets(uint64_t currentFrame);
 
 		// Converter functions
 		uint32_t GetParamTypeSize(const spirv_cross::SPIRType& type);
@@ -406,6 +455,12 @@ namespace Engine
 		unsigned int m_descriptorSetAccessIndex;
 		mutable std::mutex m_descriptorSetGetMutex;
 
+		VkDescriptorUpdateTemplate m_descriptorUpdateTemplate;
+		std::unordered_map<uint32_t, uint32_t> m_templateEntryIndices; // binding - template entry index
+		std::unordered_map<DescriptorSetKey_Vulkan, std::shared_ptr<DrawingDescriptorSet_Vulkan>, DescriptorSetKeyHasher_Vulkan> m_cachedDescriptorSets;
+		uint64_t m_lastEvictionFrame;
+		mutable std::mutex m_descriptorSetCacheMutex;
+
 		std::vector<VkPipelineShaderStageCreateInfo> m_pipelineShaderStageCreateInfos;
 	};
 
@@ -0,0 +1,386 @@
+#include "DrawingShaderPack_Vulkan.h"
+#include "DrawingDevice_Vulkan.h"
+#include "DrawingResources_Vulkan.h"
+
+#include <fstream>
+#include <filesystem>
+#include <future>
+#include <thread>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+#include <assert.h>
+
+using namespace Engine;
+
+namespace
+{
+	// Appends raw bytes at given alignment and returns their offset in buffer
+	uint64_t AppendPackData(std::vector<uint8_t>& buffer, const void* pData, size_t size, size_t alignment)
+	{
+		size_t offset = (buffer.size() + alignment - 1) / alignment * alignment;
+		buffer.resize(offset + size);
+		if (size > 0)
+		{
+			memcpy(buffer.data() + offset, pData, size);
+		}
+		return offset;
+	}
+}
+
+DrawingShaderPack_Vulkan::DrawingShaderPack_Vulkan(const std::shared_ptr<LogicalDevice_Vulkan> pDevice, const char* packFilePath)
+	: m_pDevice(pDevice), m_packFilePath(packFilePath)
+{
+	if (!m_packFile.Open(m_packFilePath.c_str()))
+	{
+		return; // Pack will be built from shaders loaded in this run
+	}
+
+	if (!LoadFromFile())
+	{
+		std::cerr << "Vulkan: discarding malformed shader pack " << m_packFilePath << std::endl;
+		m_entries.clear();
+		m_packFile.Close();
+		return;
+	}
+
+	CreateShaderModules();
+}
+
+DrawingShaderPack_Vulkan::~DrawingShaderPack_Vulkan()
+{
+	for (auto& shaderModule : m_ownedModules)
+	{
+		vkDestroyShaderModule(m_pDevice->logicalDevice, shaderModule, nullptr);
+	}
+	m_ownedModules.clear();
+}
+
+std::shared_ptr<RawShader_Vulkan> DrawingShaderPack_Vulkan::RequestShader(const char* shaderFilePath, VkShaderStageFlagBits shaderStage)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto itr = m_entries.find(shaderFilePath);
+	if (itr == m_entries.end() || !itr->second.pShader || itr->second.shaderStage != shaderStage)
+	{
+		return nullptr;
+	}
+
+	return itr->second.pShader;
+}
+
+void DrawingShaderPack_Vulkan::RecordShader(const char* shaderFilePath, const std::shared_ptr<RawShader_Vulkan> pShader)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto itr = m_entries.find(shaderFilePath);
+	if (itr != m_entries.end() && itr->second.isUpToDate && itr->second.shaderStage == pShader->m_shaderStage)
+	{
+		return;
+	}
+
+	m_pendingShaders[shaderFilePath] = pShader;
+}
+
+bool DrawingShaderPack_Vulkan::OwnsShaderModule(VkShaderModule shaderModule) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_ownedModules.find(shaderModule) != m_ownedModules.end();
+}
+
+bool DrawingShaderPack_Vulkan::SaveToFile()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (m_pendingShaders.empty())
+	{
+		return true;
+	}
+
+	std::unordered_map<std::string, const std::vector<char>*> recordedCode;
+	for (auto& pending : m_pendingShaders)
+	{
+		auto& pShader = pending.second;
+		if (!pShader->m_pReflectionData || pShader->m_rawCode.empty())
+		{
+			continue; // Not reflected by any program yet
+		}
+
+		ShaderEntry entry = {};
+		if (!QuerySourceStamp(pending.first, entry.sourceSize, entry.sourceWriteTime))
+		{
+			continue;
+		}
+		entry.shaderStage = pShader->m_shaderStage;
+		entry.codeSize = pShader->m_rawCode.size();
+		entry.isUpToDate = true;
+		entry.pReflectionData = pShader->m_pReflectionData;
+
+		m_entries[pending.first] = entry; // Replaces outdated entry, its module is still owned by pack
+		recordedCode[pending.first] = &pShader->m_rawCode;
+	}
+
+	if (recordedCode.empty())
+	{
+		return true;
+	}
+
+	// Stale entries are dropped, their shaders will be re-recorded once loaded from file
+	std::vector<std::pair<const std::string*, ShaderEntry*>> packedEntries;
+	for (auto& entry : m_entries)
+	{
+		if (entry.second.isUpToDate)
+		{
+			packedEntries.emplace_back(&entry.first, &entry.second);
+		}
+	}
+
+	std::vector<uint8_t> buffer(sizeof(PackHeader) + sizeof(PackEntry) * packedEntries.size());
+	std::vector<PackEntry> packEntries(packedEntries.size());
+
+	for (size_t i = 0; i < packedEntries.size(); ++i)
+	{
+		const std::string& path = *packedEntries[i].first;
+		const ShaderEntry& entry = *packedEntries[i].second;
+		PackEntry& packEntry = packEntries[i];
+
+		packEntry.pathOffset = AppendPackData(buffer, path.data(), path.size(), 1);
+		packEntry.pathLength = (uint32_t)path.size();
+		packEntry.shaderStage = (uint32_t)entry.shaderStage;
+		packEntry.sourceSize = entry.sourceSize;
+		packEntry.sourceWriteTime = entry.sourceWriteTime;
+
+		auto recordedItr = recordedCode.find(path);
+		const void* pCode = (recordedItr != recordedCode.end()) ? (const void*)recordedItr->second->data() : (const void*)(m_packFile.GetData() + entry.codeOffset);
+		packEntry.codeOffset = AppendPackData(buffer, pCode, (size_t)entry.codeSize, sizeof(uint32_t));
+		packEntry.codeSize = entry.codeSize;
+
+		std::vector<PackResource> resources(entry.pReflectionData->resources.size());
+		for (size_t j = 0; j < resources.size(); ++j)
+		{
+			auto& resource = entry.pReflectionData->resources[j];
+			resources[j].type = (uint32_t)resource.type;
+			resources[j].binding = resource.binding;
+			resources[j].nameOffset = AppendPackData(buffer, resource.name.data(), resource.name.size(), 1);
+			resources[j].nameLength = (uint32_t)resource.name.size();
+		}
+		packEntry.resourceOffset = AppendPackData(buffer, resources.data(), sizeof(PackResource) * resources.size(), sizeof(uint64_t));
+		packEntry.resourceCount = (uint32_t)resources.size();
+
+		auto& pushConstantRanges = entry.pReflectionData->pushConstantRanges;
+		packEntry.pushConstantOffset = AppendPackData(buffer, pushConstantRanges.data(), sizeof(VkPushConstantRange) * pushConstantRanges.size(), sizeof(uint32_t));
+		packEntry.pushConstantCount = (uint32_t)pushConstantRanges.size();
+	}
+
+	PackHeader header = {};
+	header.magic = PACK_FILE_MAGIC;
+	header.version = PACK_FILE_VERSION;
+	header.entryCount = (uint32_t)packEntries.size();
+
+	memcpy(buffer.data(), &header, sizeof(PackHeader));
+	if (!packEntries.empty())
+	{
+		memcpy(buffer.data() + sizeof(PackHeader), packEntries.data(), sizeof(PackEntry) * packEntries.size());
+	}
+
+	for (auto& recorded : recordedCode)
+	{
+		m_pendingShaders.erase(recorded.first);
+	}
+
+	// Mapping has to be released before the file can be overwritten
+	m_packFile.Close();
+
+	std::ofstream file(m_packFilePath, std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		std::cerr << "Vulkan: failed to open shader pack file for writing: " << m_packFilePath << std::endl;
+		m_entries.clear(); // Code of loaded entries is no longer accessible
+		return false;
+	}
+
+	file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+	file.close();
+
+	if (!m_packFile.Open(m_packFilePath.c_str()))
+	{
+		m_entries.clear();
+		return false;
+	}
+
+	for (size_t i = 0; i < packedEntries.size(); ++i)
+	{
+		packedEntries[i].second->codeOffset = packEntries[i].codeOffset;
+	}
+
+	for (auto itr = m_entries.begin(); itr != m_entries.end();)
+	{
+		itr = itr->second.isUpToDate ? std::next(itr) : m_entries.erase(itr);
+	}
+
+	std::cout << "Vulkan: Saved " << packEntries.size() << " shaders to shader pack (" << buffer.size() << " bytes).\n";
+	return true;
+}
+
+bool DrawingShaderPack_Vulkan::LoadFromFile()
+{
+	const uint8_t* pData = m_packFile.GetData();
+	size_t fileSize = m_packFile.GetSize();
+
+	if (fileSize < sizeof(PackHeader))
+	{
+		return false;
+	}
+
+	PackHeader header = {};
+	memcpy(&header, pData, sizeof(PackHeader));
+
+	if (header.magic != PACK_FILE_MAGIC || header.version != PACK_FILE_VERSION || fileSize < sizeof(PackHeader) + sizeof(PackEntry) * (size_t)header.entryCount)
+	{
+		return false;
+	}
+
+	auto isInRange = [fileSize](uint64_t offset, uint64_t size)
+	{
+		return offset <= fileSize && size <= fileSize - offset;
+	};
+
+	for (uint32_t i = 0; i < header.entryCount; ++i)
+	{
+		PackEntry packEntry = {};
+		memcpy(&packEntry, pData + sizeof(PackHeader) + sizeof(PackEntry) * i, sizeof(PackEntry));
+
+		if (!isInRange(packEntry.pathOffset, packEntry.pathLength)
+			|| !isInRange(packEntry.codeOffset, packEntry.codeSize)
+			|| !isInRange(packEntry.resourceOffset, sizeof(PackResource) * (uint64_t)packEntry.resourceCount)
+			|| !isInRange(packEntry.pushConstantOffset, sizeof(VkPushConstantRange) * (uint64_t)packEntry.pushConstantCount)
+			|| packEntry.codeOffset % sizeof(uint32_t) != 0 || packEntry.codeSize % sizeof(uint32_t) != 0 || packEntry.codeSize == 0)
+		{
+			return false;
+		}
+
+		std::string path(reinterpret_cast<const char*>(pData + packEntry.pathOffset), packEntry.pathLength);
+
+		ShaderEntry entry = {};
+		entry.sourceSize = packEntry.sourceSize;
+		entry.sourceWriteTime = packEntry.sourceWriteTime;
+		entry.shaderStage = (VkShaderStageFlagBits)packEntry.shaderStage;
+		entry.codeOffset = packEntry.codeOffset;
+		entry.codeSize = packEntry.codeSize;
+
+		// Only SPIR-V files that still exist and are unchanged are trusted, missing files are treated as shipped in pack only
+		uint64_t sourceSize = 0;
+		int64_t sourceWriteTime = 0;
+		entry.isUpToDate = !QuerySourceStamp(path, sourceSize, sourceWriteTime) || (sourceSize == entry.sourceSize && sourceWriteTime == entry.sourceWriteTime);
+
+		entry.pReflectionData = std::make_shared<ShaderReflectionData_Vulkan>();
+
+		for (uint32_t j = 0; j < packEntry.resourceCount; ++j)
+		{
+			PackResource packResource = {};
+			memcpy(&packResource, pData + packEntry.resourceOffset + sizeof(PackResource) * j, sizeof(PackResource));
+
+			if (!isInRange(packResource.nameOffset, packResource.nameLength))
+			{
+				return false;
+			}
+
+			ShaderReflectionData_Vulkan::Resource resource;
+			resource.type = (EShaderResourceType_Vulkan)packResource.type;
+			resource.binding = packResource.binding;
+			resource.name.assign(reinterpret_cast<const char*>(pData + packResource.nameOffset), packResource.nameLength);
+			entry.pReflectionData->resources.emplace_back(resource);
+		}
+
+		entry.pReflectionData->pushConstantRanges.resize(packEntry.pushConstantCount);
+		if (packEntry.pushConstantCount > 0)
+		{
+			memcpy(entry.pReflectionData->pushConstantRanges.data(), pData + packEntry.pushConstantOffset, sizeof(VkPushConstantRange) * packEntry.pushConstantCount);
+		}
+
+		m_entries.emplace(path, entry);
+	}
+
+	return true;
+}
+
+void DrawingShaderPack_Vulkan::CreateShaderModules()
+{
+	auto creationStart = std::chrono::high_resolution_clock::now();
+
+	std::vector<ShaderEntry*> validEntries;
+	for (auto& entry : m_entries)
+	{
+		if (entry.second.isUpToDate)
+		{
+			validEntries.emplace_back(&entry.second);
+		}
+	}
+
+	if (validEntries.empty())
+	{
+		return;
+	}
+
+	std::vector<VkShaderModule> shaderModules(validEntries.size(), VK_NULL_HANDLE);
+
+	// Module creation reads code straight from mapped pages, entries are distributed among workers by index
+	size_t workerCount = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), validEntries.size()));
+	std::vector<std::future<void>> workers;
+
+	for (size_t worker = 0; worker < workerCount; ++worker)
+	{
+		workers.emplace_back(std::async(std::launch::async, [this, worker, workerCount, &validEntries, &shaderModules]()
+			{
+				for (size_t i = worker; i < validEntries.size(); i += workerCount)
+				{
+					VkShaderModuleCreateInfo createInfo = {};
+					createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+					createInfo.codeSize = (size_t)validEntries[i]->codeSize;
+					createInfo.pCode = reinterpret_cast<const uint32_t*>(m_packFile.GetData() + validEntries[i]->codeOffset);
+
+					if (vkCreateShaderModule(m_pDevice->logicalDevice, &createInfo, nullptr, &shaderModules[i]) != VK_SUCCESS)
+					{
+						shaderModules[i] = VK_NULL_HANDLE;
+					}
+				}
+			}));
+	}
+
+	for (auto& worker : workers)
+	{
+		worker.wait();
+	}
+
+	for (size_t i = 0; i < validEntries.size(); ++i)
+	{
+		if (shaderModules[i] == VK_NULL_HANDLE)
+		{
+			validEntries[i]->isUpToDate = false; // Will be loaded from file instead
+			continue;
+		}
+
+		auto pShader = std::make_shared<RawShader_Vulkan>(m_pDevice, shaderModules[i], validEntries[i]->shaderStage, "main");
+		pShader->m_pReflectionData = validEntries[i]->pReflectionData;
+
+		validEntries[i]->pShader = pShader;
+		m_ownedModules.emplace(shaderModules[i]);
+	}
+
+	std::chrono::duration<float, std::milli> creationTime = std::chrono::high_resolution_clock::now() - creationStart;
+	std::cout << "Vulkan: Created " << m_ownedModules.size() << " shader modules from shader pack in " << creationTime.count() << " ms.\n";
+}
+
+bool DrawingShaderPack_Vulkan::QuerySourceStamp(const std::string& shaderFilePath, uint64_t& outSize, int64_t& outWriteTime) const
+{
+	std::error_code errorCode;
+
+	outSize = (uint64_t)std::filesystem::file_size(shaderFilePath, errorCode);
+	if (errorCode)
+	{
+		return false;
+	}
+
+	outWriteTime = (int64_t)std::filesystem::last_write_time(shaderFilePath, errorCode).time_since_epoch().count();
+	return !errorCode;
+}
\ No newline at end of file
@@ -0,0 +1,100 @@
+#pragma once
+#include "NoCopy.h"
+#include "MemoryMappedFile.h"
+
+#include <vulkan.h>
+#include <memory>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+
+namespace Engine
+{
+	struct LogicalDevice_Vulkan;
+	struct ShaderReflectionData_Vulkan;
+	class RawShader_Vulkan;
+
+	// Single memory-mapped file holding SPIR-V code and reflection data of all shaders loaded in previous runs
+	// Shader modules of up-to-date entries are created in parallel at startup and stay alive until the pack is destroyed
+	class DrawingShaderPack_Vulkan : public NoCopy
+	{
+	public:
+		DrawingShaderPack_Vulkan(const std::shared_ptr<LogicalDevice_Vulkan> pDevice, const char* packFilePath);
+		~DrawingShaderPack_Vulkan();
+
+		// Returns nullptr if the shader is not packed or its SPIR-V file has been modified since
+		std::shared_ptr<RawShader_Vulkan> RequestShader(const char* shaderFilePath, VkShaderStageFlagBits shaderStage);
+		// Shaders loaded from file are added to pack on next save, their reflection data must be ready by then
+		void RecordShader(const char* shaderFilePath, const std::shared_ptr<RawShader_Vulkan> pShader);
+		bool OwnsShaderModule(VkShaderModule shaderModule) const;
+
+		// Rewrites pack file if new shaders have been recorded since last save, only called on device shutdown to keep file I/O out of frame loop
+		bool SaveToFile();
+
+	private:
+		struct ShaderEntry
+		{
+			uint64_t				sourceSize;
+			int64_t					sourceWriteTime;
+			VkShaderStageFlagBits	shaderStage;
+			uint64_t				codeOffset; // Into mapped pack file
+			uint64_t				codeSize;
+			bool					isUpToDate;
+			std::shared_ptr<ShaderReflectionData_Vulkan> pReflectionData;
+			std::shared_ptr<RawShader_Vulkan> pShader; // Only for shaders whose modules are created from pack
+		};
+
+		bool LoadFromFile();
+		void CreateShaderModules();
+		bool QuerySourceStamp(const std::string& shaderFilePath, uint64_t& outSize, int64_t& outWriteTime) const;
+
+	public:
+		const uint32_t PACK_FILE_MAGIC = 0x4B505356; // "VSPK"
+		const uint32_t PACK_FILE_VERSION = 2;
+
+	private:
+		struct PackHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t entryCount;
+			uint32_t reserved;
+		};
+
+		// All offsets are relative to the beginning of pack file
+		struct PackEntry
+		{
+			uint64_t pathOffset;
+			uint32_t pathLength;
+			uint32_t shaderStage;
+			uint64_t sourceSize;
+			int64_t	 sourceWriteTime;
+			uint64_t codeOffset; // 4-byte aligned so that modules can be created directly from mapped memory
+			uint64_t codeSize;
+			uint64_t resourceOffset;
+			uint32_t resourceCount;
+			uint32_t pushConstantCount;
+			uint64_t pushConstantOffset;
+		};
+
+		struct PackResource
+		{
+			uint32_t type;
+			uint32_t binding;
+			uint64_t nameOffset;
+			uint32_t nameLength;
+			uint32_t padding;
+		};
+
+		std::shared_ptr<LogicalDevice_Vulkan> m_pDevice;
+		const std::string m_packFilePath;
+		MemoryMappedFile m_packFile;
+		mutable std::mutex m_mutex;
+
+		std::unordered_map<std::string, ShaderEntry> m_entries;
+		std::unordered_map<std::string, std::shared_ptr<RawShader_Vulkan>> m_pendingShaders;
+		std::unordered_set<VkShaderModule> m_ownedModules;
+	};
+}
\ No newline at end of file
@@ -25,6 +25,11 @@ VkResult TimelineSemaphore_Vulkan::Wait(uint64_t timeout)
 	return vkWaitSemaphores(m_pDevice->logicalDevice, &m_waitInfo, timeout);
 }
 
+uint64_t TimelineSemaphore_Vulkan::GetSignalValue() const
+{
+	return m_signalValue;
+}
+
 void TimelineSemaphore_Vulkan::UpdateTimeline()
 {
 	m_waitValue = m_signalValue + 1;
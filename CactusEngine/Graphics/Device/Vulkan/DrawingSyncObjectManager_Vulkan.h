@@ -35,6 +35,7 @@ namespace Engine
 		TimelineSemaphore_Vulkan(const std::shared_ptr<LogicalDevice_Vulkan> pDevice, const VkSemaphore& semaphoreHandle, uint32_t assignedID);
 
 		VkResult Wait(uint64_t timeout = UINT64_MAX);
+		uint64_t GetSignalValue() const; // Value to be signaled by current submission, stays reached after the semaphore is recycled
 
 	private:
 		void UpdateTimeline();
@@ -4,12 +4,16 @@
 #include "DrawingCommandManager_Vulkan.h"
 #include "DrawingResources_Vulkan.h"
 #include <assert.h>
+#include <algorithm>
 
 using namespace Engine;
 
 DrawingUploadAllocator_Vulkan::DrawingUploadAllocator_Vulkan(const std::shared_ptr<LogicalDevice_Vulkan> pDevice, VkInstance instance)
-	: m_pDevice(pDevice)
+	: m_pDevice(pDevice), m_pStagingRing(nullptr), m_stagingRingHead(0), m_stagingRingTail(0)
 {
+	// Covers texel sizes of all supported formats, and the 4 byte alignment required by buffer to image copies
+	m_stagingAlignment = std::max<VkDeviceSize>(16, pDevice->deviceProperties.limits.optimalBufferCopyOffsetAlignment);
+
 	VmaAllocatorCreateInfo createInfo = {};
 	createInfo.physicalDevice = pDevice->physicalDevice;
 	createInfo.device = pDevice->logicalDevice;
@@ -74,7 +78,20 @@ bool DrawingUploadAllocator_Vulkan::CreateTexture2D(const Texture2DCreateInfo_Vu
 	texture2d.m_format = createInfo.format;
 	texture2d.m_mipLevels = createInfo.mipLevels;
 
-	if (vmaCreateImage(m_allocator, &imageCreateInfo, &allocationInfo, &texture2d.m_image, &texture2d.m_allocation, nullptr) == VK_SUCCESS)
+	if (createInfo.pAliasTexture != nullptr && BindAliasedImage(imageCreateInfo, createInfo.pAliasTexture, texture2d))
+	{
+		return true;
+	}
+
+	VkResult result = vmaCreateImage(m_allocator, &imageCreateInfo, &allocationInfo, &texture2d.m_image, &texture2d.m_allocation, nullptr);
+	if (result == VK_ERROR_FEATURE_NOT_PRESENT && allocationInfo.usage == VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED)
+	{
+		// Lazily allocated memory is usually only exposed by tile-based GPUs
+		allocationInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+		result = vmaCreateImage(m_allocator, &imageCreateInfo, &allocationInfo, &texture2d.m_image, &texture2d.m_allocation, nullptr);
+	}
+
+	if (result == VK_SUCCESS)
 	{
 		return true;
 	}
@@ -108,4 +125,113 @@ void DrawingUploadAllocator_Vulkan::FreeImage(VkImage& image, VmaAllocation& all
 {
 	assert(m_allocator != VK_NULL_HANDLE && image != VK_NULL_HANDLE && allocation != VK_NULL_HANDLE);
 	vmaDestroyImage(m_allocator, image, allocation);
+}
+
+void DrawingUploadAllocator_Vulkan::FreeAliasedImage(VkImage& image)
+{
+	assert(image != VK_NULL_HANDLE);
+	vkDestroyImage(m_pDevice->logicalDevice, image, nullptr);
+}
+
+bool DrawingUploadAllocator_Vulkan::BindAliasedImage(const VkImageCreateInfo& imageCreateInfo, const std::shared_ptr<Texture2D_Vulkan> pAliasTexture, Texture2D_Vulkan& texture2d)
+{
+	assert(pAliasTexture->m_allocatorType == EAllocatorType_Vulkan::VMA && pAliasTexture->m_pAliasedTexture == nullptr);
+
+	if (vkCreateImage(m_pDevice->logicalDevice, &imageCreateInfo, nullptr, &texture2d.m_image) != VK_SUCCESS)
+	{
+		return false;
+	}
+
+	VkMemoryRequirements memoryRequirements = {};
+	vkGetImageMemoryRequirements(m_pDevice->logicalDevice, texture2d.m_image, &memoryRequirements);
+
+	VmaAllocationInfo aliasAllocationInfo = {};
+	vmaGetAllocationInfo(m_allocator, pAliasTexture->m_allocation, &aliasAllocationInfo);
+
+	// Fall back to a separate allocation if the memory of alias texture cannot hold this image
+	if (memoryRequirements.size > aliasAllocationInfo.size
+		|| (memoryRequirements.memoryTypeBits & (1u << aliasAllocationInfo.memoryType)) == 0
+		|| aliasAllocationInfo.offset % memoryRequirements.alignment != 0
+		|| vmaBindImageMemory(m_allocator, pAliasTexture->m_allocation, texture2d.m_image) != VK_SUCCESS)
+	{
+		vkDestroyImage(m_pDevice->logicalDevice, texture2d.m_image, nullptr);
+		texture2d.m_image = VK_NULL_HANDLE;
+		return false;
+	}
+
+	texture2d.m_allocation = pAliasTexture->m_allocation;
+	texture2d.m_pAliasedTexture = pAliasTexture;
+	return true;
+}
+
+bool DrawingUploadAllocator_Vulkan::AllocateStaging(VkDeviceSize size, StagingAllocation_Vulkan& outAllocation)
+{
+	assert(size > 0);
+
+	std::lock_guard<std::mutex> lock(m_stagingMutex);
+
+	if (m_pStagingRing == nullptr)
+	{
+		m_pStagingRing = std::make_shared<StagingBuffer_Vulkan>(m_pDevice, STAGING_RING_SIZE);
+	}
+
+	uint64_t begin = (m_stagingRingHead + m_stagingAlignment - 1) / m_stagingAlignment * m_stagingAlignment;
+	if (begin % STAGING_RING_SIZE + size > STAGING_RING_SIZE)
+	{
+		begin += STAGING_RING_SIZE - begin % STAGING_RING_SIZE; // Skip the rest of ring to keep the allocation contiguous
+	}
+
+	if (size <= STAGING_RING_SIZE && begin + size - m_stagingRingTail <= STAGING_RING_SIZE)
+	{
+		// Padding and skipped space are owned by this block, so they are reclaimed along with it
+		StagingRingBlock block = {};
+		block.begin = m_stagingRingHead;
+		block.end = begin + size;
+		block.isReleased = false;
+		m_stagingRingBlocks.emplace_back(block);
+		m_stagingRingHead = block.end;
+
+		outAllocation.pBuffer = m_pStagingRing;
+		outAllocation.offset = begin % STAGING_RING_SIZE;
+		outAllocation.size = size;
+		outAllocation.pMappedData = (uint8_t*)m_pStagingRing->GetMappedData() + outAllocation.offset;
+		outAllocation.ringPosition = block.begin;
+		outAllocation.isDedicated = false;
+		return true;
+	}
+
+	// Ring is full or the request is too large, dedicated buffer is freed once the caller drops it
+	outAllocation.pBuffer = std::make_shared<StagingBuffer_Vulkan>(m_pDevice, size);
+	outAllocation.offset = 0;
+	outAllocation.size = size;
+	outAllocation.pMappedData = outAllocation.pBuffer->GetMappedData();
+	outAllocation.ringPosition = 0;
+	outAllocation.isDedicated = true;
+	return outAllocation.pMappedData != nullptr;
+}
+
+void DrawingUploadAllocator_Vulkan::ReleaseStaging(const StagingAllocation_Vulkan& allocation)
+{
+	if (allocation.isDedicated)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_stagingMutex);
+
+	auto itr = std::lower_bound(m_stagingRingBlocks.begin(), m_stagingRingBlocks.end(), allocation.ringPosition,
+		[](const StagingRingBlock& block, uint64_t position)
+		{
+			return block.begin < position;
+		});
+
+	assert(itr != m_stagingRingBlocks.end() && itr->begin == allocation.ringPosition);
+	itr->isReleased = true;
+
+	// Space can only be reused in ring order
+	while (!m_stagingRingBlocks.empty() && m_stagingRingBlocks.front().isReleased)
+	{
+		m_stagingRingTail = m_stagingRingBlocks.front().end;
+		m_stagingRingBlocks.pop_front();
+	}
 }
\ No newline at end of file
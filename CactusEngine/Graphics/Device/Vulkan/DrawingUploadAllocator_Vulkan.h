@@ -2,10 +2,13 @@
 #include <vulkan.h>
 #include <memory>
 #include <vector>
+#include <deque>
+#include <mutex>
 #include <vk_mem_alloc.h>
 
 namespace Engine
 {
+	class Texture2D_Vulkan;
 	struct Texture2DCreateInfo_Vulkan
 	{
 		VkExtent2D			extent = { 0, 0 };
@@ -16,6 +19,8 @@ namespace Engine
 		VkImageViewType		viewType = VK_IMAGE_VIEW_TYPE_2D;
 		VkImageUsageFlags	usage = 0;
 		VmaMemoryUsage		memoryUsage = VMA_MEMORY_USAGE_UNKNOWN;
+
+		std::shared_ptr<Texture2D_Vulkan> pAliasTexture = nullptr; // Bind to the memory of this texture instead of making a new allocation
 	};
 
 	struct RawBufferCreateInfo_Vulkan
@@ -28,8 +33,18 @@ namespace Engine
 		VkIndexType			indexFormat = VK_INDEX_TYPE_UINT32;
 	};
 
+	class StagingBuffer_Vulkan;
+	struct StagingAllocation_Vulkan
+	{
+		std::shared_ptr<StagingBuffer_Vulkan> pBuffer = nullptr; // Staging ring, or a dedicated buffer if the ring is full
+		VkDeviceSize	offset = 0;
+		VkDeviceSize	size = 0;
+		void*			pMappedData = nullptr; // Points to the start of this allocation
+		uint64_t		ringPosition = 0;
+		bool			isDedicated = false;
+	};
+
 	struct LogicalDevice_Vulkan;
-	class Texture2D_Vulkan;	
 	class RawBuffer_Vulkan;	
 	class DrawingCommandManager_Vulkan;
 	class DrawingUploadAllocator_Vulkan
@@ -46,9 +61,35 @@ namespace Engine
 
 		void FreeBuffer(VkBuffer& buffer, VmaAllocation& allocation);
 		void FreeImage(VkImage& image, VmaAllocation& allocation);
+		void FreeAliasedImage(VkImage& image); // Memory is owned by the alias texture
+
+		// Sub-allocates upload space from a persistently mapped ring, the space is reused only after it's released
+		// Caller releases the allocation once the GPU has consumed it, allocations can be released in any order
+		bool AllocateStaging(VkDeviceSize size, StagingAllocation_Vulkan& outAllocation);
+		void ReleaseStaging(const StagingAllocation_Vulkan& allocation);
+
+	public:
+		const VkDeviceSize STAGING_RING_SIZE = 64 * 1024 * 1024;
+
+	private:
+		bool BindAliasedImage(const VkImageCreateInfo& imageCreateInfo, const std::shared_ptr<Texture2D_Vulkan> pAliasTexture, Texture2D_Vulkan& texture2d);
 
 	private:
+		struct StagingRingBlock
+		{
+			uint64_t	begin; // Ring positions keep increasing, wrapping is done by taking them modulo ring size
+			uint64_t	end;
+			bool		isReleased;
+		};
+
 		std::shared_ptr<LogicalDevice_Vulkan> m_pDevice;
 		VmaAllocator m_allocator;
+
+		std::mutex m_stagingMutex;
+		std::shared_ptr<StagingBuffer_Vulkan> m_pStagingRing; // Created on first use
+		std::deque<StagingRingBlock> m_stagingRingBlocks;
+		uint64_t m_stagingRingHead;
+		uint64_t m_stagingRingTail;
+		VkDeviceSize m_stagingAlignment;
 	};
 }
\ No newline at end of file
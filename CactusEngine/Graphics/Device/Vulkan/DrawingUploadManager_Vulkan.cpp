@@ -0,0 +1,267 @@
+#include "DrawingUploadManager_Vulkan.h"
+#include "DrawingDevice_Vulkan.h"
+#include "DrawingResources_Vulkan.h"
+#include "DrawingCommandManager_Vulkan.h"
+#include <assert.h>
+
+using namespace Engine;
+
+DrawingUploadManager_Vulkan::DrawingUploadManager_Vulkan(const std::shared_ptr<LogicalDevice_Vulkan> pDevice)
+	: m_pDevice(pDevice), m_pTransferCmdBuffer(nullptr), m_pHandoverCmdBuffer(nullptr), m_pendingStagingSize(0), m_completedTicket(0)
+{
+	m_useTransferQueue = pDevice->pTransferCommandManager != nullptr;
+	m_requireOwnershipTransfer = m_useTransferQueue && pDevice->transferQueue.queueFamilyIndex != pDevice->graphicsQueue.queueFamilyIndex;
+
+	m_srcQueueFamily = m_requireOwnershipTransfer ? pDevice->transferQueue.queueFamilyIndex : pDevice->graphicsQueue.queueFamilyIndex;
+	m_dstQueueFamily = pDevice->graphicsQueue.queueFamilyIndex;
+
+	ResetPendingBatch(1);
+}
+
+bool DrawingUploadManager_Vulkan::AllocateStaging(VkDeviceSize size, StagingAllocation_Vulkan& outAllocation)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	RetireCompletedBatches(); // Give the ring a chance to recycle before falling back to a dedicated buffer
+
+	return m_pDevice->pUploadAllocator->AllocateStaging(size, outAllocation);
+}
+
+uint64_t DrawingUploadManager_Vulkan::UploadBuffer(uint32_t resourceID, const StagingAllocation_Vulkan& staging, const std::shared_ptr<RawBuffer_Vulkan> pDstBuffer, VkDeviceSize dstOffset,
+	VkAccessFlags dstAccess, VkPipelineStageFlags dstStage)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	VkBufferCopy region = {};
+	region.srcOffset = staging.offset;
+	region.dstOffset = dstOffset;
+	region.size = staging.size;
+
+	auto pCopyCmdBuffer = GetCopyCommandBuffer();
+	pCopyCmdBuffer->CopyBufferToBuffer(staging.pBuffer, pDstBuffer, region);
+
+	if (m_requireOwnershipTransfer)
+	{
+		pCopyCmdBuffer->ReleaseBufferOwnership(pDstBuffer, m_srcQueueFamily, m_dstQueueFamily);
+	}
+
+	GetHandoverCommandBuffer()->AcquireBufferOwnership(pDstBuffer, m_srcQueueFamily, m_dstQueueFamily, dstAccess, dstStage);
+
+	return EnqueueUpload(resourceID, staging);
+}
+
+uint64_t DrawingUploadManager_Vulkan::UploadTexture2D(uint32_t resourceID, const StagingAllocation_Vulkan& staging, const std::shared_ptr<Texture2D_Vulkan> pDstImage, const std::vector<VkBufferImageCopy>& regions,
+	bool generateMipmap, VkImageLayout finalLayout, uint32_t appliedStages)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	std::vector<VkBufferImageCopy> stagingRegions = regions;
+	for (auto& region : stagingRegions)
+	{
+		region.bufferOffset += staging.offset;
+	}
+
+	auto pCopyCmdBuffer = GetCopyCommandBuffer();
+	pCopyCmdBuffer->TransitionImageLayout(pDstImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0);
+	pCopyCmdBuffer->CopyBufferToTexture2D(staging.pBuffer, pDstImage, stagingRegions);
+
+	auto pHandoverCmdBuffer = GetHandoverCommandBuffer();
+
+	if (m_requireOwnershipTransfer)
+	{
+		pCopyCmdBuffer->ReleaseImageOwnership(pDstImage, m_srcQueueFamily, m_dstQueueFamily);
+		pHandoverCmdBuffer->AcquireImageOwnership(pDstImage, m_srcQueueFamily, m_dstQueueFamily);
+	}
+
+	// Blitting for mipmap generation is not supported on transfer queue, so it's always done on graphics queue
+	if (generateMipmap)
+	{
+		pHandoverCmdBuffer->GenerateMipmap(pDstImage, finalLayout, appliedStages);
+	}
+	else if (finalLayout != VK_IMAGE_LAYOUT_UNDEFINED)
+	{
+		pHandoverCmdBuffer->TransitionImageLayout(pDstImage, finalLayout, appliedStages);
+	}
+
+	return EnqueueUpload(resourceID, staging);
+}
+
+void DrawingUploadManager_Vulkan::Flush()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (m_useTransferQueue)
+	{
+		SubmitTransferBatch();
+	}
+	else if (!m_pendingBatch.resourceIDs.empty())
+	{
+		// Handover command buffer is submitted with current frame, which is known to be finished once its frame slot is reused
+		m_pendingBatch.retireFrame = m_pDevice->pDescriptorAllocator->GetCurrentFrame() + m_pDevice->framesInFlight;
+
+		uint64_t nextTicket = m_pendingBatch.ticket + 1;
+		m_inFlightBatches.emplace_back(std::move(m_pendingBatch));
+		ResetPendingBatch(nextTicket);
+	}
+
+	if (m_pHandoverCmdBuffer != nullptr)
+	{
+		// It's already in the in-use queue of graphics command manager, the caller submits it along with other implicit command buffers
+		m_pHandoverCmdBuffer = nullptr;
+
+		for (auto& batch : m_inFlightBatches)
+		{
+			batch.isHandedOver = true;
+		}
+	}
+
+	RetireCompletedBatches();
+}
+
+bool DrawingUploadManager_Vulkan::IsUploadComplete(uint64_t ticket)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	RetireCompletedBatches();
+
+	return ticket <= m_completedTicket;
+}
+
+bool DrawingUploadManager_Vulkan::IsResourceUploaded(uint32_t resourceID)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	RetireCompletedBatches();
+
+	return m_resourceTickets.find(resourceID) == m_resourceTickets.end();
+}
+
+std::shared_ptr<DrawingCommandBuffer_Vulkan> DrawingUploadManager_Vulkan::GetCopyCommandBuffer()
+{
+	if (!m_useTransferQueue)
+	{
+		return GetHandoverCommandBuffer();
+	}
+
+	if (m_pTransferCmdBuffer == nullptr)
+	{
+		m_pTransferCmdBuffer = m_pDevice->pTransferCommandManager->RequestPrimaryCommandBuffer();
+		m_pTransferCmdBuffer->m_usageFlags = (uint32_t)EDrawingCommandBufferUsageFlagBits_Vulkan::Upload; // Keeps it away from other transfer submissions
+	}
+
+	return m_pTransferCmdBuffer;
+}
+
+std::shared_ptr<DrawingCommandBuffer_Vulkan> DrawingUploadManager_Vulkan::GetHandoverCommandBuffer()
+{
+	if (m_pHandoverCmdBuffer == nullptr)
+	{
+		m_pHandoverCmdBuffer = m_pDevice->pGraphicsCommandManager->RequestPrimaryCommandBuffer();
+	}
+
+	return m_pHandoverCmdBuffer;
+}
+
+uint64_t DrawingUploadManager_Vulkan::EnqueueUpload(uint32_t resourceID, const StagingAllocation_Vulkan& staging)
+{
+	uint64_t ticket = m_pendingBatch.ticket;
+
+	m_pendingBatch.resourceIDs.emplace_back(resourceID);
+	m_pendingBatch.stagingAllocations.emplace_back(staging);
+	m_resourceTickets[resourceID] = ticket;
+
+	m_pendingStagingSize += staging.size;
+	if (m_useTransferQueue && m_pendingStagingSize >= MAX_BATCH_STAGING_SIZE)
+	{
+		SubmitTransferBatch();
+	}
+
+	return ticket;
+}
+
+void DrawingUploadManager_Vulkan::SubmitTransferBatch()
+{
+	assert(m_useTransferQueue);
+
+	if (m_pTransferCmdBuffer == nullptr)
+	{
+		return;
+	}
+
+	// Pooled semaphore could be reused after this submission completes, its timeline would only move forward
+	auto pSubmitSemaphore = m_pDevice->pSyncObjectManager->RequestTimelineSemaphore();
+	m_pendingBatch.semaphore = pSubmitSemaphore->semaphore;
+	m_pendingBatch.semaphoreValue = pSubmitSemaphore->GetSignalValue();
+
+	m_pDevice->pTransferCommandManager->SubmitCommandBuffers(pSubmitSemaphore, (uint32_t)EDrawingCommandBufferUsageFlagBits_Vulkan::Upload);
+	m_pTransferCmdBuffer = nullptr;
+
+	// Every upload records its graphics side, so the handover command buffer exists whenever copies do
+	m_pHandoverCmdBuffer->WaitTimelineValue(m_pendingBatch.semaphore, m_pendingBatch.semaphoreValue, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+
+	uint64_t nextTicket = m_pendingBatch.ticket + 1;
+	m_inFlightBatches.emplace_back(std::move(m_pendingBatch));
+	ResetPendingBatch(nextTicket);
+}
+
+void DrawingUploadManager_Vulkan::ResetPendingBatch(uint64_t ticket)
+{
+	m_pendingBatch = {};
+	m_pendingBatch.ticket = ticket;
+	m_pendingBatch.semaphore = VK_NULL_HANDLE;
+	m_pendingBatch.semaphoreValue = 0;
+	m_pendingBatch.retireFrame = 0;
+	m_pendingBatch.isHandedOver = false;
+	m_pendingBatch.isCopyComplete = false;
+
+	m_pendingStagingSize = 0;
+}
+
+bool DrawingUploadManager_Vulkan::IsCopyComplete(const UploadBatch& batch, uint64_t currentFrame) const
+{
+	if (batch.semaphore == VK_NULL_HANDLE)
+	{
+		return batch.isHandedOver && currentFrame >= batch.retireFrame;
+	}
+
+	uint64_t counterValue = 0;
+	return vkGetSemaphoreCounterValue(m_pDevice->logicalDevice, batch.semaphore, &counterValue) == VK_SUCCESS && counterValue >= batch.semaphoreValue;
+}
+
+void DrawingUploadManager_Vulkan::RetireCompletedBatches()
+{
+	uint64_t currentFrame = m_pDevice->pDescriptorAllocator->GetCurrentFrame();
+
+	// Transfer submissions complete in order, so later batches are not checked once one is found unfinished
+	for (auto& batch : m_inFlightBatches)
+	{
+		if (!batch.isCopyComplete)
+		{
+			if (!IsCopyComplete(batch, currentFrame))
+			{
+				break;
+			}
+
+			batch.isCopyComplete = true;
+			for (auto& staging : batch.stagingAllocations)
+			{
+				m_pDevice->pUploadAllocator->ReleaseStaging(staging);
+			}
+			batch.stagingAllocations.clear(); // Dedicated staging buffers are freed here
+		}
+	}
+
+	while (!m_inFlightBatches.empty() && m_inFlightBatches.front().isCopyComplete && m_inFlightBatches.front().isHandedOver)
+	{
+		auto& batch = m_inFlightBatches.front();
+
+		for (auto resourceID : batch.resourceIDs)
+		{
+			auto itr = m_resourceTickets.find(resourceID);
+			if (itr != m_resourceTickets.end() && itr->second <= batch.ticket)
+			{
+				m_resourceTickets.erase(itr);
+			}
+		}
+
+		m_completedTicket = batch.ticket;
+		m_inFlightBatches.pop_front();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+#pragma once
+#include "NoCopy.h"
+#include "DrawingUploadAllocator_Vulkan.h"
+
+#include <vulkan.h>
+#include <memory>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <mutex>
+
+namespace Engine
+{
+	struct LogicalDevice_Vulkan;
+	class  RawBuffer_Vulkan;
+	class  Texture2D_Vulkan;
+	class  DrawingCommandBuffer_Vulkan;
+
+	// Batches vertex buffer and texture uploads on transfer queue, graphics queue only waits for them once per frame
+	// Falls back to recording uploads on graphics queue if the device has no separate transfer queue
+	class DrawingUploadManager_Vulkan : public NoCopy
+	{
+	public:
+		DrawingUploadManager_Vulkan(const std::shared_ptr<LogicalDevice_Vulkan> pDevice);
+		~DrawingUploadManager_Vulkan() = default;
+
+		// Staging space is written by caller and handed back through one of the upload functions, which release it once the copy completes
+		bool AllocateStaging(VkDeviceSize size, StagingAllocation_Vulkan& outAllocation);
+
+		// Commands are recorded immediately, so resource states are final once these return, but nothing is submitted before Flush
+		// Returns the ticket of the batch the upload goes into
+		// Resource ID is the one exposed to users, e.g. the vertex buffer owning the destination buffer
+		uint64_t UploadBuffer(uint32_t resourceID, const StagingAllocation_Vulkan& staging, const std::shared_ptr<RawBuffer_Vulkan> pDstBuffer, VkDeviceSize dstOffset,
+			VkAccessFlags dstAccess, VkPipelineStageFlags dstStage);
+		// Buffer offsets of regions are relative to the staging allocation
+		uint64_t UploadTexture2D(uint32_t resourceID, const StagingAllocation_Vulkan& staging, const std::shared_ptr<Texture2D_Vulkan> pDstImage, const std::vector<VkBufferImageCopy>& regions,
+			bool generateMipmap, VkImageLayout finalLayout, uint32_t appliedStages);
+
+		// Submits pending copies on transfer queue, must be followed by submission of implicit graphics command buffers
+		// Ownership acquisition, mipmap generation and final layout transitions are left in an implicit graphics command buffer
+		void Flush();
+
+		bool IsUploadComplete(uint64_t ticket);
+		bool IsResourceUploaded(uint32_t resourceID);
+
+	public:
+		const VkDeviceSize MAX_BATCH_STAGING_SIZE = 16 * 1024 * 1024; // Pending copies are submitted early once their staging data exceeds this size, so staging ring can be recycled during long loads
+
+	private:
+		struct UploadBatch
+		{
+			uint64_t		ticket;
+			VkSemaphore		semaphore;		// Signaled by transfer submission, VK_NULL_HANDLE if copies are recorded on graphics queue
+			uint64_t		semaphoreValue;
+			uint64_t		retireFrame;	// Only used when copies are recorded on graphics queue
+			bool			isHandedOver;	// Whether graphics queue side has been queued for submission
+			bool			isCopyComplete;	// Staging space is released as soon as copies are done
+
+			std::vector<uint32_t>					resourceIDs;
+			std::vector<StagingAllocation_Vulkan>	stagingAllocations;
+		};
+
+		std::shared_ptr<DrawingCommandBuffer_Vulkan> GetCopyCommandBuffer();
+		std::shared_ptr<DrawingCommandBuffer_Vulkan> GetHandoverCommandBuffer();
+		uint64_t EnqueueUpload(uint32_t resourceID, const StagingAllocation_Vulkan& staging);
+		bool IsCopyComplete(const UploadBatch& batch, uint64_t currentFrame) const;
+		void SubmitTransferBatch();
+		void ResetPendingBatch(uint64_t ticket);
+		void RetireCompletedBatches();
+
+	private:
+		std::shared_ptr<LogicalDevice_Vulkan> m_pDevice;
+		bool m_useTransferQueue;
+		bool m_requireOwnershipTransfer;
+		uint32_t m_srcQueueFamily;
+		uint32_t m_dstQueueFamily;
+		std::mutex m_mutex;
+
+		std::shared_ptr<DrawingCommandBuffer_Vulkan> m_pTransferCmdBuffer; // Copies on transfer queue, nullptr if nothing is pending
+		std::shared_ptr<DrawingCommandBuffer_Vulkan> m_pHandoverCmdBuffer; // Graphics queue side of pending and early submitted batches
+
+		UploadBatch m_pendingBatch;
+		VkDeviceSize m_pendingStagingSize;
+		std::deque<UploadBatch> m_inFlightBatches;
+
+		uint64_t m_completedTicket;
+		std::unordered_map<uint32_t, uint64_t> m_resourceTickets; // Resource ID to ticket, only contains unfinished uploads
+	};
+}
\ No newline at end of file
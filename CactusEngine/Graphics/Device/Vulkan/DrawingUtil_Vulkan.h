@@ -206,12 +206,48 @@ namespace Engine
 		case ETextureFormat::BGRA8_UNORM:
 			return VK_FORMAT_B8G8R8A8_UNORM;
 
+		case ETextureFormat::RGBA16F:
+			return VK_FORMAT_R16G16B16A16_SFLOAT;
+
+		case ETextureFormat::R11G11B10F:
+			return VK_FORMAT_B10G11R11_UFLOAT_PACK32;
+
+		case ETextureFormat::RGBA8_UNORM:
+			return VK_FORMAT_R8G8B8A8_UNORM;
+
 		case ETextureFormat::RGB32F:
 			return VK_FORMAT_R32G32B32_SFLOAT;
 
 		case ETextureFormat::RG32F:
 			return VK_FORMAT_R32G32_SFLOAT;
 
+		case ETextureFormat::RG16F:
+			return VK_FORMAT_R16G16_SFLOAT;
+
+		case ETextureFormat::RGBA8_SNORM:
+			return VK_FORMAT_R8G8B8A8_SNORM;
+
+		case ETextureFormat::RG16_SNORM:
+			return VK_FORMAT_R16G16_SNORM;
+
+		case ETextureFormat::RGBA16_UNORM:
+			return VK_FORMAT_R16G16B16A16_UNORM;
+
+		case ETextureFormat::BC1_SRGB:
+			return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+
+		case ETextureFormat::BC3_SRGB:
+			return VK_FORMAT_BC3_SRGB_BLOCK;
+
+		case ETextureFormat::BC4_UNORM:
+			return VK_FORMAT_BC4_UNORM_BLOCK;
+
+		case ETextureFormat::BC5_UNORM:
+			return VK_FORMAT_BC5_UNORM_BLOCK;
+
+		case ETextureFormat::BC7_SRGB:
+			return VK_FORMAT_BC7_SRGB_BLOCK;
+
 		default:
 			return VK_FORMAT_UNDEFINED;
 		}
@@ -227,8 +263,13 @@ namespace Engine
 		case ETextureFormat::Depth:
 			return 4U;
 
+		case ETextureFormat::RGBA16F:
+			return 8U;
+
 		case ETextureFormat::RGBA8_SRGB:
 		case ETextureFormat::BGRA8_UNORM:
+		case ETextureFormat::R11G11B10F:
+		case ETextureFormat::RGBA8_UNORM:
 			return 4U;
 
 		default:
@@ -247,8 +288,13 @@ namespace Engine
 		case VK_FORMAT_D32_SFLOAT:
 			return 4U;
 
+		case VK_FORMAT_R16G16B16A16_SFLOAT:
+			return 8U;
+
 		case VK_FORMAT_R8G8B8A8_SRGB:
 		case VK_FORMAT_B8G8R8A8_UNORM:
+		case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
+		case VK_FORMAT_R8G8B8A8_UNORM:
 			return 4U;
 
 		default:
@@ -547,7 +593,7 @@ namespace Engine
 		{
 		case EDescriptorType::UniformBuffer:
 		case EDescriptorType::SubUniformBuffer:
-			return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+			return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC; // Offset is provided at bind time
 
 		case EDescriptorType::StorageBuffer:
 			return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
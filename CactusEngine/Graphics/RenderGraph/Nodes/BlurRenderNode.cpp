@@ -13,11 +13,15 @@ const char* BlurRenderNode::INPUT_COLOR_TEXTURE = "BlurInputTexture";
 BlurRenderNode::BlurRenderNode(std::shared_ptr<RenderGraphResource> pGraphResources, BaseRenderer* pRenderer)
 	: RenderNode(pGraphResources, pRenderer)
 {
+	m_outputResourceNames.emplace_back(OUTPUT_COLOR_TEXTURE);
+
 	m_inputResourceNames[INPUT_COLOR_TEXTURE] = nullptr;
 }
 
 void BlurRenderNode::SetupFunction(std::shared_ptr<RenderGraphResource> pGraphResources)
 {
+	m_colorInputHandle = pGraphResources->GetHandle(m_inputResourceNames.at(INPUT_COLOR_TEXTURE));
+
 	uint32_t screenWidth  = gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetWindowWidth();
 	uint32_t screenHeight = gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetWindowHeight();
 
@@ -29,25 +33,25 @@ void BlurRenderNode::SetupFunction(std::shared_ptr<RenderGraphResource> pGraphRe
 	texCreateInfo.textureWidth = screenWidth;
 	texCreateInfo.textureHeight = screenHeight;
 	texCreateInfo.dataType = EDataType::Float32;
-	texCreateInfo.format = ETextureFormat::RGBA32F;
+	texCreateInfo.format = GetRenderTargetFormat(ERenderTargetPrecision::HalfFloat);
 	texCreateInfo.textureType = ETextureType::ColorAttachment;
 	texCreateInfo.initialLayout = EImageLayout::ShaderReadOnly;
 
-	m_pDevice->CreateTexture2D(texCreateInfo, m_pHorizontalResult);
-	m_pDevice->CreateTexture2D(texCreateInfo, m_pColorOutput);
+	CreateTransientTexture2D(texCreateInfo, m_pHorizontalResult);
+	CreateTransientTexture2D(texCreateInfo, m_pColorOutput, OUTPUT_COLOR_TEXTURE);
 
 	pGraphResources->Add(OUTPUT_COLOR_TEXTURE, m_pColorOutput);
 
 	// Render pass object
 
 	RenderPassAttachmentDescription colorDesc = {};
-	colorDesc.format = ETextureFormat::RGBA32F;
+	colorDesc.format = texCreateInfo.format;
 	colorDesc.sampleCount = 1;
 	colorDesc.loadOp = EAttachmentOperation::None;
 	colorDesc.storeOp = EAttachmentOperation::Store;
 	colorDesc.stencilLoadOp = EAttachmentOperation::None;
 	colorDesc.stencilStoreOp = EAttachmentOperation::None;
-	colorDesc.initialLayout = EImageLayout::ShaderReadOnly;
+	colorDesc.initialLayout = EImageLayout::Undefined;
 	colorDesc.usageLayout = EImageLayout::ColorAttachment;
 	colorDesc.finalLayout = EImageLayout::ShaderReadOnly;
 	colorDesc.type = EAttachmentType::Color;
@@ -83,7 +87,8 @@ void BlurRenderNode::SetupFunction(std::shared_ptr<RenderGraphResource> pGraphRe
 	uint32_t perPassAllocation = m_eGraphicsDeviceType == EGraphicsDeviceType::Vulkan ? 8 : 1;
 
 	UniformBufferCreateInfo ubCreateInfo = {};
-	ubCreateInfo.sizeInBytes = sizeof(UBControlVariables) * perPassAllocation;
+	ubCreateInfo.sizeInBytes = sizeof(UBControlVariables);
+	ubCreateInfo.subBufferCount = perPassAllocation;
 	ubCreateInfo.appliedStages = (uint32_t)EShaderType::Fragment;
 	m_pDevice->CreateUniformBuffer(ubCreateInfo, m_pControlVariables_UB);
 
@@ -196,7 +201,7 @@ void BlurRenderNode::RenderPassFunction(std::shared_ptr<RenderGraphResource> pGr
 	auto pShaderParamTable = std::make_shared<ShaderParameterTable>();
 
 	pShaderParamTable->AddEntry(pShaderProgram->GetParamBinding(ShaderParamNames::COLOR_TEXTURE_1), EDescriptorType::CombinedImageSampler,
-		std::static_pointer_cast<Texture2D>(pGraphResources->Get(m_inputResourceNames.at(INPUT_COLOR_TEXTURE))));
+		pGraphResources->Get(m_colorInputHandle));
 
 	ubControlVariables.bool_1 = 1;
 	if (m_eGraphicsDeviceType == EGraphicsDeviceType::Vulkan)
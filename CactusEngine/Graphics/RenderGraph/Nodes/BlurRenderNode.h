@@ -25,5 +25,7 @@ namespace Engine
 
 		std::shared_ptr<Texture2D>			m_pHorizontalResult;
 		std::shared_ptr<Texture2D>			m_pColorOutput;
+
+		RenderResourceHandle				m_colorInputHandle;
 	};
 }
\ No newline at end of file
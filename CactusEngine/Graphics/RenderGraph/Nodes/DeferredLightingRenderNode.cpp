@@ -16,6 +16,8 @@ const char* DeferredLightingRenderNode::INPUT_DEPTH_TEXTURE = "DeferredInputDept
 DeferredLightingRenderNode::DeferredLightingRenderNode(std::shared_ptr<RenderGraphResource> pGraphResources, BaseRenderer* pRenderer)
 	: RenderNode(pGraphResources, pRenderer)
 {
+	m_outputResourceNames.emplace_back(OUTPUT_COLOR_TEXTURE);
+
 	m_inputResourceNames[INPUT_GBUFFER_COLOR] = nullptr;
 	m_inputResourceNames[INPUT_GBUFFER_NORMAL] = nullptr;
 	m_inputResourceNames[INPUT_GBUFFER_POSITION] = nullptr;
@@ -24,35 +26,42 @@ DeferredLightingRenderNode::DeferredLightingRenderNode(std::shared_ptr<RenderGra
 
 void DeferredLightingRenderNode::SetupFunction(std::shared_ptr<RenderGraphResource> pGraphResources)
 {
+	m_gBufferColorInputHandle = pGraphResources->GetHandle(m_inputResourceNames.at(INPUT_GBUFFER_COLOR));
+	m_gBufferNormalInputHandle = pGraphResources->GetHandle(m_inputResourceNames.at(INPUT_GBUFFER_NORMAL));
+	m_gBufferPositionInputHandle = pGraphResources->GetHandle(m_inputResourceNames.at(INPUT_GBUFFER_POSITION));
+	m_depthInputHandle = pGraphResources->GetHandle(m_inputResourceNames.at(INPUT_DEPTH_TEXTURE));
+
 	uint32_t screenWidth  = gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetWindowWidth();
 	uint32_t screenHeight = gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetWindowHeight();
 
 	// Color output
 
+	ETextureFormat colorFormat = GetRenderTargetFormat(ERenderTargetPrecision::HighDynamicRange);
+
 	Texture2DCreateInfo texCreateInfo = {};
 	texCreateInfo.generateMipmap = false;
 	texCreateInfo.pSampler = m_pDevice->GetDefaultTextureSampler();
 	texCreateInfo.textureWidth = screenWidth;
 	texCreateInfo.textureHeight = screenHeight;
 	texCreateInfo.dataType = EDataType::Float32;
-	texCreateInfo.format = ETextureFormat::RGBA32F;
+	texCreateInfo.format = colorFormat;
 	texCreateInfo.textureType = ETextureType::ColorAttachment;
 	texCreateInfo.initialLayout = EImageLayout::ShaderReadOnly;
 
-	m_pDevice->CreateTexture2D(texCreateInfo, m_pColorOutput);
+	CreateTransientTexture2D(texCreateInfo, m_pColorOutput, OUTPUT_COLOR_TEXTURE);
 
 	pGraphResources->Add(OUTPUT_COLOR_TEXTURE, m_pColorOutput);
 
 	// Render pass object
 
 	RenderPassAttachmentDescription colorDesc = {};
-	colorDesc.format = ETextureFormat::RGBA32F;
+	colorDesc.format = colorFormat;
 	colorDesc.sampleCount = 1;
 	colorDesc.loadOp = EAttachmentOperation::None;
 	colorDesc.storeOp = EAttachmentOperation::Store;
 	colorDesc.stencilLoadOp = EAttachmentOperation::None;
 	colorDesc.stencilStoreOp = EAttachmentOperation::None;
-	colorDesc.initialLayout = EImageLayout::ShaderReadOnly;
+	colorDesc.initialLayout = EImageLayout::Undefined;
 	colorDesc.usageLayout = EImageLayout::ColorAttachment;
 	colorDesc.finalLayout = EImageLayout::ShaderReadOnly;
 	colorDesc.type = EAttachmentType::Color;
@@ -81,14 +90,17 @@ void DeferredLightingRenderNode::SetupFunction(std::shared_ptr<RenderGraphResour
 	uint32_t perLightSourceAllocation = m_eGraphicsDeviceType == EGraphicsDeviceType::Vulkan ? 1024 : 1;
 
 	UniformBufferCreateInfo ubCreateInfo = {};
-	ubCreateInfo.sizeInBytes = sizeof(UBTransformMatrices) * perLightSourceAllocation;
+	ubCreateInfo.sizeInBytes = sizeof(UBTransformMatrices);
+	ubCreateInfo.subBufferCount = perLightSourceAllocation;
 	ubCreateInfo.appliedStages = (uint32_t)EShaderType::Vertex | (uint32_t)EShaderType::Fragment;
 	m_pDevice->CreateUniformBuffer(ubCreateInfo, m_pTransformMatrices_UB);
 
 	ubCreateInfo.sizeInBytes = sizeof(UBCameraProperties);
+	ubCreateInfo.subBufferCount = 0;
 	m_pDevice->CreateUniformBuffer(ubCreateInfo, m_pCameraProperties_UB);
 
-	ubCreateInfo.sizeInBytes = sizeof(UBLightSourceProperties) * perLightSourceAllocation;
+	ubCreateInfo.sizeInBytes = sizeof(UBLightSourceProperties);
+	ubCreateInfo.subBufferCount = perLightSourceAllocation;
 	ubCreateInfo.appliedStages = (uint32_t)EShaderType::Fragment;
 	m_pDevice->CreateUniformBuffer(ubCreateInfo, m_pLightSourceProperties_UB);
 
@@ -96,44 +108,7 @@ void DeferredLightingRenderNode::SetupFunction(std::shared_ptr<RenderGraphResour
 
 	// Vertex input states
 
-	VertexInputBindingDescription vertexInputBindingDesc = {};
-	vertexInputBindingDesc.binding = 0;
-	vertexInputBindingDesc.stride = VertexBufferCreateInfo::interleavedStride;
-	vertexInputBindingDesc.inputRate = EVertexInputRate::PerVertex;
-
-	VertexInputAttributeDescription positionAttributeDesc = {};
-	positionAttributeDesc.binding = vertexInputBindingDesc.binding;
-	positionAttributeDesc.location = DrawingDevice::ATTRIB_POSITION_LOCATION;
-	positionAttributeDesc.offset = VertexBufferCreateInfo::positionOffset;
-	positionAttributeDesc.format = ETextureFormat::RGB32F;
-
-	VertexInputAttributeDescription normalAttributeDesc = {};
-	normalAttributeDesc.binding = vertexInputBindingDesc.binding;
-	normalAttributeDesc.location = DrawingDevice::ATTRIB_NORMAL_LOCATION;
-	normalAttributeDesc.offset = VertexBufferCreateInfo::normalOffset;
-	normalAttributeDesc.format = ETextureFormat::RGB32F;
-
-	VertexInputAttributeDescription texcoordAttributeDesc = {};
-	texcoordAttributeDesc.binding = vertexInputBindingDesc.binding;
-	texcoordAttributeDesc.location = DrawingDevice::ATTRIB_TEXCOORD_LOCATION;
-	texcoordAttributeDesc.offset = VertexBufferCreateInfo::texcoordOffset;
-	texcoordAttributeDesc.format = ETextureFormat::RG32F;
-
-	VertexInputAttributeDescription tangentAttributeDesc = {};
-	tangentAttributeDesc.binding = vertexInputBindingDesc.binding;
-	tangentAttributeDesc.location = DrawingDevice::ATTRIB_TANGENT_LOCATION;
-	tangentAttributeDesc.offset = VertexBufferCreateInfo::tangentOffset;
-	tangentAttributeDesc.format = ETextureFormat::RGB32F;
-
-	VertexInputAttributeDescription bitangentAttributeDesc = {};
-	bitangentAttributeDesc.binding = vertexInputBindingDesc.binding;
-	bitangentAttributeDesc.location = DrawingDevice::ATTRIB_BITANGENT_LOCATION;
-	bitangentAttributeDesc.offset = VertexBufferCreateInfo::bitangentOffset;
-	bitangentAttributeDesc.format = ETextureFormat::RGB32F;
-
-	PipelineVertexInputStateCreateInfo vertexInputStateCreateInfo = {};
-	vertexInputStateCreateInfo.bindingDescs = { vertexInputBindingDesc };
-	vertexInputStateCreateInfo.attributeDescs = { positionAttributeDesc, normalAttributeDesc, texcoordAttributeDesc, tangentAttributeDesc, bitangentAttributeDesc };
+	PipelineVertexInputStateCreateInfo vertexInputStateCreateInfo = VertexBufferCreateInfo::GetVertexInputStateCreateInfo(gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetVertexFormat());
 
 	std::shared_ptr<PipelineVertexInputState> pVertexInputState = nullptr;
 	m_pDevice->CreatePipelineVertexInputState(vertexInputStateCreateInfo, pVertexInputState);
@@ -265,10 +240,10 @@ void DeferredLightingRenderNode::RenderPassFunction(std::shared_ptr<RenderGraphR
 	m_pTransformMatrices_UB->ResetSubBufferAllocation();
 	m_pLightSourceProperties_UB->ResetSubBufferAllocation();
 
-	auto pGBufferColorTexture = std::static_pointer_cast<Texture2D>(pGraphResources->Get(m_inputResourceNames.at(INPUT_GBUFFER_COLOR)));
-	auto pGBufferNormalTexture = std::static_pointer_cast<Texture2D>(pGraphResources->Get(m_inputResourceNames.at(INPUT_GBUFFER_NORMAL)));
-	auto pGBufferPositionTexture = std::static_pointer_cast<Texture2D>(pGraphResources->Get(m_inputResourceNames.at(INPUT_GBUFFER_POSITION)));
-	auto pSceneDepthTexture = std::static_pointer_cast<Texture2D>(pGraphResources->Get(m_inputResourceNames.at(INPUT_DEPTH_TEXTURE)));
+	const auto& pGBufferColorTexture = pGraphResources->Get(m_gBufferColorInputHandle);
+	const auto& pGBufferNormalTexture = pGraphResources->Get(m_gBufferNormalInputHandle);
+	const auto& pGBufferPositionTexture = pGraphResources->Get(m_gBufferPositionInputHandle);
+	const auto& pSceneDepthTexture = pGraphResources->Get(m_depthInputHandle);
 
 	std::shared_ptr<DrawingCommandBuffer> pCommandBuffer = m_pDevice->RequestCommandBuffer(pCmdContext->pCommandPool);
 
@@ -337,6 +312,8 @@ void DeferredLightingRenderNode::RenderPassFunction(std::shared_ptr<RenderGraphR
 		}
 
 		ubTransformMatrices.modelMatrix = pTransformComp->GetModelMatrix();
+		ubTransformMatrices.positionScale = Vector4(lightProfile.pVolumeMesh->GetVertexBuffer()->GetPositionScale(), 0.0f);
+		ubTransformMatrices.positionOffset = Vector4(lightProfile.pVolumeMesh->GetVertexBuffer()->GetPositionOffset(), 0.0f);
 
 		std::shared_ptr<SubUniformBuffer> pSubTransformMatricesUB = nullptr;
 		if (m_eGraphicsDeviceType == EGraphicsDeviceType::Vulkan)
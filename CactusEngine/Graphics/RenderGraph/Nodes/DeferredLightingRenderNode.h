@@ -28,5 +28,10 @@ namespace Engine
 		std::shared_ptr<UniformBuffer>		m_pLightSourceProperties_UB;
 
 		std::shared_ptr<Texture2D>			m_pColorOutput;
+
+		RenderResourceHandle				m_gBufferColorInputHandle;
+		RenderResourceHandle				m_gBufferNormalInputHandle;
+		RenderResourceHandle				m_gBufferPositionInputHandle;
+		RenderResourceHandle				m_depthInputHandle;
 	};
 }
\ No newline at end of file
@@ -23,22 +23,29 @@ DepthOfFieldRenderNode::DepthOfFieldRenderNode(std::shared_ptr<RenderGraphResour
 
 void DepthOfFieldRenderNode::SetupFunction(std::shared_ptr<RenderGraphResource> pGraphResources)
 {
+	m_colorInputHandle = pGraphResources->GetHandle(m_inputResourceNames.at(INPUT_COLOR_TEXTURE));
+	m_gBufferPositionInputHandle = pGraphResources->GetHandle(m_inputResourceNames.at(INPUT_GBUFFER_POSITION));
+	m_shadowMarkInputHandle = pGraphResources->GetHandle(m_inputResourceNames.at(INPUT_SHADOW_MARK_TEXTURE));
+
 	uint32_t screenWidth  = gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetWindowWidth();
 	uint32_t screenHeight = gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetWindowHeight();
 
-	// Horizontal result
+	// Horizontal result, vertical pass upsamples it with bilinear filtering if downscaled
+
+	uint32_t horizontalWidth = GetScaledExtent(screenWidth);
+	uint32_t horizontalHeight = GetScaledExtent(screenHeight);
 
 	Texture2DCreateInfo texCreateInfo = {};
 	texCreateInfo.generateMipmap = false;
 	texCreateInfo.pSampler = m_pDevice->GetDefaultTextureSampler();
-	texCreateInfo.textureWidth = screenWidth;
-	texCreateInfo.textureHeight = screenHeight;
+	texCreateInfo.textureWidth = horizontalWidth;
+	texCreateInfo.textureHeight = horizontalHeight;
 	texCreateInfo.dataType = EDataType::Float32;
-	texCreateInfo.format = ETextureFormat::RGBA32F;
+	texCreateInfo.format = GetRenderTargetFormat(ERenderTargetPrecision::LowDynamicRange);
 	texCreateInfo.textureType = ETextureType::ColorAttachment;
 	texCreateInfo.initialLayout = EImageLayout::ShaderReadOnly;
 
-	m_pDevice->CreateTexture2D(texCreateInfo, m_pHorizontalResult);
+	CreateTransientTexture2D(texCreateInfo, m_pHorizontalResult);
 
 	// Post effects images
 
@@ -57,13 +64,13 @@ void DepthOfFieldRenderNode::SetupFunction(std::shared_ptr<RenderGraphResource>
 	// Horizontal pass
 
 	RenderPassAttachmentDescription colorDesc = {};
-	colorDesc.format = ETextureFormat::RGBA32F;
+	colorDesc.format = texCreateInfo.format;
 	colorDesc.sampleCount = 1;
 	colorDesc.loadOp = EAttachmentOperation::None;
 	colorDesc.storeOp = EAttachmentOperation::Store;
 	colorDesc.stencilLoadOp = EAttachmentOperation::None;
 	colorDesc.stencilStoreOp = EAttachmentOperation::None;
-	colorDesc.initialLayout = EImageLayout::ShaderReadOnly;
+	colorDesc.initialLayout = EImageLayout::Undefined;
 	colorDesc.usageLayout = EImageLayout::ColorAttachment;
 	colorDesc.finalLayout = EImageLayout::ShaderReadOnly;
 	colorDesc.type = EAttachmentType::Color;
@@ -100,8 +107,8 @@ void DepthOfFieldRenderNode::SetupFunction(std::shared_ptr<RenderGraphResource>
 
 	FrameBufferCreateInfo fbCreateInfo_Horizontal = {};
 	fbCreateInfo_Horizontal.attachments.emplace_back(m_pHorizontalResult);
-	fbCreateInfo_Horizontal.framebufferWidth = screenWidth;
-	fbCreateInfo_Horizontal.framebufferHeight = screenHeight;
+	fbCreateInfo_Horizontal.framebufferWidth = horizontalWidth;
+	fbCreateInfo_Horizontal.framebufferHeight = horizontalHeight;
 	fbCreateInfo_Horizontal.pRenderPass = m_pRenderPassObject_Horizontal;
 
 	m_pDevice->CreateFrameBuffer(fbCreateInfo_Horizontal, m_pFrameBuffer_Horizontal);
@@ -144,7 +151,8 @@ void DepthOfFieldRenderNode::SetupFunction(std::shared_ptr<RenderGraphResource>
 	ubCreateInfo.sizeInBytes = sizeof(UBSystemVariables);
 	m_pDevice->CreateUniformBuffer(ubCreateInfo, m_pSystemVariables_UB);
 
-	ubCreateInfo.sizeInBytes = sizeof(UBControlVariables) * perPassAllocation;
+	ubCreateInfo.sizeInBytes = sizeof(UBControlVariables);
+	ubCreateInfo.subBufferCount = perPassAllocation;
 	m_pDevice->CreateUniformBuffer(ubCreateInfo, m_pControlVariables_UB);
 
 	// Pipeline objects
@@ -213,11 +221,17 @@ void DepthOfFieldRenderNode::SetupFunction(std::shared_ptr<RenderGraphResource>
 	// Viewport state
 
 	PipelineViewportStateCreateInfo viewportStateCreateInfo = {};
+	viewportStateCreateInfo.width = horizontalWidth;
+	viewportStateCreateInfo.height = horizontalHeight;
+
+	std::shared_ptr<PipelineViewportState> pViewportState_Horizontal;
+	m_pDevice->CreatePipelineViewportState(viewportStateCreateInfo, pViewportState_Horizontal);
+
 	viewportStateCreateInfo.width = screenWidth;
 	viewportStateCreateInfo.height = screenHeight;
 
-	std::shared_ptr<PipelineViewportState> pViewportState;
-	m_pDevice->CreatePipelineViewportState(viewportStateCreateInfo, pViewportState);
+	std::shared_ptr<PipelineViewportState> pViewportState_Present;
+	m_pDevice->CreatePipelineViewportState(viewportStateCreateInfo, pViewportState_Present);
 
 	// Pipeline creation
 
@@ -229,12 +243,13 @@ void DepthOfFieldRenderNode::SetupFunction(std::shared_ptr<RenderGraphResource>
 	pipelineCreateInfo.pRasterizationState = pRasterizationState;
 	pipelineCreateInfo.pDepthStencilState = pDepthStencilState;
 	pipelineCreateInfo.pMultisampleState = pMultisampleState;
-	pipelineCreateInfo.pViewportState = pViewportState;
+	pipelineCreateInfo.pViewportState = pViewportState_Horizontal;
 	pipelineCreateInfo.pRenderPass = m_pRenderPassObject_Horizontal;
 
 	std::shared_ptr<GraphicsPipelineObject> pPipeline_0 = nullptr;
 	m_pDevice->CreateGraphicsPipelineObject(pipelineCreateInfo, pPipeline_0);
 
+	pipelineCreateInfo.pViewportState = pViewportState_Present;
 	pipelineCreateInfo.pRenderPass = m_pRenderPassObject_Present;
 
 	std::shared_ptr<GraphicsPipelineObject> pPipeline_1 = nullptr;
@@ -267,6 +282,11 @@ void DepthOfFieldRenderNode::RenderPassFunction(std::shared_ptr<RenderGraphResou
 	UBCameraProperties ubCameraProperties = {};
 	UBControlVariables ubControlVariables = {};
 
+	// Blur offsets are given in full resolution texels for both passes, so blur radius does not depend on resolution scale
+	uint32_t screenWidth  = gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetWindowWidth();
+	uint32_t screenHeight = gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetWindowHeight();
+	ubControlVariables.texelSize = Vector2(1.0f / screenWidth, 1.0f / screenHeight);
+
 	ubTransformMatrices.viewMatrix = viewMat;
 	m_pTransformMatrices_UB->UpdateBufferData(&ubTransformMatrices);
 
@@ -288,10 +308,10 @@ void DepthOfFieldRenderNode::RenderPassFunction(std::shared_ptr<RenderGraphResou
 	pShaderParamTable->AddEntry(pShaderProgram->GetParamBinding(ShaderParamNames::CAMERA_PROPERTIES), EDescriptorType::UniformBuffer, m_pCameraProperties_UB);
 
 	pShaderParamTable->AddEntry(pShaderProgram->GetParamBinding(ShaderParamNames::COLOR_TEXTURE_1), EDescriptorType::CombinedImageSampler,
-		pGraphResources->Get(m_inputResourceNames.at(INPUT_COLOR_TEXTURE)));
+		pGraphResources->Get(m_colorInputHandle));
 
 	pShaderParamTable->AddEntry(pShaderProgram->GetParamBinding(ShaderParamNames::GPOSITION_TEXTURE), EDescriptorType::CombinedImageSampler,
-		pGraphResources->Get(m_inputResourceNames.at(INPUT_GBUFFER_POSITION)));
+		pGraphResources->Get(m_gBufferPositionInputHandle));
 
 	pShaderParamTable->AddEntry(pShaderProgram->GetParamBinding(ShaderParamNames::SYSTEM_VARIABLES), EDescriptorType::UniformBuffer, m_pSystemVariables_UB);
 
@@ -308,7 +328,7 @@ void DepthOfFieldRenderNode::RenderPassFunction(std::shared_ptr<RenderGraphResou
 		m_pPencilMaskTexture_2);
 
 	pShaderParamTable->AddEntry(pShaderProgram->GetParamBinding(ShaderParamNames::COLOR_TEXTURE_2), EDescriptorType::CombinedImageSampler,
-		pGraphResources->Get(m_inputResourceNames.at(INPUT_SHADOW_MARK_TEXTURE)));
+		pGraphResources->Get(m_shadowMarkInputHandle));
 
 	ubControlVariables.bool_1 = 1;
 	if (m_eGraphicsDeviceType == EGraphicsDeviceType::Vulkan)
@@ -359,7 +379,7 @@ void DepthOfFieldRenderNode::RenderPassFunction(std::shared_ptr<RenderGraphResou
 		m_pHorizontalResult);
 
 	pShaderParamTable->AddEntry(pShaderProgram->GetParamBinding(ShaderParamNames::GPOSITION_TEXTURE), EDescriptorType::CombinedImageSampler,
-		pGraphResources->Get(m_inputResourceNames.at(INPUT_GBUFFER_POSITION)));
+		pGraphResources->Get(m_gBufferPositionInputHandle));
 
 	pShaderParamTable->AddEntry(pShaderProgram->GetParamBinding(ShaderParamNames::SYSTEM_VARIABLES), EDescriptorType::UniformBuffer, m_pSystemVariables_UB);
 
@@ -376,7 +396,7 @@ void DepthOfFieldRenderNode::RenderPassFunction(std::shared_ptr<RenderGraphResou
 		m_pPencilMaskTexture_2);
 
 	pShaderParamTable->AddEntry(pShaderProgram->GetParamBinding(ShaderParamNames::COLOR_TEXTURE_2), EDescriptorType::CombinedImageSampler,
-		pGraphResources->Get(m_inputResourceNames.at(INPUT_SHADOW_MARK_TEXTURE)));
+		pGraphResources->Get(m_shadowMarkInputHandle));
 
 	ubControlVariables.bool_1 = 0;
 	if (m_eGraphicsDeviceType == EGraphicsDeviceType::Vulkan)
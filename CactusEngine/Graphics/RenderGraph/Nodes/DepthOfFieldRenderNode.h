@@ -32,5 +32,9 @@ namespace Engine
 		std::shared_ptr<Texture2D>			m_pBrushMaskTexture_2;
 		std::shared_ptr<Texture2D>			m_pPencilMaskTexture_1;
 		std::shared_ptr<Texture2D>			m_pPencilMaskTexture_2;
+
+		RenderResourceHandle				m_colorInputHandle;
+		RenderResourceHandle				m_gBufferPositionInputHandle;
+		RenderResourceHandle				m_shadowMarkInputHandle;
 	};
 }
\ No newline at end of file
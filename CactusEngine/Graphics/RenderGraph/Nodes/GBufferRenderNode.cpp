@@ -12,7 +12,8 @@ const char* GBufferRenderNode::OUTPUT_POSITION_GBUFFER = "PositionGBufferTexture
 GBufferRenderNode::GBufferRenderNode(std::shared_ptr<RenderGraphResource> pGraphResources, BaseRenderer* pRenderer)
 	: RenderNode(pGraphResources, pRenderer)
 {
-
+	m_outputResourceNames.emplace_back(OUTPUT_NORMAL_GBUFFER);
+	m_outputResourceNames.emplace_back(OUTPUT_POSITION_GBUFFER);
 }
 
 void GBufferRenderNode::SetupFunction(std::shared_ptr<RenderGraphResource> pGraphResources)
@@ -20,7 +21,10 @@ void GBufferRenderNode::SetupFunction(std::shared_ptr<RenderGraphResource> pGrap
 	uint32_t screenWidth  = gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetWindowWidth();
 	uint32_t screenHeight = gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetWindowHeight();
 
-	// GBuffer color textures
+	// GBuffer color textures, world space positions would lose too much precision in half float
+
+	ETextureFormat normalFormat = GetRenderTargetFormat(ERenderTargetPrecision::HalfFloat);
+	ETextureFormat positionFormat = GetRenderTargetFormat(ERenderTargetPrecision::FullFloat);
 
 	Texture2DCreateInfo texCreateInfo = {};
 	texCreateInfo.generateMipmap = false;
@@ -28,47 +32,51 @@ void GBufferRenderNode::SetupFunction(std::shared_ptr<RenderGraphResource> pGrap
 	texCreateInfo.textureWidth = screenWidth;
 	texCreateInfo.textureHeight = screenHeight;
 	texCreateInfo.dataType = EDataType::Float32;
-	texCreateInfo.format = ETextureFormat::RGBA32F;
+	texCreateInfo.format = normalFormat;
 	texCreateInfo.textureType = ETextureType::ColorAttachment;
 	texCreateInfo.initialLayout = EImageLayout::ShaderReadOnly;
 
-	m_pDevice->CreateTexture2D(texCreateInfo, m_pNormalOutput);
-	m_pDevice->CreateTexture2D(texCreateInfo, m_pPositionOutput);
+	CreateTransientTexture2D(texCreateInfo, m_pNormalOutput, OUTPUT_NORMAL_GBUFFER);
+
+	texCreateInfo.format = positionFormat;
+
+	CreateTransientTexture2D(texCreateInfo, m_pPositionOutput, OUTPUT_POSITION_GBUFFER);
 
 	pGraphResources->Add(OUTPUT_NORMAL_GBUFFER, m_pNormalOutput);
 	pGraphResources->Add(OUTPUT_POSITION_GBUFFER, m_pPositionOutput);
 
-	// Depth attachment
+	// Depth attachment, only used for depth test within this pass
 
 	texCreateInfo.format = ETextureFormat::Depth;
 	texCreateInfo.textureType = ETextureType::DepthAttachment;
 	texCreateInfo.initialLayout = EImageLayout::DepthStencilAttachment;
+	texCreateInfo.isTransientAttachment = true;
 
-	m_pDevice->CreateTexture2D(texCreateInfo, m_pDepthBuffer);
+	CreateTransientTexture2D(texCreateInfo, m_pDepthBuffer);
 
 	// Render pass object
 
 	RenderPassAttachmentDescription normalDesc = {};
-	normalDesc.format = ETextureFormat::RGBA32F;
+	normalDesc.format = normalFormat;
 	normalDesc.sampleCount = 1;
 	normalDesc.loadOp = EAttachmentOperation::Clear;
 	normalDesc.storeOp = EAttachmentOperation::Store;
 	normalDesc.stencilLoadOp = EAttachmentOperation::None;
 	normalDesc.stencilStoreOp = EAttachmentOperation::None;
-	normalDesc.initialLayout = EImageLayout::ShaderReadOnly;
+	normalDesc.initialLayout = EImageLayout::Undefined;
 	normalDesc.usageLayout = EImageLayout::ColorAttachment;
 	normalDesc.finalLayout = EImageLayout::ShaderReadOnly;
 	normalDesc.type = EAttachmentType::Color;
 	normalDesc.index = 0;	
 
 	RenderPassAttachmentDescription positionDesc = {};
-	positionDesc.format = ETextureFormat::RGBA32F;
+	positionDesc.format = positionFormat;
 	positionDesc.sampleCount = 1;
 	positionDesc.loadOp = EAttachmentOperation::Clear;
 	positionDesc.storeOp = EAttachmentOperation::Store;
 	positionDesc.stencilLoadOp = EAttachmentOperation::None;
 	positionDesc.stencilStoreOp = EAttachmentOperation::None;
-	positionDesc.initialLayout = EImageLayout::ShaderReadOnly;
+	positionDesc.initialLayout = EImageLayout::Undefined;
 	positionDesc.usageLayout = EImageLayout::ColorAttachment;
 	positionDesc.finalLayout = EImageLayout::ShaderReadOnly;
 	positionDesc.type = EAttachmentType::Color;
@@ -78,10 +86,10 @@ void GBufferRenderNode::SetupFunction(std::shared_ptr<RenderGraphResource> pGrap
 	depthDesc.format = ETextureFormat::Depth;
 	depthDesc.sampleCount = 1;
 	depthDesc.loadOp = EAttachmentOperation::Clear;
-	depthDesc.storeOp = EAttachmentOperation::Store;
+	depthDesc.storeOp = EAttachmentOperation::None;
 	depthDesc.stencilLoadOp = EAttachmentOperation::None;
 	depthDesc.stencilStoreOp = EAttachmentOperation::None;
-	depthDesc.initialLayout = EImageLayout::DepthStencilAttachment;
+	depthDesc.initialLayout = EImageLayout::Undefined;
 	depthDesc.usageLayout = EImageLayout::DepthStencilAttachment;
 	depthDesc.finalLayout = EImageLayout::DepthStencilAttachment;
 	depthDesc.type = EAttachmentType::Depth;
@@ -114,7 +122,8 @@ void GBufferRenderNode::SetupFunction(std::shared_ptr<RenderGraphResource> pGrap
 	uint32_t perSubmeshAllocation = m_eGraphicsDeviceType == EGraphicsDeviceType::Vulkan ? 4096 : 1;
 
 	UniformBufferCreateInfo ubCreateInfo = {};
-	ubCreateInfo.sizeInBytes = sizeof(UBTransformMatrices) * perSubmeshAllocation;
+	ubCreateInfo.sizeInBytes = sizeof(UBTransformMatrices);
+	ubCreateInfo.subBufferCount = perSubmeshAllocation;
 	ubCreateInfo.appliedStages = (uint32_t)EShaderType::Vertex | (uint32_t)EShaderType::Fragment;
 	m_pDevice->CreateUniformBuffer(ubCreateInfo, m_pTransformMatrices_UB);
 
@@ -122,44 +131,7 @@ void GBufferRenderNode::SetupFunction(std::shared_ptr<RenderGraphResource> pGrap
 
 	// Vertex input state
 
-	VertexInputBindingDescription vertexInputBindingDesc = {};
-	vertexInputBindingDesc.binding = 0;
-	vertexInputBindingDesc.stride = VertexBufferCreateInfo::interleavedStride;
-	vertexInputBindingDesc.inputRate = EVertexInputRate::PerVertex;
-
-	VertexInputAttributeDescription positionAttributeDesc = {};
-	positionAttributeDesc.binding = vertexInputBindingDesc.binding;
-	positionAttributeDesc.location = DrawingDevice::ATTRIB_POSITION_LOCATION;
-	positionAttributeDesc.offset = VertexBufferCreateInfo::positionOffset;
-	positionAttributeDesc.format = ETextureFormat::RGB32F;
-
-	VertexInputAttributeDescription normalAttributeDesc = {};
-	normalAttributeDesc.binding = vertexInputBindingDesc.binding;
-	normalAttributeDesc.location = DrawingDevice::ATTRIB_NORMAL_LOCATION;
-	normalAttributeDesc.offset = VertexBufferCreateInfo::normalOffset;
-	normalAttributeDesc.format = ETextureFormat::RGB32F;
-
-	VertexInputAttributeDescription texcoordAttributeDesc = {};
-	texcoordAttributeDesc.binding = vertexInputBindingDesc.binding;
-	texcoordAttributeDesc.location = DrawingDevice::ATTRIB_TEXCOORD_LOCATION;
-	texcoordAttributeDesc.offset = VertexBufferCreateInfo::texcoordOffset;
-	texcoordAttributeDesc.format = ETextureFormat::RG32F;
-
-	VertexInputAttributeDescription tangentAttributeDesc = {};
-	tangentAttributeDesc.binding = vertexInputBindingDesc.binding;
-	tangentAttributeDesc.location = DrawingDevice::ATTRIB_TANGENT_LOCATION;
-	tangentAttributeDesc.offset = VertexBufferCreateInfo::tangentOffset;
-	tangentAttributeDesc.format = ETextureFormat::RGB32F;
-
-	VertexInputAttributeDescription bitangentAttributeDesc = {};
-	bitangentAttributeDesc.binding = vertexInputBindingDesc.binding;
-	bitangentAttributeDesc.location = DrawingDevice::ATTRIB_BITANGENT_LOCATION;
-	bitangentAttributeDesc.offset = VertexBufferCreateInfo::bitangentOffset;
-	bitangentAttributeDesc.format = ETextureFormat::RGB32F;
-
-	PipelineVertexInputStateCreateInfo vertexInputStateCreateInfo = {};
-	vertexInputStateCreateInfo.bindingDescs = { vertexInputBindingDesc };
-	vertexInputStateCreateInfo.attributeDescs = { positionAttributeDesc, normalAttributeDesc, texcoordAttributeDesc, tangentAttributeDesc, bitangentAttributeDesc };
+	PipelineVertexInputStateCreateInfo vertexInputStateCreateInfo = VertexBufferCreateInfo::GetVertexInputStateCreateInfo(gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetVertexFormat());
 
 	std::shared_ptr<PipelineVertexInputState> pVertexInputState = nullptr;
 	m_pDevice->CreatePipelineVertexInputState(vertexInputStateCreateInfo, pVertexInputState);
@@ -287,7 +259,8 @@ void GBufferRenderNode::RenderPassFunction(std::shared_ptr<RenderGraphResource>
 
 		auto pMesh = pMeshFilterComp->GetMesh();
 
-		if (!pMesh)
+		// Occluded entities are still drawn into shadow maps, their shadows may fall on visible surfaces
+		if (!pMesh || pMeshFilterComp->IsOccluded())
 		{
 			continue;
 		}
@@ -296,6 +269,8 @@ void GBufferRenderNode::RenderPassFunction(std::shared_ptr<RenderGraphResource>
 
 		ubTransformMatrices.modelMatrix = pTransformComp->GetModelMatrix();
 		ubTransformMatrices.normalMatrix = pTransformComp->GetNormalMatrix();
+		ubTransformMatrices.positionScale = Vector4(pMesh->GetVertexBuffer()->GetPositionScale(), 0.0f);
+		ubTransformMatrices.positionOffset = Vector4(pMesh->GetVertexBuffer()->GetPositionOffset(), 0.0f);
 
 		if (m_eGraphicsDeviceType == EGraphicsDeviceType::Vulkan)
 		{
@@ -312,7 +287,7 @@ void GBufferRenderNode::RenderPassFunction(std::shared_ptr<RenderGraphResource>
 		m_pDevice->UpdateShaderParameter(pShaderProgram, pShaderParamTable, pCommandBuffer);
 		m_pDevice->SetVertexBuffer(pMesh->GetVertexBuffer(), pCommandBuffer);
 
-		auto subMeshes = pMesh->GetSubMeshes();
+		auto subMeshes = pMesh->GetSubMeshes(pMeshFilterComp->GetLODIndex());
 		for (size_t i = 0; i < subMeshes->size(); ++i)
 		{
 			auto pMaterial = pMaterialComp->GetMaterialBySubmeshIndex(i);
@@ -322,7 +297,7 @@ void GBufferRenderNode::RenderPassFunction(std::shared_ptr<RenderGraphResource>
 				continue;
 			}
 
-			m_pDevice->DrawPrimitive(subMeshes->at(i).m_numIndices, subMeshes->at(i).m_baseIndex, subMeshes->at(i).m_baseVertex, pCommandBuffer);
+			DrawSubMesh(pMeshFilterComp, (uint32_t)i, pCommandBuffer);
 		}
 
 		if (m_eGraphicsDeviceType != EGraphicsDeviceType::Vulkan)
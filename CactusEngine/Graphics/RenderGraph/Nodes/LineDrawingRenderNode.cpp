@@ -17,16 +17,23 @@ const char* LineDrawingRenderNode::INPUT_LINE_SPACE_TEXTURE = "LineDrawingSpaceC
 LineDrawingRenderNode::LineDrawingRenderNode(std::shared_ptr<RenderGraphResource> pGraphResources, BaseRenderer* pRenderer)
 	: RenderNode(pGraphResources, pRenderer), m_enableLineSmooth(false)
 {
+	m_outputResourceNames.emplace_back(OUTPUT_COLOR_TEXTURE);
+
 	m_inputResourceNames[INPUT_COLOR_TEXTURE] = nullptr;
 	m_inputResourceNames[INPUT_LINE_SPACE_TEXTURE] = nullptr;
 }
 
 void LineDrawingRenderNode::SetupFunction(std::shared_ptr<RenderGraphResource> pGraphResources)
 {
+	m_lineSpaceInputHandle = pGraphResources->GetHandle(m_inputResourceNames.at(INPUT_LINE_SPACE_TEXTURE));
+	m_colorInputHandle = pGraphResources->GetHandle(m_inputResourceNames.at(INPUT_COLOR_TEXTURE));
+
 	uint32_t screenWidth  = gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetWindowWidth();
 	uint32_t screenHeight = gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetWindowHeight();
 
-	// Textures
+	// Textures, line result stores opacity in alpha
+
+	ETextureFormat colorFormat = GetRenderTargetFormat(ERenderTargetPrecision::HalfFloat);
 
 	Texture2DCreateInfo texCreateInfo = {};
 	texCreateInfo.generateMipmap = false;
@@ -34,25 +41,25 @@ void LineDrawingRenderNode::SetupFunction(std::shared_ptr<RenderGraphResource> p
 	texCreateInfo.textureWidth = screenWidth;
 	texCreateInfo.textureHeight = screenHeight;
 	texCreateInfo.dataType = EDataType::Float32;
-	texCreateInfo.format = ETextureFormat::RGBA32F;
+	texCreateInfo.format = colorFormat;
 	texCreateInfo.textureType = ETextureType::ColorAttachment;
 	texCreateInfo.initialLayout = EImageLayout::ShaderReadOnly;
 
-	m_pDevice->CreateTexture2D(texCreateInfo, m_pColorOutput);
-	m_pDevice->CreateTexture2D(texCreateInfo, m_pLineResult);
+	CreateTransientTexture2D(texCreateInfo, m_pColorOutput, OUTPUT_COLOR_TEXTURE);
+	CreateTransientTexture2D(texCreateInfo, m_pLineResult);
 
 	pGraphResources->Add(OUTPUT_COLOR_TEXTURE, m_pColorOutput);
 
 	// Render pass object
 
 	RenderPassAttachmentDescription colorDesc = {};
-	colorDesc.format = ETextureFormat::RGBA32F;
+	colorDesc.format = colorFormat;
 	colorDesc.sampleCount = 1;
 	colorDesc.loadOp = EAttachmentOperation::None;
 	colorDesc.storeOp = EAttachmentOperation::Store;
 	colorDesc.stencilLoadOp = EAttachmentOperation::None;
 	colorDesc.stencilStoreOp = EAttachmentOperation::None;
-	colorDesc.initialLayout = EImageLayout::ShaderReadOnly;
+	colorDesc.initialLayout = EImageLayout::Undefined;
 	colorDesc.usageLayout = EImageLayout::ColorAttachment;
 	colorDesc.finalLayout = EImageLayout::ShaderReadOnly;
 	colorDesc.type = EAttachmentType::Color;
@@ -105,7 +112,8 @@ void LineDrawingRenderNode::SetupFunction(std::shared_ptr<RenderGraphResource> p
 	uint32_t perPassAllocation = m_eGraphicsDeviceType == EGraphicsDeviceType::Vulkan ? 8 : 1;
 
 	UniformBufferCreateInfo ubCreateInfo = {};
-	ubCreateInfo.sizeInBytes = sizeof(UBControlVariables) * perPassAllocation;
+	ubCreateInfo.sizeInBytes = sizeof(UBControlVariables);
+	ubCreateInfo.subBufferCount = perPassAllocation;
 	ubCreateInfo.appliedStages = (uint32_t)EShaderType::Fragment;
 	m_pDevice->CreateUniformBuffer(ubCreateInfo, m_pControlVariables_UB);
 
@@ -234,7 +242,7 @@ void LineDrawingRenderNode::RenderPassFunction(std::shared_ptr<RenderGraphResour
 	auto pShaderParamTable = std::make_shared<ShaderParameterTable>();
 
 	pShaderParamTable->AddEntry(pShaderProgram->GetParamBinding(ShaderParamNames::COLOR_TEXTURE_1), EDescriptorType::CombinedImageSampler,
-		pGraphResources->Get(m_inputResourceNames.at(INPUT_LINE_SPACE_TEXTURE)));
+		pGraphResources->Get(m_lineSpaceInputHandle));
 
 	m_pDevice->UpdateShaderParameter(pShaderProgram, pShaderParamTable, pCommandBuffer);
 	m_pDevice->DrawFullScreenQuad(pCommandBuffer);
@@ -338,7 +346,7 @@ void LineDrawingRenderNode::RenderPassFunction(std::shared_ptr<RenderGraphResour
 		m_pLineResult);
 
 	pShaderParamTable->AddEntry(pShaderProgram->GetParamBinding(ShaderParamNames::COLOR_TEXTURE_2), EDescriptorType::CombinedImageSampler,
-		pGraphResources->Get(m_inputResourceNames.at(INPUT_COLOR_TEXTURE)));
+		pGraphResources->Get(m_colorInputHandle));
 
 	m_pDevice->UpdateShaderParameter(pShaderProgram, pShaderParamTable, pCommandBuffer);
 	m_pDevice->DrawFullScreenQuad(pCommandBuffer);
@@ -31,5 +31,8 @@ namespace Engine
 
 		std::shared_ptr<Texture2D>			m_pColorOutput;
 		std::shared_ptr<Texture2D>			m_pLineResult;
+
+		RenderResourceHandle				m_lineSpaceInputHandle;
+		RenderResourceHandle				m_colorInputHandle;
 	};
 }
\ No newline at end of file
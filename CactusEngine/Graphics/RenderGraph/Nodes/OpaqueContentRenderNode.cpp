@@ -16,16 +16,25 @@ const char* OpaqueContentRenderNode::INPUT_SHADOW_MAP = "OpaqueInputShadowMap";
 OpaqueContentRenderNode::OpaqueContentRenderNode(std::shared_ptr<RenderGraphResource> pGraphResources, BaseRenderer* pRenderer)
 	: RenderNode(pGraphResources, pRenderer)
 {
+	m_outputResourceNames.emplace_back(OUTPUT_COLOR_TEXTURE);
+	m_outputResourceNames.emplace_back(OUTPUT_DEPTH_TEXTURE);
+	m_outputResourceNames.emplace_back(OUTPUT_LINE_SPACE_TEXTURE);
+
 	m_inputResourceNames[INPUT_GBUFFER_NORMAL] = nullptr;
 	m_inputResourceNames[INPUT_SHADOW_MAP] = nullptr;
 }
 
 void OpaqueContentRenderNode::SetupFunction(std::shared_ptr<RenderGraphResource> pGraphResources)
 {
+	m_gBufferNormalInputHandle = pGraphResources->GetHandle(m_inputResourceNames.at(INPUT_GBUFFER_NORMAL));
+	m_shadowMapInputHandle = pGraphResources->GetHandle(m_inputResourceNames.at(INPUT_SHADOW_MAP));
+
 	uint32_t screenWidth  = gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetWindowWidth();
 	uint32_t screenHeight = gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetWindowHeight();
 
-	// Color output and shadow mark output
+	// Color output and shadow mark output, both need signed values or alpha
+
+	ETextureFormat colorFormat = GetRenderTargetFormat(ERenderTargetPrecision::HalfFloat);
 
 	Texture2DCreateInfo texCreateInfo = {};
 	texCreateInfo.generateMipmap = false;
@@ -33,19 +42,19 @@ void OpaqueContentRenderNode::SetupFunction(std::shared_ptr<RenderGraphResource>
 	texCreateInfo.textureWidth = screenWidth;
 	texCreateInfo.textureHeight = screenHeight;
 	texCreateInfo.dataType = EDataType::Float32;
-	texCreateInfo.format = ETextureFormat::RGBA32F;
+	texCreateInfo.format = colorFormat;
 	texCreateInfo.textureType = ETextureType::ColorAttachment;
 	texCreateInfo.initialLayout = EImageLayout::ShaderReadOnly;
 
-	m_pDevice->CreateTexture2D(texCreateInfo, m_pColorOutput);
-	m_pDevice->CreateTexture2D(texCreateInfo, m_pLineSpaceOutput);
+	CreateTransientTexture2D(texCreateInfo, m_pColorOutput, OUTPUT_COLOR_TEXTURE);
+	CreateTransientTexture2D(texCreateInfo, m_pLineSpaceOutput, OUTPUT_LINE_SPACE_TEXTURE);
 
 	// Depth output
 
 	texCreateInfo.format = ETextureFormat::Depth;
 	texCreateInfo.textureType = ETextureType::DepthAttachment;
 
-	m_pDevice->CreateTexture2D(texCreateInfo, m_pDepthOutput);
+	CreateTransientTexture2D(texCreateInfo, m_pDepthOutput, OUTPUT_DEPTH_TEXTURE);
 
 	pGraphResources->Add(OUTPUT_COLOR_TEXTURE, m_pColorOutput);
 	pGraphResources->Add(OUTPUT_DEPTH_TEXTURE, m_pDepthOutput);
@@ -54,26 +63,26 @@ void OpaqueContentRenderNode::SetupFunction(std::shared_ptr<RenderGraphResource>
 	// Render pass object
 
 	RenderPassAttachmentDescription colorDesc = {};
-	colorDesc.format = ETextureFormat::RGBA32F;
+	colorDesc.format = colorFormat;
 	colorDesc.sampleCount = 1;
 	colorDesc.loadOp = EAttachmentOperation::Clear;
 	colorDesc.storeOp = EAttachmentOperation::Store;
 	colorDesc.stencilLoadOp = EAttachmentOperation::None;
 	colorDesc.stencilStoreOp = EAttachmentOperation::None;
-	colorDesc.initialLayout = EImageLayout::ShaderReadOnly;
+	colorDesc.initialLayout = EImageLayout::Undefined;
 	colorDesc.usageLayout = EImageLayout::ColorAttachment;
 	colorDesc.finalLayout = EImageLayout::ShaderReadOnly;
 	colorDesc.type = EAttachmentType::Color;
 	colorDesc.index = 0;	
 
 	RenderPassAttachmentDescription shadowDesc = {};
-	shadowDesc.format = ETextureFormat::RGBA32F;
+	shadowDesc.format = colorFormat;
 	shadowDesc.sampleCount = 1;
 	shadowDesc.loadOp = EAttachmentOperation::Clear;
 	shadowDesc.storeOp = EAttachmentOperation::Store;
 	shadowDesc.stencilLoadOp = EAttachmentOperation::None;
 	shadowDesc.stencilStoreOp = EAttachmentOperation::None;
-	shadowDesc.initialLayout = EImageLayout::ShaderReadOnly;
+	shadowDesc.initialLayout = EImageLayout::Undefined;
 	shadowDesc.usageLayout = EImageLayout::ColorAttachment;
 	shadowDesc.finalLayout = EImageLayout::ShaderReadOnly;
 	shadowDesc.type = EAttachmentType::Color;
@@ -86,7 +95,7 @@ void OpaqueContentRenderNode::SetupFunction(std::shared_ptr<RenderGraphResource>
 	depthDesc.storeOp = EAttachmentOperation::Store;
 	depthDesc.stencilLoadOp = EAttachmentOperation::None;
 	depthDesc.stencilStoreOp = EAttachmentOperation::None;
-	depthDesc.initialLayout = EImageLayout::ShaderReadOnly;
+	depthDesc.initialLayout = EImageLayout::Undefined;
 	depthDesc.usageLayout = EImageLayout::DepthStencilAttachment;
 	depthDesc.finalLayout = EImageLayout::ShaderReadOnly;
 	depthDesc.type = EAttachmentType::Depth;
@@ -119,62 +128,28 @@ void OpaqueContentRenderNode::SetupFunction(std::shared_ptr<RenderGraphResource>
 	uint32_t perSubmeshAllocation = m_eGraphicsDeviceType == EGraphicsDeviceType::Vulkan ? 4096 : 1;
 
 	UniformBufferCreateInfo ubCreateInfo = {};
-	ubCreateInfo.sizeInBytes = sizeof(UBTransformMatrices) * perSubmeshAllocation;
+	ubCreateInfo.sizeInBytes = sizeof(UBTransformMatrices);
+	ubCreateInfo.subBufferCount = perSubmeshAllocation;
 	ubCreateInfo.appliedStages = (uint32_t)EShaderType::Vertex | (uint32_t)EShaderType::Fragment;
 	m_pDevice->CreateUniformBuffer(ubCreateInfo, m_pTransformMatrices_UB);
 
 	ubCreateInfo.sizeInBytes = sizeof(UBLightSpaceTransformMatrix);
+	ubCreateInfo.subBufferCount = 0;
 	m_pDevice->CreateUniformBuffer(ubCreateInfo, m_pLightSpaceTransformMatrix_UB);
 
 	ubCreateInfo.sizeInBytes = sizeof(UBCameraProperties);
 	ubCreateInfo.appliedStages = (uint32_t)EShaderType::Fragment;
 	m_pDevice->CreateUniformBuffer(ubCreateInfo, m_pCameraProperties_UB);
 
-	ubCreateInfo.sizeInBytes = sizeof(UBMaterialNumericalProperties) * perSubmeshAllocation;
+	ubCreateInfo.sizeInBytes = sizeof(UBMaterialNumericalProperties);
+	ubCreateInfo.subBufferCount = perSubmeshAllocation;
 	m_pDevice->CreateUniformBuffer(ubCreateInfo, m_pMaterialNumericalProperties_UB);
 
 	// Pipeline objects
 
 	// Vertex input state
 
-	VertexInputBindingDescription vertexInputBindingDesc = {};
-	vertexInputBindingDesc.binding = 0;
-	vertexInputBindingDesc.stride = VertexBufferCreateInfo::interleavedStride;
-	vertexInputBindingDesc.inputRate = EVertexInputRate::PerVertex;
-
-	VertexInputAttributeDescription positionAttributeDesc = {};
-	positionAttributeDesc.binding = vertexInputBindingDesc.binding;
-	positionAttributeDesc.location = DrawingDevice::ATTRIB_POSITION_LOCATION;
-	positionAttributeDesc.offset = VertexBufferCreateInfo::positionOffset;
-	positionAttributeDesc.format = ETextureFormat::RGB32F;
-
-	VertexInputAttributeDescription normalAttributeDesc = {};
-	normalAttributeDesc.binding = vertexInputBindingDesc.binding;
-	normalAttributeDesc.location = DrawingDevice::ATTRIB_NORMAL_LOCATION;
-	normalAttributeDesc.offset = VertexBufferCreateInfo::normalOffset;
-	normalAttributeDesc.format = ETextureFormat::RGB32F;
-
-	VertexInputAttributeDescription texcoordAttributeDesc = {};
-	texcoordAttributeDesc.binding = vertexInputBindingDesc.binding;
-	texcoordAttributeDesc.location = DrawingDevice::ATTRIB_TEXCOORD_LOCATION;
-	texcoordAttributeDesc.offset = VertexBufferCreateInfo::texcoordOffset;
-	texcoordAttributeDesc.format = ETextureFormat::RG32F;
-
-	VertexInputAttributeDescription tangentAttributeDesc = {};
-	tangentAttributeDesc.binding = vertexInputBindingDesc.binding;
-	tangentAttributeDesc.location = DrawingDevice::ATTRIB_TANGENT_LOCATION;
-	tangentAttributeDesc.offset = VertexBufferCreateInfo::tangentOffset;
-	tangentAttributeDesc.format = ETextureFormat::RGB32F;
-
-	VertexInputAttributeDescription bitangentAttributeDesc = {};
-	bitangentAttributeDesc.binding = vertexInputBindingDesc.binding;
-	bitangentAttributeDesc.location = DrawingDevice::ATTRIB_BITANGENT_LOCATION;
-	bitangentAttributeDesc.offset = VertexBufferCreateInfo::bitangentOffset;
-	bitangentAttributeDesc.format = ETextureFormat::RGB32F;
-
-	PipelineVertexInputStateCreateInfo vertexInputStateCreateInfo = {};
-	vertexInputStateCreateInfo.bindingDescs = { vertexInputBindingDesc };
-	vertexInputStateCreateInfo.attributeDescs = { positionAttributeDesc, normalAttributeDesc, texcoordAttributeDesc, tangentAttributeDesc, bitangentAttributeDesc };
+	PipelineVertexInputStateCreateInfo vertexInputStateCreateInfo = VertexBufferCreateInfo::GetVertexInputStateCreateInfo(gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetVertexFormat());
 
 	std::shared_ptr<PipelineVertexInputState> pVertexInputState = nullptr;
 	m_pDevice->CreatePipelineVertexInputState(vertexInputStateCreateInfo, pVertexInputState);
@@ -254,16 +229,11 @@ void OpaqueContentRenderNode::SetupFunction(std::shared_ptr<RenderGraphResource>
 	pipelineCreateInfo.pViewportState = pViewportState;
 	pipelineCreateInfo.pRenderPass = m_pRenderPassObject;
 
-	std::shared_ptr<GraphicsPipelineObject> pPipeline_0 = nullptr;
-	m_pDevice->CreateGraphicsPipelineObject(pipelineCreateInfo, pPipeline_0);
+	// Variants for material feature keys are created on first draw
+	m_pipelineVariantCreateInfos.emplace(EBuiltInShaderProgramType::AnimeStyle, pipelineCreateInfo);
 
 	pipelineCreateInfo.pShaderProgram = m_pRenderer->GetDrawingSystem()->GetShaderProgramByType(EBuiltInShaderProgramType::Basic);
-
-	std::shared_ptr<GraphicsPipelineObject> pPipeline_1 = nullptr;
-	m_pDevice->CreateGraphicsPipelineObject(pipelineCreateInfo, pPipeline_1);
-
-	m_graphicsPipelines.emplace(EBuiltInShaderProgramType::AnimeStyle, pPipeline_0);
-	m_graphicsPipelines.emplace(EBuiltInShaderProgramType::Basic, pPipeline_1);
+	m_pipelineVariantCreateInfos.emplace(EBuiltInShaderProgramType::Basic, pipelineCreateInfo);
 }
 
 void OpaqueContentRenderNode::RenderPassFunction(std::shared_ptr<RenderGraphResource> pGraphResources, const std::shared_ptr<RenderContext> pRenderContext, const std::shared_ptr<CommandContext> pCmdContext)
@@ -292,11 +262,11 @@ void OpaqueContentRenderNode::RenderPassFunction(std::shared_ptr<RenderGraphReso
 	Matrix4x4 lightView = glm::lookAt(glm::normalize(lightDir), Vector3(0), UP);
 	Matrix4x4 lightSpaceMatrix = lightProjection * lightView;
 
-	auto pGBufferNormalTexture = std::static_pointer_cast<Texture2D>(pGraphResources->Get(m_inputResourceNames.at(INPUT_GBUFFER_NORMAL)));
-	auto pShadowMapTexture = std::static_pointer_cast<Texture2D>(pGraphResources->Get(m_inputResourceNames.at(INPUT_SHADOW_MAP)));
+	const auto& pGBufferNormalTexture = pGraphResources->Get(m_gBufferNormalInputHandle);
+	const auto& pShadowMapTexture = pGraphResources->Get(m_shadowMapInputHandle);
 
 	std::shared_ptr<ShaderProgram> pShaderProgram = nullptr;
-	EBuiltInShaderProgramType lastUsedShaderProgramType = EBuiltInShaderProgramType::NONE;
+	std::shared_ptr<GraphicsPipelineObject> pLastUsedPipeline = nullptr;
 
 	UBTransformMatrices ubTransformMatrices = {};
 	UBLightSpaceTransformMatrix ubLightSpaceTransformMatrix = {};
@@ -325,13 +295,16 @@ void OpaqueContentRenderNode::RenderPassFunction(std::shared_ptr<RenderGraphReso
 
 		auto pMesh = pMeshFilterComp->GetMesh();
 
-		if (!pMesh)
+		// Occluded entities are still drawn into shadow maps, their shadows may fall on visible surfaces
+		if (!pMesh || pMeshFilterComp->IsOccluded())
 		{
 			continue;
 		}
 
 		ubTransformMatrices.modelMatrix = pTransformComp->GetModelMatrix();
 		ubTransformMatrices.normalMatrix = pTransformComp->GetNormalMatrix();
+		ubTransformMatrices.positionScale = Vector4(pMesh->GetVertexBuffer()->GetPositionScale(), 0.0f);
+		ubTransformMatrices.positionOffset = Vector4(pMesh->GetVertexBuffer()->GetPositionOffset(), 0.0f);
 
 		std::shared_ptr<SubUniformBuffer> pSubTransformMatricesUB = nullptr;
 		if (m_eGraphicsDeviceType == EGraphicsDeviceType::Vulkan)
@@ -347,7 +320,6 @@ void OpaqueContentRenderNode::RenderPassFunction(std::shared_ptr<RenderGraphReso
 		auto pShaderParamTable = std::make_shared<ShaderParameterTable>();
 
 		unsigned int submeshCount = pMesh->GetSubmeshCount();
-		auto subMeshes = pMesh->GetSubMeshes();
 
 		m_pDevice->SetVertexBuffer(pMesh->GetVertexBuffer(), pCommandBuffer);
 
@@ -360,11 +332,12 @@ void OpaqueContentRenderNode::RenderPassFunction(std::shared_ptr<RenderGraphReso
 				continue;
 			}
 
-			if (lastUsedShaderProgramType != pMaterial->GetShaderProgramType())
+			auto pPipeline = RequestPipelineVariant(pMaterial->GetShaderProgramType(), pMaterial->GetFeatureKey());
+			if (pLastUsedPipeline != pPipeline)
 			{
-				m_pDevice->BindGraphicsPipeline(m_graphicsPipelines.at(pMaterial->GetShaderProgramType()), pCommandBuffer);
+				m_pDevice->BindGraphicsPipeline(pPipeline, pCommandBuffer);
 				pShaderProgram = (m_pRenderer->GetDrawingSystem())->GetShaderProgramByType(pMaterial->GetShaderProgramType());
-				lastUsedShaderProgramType = pMaterial->GetShaderProgramType();
+				pLastUsedPipeline = pPipeline;
 			}
 			pShaderParamTable->Clear();
 
@@ -411,7 +384,7 @@ void OpaqueContentRenderNode::RenderPassFunction(std::shared_ptr<RenderGraphReso
 			}
 
 			m_pDevice->UpdateShaderParameter(pShaderProgram, pShaderParamTable, pCommandBuffer);
-			m_pDevice->DrawPrimitive(subMeshes->at(i).m_numIndices, subMeshes->at(i).m_baseIndex, subMeshes->at(i).m_baseVertex, pCommandBuffer);
+			DrawSubMesh(pMeshFilterComp, (uint32_t)i, pCommandBuffer);
 
 			if (m_eGraphicsDeviceType != EGraphicsDeviceType::Vulkan)
 			{
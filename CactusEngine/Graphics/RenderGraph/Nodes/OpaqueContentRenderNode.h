@@ -31,5 +31,8 @@ namespace Engine
 		std::shared_ptr<Texture2D>			m_pColorOutput;
 		std::shared_ptr<Texture2D>			m_pDepthOutput;
 		std::shared_ptr<Texture2D>			m_pLineSpaceOutput;
+
+		RenderResourceHandle				m_gBufferNormalInputHandle;
+		RenderResourceHandle				m_shadowMapInputHandle;
 	};
 }
\ No newline at end of file
@@ -11,7 +11,7 @@ const char* ShadowMapRenderNode::OUTPUT_DEPTH_TEXTURE = "ShadowMapDepthTexture";
 ShadowMapRenderNode::ShadowMapRenderNode(std::shared_ptr<RenderGraphResource> pGraphResources, BaseRenderer* pRenderer)
 	: RenderNode(pGraphResources, pRenderer)
 {
-
+	m_outputResourceNames.emplace_back(OUTPUT_DEPTH_TEXTURE);
 }
 
 void ShadowMapRenderNode::SetupFunction(std::shared_ptr<RenderGraphResource> pGraphResources)
@@ -31,7 +31,7 @@ void ShadowMapRenderNode::SetupFunction(std::shared_ptr<RenderGraphResource> pGr
 	texCreateInfo.textureType = ETextureType::DepthAttachment;
 	texCreateInfo.initialLayout = EImageLayout::ShaderReadOnly;
 
-	m_pDevice->CreateTexture2D(texCreateInfo, m_pDepthOutput);
+	CreateTransientTexture2D(texCreateInfo, m_pDepthOutput, OUTPUT_DEPTH_TEXTURE);
 
 	pGraphResources->Add(OUTPUT_DEPTH_TEXTURE, m_pDepthOutput);
 
@@ -44,7 +44,7 @@ void ShadowMapRenderNode::SetupFunction(std::shared_ptr<RenderGraphResource> pGr
 	depthDesc.storeOp = EAttachmentOperation::Store;
 	depthDesc.stencilLoadOp = EAttachmentOperation::None;
 	depthDesc.stencilStoreOp = EAttachmentOperation::None;
-	depthDesc.initialLayout = EImageLayout::ShaderReadOnly;
+	depthDesc.initialLayout = EImageLayout::Undefined;
 	depthDesc.usageLayout = EImageLayout::DepthStencilAttachment;
 	depthDesc.finalLayout = EImageLayout::ShaderReadOnly;
 	depthDesc.type = EAttachmentType::Depth;
@@ -73,55 +73,20 @@ void ShadowMapRenderNode::SetupFunction(std::shared_ptr<RenderGraphResource> pGr
 	uint32_t perSubmeshAllocation = m_eGraphicsDeviceType == EGraphicsDeviceType::Vulkan ? 4096 : 1;
 
 	UniformBufferCreateInfo ubCreateInfo = {};
-	ubCreateInfo.sizeInBytes = sizeof(UBTransformMatrices) * perSubmeshAllocation;
+	ubCreateInfo.sizeInBytes = sizeof(UBTransformMatrices);
+	ubCreateInfo.subBufferCount = perSubmeshAllocation;
 	ubCreateInfo.appliedStages = (uint32_t)EShaderType::Vertex | (uint32_t)EShaderType::Fragment;
 	m_pDevice->CreateUniformBuffer(ubCreateInfo, m_pTransformMatrices_UB);
 
 	ubCreateInfo.sizeInBytes = sizeof(UBLightSpaceTransformMatrix);
+	ubCreateInfo.subBufferCount = 0;
 	m_pDevice->CreateUniformBuffer(ubCreateInfo, m_pLightSpaceTransformMatrix_UB);
 
 	// Pipeline object
 
 	// Vertex input state
 
-	VertexInputBindingDescription vertexInputBindingDesc = {};
-	vertexInputBindingDesc.binding = 0;
-	vertexInputBindingDesc.stride = VertexBufferCreateInfo::interleavedStride;
-	vertexInputBindingDesc.inputRate = EVertexInputRate::PerVertex;
-
-	VertexInputAttributeDescription positionAttributeDesc = {};
-	positionAttributeDesc.binding = vertexInputBindingDesc.binding;
-	positionAttributeDesc.location = DrawingDevice::ATTRIB_POSITION_LOCATION;
-	positionAttributeDesc.offset = VertexBufferCreateInfo::positionOffset;
-	positionAttributeDesc.format = ETextureFormat::RGB32F;
-
-	VertexInputAttributeDescription normalAttributeDesc = {};
-	normalAttributeDesc.binding = vertexInputBindingDesc.binding;
-	normalAttributeDesc.location = DrawingDevice::ATTRIB_NORMAL_LOCATION;
-	normalAttributeDesc.offset = VertexBufferCreateInfo::normalOffset;
-	normalAttributeDesc.format = ETextureFormat::RGB32F;
-
-	VertexInputAttributeDescription texcoordAttributeDesc = {};
-	texcoordAttributeDesc.binding = vertexInputBindingDesc.binding;
-	texcoordAttributeDesc.location = DrawingDevice::ATTRIB_TEXCOORD_LOCATION;
-	texcoordAttributeDesc.offset = VertexBufferCreateInfo::texcoordOffset;
-	texcoordAttributeDesc.format = ETextureFormat::RG32F;
-
-	VertexInputAttributeDescription tangentAttributeDesc = {};
-	tangentAttributeDesc.binding = vertexInputBindingDesc.binding;
-	tangentAttributeDesc.location = DrawingDevice::ATTRIB_TANGENT_LOCATION;
-	tangentAttributeDesc.offset = VertexBufferCreateInfo::tangentOffset;
-	tangentAttributeDesc.format = ETextureFormat::RGB32F;
-
-	VertexInputAttributeDescription bitangentAttributeDesc = {};
-	bitangentAttributeDesc.binding = vertexInputBindingDesc.binding;
-	bitangentAttributeDesc.location = DrawingDevice::ATTRIB_BITANGENT_LOCATION;
-	bitangentAttributeDesc.offset = VertexBufferCreateInfo::bitangentOffset;
-	bitangentAttributeDesc.format = ETextureFormat::RGB32F;
-
-	PipelineVertexInputStateCreateInfo vertexInputStateCreateInfo = {};
-	vertexInputStateCreateInfo.bindingDescs = { vertexInputBindingDesc };
-	vertexInputStateCreateInfo.attributeDescs = { positionAttributeDesc, normalAttributeDesc, texcoordAttributeDesc, tangentAttributeDesc, bitangentAttributeDesc };
+	PipelineVertexInputStateCreateInfo vertexInputStateCreateInfo = VertexBufferCreateInfo::GetVertexInputStateCreateInfo(gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetVertexFormat());
 
 	std::shared_ptr<PipelineVertexInputState> pVertexInputState = nullptr;
 	m_pDevice->CreatePipelineVertexInputState(vertexInputStateCreateInfo, pVertexInputState);
@@ -259,6 +224,9 @@ void ShadowMapRenderNode::RenderPassFunction(std::shared_ptr<RenderGraphResource
 		m_pDevice->SetVertexBuffer(pMesh->GetVertexBuffer(), pCommandBuffer);
 
 		ubTransformMatrices.modelMatrix = pTransformComp->GetModelMatrix();
+		ubTransformMatrices.positionScale = Vector4(pMesh->GetVertexBuffer()->GetPositionScale(), 0.0f);
+		ubTransformMatrices.positionOffset = Vector4(pMesh->GetVertexBuffer()->GetPositionOffset(), 0.0f);
+
 		std::shared_ptr<SubUniformBuffer> pSubTransformMatricesUB = nullptr;
 		if (m_eGraphicsDeviceType == EGraphicsDeviceType::Vulkan)
 		{
@@ -270,7 +238,7 @@ void ShadowMapRenderNode::RenderPassFunction(std::shared_ptr<RenderGraphResource
 			m_pTransformMatrices_UB->UpdateBufferData(&ubTransformMatrices);
 		}
 
-		auto subMeshes = pMesh->GetSubMeshes();
+		auto subMeshes = pMesh->GetSubMeshes(pMeshFilterComp->GetLODIndex());
 		for (unsigned int i = 0; i < subMeshes->size(); ++i)
 		{
 			auto pMaterial = pMaterialComp->GetMaterialBySubmeshIndex(i);
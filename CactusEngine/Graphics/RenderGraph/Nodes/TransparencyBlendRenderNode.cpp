@@ -17,6 +17,8 @@ const char* TransparencyBlendRenderNode::INPUT_TRANSPARENCY_DEPTH_TEXTURE = "Tra
 TransparencyBlendRenderNode::TransparencyBlendRenderNode(std::shared_ptr<RenderGraphResource> pGraphResources, BaseRenderer* pRenderer)
 	: RenderNode(pGraphResources, pRenderer)
 {
+	m_outputResourceNames.emplace_back(OUTPUT_COLOR_TEXTURE);
+
 	m_inputResourceNames[INPUT_OPQAUE_COLOR_TEXTURE] = nullptr;
 	m_inputResourceNames[INPUT_OPQAUE_DEPTH_TEXTURE] = nullptr;
 	m_inputResourceNames[INPUT_TRANSPARENCY_COLOR_TEXTURE] = nullptr;
@@ -25,10 +27,17 @@ TransparencyBlendRenderNode::TransparencyBlendRenderNode(std::shared_ptr<RenderG
 
 void TransparencyBlendRenderNode::SetupFunction(std::shared_ptr<RenderGraphResource> pGraphResources)
 {
+	m_opaqueDepthInputHandle = pGraphResources->GetHandle(m_inputResourceNames.at(INPUT_OPQAUE_DEPTH_TEXTURE));
+	m_opaqueColorInputHandle = pGraphResources->GetHandle(m_inputResourceNames.at(INPUT_OPQAUE_COLOR_TEXTURE));
+	m_transparencyDepthInputHandle = pGraphResources->GetHandle(m_inputResourceNames.at(INPUT_TRANSPARENCY_DEPTH_TEXTURE));
+	m_transparencyColorInputHandle = pGraphResources->GetHandle(m_inputResourceNames.at(INPUT_TRANSPARENCY_COLOR_TEXTURE));
+
 	uint32_t screenWidth  = gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetWindowWidth();
 	uint32_t screenHeight = gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetWindowHeight();
 
-	// Color output
+	// Color output, already tone mapped
+
+	ETextureFormat colorFormat = GetRenderTargetFormat(ERenderTargetPrecision::LowDynamicRange);
 
 	Texture2DCreateInfo texCreateInfo = {};
 	texCreateInfo.generateMipmap = false;
@@ -36,24 +45,24 @@ void TransparencyBlendRenderNode::SetupFunction(std::shared_ptr<RenderGraphResou
 	texCreateInfo.textureWidth = screenWidth;
 	texCreateInfo.textureHeight = screenHeight;
 	texCreateInfo.dataType = EDataType::Float32;
-	texCreateInfo.format = ETextureFormat::RGBA32F;
+	texCreateInfo.format = colorFormat;
 	texCreateInfo.textureType = ETextureType::ColorAttachment;
 	texCreateInfo.initialLayout = EImageLayout::ShaderReadOnly;
 
-	m_pDevice->CreateTexture2D(texCreateInfo, m_pColorOutput);
+	CreateTransientTexture2D(texCreateInfo, m_pColorOutput, OUTPUT_COLOR_TEXTURE);
 
 	pGraphResources->Add(OUTPUT_COLOR_TEXTURE, m_pColorOutput);
 
 	// Render pass object
 
 	RenderPassAttachmentDescription colorDesc = {};
-	colorDesc.format = ETextureFormat::RGBA32F;
+	colorDesc.format = colorFormat;
 	colorDesc.sampleCount = 1;
 	colorDesc.loadOp = EAttachmentOperation::None;
 	colorDesc.storeOp = EAttachmentOperation::Store;
 	colorDesc.stencilLoadOp = EAttachmentOperation::None;
 	colorDesc.stencilStoreOp = EAttachmentOperation::None;
-	colorDesc.initialLayout = EImageLayout::ShaderReadOnly;
+	colorDesc.initialLayout = EImageLayout::Undefined;
 	colorDesc.usageLayout = EImageLayout::ColorAttachment;
 	colorDesc.finalLayout = EImageLayout::ShaderReadOnly;
 	colorDesc.type = EAttachmentType::Color;
@@ -180,16 +189,16 @@ void TransparencyBlendRenderNode::RenderPassFunction(std::shared_ptr<RenderGraph
 	auto pShaderParamTable = std::make_shared<ShaderParameterTable>();
 
 	pShaderParamTable->AddEntry(pShaderProgram->GetParamBinding(ShaderParamNames::DEPTH_TEXTURE_1), EDescriptorType::CombinedImageSampler,
-		pGraphResources->Get(m_inputResourceNames.at(INPUT_OPQAUE_DEPTH_TEXTURE)));
+		pGraphResources->Get(m_opaqueDepthInputHandle));
 
 	pShaderParamTable->AddEntry(pShaderProgram->GetParamBinding(ShaderParamNames::COLOR_TEXTURE_1), EDescriptorType::CombinedImageSampler,
-		pGraphResources->Get(m_inputResourceNames.at(INPUT_OPQAUE_COLOR_TEXTURE)));
+		pGraphResources->Get(m_opaqueColorInputHandle));
 
 	pShaderParamTable->AddEntry(pShaderProgram->GetParamBinding(ShaderParamNames::DEPTH_TEXTURE_2), EDescriptorType::CombinedImageSampler,
-		pGraphResources->Get(m_inputResourceNames.at(INPUT_TRANSPARENCY_DEPTH_TEXTURE)));
+		pGraphResources->Get(m_transparencyDepthInputHandle));
 
 	pShaderParamTable->AddEntry(pShaderProgram->GetParamBinding(ShaderParamNames::COLOR_TEXTURE_2), EDescriptorType::CombinedImageSampler,
-		pGraphResources->Get(m_inputResourceNames.at(INPUT_TRANSPARENCY_COLOR_TEXTURE)));
+		pGraphResources->Get(m_transparencyColorInputHandle));
 
 	m_pDevice->UpdateShaderParameter(pShaderProgram, pShaderParamTable, pCommandBuffer);
 	m_pDevice->DrawFullScreenQuad(pCommandBuffer);
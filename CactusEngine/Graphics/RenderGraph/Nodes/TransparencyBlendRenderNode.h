@@ -24,5 +24,10 @@ namespace Engine
 		std::shared_ptr<RenderPassObject>	m_pRenderPassObject;
 
 		std::shared_ptr<Texture2D>			m_pColorOutput;
+
+		RenderResourceHandle				m_opaqueDepthInputHandle;
+		RenderResourceHandle				m_opaqueColorInputHandle;
+		RenderResourceHandle				m_transparencyDepthInputHandle;
+		RenderResourceHandle				m_transparencyColorInputHandle;
 	};
 }
\ No newline at end of file
@@ -16,16 +16,24 @@ const char* TransparentContentRenderNode::INPUT_BACKGROUND_DEPTH = "Transparency
 TransparentContentRenderNode::TransparentContentRenderNode(std::shared_ptr<RenderGraphResource> pGraphResources, BaseRenderer* pRenderer)
 	: RenderNode(pGraphResources, pRenderer)
 {
+	m_outputResourceNames.emplace_back(OUTPUT_COLOR_TEXTURE);
+	m_outputResourceNames.emplace_back(OUTPUT_DEPTH_TEXTURE);
+
 	m_inputResourceNames[INPUT_COLOR_TEXTURE] = nullptr;
 	m_inputResourceNames[INPUT_BACKGROUND_DEPTH] = nullptr;
 }
 
 void TransparentContentRenderNode::SetupFunction(std::shared_ptr<RenderGraphResource> pGraphResources)
 {
+	m_backgroundDepthInputHandle = pGraphResources->GetHandle(m_inputResourceNames.at(INPUT_BACKGROUND_DEPTH));
+	m_colorInputHandle = pGraphResources->GetHandle(m_inputResourceNames.at(INPUT_COLOR_TEXTURE));
+
 	uint32_t screenWidth  = gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetWindowWidth();
 	uint32_t screenHeight = gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetWindowHeight();
 
-	// Color and depth texture
+	// Color and depth texture, alpha of color is not read by blending
+
+	ETextureFormat colorFormat = GetRenderTargetFormat(ERenderTargetPrecision::HighDynamicRange);
 
 	Texture2DCreateInfo texCreateInfo = {};
 	texCreateInfo.generateMipmap = false;
@@ -33,16 +41,16 @@ void TransparentContentRenderNode::SetupFunction(std::shared_ptr<RenderGraphReso
 	texCreateInfo.textureWidth = screenWidth;
 	texCreateInfo.textureHeight = screenHeight;
 	texCreateInfo.dataType = EDataType::Float32;
-	texCreateInfo.format = ETextureFormat::RGBA32F;
+	texCreateInfo.format = colorFormat;
 	texCreateInfo.textureType = ETextureType::ColorAttachment;
 	texCreateInfo.initialLayout = EImageLayout::ShaderReadOnly;
 
-	m_pDevice->CreateTexture2D(texCreateInfo, m_pColorOutput);
+	CreateTransientTexture2D(texCreateInfo, m_pColorOutput, OUTPUT_COLOR_TEXTURE);
 
 	texCreateInfo.format = ETextureFormat::Depth;
 	texCreateInfo.textureType = ETextureType::DepthAttachment;
 
-	m_pDevice->CreateTexture2D(texCreateInfo, m_pDepthOutput);
+	CreateTransientTexture2D(texCreateInfo, m_pDepthOutput, OUTPUT_DEPTH_TEXTURE);
 
 	pGraphResources->Add(OUTPUT_COLOR_TEXTURE, m_pColorOutput);
 	pGraphResources->Add(OUTPUT_DEPTH_TEXTURE, m_pDepthOutput);
@@ -50,13 +58,13 @@ void TransparentContentRenderNode::SetupFunction(std::shared_ptr<RenderGraphReso
 	// Render pass object
 
 	RenderPassAttachmentDescription colorDesc = {};
-	colorDesc.format = ETextureFormat::RGBA32F;
+	colorDesc.format = colorFormat;
 	colorDesc.sampleCount = 1;
 	colorDesc.loadOp = EAttachmentOperation::Clear;
 	colorDesc.storeOp = EAttachmentOperation::Store;
 	colorDesc.stencilLoadOp = EAttachmentOperation::None;
 	colorDesc.stencilStoreOp = EAttachmentOperation::None;
-	colorDesc.initialLayout = EImageLayout::ShaderReadOnly;
+	colorDesc.initialLayout = EImageLayout::Undefined;
 	colorDesc.usageLayout = EImageLayout::ColorAttachment;
 	colorDesc.finalLayout = EImageLayout::ShaderReadOnly;
 	colorDesc.type = EAttachmentType::Color;
@@ -69,7 +77,7 @@ void TransparentContentRenderNode::SetupFunction(std::shared_ptr<RenderGraphReso
 	depthDesc.storeOp = EAttachmentOperation::Store;
 	depthDesc.stencilLoadOp = EAttachmentOperation::None;
 	depthDesc.stencilStoreOp = EAttachmentOperation::None;
-	depthDesc.initialLayout = EImageLayout::ShaderReadOnly;
+	depthDesc.initialLayout = EImageLayout::Undefined;
 	depthDesc.usageLayout = EImageLayout::DepthStencilAttachment;
 	depthDesc.finalLayout = EImageLayout::ShaderReadOnly;
 	depthDesc.type = EAttachmentType::Depth;
@@ -100,62 +108,28 @@ void TransparentContentRenderNode::SetupFunction(std::shared_ptr<RenderGraphReso
 	uint32_t perSubmeshAllocation = m_eGraphicsDeviceType == EGraphicsDeviceType::Vulkan ? 4096 : 1;
 
 	UniformBufferCreateInfo ubCreateInfo = {};
-	ubCreateInfo.sizeInBytes = sizeof(UBTransformMatrices) * perSubmeshAllocation;
+	ubCreateInfo.sizeInBytes = sizeof(UBTransformMatrices);
+	ubCreateInfo.subBufferCount = perSubmeshAllocation;
 	ubCreateInfo.appliedStages = (uint32_t)EShaderType::Vertex | (uint32_t)EShaderType::Fragment;
 	m_pDevice->CreateUniformBuffer(ubCreateInfo, m_pTransformMatrices_UB);
 
 	ubCreateInfo.sizeInBytes = sizeof(UBSystemVariables);
+	ubCreateInfo.subBufferCount = 0;
 	m_pDevice->CreateUniformBuffer(ubCreateInfo, m_pSystemVariables_UB);
 
 	ubCreateInfo.sizeInBytes = sizeof(UBCameraProperties);
 	ubCreateInfo.appliedStages = (uint32_t)EShaderType::Fragment;
 	m_pDevice->CreateUniformBuffer(ubCreateInfo, m_pCameraProperties_UB);
 
-	ubCreateInfo.sizeInBytes = sizeof(UBMaterialNumericalProperties) * perSubmeshAllocation;
+	ubCreateInfo.sizeInBytes = sizeof(UBMaterialNumericalProperties);
+	ubCreateInfo.subBufferCount = perSubmeshAllocation;
 	m_pDevice->CreateUniformBuffer(ubCreateInfo, m_pMaterialNumericalProperties_UB);
 
 	// Pipeline objects
 
 	// Vertex input state
 
-	VertexInputBindingDescription vertexInputBindingDesc = {};
-	vertexInputBindingDesc.binding = 0;
-	vertexInputBindingDesc.stride = VertexBufferCreateInfo::interleavedStride;
-	vertexInputBindingDesc.inputRate = EVertexInputRate::PerVertex;
-
-	VertexInputAttributeDescription positionAttributeDesc = {};
-	positionAttributeDesc.binding = vertexInputBindingDesc.binding;
-	positionAttributeDesc.location = DrawingDevice::ATTRIB_POSITION_LOCATION;
-	positionAttributeDesc.offset = VertexBufferCreateInfo::positionOffset;
-	positionAttributeDesc.format = ETextureFormat::RGB32F;
-
-	VertexInputAttributeDescription normalAttributeDesc = {};
-	normalAttributeDesc.binding = vertexInputBindingDesc.binding;
-	normalAttributeDesc.location = DrawingDevice::ATTRIB_NORMAL_LOCATION;
-	normalAttributeDesc.offset = VertexBufferCreateInfo::normalOffset;
-	normalAttributeDesc.format = ETextureFormat::RGB32F;
-
-	VertexInputAttributeDescription texcoordAttributeDesc = {};
-	texcoordAttributeDesc.binding = vertexInputBindingDesc.binding;
-	texcoordAttributeDesc.location = DrawingDevice::ATTRIB_TEXCOORD_LOCATION;
-	texcoordAttributeDesc.offset = VertexBufferCreateInfo::texcoordOffset;
-	texcoordAttributeDesc.format = ETextureFormat::RG32F;
-
-	VertexInputAttributeDescription tangentAttributeDesc = {};
-	tangentAttributeDesc.binding = vertexInputBindingDesc.binding;
-	tangentAttributeDesc.location = DrawingDevice::ATTRIB_TANGENT_LOCATION;
-	tangentAttributeDesc.offset = VertexBufferCreateInfo::tangentOffset;
-	tangentAttributeDesc.format = ETextureFormat::RGB32F;
-
-	VertexInputAttributeDescription bitangentAttributeDesc = {};
-	bitangentAttributeDesc.binding = vertexInputBindingDesc.binding;
-	bitangentAttributeDesc.location = DrawingDevice::ATTRIB_BITANGENT_LOCATION;
-	bitangentAttributeDesc.offset = VertexBufferCreateInfo::bitangentOffset;
-	bitangentAttributeDesc.format = ETextureFormat::RGB32F;
-
-	PipelineVertexInputStateCreateInfo vertexInputStateCreateInfo = {};
-	vertexInputStateCreateInfo.bindingDescs = { vertexInputBindingDesc };
-	vertexInputStateCreateInfo.attributeDescs = { positionAttributeDesc, normalAttributeDesc, texcoordAttributeDesc, tangentAttributeDesc, bitangentAttributeDesc };
+	PipelineVertexInputStateCreateInfo vertexInputStateCreateInfo = VertexBufferCreateInfo::GetVertexInputStateCreateInfo(gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetVertexFormat());
 
 	std::shared_ptr<PipelineVertexInputState> pVertexInputState = nullptr;
 	m_pDevice->CreatePipelineVertexInputState(vertexInputStateCreateInfo, pVertexInputState);
@@ -234,16 +208,11 @@ void TransparentContentRenderNode::SetupFunction(std::shared_ptr<RenderGraphReso
 	pipelineCreateInfo.pViewportState = pViewportState;
 	pipelineCreateInfo.pRenderPass = m_pRenderPassObject;
 
-	std::shared_ptr<GraphicsPipelineObject> pPipeline_0 = nullptr;
-	m_pDevice->CreateGraphicsPipelineObject(pipelineCreateInfo, pPipeline_0);
+	// Variants for material feature keys are created on first draw
+	m_pipelineVariantCreateInfos.emplace(EBuiltInShaderProgramType::Basic_Transparent, pipelineCreateInfo);
 
 	pipelineCreateInfo.pShaderProgram = m_pRenderer->GetDrawingSystem()->GetShaderProgramByType(EBuiltInShaderProgramType::WaterBasic);
-
-	std::shared_ptr<GraphicsPipelineObject> pPipeline_1 = nullptr;
-	m_pDevice->CreateGraphicsPipelineObject(pipelineCreateInfo, pPipeline_1);
-
-	m_graphicsPipelines.emplace(EBuiltInShaderProgramType::Basic_Transparent, pPipeline_0);
-	m_graphicsPipelines.emplace(EBuiltInShaderProgramType::WaterBasic, pPipeline_1);
+	m_pipelineVariantCreateInfos.emplace(EBuiltInShaderProgramType::WaterBasic, pipelineCreateInfo);
 }
 
 void TransparentContentRenderNode::RenderPassFunction(std::shared_ptr<RenderGraphResource> pGraphResources, const std::shared_ptr<RenderContext> pRenderContext, const std::shared_ptr<CommandContext> pCmdContext)
@@ -280,7 +249,7 @@ void TransparentContentRenderNode::RenderPassFunction(std::shared_ptr<RenderGrap
 	m_pCameraProperties_UB->UpdateBufferData(&ubCameraProperties);
 
 	std::shared_ptr<ShaderProgram> pShaderProgram = nullptr;
-	EBuiltInShaderProgramType lastUsedShaderProgramType = EBuiltInShaderProgramType::NONE;
+	std::shared_ptr<GraphicsPipelineObject> pLastUsedPipeline = nullptr;
 
 	m_pDevice->BeginRenderPass(m_pRenderPassObject, m_pFrameBuffer, pCommandBuffer);
 
@@ -297,13 +266,16 @@ void TransparentContentRenderNode::RenderPassFunction(std::shared_ptr<RenderGrap
 
 		auto pMesh = pMeshFilterComp->GetMesh();
 
-		if (!pMesh)
+		// Occluded entities are still drawn into shadow maps, their shadows may fall on visible surfaces
+		if (!pMesh || pMeshFilterComp->IsOccluded())
 		{
 			continue;
 		}
 
 		ubTransformMatrices.modelMatrix = pTransformComp->GetModelMatrix();
 		ubTransformMatrices.normalMatrix = pTransformComp->GetNormalMatrix();
+		ubTransformMatrices.positionScale = Vector4(pMesh->GetVertexBuffer()->GetPositionScale(), 0.0f);
+		ubTransformMatrices.positionOffset = Vector4(pMesh->GetVertexBuffer()->GetPositionOffset(), 0.0f);
 
 		std::shared_ptr<SubUniformBuffer> pSubTransformMatricesUB = nullptr;
 		if (m_eGraphicsDeviceType == EGraphicsDeviceType::Vulkan)
@@ -319,7 +291,6 @@ void TransparentContentRenderNode::RenderPassFunction(std::shared_ptr<RenderGrap
 		auto pShaderParamTable = std::make_shared<ShaderParameterTable>();
 
 		unsigned int submeshCount = pMesh->GetSubmeshCount();
-		auto subMeshes = pMesh->GetSubMeshes();
 
 		m_pDevice->SetVertexBuffer(pMesh->GetVertexBuffer(), pCommandBuffer);
 
@@ -332,11 +303,12 @@ void TransparentContentRenderNode::RenderPassFunction(std::shared_ptr<RenderGrap
 				continue;
 			}
 
-			if (lastUsedShaderProgramType != pMaterial->GetShaderProgramType())
+			auto pPipeline = RequestPipelineVariant(pMaterial->GetShaderProgramType(), pMaterial->GetFeatureKey());
+			if (pLastUsedPipeline != pPipeline)
 			{
-				m_pDevice->BindGraphicsPipeline(m_graphicsPipelines.at(pMaterial->GetShaderProgramType()), pCommandBuffer);
+				m_pDevice->BindGraphicsPipeline(pPipeline, pCommandBuffer);
 				pShaderProgram = (m_pRenderer->GetDrawingSystem())->GetShaderProgramByType(pMaterial->GetShaderProgramType());
-				lastUsedShaderProgramType = pMaterial->GetShaderProgramType();
+				pLastUsedPipeline = pPipeline;
 			}
 			pShaderParamTable->Clear();
 
@@ -367,10 +339,10 @@ void TransparentContentRenderNode::RenderPassFunction(std::shared_ptr<RenderGrap
 			}
 
 			pShaderParamTable->AddEntry(pShaderProgram->GetParamBinding(ShaderParamNames::DEPTH_TEXTURE_1), EDescriptorType::CombinedImageSampler,
-				pGraphResources->Get(m_inputResourceNames.at(INPUT_BACKGROUND_DEPTH)));
+				pGraphResources->Get(m_backgroundDepthInputHandle));
 
 			pShaderParamTable->AddEntry(pShaderProgram->GetParamBinding(ShaderParamNames::COLOR_TEXTURE_1), EDescriptorType::CombinedImageSampler,
-				pGraphResources->Get(m_inputResourceNames.at(INPUT_COLOR_TEXTURE)));
+				pGraphResources->Get(m_colorInputHandle));
 
 			auto pAlbedoTexture = pMaterial->GetTexture(EMaterialTextureType::Albedo);
 			if (pAlbedoTexture)
@@ -387,7 +359,7 @@ void TransparentContentRenderNode::RenderPassFunction(std::shared_ptr<RenderGrap
 			}
 
 			m_pDevice->UpdateShaderParameter(pShaderProgram, pShaderParamTable, pCommandBuffer);
-			m_pDevice->DrawPrimitive(subMeshes->at(i).m_numIndices, subMeshes->at(i).m_baseIndex, subMeshes->at(i).m_baseVertex, pCommandBuffer);
+			DrawSubMesh(pMeshFilterComp, (uint32_t)i, pCommandBuffer);
 
 			if (m_eGraphicsDeviceType != EGraphicsDeviceType::Vulkan)
 			{
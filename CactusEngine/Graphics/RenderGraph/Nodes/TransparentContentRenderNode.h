@@ -29,5 +29,8 @@ namespace Engine
 
 		std::shared_ptr<Texture2D>			m_pColorOutput;
 		std::shared_ptr<Texture2D>			m_pDepthOutput;
+
+		RenderResourceHandle				m_backgroundDepthInputHandle;
+		RenderResourceHandle				m_colorInputHandle;
 	};
 }
\ No newline at end of file
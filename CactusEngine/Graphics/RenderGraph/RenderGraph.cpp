@@ -1,21 +1,31 @@
 #include "RenderGraph.h"
 #include "DrawingDevice.h"
 #include "BaseRenderer.h"
+#include "MeshFilterComponent.h"
 #include <assert.h>
 #include <iostream>
+#include <algorithm>
+#include <string>
+#include <cstring>
+#include <unordered_set>
 
 using namespace Engine;
 
 void RenderGraphResource::Add(const char* name, std::shared_ptr<RawResource> pResource)
 {
-	m_renderResources.emplace(name, pResource);
+	RenderResourceHandle handle = RegisterHandle(name);
+	if (m_renderResources[handle] == nullptr)
+	{
+		m_renderResources[handle] = pResource;
+	}
 }
 
 std::shared_ptr<RawResource> RenderGraphResource::Get(const char* name) const
 {
-	if (m_renderResources.find(name) != m_renderResources.end())
+	auto itr = m_resourceHandles.find(name);
+	if (itr != m_resourceHandles.end() && m_renderResources[itr->second] != nullptr)
 	{
-		return m_renderResources.at(name);
+		return m_renderResources[itr->second];
 	}
 	std::cerr << "Couldn't find resource: " << name << std::endl;
 	return nullptr;
@@ -23,9 +33,10 @@ std::shared_ptr<RawResource> RenderGraphResource::Get(const char* name) const
 
 void RenderGraphResource::Swap(const char* name, std::shared_ptr<RawResource> pResource)
 {
-	if (m_renderResources.find(name) != m_renderResources.end())
+	auto itr = m_resourceHandles.find(name);
+	if (itr != m_resourceHandles.end())
 	{
-		m_renderResources.at(name) = pResource;
+		m_renderResources[itr->second] = pResource;
 	}
 	else
 	{
@@ -33,8 +44,106 @@ void RenderGraphResource::Swap(const char* name, std::shared_ptr<RawResource> pR
 	}
 }
 
+RenderResourceHandle RenderGraphResource::GetHandle(const char* name) const
+{
+	auto itr = m_resourceHandles.find(name);
+	if (itr != m_resourceHandles.end())
+	{
+		return itr->second;
+	}
+	std::cerr << "Couldn't find resource handle: " << name << std::endl;
+	return INVALID_HANDLE;
+}
+
+RenderResourceHandle RenderGraphResource::RegisterHandle(const char* name)
+{
+	auto itr = m_resourceHandles.find(name);
+	if (itr != m_resourceHandles.end())
+	{
+		return itr->second;
+	}
+
+	RenderResourceHandle handle = (RenderResourceHandle)m_renderResources.size();
+	m_resourceHandles.emplace(name, handle);
+	m_renderResources.emplace_back(nullptr);
+	return handle;
+}
+
+void RenderGraphResource::CreateTransientTexture2D(const std::shared_ptr<DrawingDevice> pDevice, const Texture2DCreateInfo& createInfo, const char* name, uint32_t producerPriority, std::shared_ptr<Texture2D>& pOutput)
+{
+	std::vector<uint32_t> users(1, producerPriority);
+	if (name != nullptr)
+	{
+		auto itr = m_resourceConsumers.find(name);
+		if (itr == m_resourceConsumers.end())
+		{
+			// Outputs not read by any node could be accessed outside of the graph, their lifetimes are unknown
+			pDevice->CreateTexture2D(createInfo, pOutput);
+			return;
+		}
+		users.insert(users.end(), itr->second.begin(), itr->second.end());
+	}
+
+	m_transientTextureCount++;
+
+	// Greedily reuse the first block whose previous occupants are all done before the producer starts
+	for (auto& block : m_transientMemoryBlocks)
+	{
+		if (!IsAliasCompatible(block.createInfo, createInfo))
+		{
+			continue;
+		}
+
+		bool isOverlapping = false;
+		for (uint32_t user : block.users)
+		{
+			if (!IsExecutedBefore(user, producerPriority))
+			{
+				isOverlapping = true;
+				break;
+			}
+		}
+
+		if (!isOverlapping)
+		{
+			Texture2DCreateInfo aliasCreateInfo = createInfo;
+			aliasCreateInfo.pAliasTexture = block.pTexture;
+			pDevice->CreateTexture2D(aliasCreateInfo, pOutput);
+
+			block.users.insert(block.users.end(), users.begin(), users.end());
+			return;
+		}
+	}
+
+	pDevice->CreateTexture2D(createInfo, pOutput);
+
+	if (!createInfo.isTransientAttachment) // Lazily allocated memory may not have a backing store to share
+	{
+		TransientMemoryBlock block = {};
+		block.createInfo = createInfo;
+		block.pTexture = pOutput;
+		block.users = users;
+		m_transientMemoryBlocks.emplace_back(block);
+	}
+}
+
+bool RenderGraphResource::IsExecutedBefore(uint32_t priority, uint32_t laterPriority) const
+{
+	// Command buffers are submitted to the same queue, a dependent node is always submitted after its prior nodes
+	return priority != laterPriority && laterPriority < m_executionDependencies.size() && priority < m_executionDependencies.size()
+		&& m_executionDependencies[laterPriority][priority];
+}
+
+bool RenderGraphResource::IsAliasCompatible(const Texture2DCreateInfo& lhs, const Texture2DCreateInfo& rhs) const
+{
+	// Identical images have identical memory requirements, the device would still verify it before binding
+	return lhs.textureWidth == rhs.textureWidth && lhs.textureHeight == rhs.textureHeight && lhs.format == rhs.format && lhs.textureType == rhs.textureType
+		&& lhs.pTextureData == nullptr && rhs.pTextureData == nullptr && !lhs.generateMipmap && !rhs.generateMipmap
+		&& !lhs.isTransientAttachment && !rhs.isTransientAttachment && lhs.deviceType == rhs.deviceType;
+}
+
 RenderNode::RenderNode(std::shared_ptr<RenderGraphResource> pGraphResources, BaseRenderer* pRenderer)
-	: m_pRenderer(pRenderer), m_pGraphResources(pGraphResources), m_finishedExecution(false), m_pName(nullptr)
+	: m_pRenderer(pRenderer), m_pGraphResources(pGraphResources), m_finishedExecution(false), m_submitPriority(0), m_resolutionScale(1.0f), m_pName(nullptr)
 {
 	assert(m_pGraphResources != nullptr);
 	m_pDevice = m_pRenderer->GetDrawingDevice();
@@ -43,6 +152,11 @@ RenderNode::RenderNode(std::shared_ptr<RenderGraphResource> pGraphResources, Bas
 
 void RenderNode::ConnectNext(std::shared_ptr<RenderNode> pNode)
 {
+	if (std::find(m_nextNodes.begin(), m_nextNodes.end(), pNode) != m_nextNodes.end())
+	{
+		return;
+	}
+
 	m_nextNodes.emplace_back(pNode);
 	pNode->m_prevNodes.emplace_back(this);
 }
@@ -53,13 +167,103 @@ void RenderNode::SetInputResource(const char* slot, const char* pResourceName)
 	m_inputResourceNames.at(slot) = pResourceName;
 }
 
+void RenderNode::SetResolutionScale(float scale)
+{
+	assert(scale > 0.0f && scale <= 1.0f);
+	m_resolutionScale = scale;
+}
+
 void RenderNode::Setup()
 {
 	SetupFunction(m_pGraphResources);
 }
 
+std::shared_ptr<GraphicsPipelineObject> RenderNode::RequestPipelineVariant(EBuiltInShaderProgramType shaderType, MaterialFeatureKey featureKey)
+{
+	uint64_t variantKey = ((uint64_t)shaderType << 32) | featureKey;
+
+	auto itr = m_pipelineVariants.find(variantKey);
+	if (itr != m_pipelineVariants.end())
+	{
+		return itr->second;
+	}
+
+	assert(m_pipelineVariantCreateInfos.find(shaderType) != m_pipelineVariantCreateInfos.end());
+
+	GraphicsPipelineCreateInfo pipelineCreateInfo = m_pipelineVariantCreateInfos.at(shaderType);
+	pipelineCreateInfo.featureKey = featureKey;
+
+	std::shared_ptr<GraphicsPipelineObject> pPipeline = nullptr;
+	m_pDevice->CreateGraphicsPipelineObject(pipelineCreateInfo, pPipeline);
+
+	m_pipelineVariants.emplace(variantKey, pPipeline);
+	return pPipeline;
+}
+
+void RenderNode::DrawSubMesh(const std::shared_ptr<MeshFilterComponent>& pMeshFilterComp, uint32_t subMeshIndex, std::shared_ptr<DrawingCommandBuffer> pCommandBuffer)
+{
+	const SubMesh& subMesh = pMeshFilterComp->GetMesh()->GetSubMeshes(pMeshFilterComp->GetLODIndex())->at(subMeshIndex);
+	const ClusterCullingResult& cullingResult = pMeshFilterComp->GetClusterCullingResult();
+
+	if (!cullingResult.isValid)
+	{
+		m_pDevice->DrawPrimitive(subMesh.m_numIndices, subMesh.m_baseIndex, subMesh.m_baseVertex, pCommandBuffer);
+		return;
+	}
+
+	// Neighbouring visible clusters were merged, so this is usually a handful of draws
+	for (uint32_t i = cullingResult.subMeshRangeOffsets[subMeshIndex]; i < cullingResult.subMeshRangeOffsets[subMeshIndex + 1]; ++i)
+	{
+		m_pDevice->DrawPrimitive(cullingResult.ranges[i].numIndices, cullingResult.ranges[i].baseIndex, subMesh.m_baseVertex, pCommandBuffer);
+	}
+}
+
+void RenderNode::CreateTransientTexture2D(const Texture2DCreateInfo& createInfo, std::shared_ptr<Texture2D>& pOutput, const char* outputName)
+{
+	m_pGraphResources->CreateTransientTexture2D(m_pDevice, createInfo, outputName, m_submitPriority, pOutput);
+}
+
+ETextureFormat RenderNode::GetRenderTargetFormat(ERenderTargetPrecision precision) const
+{
+	// Candidates in the order of preference, RGBA32F is always the last resort
+	std::vector<ETextureFormat> candidates;
+	switch (precision)
+	{
+	case ERenderTargetPrecision::LowDynamicRange:
+		candidates = { ETextureFormat::RGBA8_UNORM, ETextureFormat::RGBA16F };
+		break;
+	case ERenderTargetPrecision::HighDynamicRange:
+		candidates = { ETextureFormat::R11G11B10F, ETextureFormat::RGBA16F };
+		break;
+	case ERenderTargetPrecision::HalfFloat:
+		candidates = { ETextureFormat::RGBA16F };
+		break;
+	default:
+		break;
+	}
+
+	for (auto format : candidates)
+	{
+		if (m_pDevice->SupportColorAttachmentFormat(format))
+		{
+			return format;
+		}
+	}
+	return ETextureFormat::RGBA32F;
+}
+
+uint32_t RenderNode::GetScaledExtent(uint32_t extent) const
+{
+	return std::max(1U, (uint32_t)(extent * m_resolutionScale));
+}
+
 void RenderNode::ExecuteSequential()
 {
+	if (m_finishedExecution) // Could be reached again from another previous node
+	{
+		return;
+	}
+
 	for (auto& pNode : m_prevNodes)
 	{
 		if (!pNode->m_finishedExecution)
@@ -84,7 +288,7 @@ void RenderNode::ExecuteParallel()
 }
 
 RenderGraph::RenderGraph(const std::shared_ptr<DrawingDevice> pDevice, uint32_t executionThreadCount, EGPUType deviceType)
-	: m_pDevice(pDevice), m_isRunning(true), m_executionThreadCount(executionThreadCount), m_deviceType(deviceType)
+	: m_pDevice(pDevice), m_isRunning(true), m_executionThreadCount(executionThreadCount), m_deviceType(deviceType), m_recordedNodeCount(0)
 {
 	if (gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetDeviceType() == EGraphicsDeviceType::Vulkan)
 	{
@@ -113,9 +317,119 @@ void RenderGraph::AddRenderNode(const char* name, std::shared_ptr<RenderNode> pN
 
 void RenderGraph::SetupRenderNodes()
 {
+	assert(m_sortedNodes.size() == m_nodes.size());
+
+	if (m_nodes.empty())
+	{
+		return;
+	}
+
+	auto pGraphResources = m_nodes.begin()->second->m_pGraphResources;
+	CompileResourceHandles(pGraphResources);
+	CompileResourceLifetimes(pGraphResources);
+
+	// Setup by submit sequence, so that transient textures are placed in the order of their first use
+	for (auto& pNode : m_sortedNodes)
+	{
+		pNode->m_submitPriority = m_renderNodePriorities.at(pNode->m_pName);
+		pNode->Setup();
+	}
+
+	if (pGraphResources->m_transientTextureCount > 0)
+	{
+		std::cout << "Render graph: " << pGraphResources->m_transientTextureCount << " transient textures placed in "
+			<< pGraphResources->m_transientMemoryBlocks.size() << " shared memory blocks.\n";
+	}
+}
+
+void RenderGraph::BuildRenderNodeDependencies()
+{
+	// Resource names are matched by content, the same name could be referred to by different pointers
+	std::unordered_map<std::string, std::pair<const char*, std::shared_ptr<RenderNode>>> producers; // Resource name - Declared name, Writing node
+	for (auto& node : m_nodes)
+	{
+		for (auto pOutputName : node.second->m_outputResourceNames)
+		{
+			if (!producers.emplace(pOutputName, std::make_pair(pOutputName, node.second)).second)
+			{
+				std::cerr << "Render graph: resource " << pOutputName << " is written by multiple nodes.\n";
+			}
+		}
+	}
+
+	// Nodes without outputs write to external targets and are always kept, other nodes are kept only if a kept node reads from them
+	std::unordered_set<RenderNode*> liveNodes;
+	std::queue<std::shared_ptr<RenderNode>> pendingNodes;
 	for (auto& node : m_nodes)
 	{
-		node.second->Setup();
+		if (node.second->m_outputResourceNames.empty())
+		{
+			liveNodes.emplace(node.second.get());
+			pendingNodes.push(node.second);
+		}
+	}
+
+	while (!pendingNodes.empty())
+	{
+		auto pNode = pendingNodes.front();
+		pendingNodes.pop();
+
+		for (auto& input : pNode->m_inputResourceNames)
+		{
+			if (input.second == nullptr)
+			{
+				continue;
+			}
+
+			auto itr = producers.find(input.second);
+			if (itr == producers.end())
+			{
+				std::cerr << "Render graph: no node writes resource " << input.second << " read by " << pNode->m_pName << std::endl;
+				continue;
+			}
+
+			input.second = itr->second.first; // Resources are stored by the declared name
+			itr->second.second->ConnectNext(pNode);
+
+			if (liveNodes.emplace(itr->second.second.get()).second)
+			{
+				pendingNodes.push(itr->second.second);
+			}
+		}
+
+		// Explicit connections are kept as they are
+		for (auto pPrevNode : pNode->m_prevNodes)
+		{
+			if (liveNodes.emplace(pPrevNode).second)
+			{
+				pendingNodes.push(m_nodes.at(pPrevNode->m_pName));
+			}
+		}
+	}
+
+	for (auto itr = m_nodes.begin(); itr != m_nodes.end();)
+	{
+		if (liveNodes.find(itr->second.get()) == liveNodes.end())
+		{
+			std::cout << "Render graph: culled " << itr->first << " as none of its outputs is read.\n";
+			m_culledNodes.emplace(itr->first, itr->second);
+			itr = m_nodes.erase(itr);
+		}
+		else
+		{
+			++itr;
+		}
+	}
+
+	// Culled nodes could still be explicitly connected after kept nodes
+	for (auto& node : m_nodes)
+	{
+		auto& nextNodes = node.second->m_nextNodes;
+		nextNodes.erase(std::remove_if(nextNodes.begin(), nextNodes.end(),
+			[&liveNodes](const std::shared_ptr<RenderNode>& pNode)
+			{
+				return liveNodes.find(pNode.get()) == liveNodes.end();
+			}), nextNodes.end());
 	}
 }
 
@@ -123,48 +437,63 @@ void RenderGraph::BuildRenderNodePriorities()
 {
 	m_renderNodePriorities.clear();
 	m_nodePriorityDependencies.clear();
+	m_sortedNodes.clear();
 
-	// Find all starting nodes
-	std::queue<std::shared_ptr<RenderNode>> startingNodes;
-	for (auto& pNode : m_nodes)
+	std::unordered_map<RenderNode*, uint32_t> pathLengths;
+	std::unordered_map<RenderNode*, uint32_t> remainingPrevCounts;
+	std::vector<std::shared_ptr<RenderNode>> readyNodes;
+
+	for (auto& node : m_nodes)
 	{
-		pNode.second->m_finishedExecution = false;
+		ComputeCriticalPathLength(node.second.get(), pathLengths);
+		remainingPrevCounts[node.second.get()] = (uint32_t)node.second->m_prevNodes.size();
 
-		if (pNode.second->m_prevNodes.empty())
+		if (node.second->m_prevNodes.empty())
 		{
-			startingNodes.push(pNode.second);
+			readyNodes.emplace_back(node.second);
 		}
 	}
 
-	// Traverse graph
-	std::vector<std::shared_ptr<RenderNode>> traverseResult;
-	while (!startingNodes.empty())
+	// List scheduling, the ready node heading the longest chain is submitted first so that the chain starts as early as possible
+	while (!readyNodes.empty())
 	{
-		TraverseRenderNode(startingNodes.front(), traverseResult);
-		startingNodes.pop();
-	}
-
-	// Reset flag
-	for (auto& pNode : m_nodes)
-	{
-		pNode.second->m_finishedExecution = false;
+		auto itr = std::max_element(readyNodes.begin(), readyNodes.end(),
+			[&pathLengths](const std::shared_ptr<RenderNode>& lhs, const std::shared_ptr<RenderNode>& rhs)
+			{
+				if (pathLengths[lhs.get()] != pathLengths[rhs.get()])
+				{
+					return pathLengths[lhs.get()] < pathLengths[rhs.get()];
+				}
+				return strcmp(lhs->m_pName, rhs->m_pName) > 0; // Keep the order deterministic
+			});
+
+		auto pNode = *itr;
+		readyNodes.erase(itr);
+
+		m_renderNodePriorities[pNode->m_pName] = (uint32_t)m_sortedNodes.size();
+		m_sortedNodes.emplace_back(pNode);
+
+		for (auto& pNextNode : pNode->m_nextNodes)
+		{
+			if (--remainingPrevCounts[pNextNode.get()] == 0)
+			{
+				readyNodes.emplace_back(pNextNode);
+			}
+		}
 	}
 
-	// Assign priority by traverse sequence
-	uint32_t assignedPriority = 0;
-	for (unsigned int i = 0; i < traverseResult.size(); i++)
+	if (m_sortedNodes.size() != m_nodes.size())
 	{
-		m_renderNodePriorities[traverseResult[i]->m_pName] = assignedPriority;
-		assignedPriority++;
+		std::cerr << "Render graph: " << m_nodes.size() - m_sortedNodes.size() << " nodes are not scheduled due to cyclic dependencies.\n";
 	}
 
 	// Record priority dependencies
-	for (unsigned int i = 0; i < traverseResult.size(); i++)
+	for (auto& pNode : m_sortedNodes)
 	{
-		m_nodePriorityDependencies[m_renderNodePriorities[traverseResult[i]->m_pName]] = std::vector<uint32_t>();
-		for (auto pNode : traverseResult[i]->m_prevNodes)
+		auto& dependencies = m_nodePriorityDependencies[m_renderNodePriorities[pNode->m_pName]];
+		for (auto pPrevNode : pNode->m_prevNodes)
 		{
-			m_nodePriorityDependencies[m_renderNodePriorities[traverseResult[i]->m_pName]].emplace_back(m_renderNodePriorities[pNode->m_pName]);
+			dependencies.emplace_back(m_renderNodePriorities[pPrevNode->m_pName]);
 		}
 	}
 }
@@ -198,31 +527,55 @@ void RenderGraph::BeginRenderPassesParallel(const std::shared_ptr<RenderContext>
 	{
 		pNode.second->m_pRenderContext = pContext;
 		pNode.second->m_finishedExecution = false;
+	}
 
-		if (pNode.second->m_prevNodes.empty())
-		{
-			m_startingNodes.push(pNode.second);
-		}
+	m_recordedCommandBuffers.assign(m_sortedNodes.size(), nullptr);
+	m_recordedNodeCount = 0;
+	m_recordingFinishedPromise = std::promise<void>();
+	m_recordingFinishedFuture = m_recordingFinishedPromise.get_future();
+
+	if (m_sortedNodes.empty())
+	{
+		m_recordingFinishedPromise.set_value();
 	}
 
 	{
 		std::lock_guard<std::mutex> guard(m_nodeExecutionMutex);
 
-		while (!m_startingNodes.empty())
-		{
-			EnqueueRenderNode(m_startingNodes.front());
-			m_startingNodes.pop();
-		}
-
-		for (auto& pNode : m_nodes)
+		// Record by submit sequence, nodes on the critical path are picked up first
+		for (auto& pNode : m_sortedNodes)
 		{
-			pNode.second->m_finishedExecution = false;
+			m_executionNodeQueue.Push(pNode);
 		}
 	}
 
 	m_nodeExecutionCv.notify_all();
 }
 
+void RenderGraph::EndRenderPassesParallel()
+{
+	m_recordingFinishedFuture.wait();
+
+	// All node command buffers are handed over at once and end up in the same queue submission in submit priority order,
+	// execution order within the submission together with render pass external dependencies resolves inter-node hazards
+	for (uint32_t i = 0; i < m_recordedCommandBuffers.size(); i++)
+	{
+		m_recordedCommandBuffers[i]->m_debugID = i;
+		m_pDevice->ReturnExternalCommandBuffer(m_recordedCommandBuffers[i]);
+		m_recordedCommandBuffers[i] = nullptr;
+	}
+}
+
+void RenderGraph::WriteRecordedCommandBuffer(const char* pNodeName, const std::shared_ptr<DrawingCommandBuffer>& pCommandBuffer)
+{
+	m_recordedCommandBuffers[m_renderNodePriorities.at(pNodeName)] = pCommandBuffer;
+
+	if (m_recordedNodeCount.fetch_add(1) + 1 == m_recordedCommandBuffers.size())
+	{
+		m_recordingFinishedPromise.set_value();
+	}
+}
+
 std::shared_ptr<RenderNode> RenderGraph::GetNodeByName(const char* name) const
 {
 	if (m_nodes.find(name) != m_nodes.end())
@@ -262,42 +615,88 @@ void RenderGraph::ExecuteRenderNodeParallel()
 	}
 }
 
-void RenderGraph::EnqueueRenderNode(const std::shared_ptr<RenderNode> pNode)
+uint32_t RenderGraph::ComputeCriticalPathLength(RenderNode* pNode, std::unordered_map<RenderNode*, uint32_t>& pathLengths) const
 {
-	// Enqueue render nodes by dependency sequence
-	for (auto& pPrevNode : pNode->m_prevNodes)
+	auto itr = pathLengths.find(pNode);
+	if (itr != pathLengths.end())
 	{
-		if (!pPrevNode->m_finishedExecution) // m_finishedExecution is being used as traversal flag here
-		{
-			return;
-		}
+		return itr->second;
 	}
 
-	m_executionNodeQueue.Push(pNode);
-	pNode->m_finishedExecution = true;
+	pathLengths[pNode] = 0; // Guards against cycles
 
+	uint32_t length = 0;
 	for (auto& pNextNode : pNode->m_nextNodes)
 	{
-		EnqueueRenderNode(pNextNode);
+		length = std::max(length, ComputeCriticalPathLength(pNextNode.get(), pathLengths));
 	}
+
+	pathLengths[pNode] = length + 1; // In number of nodes
+	return length + 1;
 }
 
-void RenderGraph::TraverseRenderNode(const std::shared_ptr<RenderNode> pNode, std::vector<std::shared_ptr<RenderNode>>& output)
+void RenderGraph::CompileResourceHandles(const std::shared_ptr<RenderGraphResource> pGraphResources)
 {
-	// Record render nodes by dependency sequence
-	for (auto& pPrevNode : pNode->m_prevNodes)
+	// Outputs are registered by submit sequence, so handles of resources accessed together stay close to each other
+	for (auto& pNode : m_sortedNodes)
 	{
-		if (!pPrevNode->m_finishedExecution) // m_finishedExecution is being used as traversal flag here
+		for (auto pOutputName : pNode->m_outputResourceNames)
 		{
-			return;
+			pGraphResources->RegisterHandle(pOutputName);
 		}
 	}
 
-	output.emplace_back(pNode);
-	pNode->m_finishedExecution = true;
+	// Inputs not written by any node are provided from outside of the graph, they still need a slot
+	for (auto& pNode : m_sortedNodes)
+	{
+		for (auto& input : pNode->m_inputResourceNames)
+		{
+			if (input.second != nullptr)
+			{
+				pGraphResources->RegisterHandle(input.second);
+			}
+		}
+	}
+}
 
-	for (auto& pNextNode : pNode->m_nextNodes)
+void RenderGraph::CompileResourceLifetimes(const std::shared_ptr<RenderGraphResource> pGraphResources)
+{
+	pGraphResources->m_resourceConsumers.clear();
+	pGraphResources->m_transientMemoryBlocks.clear();
+	pGraphResources->m_transientTextureCount = 0;
+
+	for (auto& node : m_nodes)
 	{
-		TraverseRenderNode(pNextNode, output);
+		assert(node.second->m_pGraphResources == pGraphResources);
+
+		for (auto& input : node.second->m_inputResourceNames)
+		{
+			if (input.second != nullptr)
+			{
+				pGraphResources->m_resourceConsumers[input.second].emplace_back(m_renderNodePriorities.at(node.first));
+			}
+		}
+	}
+
+	// Prior nodes always have lower priorities, so their dependencies are resolved first
+	uint32_t nodeCount = (uint32_t)m_nodes.size();
+	auto& dependencies = pGraphResources->m_executionDependencies;
+	dependencies.assign(nodeCount, std::vector<bool>(nodeCount, false));
+
+	for (uint32_t i = 0; i < nodeCount; i++)
+	{
+		for (uint32_t prior : m_nodePriorityDependencies[i])
+		{
+			assert(prior < i);
+
+			dependencies[i][prior] = true;
+			for (uint32_t j = 0; j < prior; j++)
+			{
+				if (dependencies[prior][j])
+				{
+					dependencies[i][j] = true;
+				}
+			}
+		}
 	}
 }
\ No newline at end of file
@@ -10,11 +10,18 @@
 
 #include <queue>
 #include <mutex>
+#include <atomic>
+#include <future>
+#include <assert.h>
 
 namespace Engine
 {
 	class BaseRenderer;
 	class RenderGraph;
+	class MeshFilterComponent;
+
+	// Index of a render graph resource, names are resolved to handles when render graph is compiled
+	typedef uint32_t RenderResourceHandle;
 
 	class RenderGraphResource
 	{
@@ -23,8 +30,53 @@ namespace Engine
 		std::shared_ptr<RawResource> Get(const char* name) const;
 		void Swap(const char* name, std::shared_ptr<RawResource> pResource);
 
+		// Handles are stable once registered, per-frame lookups should go through them rather than names
+		RenderResourceHandle GetHandle(const char* name) const;
+		const std::shared_ptr<RawResource>& Get(RenderResourceHandle handle) const
+		{
+			assert(handle < m_renderResources.size());
+			return m_renderResources[handle];
+		}
+
+		// Transient textures live from the producer node to the last node reading them, textures with non-overlapping lifetimes share device memory
+		void CreateTransientTexture2D(const std::shared_ptr<DrawingDevice> pDevice, const Texture2DCreateInfo& createInfo, const char* name, uint32_t producerPriority, std::shared_ptr<Texture2D>& pOutput);
+
+	public:
+		static const RenderResourceHandle INVALID_HANDLE = UINT32_MAX;
+
 	private:
-		std::unordered_map<const char*, std::shared_ptr<RawResource>> m_renderResources;
+		RenderResourceHandle RegisterHandle(const char* name);
+		bool IsExecutedBefore(uint32_t priority, uint32_t laterPriority) const;
+		bool IsAliasCompatible(const Texture2DCreateInfo& lhs, const Texture2DCreateInfo& rhs) const;
+
+	private:
+		struct TransientMemoryBlock
+		{
+			Texture2DCreateInfo			createInfo;
+			std::shared_ptr<Texture2D>	pTexture;	// Owner of the memory, later textures are aliased to it
+			std::vector<uint32_t>		users;		// Submit priorities of all nodes accessing the memory
+		};
+
+		std::unordered_map<const char*, RenderResourceHandle> m_resourceHandles; // Resource name - Handle
+		std::vector<std::shared_ptr<RawResource>> m_renderResources; // By handle
+
+		// Filled by render graph compilation
+		std::unordered_map<const char*, std::vector<uint32_t>> m_resourceConsumers; // Resource name - Submit priorities of nodes reading it
+		std::vector<std::vector<bool>> m_executionDependencies; // [Submit priority][Prior submit priority], true if the node transitively depends on prior one
+		std::vector<TransientMemoryBlock> m_transientMemoryBlocks;
+		uint32_t m_transientTextureCount = 0;
+
+		friend class RenderGraph;
+	};
+
+	// Precision a node requires of its color targets, the actual format is the cheapest one supported by device
+	enum class ERenderTargetPrecision
+	{
+		LowDynamicRange = 0,	// 8-bit normalized with alpha, for tone mapped colors
+		HighDynamicRange,		// Packed non-negative float without alpha, for scene colors before tone mapping
+		HalfFloat,				// 16-bit signed float with alpha
+		FullFloat,				// 32-bit float with alpha, for world space positions
+		COUNT
 	};
 
 	struct RenderContext
@@ -46,6 +98,7 @@ namespace Engine
 
 		void ConnectNext(std::shared_ptr<RenderNode> pNode);
 		void SetInputResource(const char* slot, const char* pResourceName);
+		void SetResolutionScale(float scale); // Should be set before render graph setup, only applies to nodes that support downscaled rendering
 
 	protected:
 		void Setup();
@@ -55,6 +108,18 @@ namespace Engine
 		virtual void SetupFunction(std::shared_ptr<RenderGraphResource> pGraphResources) = 0;
 		virtual void RenderPassFunction(std::shared_ptr<RenderGraphResource> pGraphResources, const std::shared_ptr<RenderContext> pRenderContext, const std::shared_ptr<CommandContext> pCmdContext) = 0;
 
+		// Pipeline variants are built on first use from the create info registered for the shader program type
+		std::shared_ptr<GraphicsPipelineObject> RequestPipelineVariant(EBuiltInShaderProgramType shaderType, MaterialFeatureKey featureKey);
+
+		// Only clusters left visible to main camera are drawn if they were culled this frame, whole submesh otherwise
+		void DrawSubMesh(const std::shared_ptr<MeshFilterComponent>& pMeshFilterComp, uint32_t subMeshIndex, std::shared_ptr<DrawingCommandBuffer> pCommandBuffer);
+
+		// Output name should be given if the texture is read by other nodes, otherwise it only lives within this node
+		void CreateTransientTexture2D(const Texture2DCreateInfo& createInfo, std::shared_ptr<Texture2D>& pOutput, const char* outputName = nullptr);
+
+		ETextureFormat GetRenderTargetFormat(ERenderTargetPrecision precision) const;
+		uint32_t GetScaledExtent(uint32_t extent) const; // Never less than 1 texel
+
 	protected:
 		const char*									m_pName;
 		BaseRenderer*								m_pRenderer;
@@ -64,12 +129,17 @@ namespace Engine
 		std::vector<RenderNode*>					m_prevNodes;
 		std::vector<std::shared_ptr<RenderNode>>	m_nextNodes;
 		bool										m_finishedExecution;
+		uint32_t									m_submitPriority;
+		float										m_resolutionScale;
 
 		std::shared_ptr<RenderGraphResource>		m_pGraphResources;
 		std::shared_ptr<RenderContext>				m_pRenderContext;
 		std::shared_ptr<CommandContext>				m_pCmdContext;
-		std::unordered_map<const char*, const char*> m_inputResourceNames;
+		std::unordered_map<const char*, const char*> m_inputResourceNames; // Input slot - Resource name
+		std::vector<const char*>					m_outputResourceNames; // Resources written by this node, nodes without outputs write to external targets
 		std::unordered_map<EBuiltInShaderProgramType, std::shared_ptr<GraphicsPipelineObject>> m_graphicsPipelines;
+		std::unordered_map<EBuiltInShaderProgramType, GraphicsPipelineCreateInfo> m_pipelineVariantCreateInfos;
+		std::unordered_map<uint64_t, std::shared_ptr<GraphicsPipelineObject>> m_pipelineVariants; // Shader program type - Feature key
 
 		friend class RenderGraph;
 	};
@@ -81,19 +151,25 @@ namespace Engine
 		~RenderGraph();
 
 		void AddRenderNode(const char* name, std::shared_ptr<RenderNode> pNode);
-		void SetupRenderNodes();
+		void BuildRenderNodeDependencies(); // Connects nodes by the resources they read and write, and culls nodes whose outputs are never read
 		void BuildRenderNodePriorities();
+		void SetupRenderNodes(); // Requires node priorities to be built
 
 		void BeginRenderPassesSequential(const std::shared_ptr<RenderContext> pContext);
 		void BeginRenderPassesParallel(const std::shared_ptr<RenderContext> pContext);
+		void EndRenderPassesParallel(); // Waits for all nodes to finish recording, then hands their command buffers to device in submit order
+
+		// Called by render nodes from execution threads, each node only writes to the slot of its own submit priority
+		void WriteRecordedCommandBuffer(const char* pNodeName, const std::shared_ptr<DrawingCommandBuffer>& pCommandBuffer);
 
 		std::shared_ptr<RenderNode> GetNodeByName(const char* name) const;
 		uint32_t GetRenderNodeCount() const;
 
 	private:
 		void ExecuteRenderNodeParallel();
-		void EnqueueRenderNode(const std::shared_ptr<RenderNode> pNode);
-		void TraverseRenderNode(const std::shared_ptr<RenderNode> pNode, std::vector<std::shared_ptr<RenderNode>>& output);
+		uint32_t ComputeCriticalPathLength(RenderNode* pNode, std::unordered_map<RenderNode*, uint32_t>& pathLengths) const;
+		void CompileResourceHandles(const std::shared_ptr<RenderGraphResource> pGraphResources);
+		void CompileResourceLifetimes(const std::shared_ptr<RenderGraphResource> pGraphResources);
 
 	public:
 		std::unordered_map<const char*, uint32_t> m_renderNodePriorities; // Render Node Name - Submit Priority
@@ -103,6 +179,8 @@ namespace Engine
 		std::shared_ptr<DrawingDevice> m_pDevice;
 		EGPUType m_deviceType;
 		std::unordered_map<const char*, std::shared_ptr<RenderNode>> m_nodes;
+		std::unordered_map<const char*, std::shared_ptr<RenderNode>> m_culledNodes;
+		std::vector<std::shared_ptr<RenderNode>> m_sortedNodes; // By submit priority
 		std::queue<std::shared_ptr<RenderNode>> m_startingNodes; // Nodes that has no previous dependencies
 		bool m_isRunning;
 
@@ -112,5 +190,11 @@ namespace Engine
 		std::mutex m_nodeExecutionMutex;
 		std::condition_variable m_nodeExecutionCv;
 		SafeQueue<std::shared_ptr<RenderNode>> m_executionNodeQueue;
+
+		// Recorded command buffers of current frame
+		std::vector<std::shared_ptr<DrawingCommandBuffer>> m_recordedCommandBuffers; // By submit priority
+		std::atomic<uint32_t> m_recordedNodeCount;
+		std::promise<void> m_recordingFinishedPromise; // Fulfilled by the last node that finishes recording
+		std::future<void> m_recordingFinishedFuture;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,8 @@
+#pragma once
+#include <cstdint>
+
+namespace Engine
+{
+	// Builds a synthetic graph where every node reads outputs of earlier nodes, and compares per-frame input lookups by name and by compiled handle
+	extern void RunRenderGraphResourceBenchmark(uint32_t nodeCount, uint32_t inputsPerNode, uint32_t frameCount);
+}
\ No newline at end of file
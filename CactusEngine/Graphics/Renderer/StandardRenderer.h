@@ -18,13 +18,5 @@ namespace Engine
 
 	private:
 		std::shared_ptr<RenderGraphResource> m_pGraphResources;
-
-		std::unordered_map<uint32_t, std::shared_ptr<DrawingCommandBuffer>> m_commandRecordReadyList; // Submit Priority - Recorded Command Buffer
-		std::unordered_map<uint32_t, bool> m_commandRecordReadyListFlag; // Submit Priority - Ready to submit or has been submitted
-
-		std::mutex m_commandRecordListWriteMutex;
-		std::condition_variable m_commandRecordListCv;
-		std::queue<uint32_t> m_writtenCommandPriorities;
-		bool m_newCommandRecorded;
 	};
 }
\ No newline at end of file
@@ -36,10 +36,29 @@ namespace Engine
 		COUNT
 	};
 
+	// Material features that are resolved when building pipeline variants instead of being branched on at runtime
+	// The enum value is used as specialization constant ID in shaders
+	enum class EMaterialFeature
+	{
+		AlbedoTexture = 0,
+		NormalTexture,
+		ToneTexture,
+		AlphaTest,
+		ReceiveShadow,
+		COUNT
+	};
+
+	typedef uint32_t MaterialFeatureKey; // One bit per EMaterialFeature
+
+	inline MaterialFeatureKey MaterialFeatureBit(EMaterialFeature feature)
+	{
+		return 1u << (uint32_t)feature;
+	}
+
 	// Uniform block structures
-	// Alert: the alignment should be set according to min device uniform buffer alignment requirement
+	// Sizes follow std140, which rounds blocks up to vec4 alignment; sub buffers are placed at device offset alignment by uniform buffers themselves
 
-	static const size_t UNIFORM_BUFFER_ALIGNMENT_CE = 64;
+	static const size_t UNIFORM_BUFFER_ALIGNMENT_CE = 16;
 
 	struct alignas(UNIFORM_BUFFER_ALIGNMENT_CE) UBTransformMatrices
 	{
@@ -47,6 +66,8 @@ namespace Engine
 		Matrix4x4 viewMatrix;
 		Matrix4x4 projectionMatrix;
 		Matrix4x4 normalMatrix;
+		Vector4 positionScale; // Decodes vertex positions of the mesh being drawn, see VertexBuffer::GetPositionScale
+		Vector4 positionOffset;
 	};
 
 	struct alignas(UNIFORM_BUFFER_ALIGNMENT_CE) UBLightSpaceTransformMatrix
@@ -76,7 +97,8 @@ namespace Engine
 
 	struct alignas(UNIFORM_BUFFER_ALIGNMENT_CE) UBControlVariables
 	{
-		int bool_1;
+		int					bool_1;
+		alignas(8) Vector2	texelSize; // std140 aligns vec2 to 8 bytes, only read by depth of field shader
 	};
 
 	struct alignas(UNIFORM_BUFFER_ALIGNMENT_CE) UBLightSourceProperties
@@ -1,4 +1,5 @@
 #include "DrawingResources.h"
+#include "DrawingDevice.h"
 
 using namespace Engine;
 
@@ -35,50 +36,74 @@ uint32_t FrameBuffer::GetHeight() const
 	return m_height;
 }
 
-std::vector<float> VertexBufferCreateInfo::ConvertToInterleavedData() const
+uint32_t VertexBufferCreateInfo::GetInterleavedStride() const
 {
-	unsigned int elementStride = 14;
-	std::vector<float> interleavedVertices(elementStride * (size_t)(positionDataCount / 3));
-
-	// Layout : [ position | normal | texcoord | tangent | bitengent ]
-
-	// TODO: optimize this process
+	return vertexFormat == EVertexFormat::Compact ? compactInterleavedStride : interleavedStride;
+}
 
-	for (uint32_t i = 0; i < positionDataCount / 3; i++)
-	{
-		interleavedVertices[(size_t)elementStride * i] = pPositionData[i * 3];
-		interleavedVertices[(size_t)elementStride * i + 1] = pPositionData[i * 3 + 1];
-		interleavedVertices[(size_t)elementStride * i + 2] = pPositionData[i * 3 + 2];
-	}
+void VertexBufferCreateInfo::ComputePositionDequantization()
+{
+	positionDecodeScale = Vector3(1);
+	positionDecodeOffset = Vector3(0);
 
-	for (uint32_t i = 0; i < normalDataCount / 3; i++)
+	if (vertexFormat != EVertexFormat::Compact || positionDataCount < 3)
 	{
-		interleavedVertices[(size_t)elementStride * i + 3] = pNormalData[i * 3];
-		interleavedVertices[(size_t)elementStride * i + 4] = pNormalData[i * 3 + 1];
-		interleavedVertices[(size_t)elementStride * i + 5] = pNormalData[i * 3 + 2];
+		return;
 	}
 
-	for (uint32_t i = 0; i < texcoordDataCount / 2; i++)
-	{
-		interleavedVertices[(size_t)elementStride * i + 6] = pTexcoordData[i * 2];
-		interleavedVertices[(size_t)elementStride * i + 7] = pTexcoordData[i * 2 + 1];
-	}
+	Vector3 minPoint(pPositionData[0], pPositionData[1], pPositionData[2]);
+	Vector3 maxPoint = minPoint;
 
-	for (uint32_t i = 0; i < tangentDataCount / 3; i++)
+	for (uint32_t i = 3; i + 2 < positionDataCount; i += 3)
 	{
-		interleavedVertices[(size_t)elementStride * i + 8] = pTangentData[i * 3];
-		interleavedVertices[(size_t)elementStride * i + 9] = pTangentData[i * 3 + 1];
-		interleavedVertices[(size_t)elementStride * i + 10] = pTangentData[i * 3 + 2];
+		Vector3 position(pPositionData[i], pPositionData[i + 1], pPositionData[i + 2]);
+		minPoint = glm::min(minPoint, position);
+		maxPoint = glm::max(maxPoint, position);
 	}
 
-	for (uint32_t i = 0; i < bitangentDataCount / 3; i++)
-	{
-		interleavedVertices[(size_t)elementStride * i + 11] = pBitangentData[i * 3];
-		interleavedVertices[(size_t)elementStride * i + 12] = pBitangentData[i * 3 + 1];
-		interleavedVertices[(size_t)elementStride * i + 13] = pBitangentData[i * 3 + 2];
-	}
+	// Flat axis gets zero scale, all of its positions then decode to the offset
+	positionDecodeScale = maxPoint - minPoint;
+	positionDecodeOffset = minPoint;
+}
 
-	return interleavedVertices;
+PipelineVertexInputStateCreateInfo VertexBufferCreateInfo::GetVertexInputStateCreateInfo(EVertexFormat format)
+{
+	bool isCompact = format == EVertexFormat::Compact;
+
+	VertexInputBindingDescription vertexInputBindingDesc = {};
+	vertexInputBindingDesc.binding = 0;
+	vertexInputBindingDesc.stride = isCompact ? compactInterleavedStride : interleavedStride;
+	vertexInputBindingDesc.inputRate = EVertexInputRate::PerVertex;
+
+	VertexInputAttributeDescription positionAttributeDesc = {};
+	positionAttributeDesc.binding = vertexInputBindingDesc.binding;
+	positionAttributeDesc.location = DrawingDevice::ATTRIB_POSITION_LOCATION;
+	positionAttributeDesc.offset = positionOffset;
+	positionAttributeDesc.format = isCompact ? ETextureFormat::RGBA16_UNORM : ETextureFormat::RGB32F;
+
+	VertexInputAttributeDescription normalAttributeDesc = {};
+	normalAttributeDesc.binding = vertexInputBindingDesc.binding;
+	normalAttributeDesc.location = DrawingDevice::ATTRIB_NORMAL_LOCATION;
+	normalAttributeDesc.offset = isCompact ? compactNormalOffset : normalOffset;
+	normalAttributeDesc.format = isCompact ? ETextureFormat::RG16_SNORM : ETextureFormat::RG32F;
+
+	VertexInputAttributeDescription texcoordAttributeDesc = {};
+	texcoordAttributeDesc.binding = vertexInputBindingDesc.binding;
+	texcoordAttributeDesc.location = DrawingDevice::ATTRIB_TEXCOORD_LOCATION;
+	texcoordAttributeDesc.offset = isCompact ? compactTexcoordOffset : texcoordOffset;
+	texcoordAttributeDesc.format = isCompact ? ETextureFormat::RG16F : ETextureFormat::RG32F;
+
+	VertexInputAttributeDescription tangentAttributeDesc = {};
+	tangentAttributeDesc.binding = vertexInputBindingDesc.binding;
+	tangentAttributeDesc.location = DrawingDevice::ATTRIB_TANGENT_LOCATION;
+	tangentAttributeDesc.offset = isCompact ? compactTangentOffset : tangentOffset;
+	tangentAttributeDesc.format = isCompact ? ETextureFormat::RGBA8_SNORM : ETextureFormat::RGB32F;
+
+	PipelineVertexInputStateCreateInfo vertexInputStateCreateInfo = {};
+	vertexInputStateCreateInfo.bindingDescs = { vertexInputBindingDesc };
+	vertexInputStateCreateInfo.attributeDescs = { positionAttributeDesc, normalAttributeDesc, texcoordAttributeDesc, tangentAttributeDesc };
+
+	return vertexInputStateCreateInfo;
 }
 
 void VertexBuffer::SetNumberOfIndices(uint32_t count)
@@ -91,6 +116,65 @@ uint32_t VertexBuffer::GetNumberOfIndices() const
 	return m_numberOfIndices;
 }
 
+void VertexBuffer::SetPositionDequantization(const Vector3& scale, const Vector3& offset)
+{
+	m_positionScale = scale;
+	m_positionOffset = offset;
+}
+
+Vector3 VertexBuffer::GetPositionScale() const
+{
+	return m_positionScale;
+}
+
+Vector3 VertexBuffer::GetPositionOffset() const
+{
+	return m_positionOffset;
+}
+
+bool Texture2DCreateInfo::IsBlockCompressed(ETextureFormat format)
+{
+	switch (format)
+	{
+	case ETextureFormat::BC1_SRGB:
+	case ETextureFormat::BC3_SRGB:
+	case ETextureFormat::BC4_UNORM:
+	case ETextureFormat::BC5_UNORM:
+	case ETextureFormat::BC7_SRGB:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+size_t Texture2DCreateInfo::GetLevelDataSize(ETextureFormat format, uint32_t width, uint32_t height)
+{
+	size_t blockCount = (size_t)((width + 3) / 4) * ((height + 3) / 4);
+	size_t texelCount = (size_t)width * height;
+
+	switch (format)
+	{
+	case ETextureFormat::BC1_SRGB:
+	case ETextureFormat::BC4_UNORM:
+		return blockCount * 8;
+
+	case ETextureFormat::BC3_SRGB:
+	case ETextureFormat::BC5_UNORM:
+	case ETextureFormat::BC7_SRGB:
+		return blockCount * 16;
+
+	case ETextureFormat::RGBA32F:
+		return texelCount * 16;
+
+	case ETextureFormat::RGBA16F:
+		return texelCount * 8;
+
+	default:
+		return texelCount * 4;
+	}
+}
+
 Texture2D::Texture2D(ETexture2DSource source)
 	: m_source(source), m_height(0), m_width(0), m_type(ETextureType::SampledImage)
 {
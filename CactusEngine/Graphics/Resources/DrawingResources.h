@@ -32,10 +32,14 @@ namespace Engine
 		static uint32_t m_assignedID;
 	};
 
+	struct PipelineVertexInputStateCreateInfo;
 	struct VertexBufferCreateInfo
 	{
+		EVertexFormat vertexFormat;
+
 		int*	 pIndexData;
 		uint32_t indexDataCount;
+		bool	 useShortIndices; // Indices are stored as 16-bit, they are relative to base vertex of each submesh so only submeshes need to stay under 65536 vertices
 
 		float*	 pPositionData;
 		uint32_t positionDataCount;
@@ -47,19 +51,35 @@ namespace Engine
 
 		float*	 pTexcoordData;
 		uint32_t texcoordDataCount;
-		static const uint32_t texcoordOffset = 6 * sizeof(float);
+		static const uint32_t texcoordOffset = 5 * sizeof(float);
 
 		float*	 pTangentData;
 		uint32_t tangentDataCount;
-		static const uint32_t tangentOffset = 8 * sizeof(float);
+		static const uint32_t tangentOffset = 7 * sizeof(float);
 
-		float*	 pBitangentData;
+		float*	 pBitangentData; // Only its handedness is stored, as sign following the tangent
 		uint32_t bitangentDataCount;
-		static const uint32_t bitangentOffset = 11 * sizeof(float);
 
-		static const uint32_t interleavedStride = 14 * sizeof(float); // 3 + 3 + 2 + 3 + 3
+		const uint32_t* pVertexRemap; // Optional, output vertex i reads attributes of source vertex pVertexRemap[i]
+
+		// Shaders decode position as stored position * scale + offset, compact format stores positions normalized to mesh bounds
+		Vector3 positionDecodeScale;
+		Vector3 positionDecodeOffset;
+
+		// Normal and tangent are octahedral encoded into 2 components each
+		static const uint32_t interleavedStride = 10 * sizeof(float); // 3 + 2 + 2 + 3
+
+		// Position takes 4 unsigned shorts, normal 2 shorts, texcoord 2 half floats and tangent 4 bytes
+		static const uint32_t compactNormalOffset = 4 * sizeof(uint16_t);
+		static const uint32_t compactTexcoordOffset = compactNormalOffset + 2 * sizeof(int16_t);
+		static const uint32_t compactTangentOffset = compactTexcoordOffset + 2 * sizeof(uint16_t);
+		static const uint32_t compactInterleavedStride = compactTangentOffset + 4;
 
-		std::vector<float> ConvertToInterleavedData() const; // This would not pack index
+		uint32_t GetInterleavedStride() const; // Interleaved data is written by VertexStreamBuilder
+		void ComputePositionDequantization(); // Fills position decode scale and offset from position stream, according to vertex format
+
+		// Single interleaved binding at binding 0 for vertex buffers created with given format
+		static PipelineVertexInputStateCreateInfo GetVertexInputStateCreateInfo(EVertexFormat format);
 	};
 
 	class VertexBuffer : public RawResource
@@ -67,12 +87,17 @@ namespace Engine
 	public:
 		void SetNumberOfIndices(uint32_t count);
 		uint32_t GetNumberOfIndices() const;
+		void SetPositionDequantization(const Vector3& scale, const Vector3& offset);
+		Vector3 GetPositionScale() const;
+		Vector3 GetPositionOffset() const;
 
 	protected:
 		VertexBuffer() = default;
 
 	protected:
 		uint32_t m_numberOfIndices;
+		Vector3 m_positionScale = Vector3(1);
+		Vector3 m_positionOffset = Vector3(0);
 	};
 
 	struct TextureSamplerCreateInfo
@@ -97,6 +122,7 @@ namespace Engine
 		TextureSampler() = default;
 	};
 
+	class Texture2D;
 	struct Texture2DCreateInfo
 	{
 		const void*	   pTextureData;
@@ -106,10 +132,18 @@ namespace Engine
 		ETextureFormat format;
 		ETextureType   textureType;
 		bool		   generateMipmap;
+		uint32_t	   mipLevels; // Levels provided in texture data, tightly packed from the largest one, 0 is treated as 1
 		std::shared_ptr<TextureSampler> pSampler;
 		EImageLayout   initialLayout;
 
 		EGPUType	   deviceType;
+
+		std::shared_ptr<Texture2D> pAliasTexture; // Shares device memory with this texture if possible, their lifetimes must not overlap
+		bool		   isTransientAttachment;	  // Content never leaves the render pass, so it can't be sampled
+
+		static bool IsBlockCompressed(ETextureFormat format);
+		// Block compressed levels are padded to whole 4x4 blocks
+		static size_t GetLevelDataSize(ETextureFormat format, uint32_t width, uint32_t height);
 	};
 
 	enum class ETexture2DSource
@@ -239,6 +273,7 @@ namespace Engine
 	struct UniformBufferCreateInfo
 	{
 		uint32_t sizeInBytes;
+		uint32_t subBufferCount; // Sub buffers of sizeInBytes that can be allocated per frame, 0 if the buffer is only updated as a whole
 
 		EGPUType deviceType;
 		uint32_t appliedStages; // Bitmask, required for push constant
@@ -323,7 +358,7 @@ namespace Engine
 		// For high-level APIs like OpenGL
 		struct ShaderParameterTableEntry
 		{
-			ShaderParameterTableEntry(unsigned int binding, EDescriptorType descType, const std::shared_ptr<RawResource> pRes)
+			ShaderParameterTableEntry(unsigned int binding, EDescriptorType descType, const std::shared_ptr<RawResource>& pRes)
 				: binding(binding), type(descType), pResource(pRes)
 			{
 			}
@@ -335,7 +370,7 @@ namespace Engine
 
 		std::vector<ShaderParameterTableEntry> m_table;
 
-		void AddEntry(unsigned int binding, EDescriptorType descType, const std::shared_ptr<RawResource> pRes)
+		void AddEntry(unsigned int binding, EDescriptorType descType, const std::shared_ptr<RawResource>& pRes)
 		{
 			m_table.emplace_back(binding, descType, pRes);
 		}
@@ -477,6 +512,7 @@ namespace Engine
 		std::shared_ptr<PipelineMultisampleState>	pMultisampleState;
 		std::shared_ptr<PipelineViewportState>		pViewportState;
 		std::shared_ptr<RenderPassObject>			pRenderPass;
+		uint32_t									featureKey; // Bit i sets boolean specialization constant i in all shader stages, see EMaterialFeature
 		//uint32_t									subpassIndex; // TODO: add subpass support
 	};
 
@@ -1,7 +1,11 @@
 #include "ExternalMesh.h"
 #include "Global.h"
 #include "GraphicsApplication.h"
+#include "MeshCache.h"
+#include "MeshSimplifier.h"
 #include <iostream>
+#include <sstream>
+#include <algorithm>
 // Integration with Assimp
 #include <assimp/scene.h>
 #include <assimp/Importer.hpp>
@@ -9,20 +13,83 @@
 
 using namespace Engine;
 
-static Assimp::Importer gImporter;
+const uint32_t ExternalMesh::IMPORT_FLAGS = aiProcessPreset_TargetRealtime_Quality | aiProcess_PreTransformVertices | aiProcess_FlipUVs;
 
-ExternalMesh::ExternalMesh(const char* filePath)
+ExternalMesh::ExternalMesh(const char* filePath, bool deferDeviceResources)
 	: Mesh(std::dynamic_pointer_cast<GraphicsApplication>(gpGlobal->GetCurrentApplication())->GetDrawingDevice())
 {
-	LoadMeshFromFile(filePath);
+	ImportMeshFromFile(filePath);
+
+	if (!deferDeviceResources)
+	{
+		CreateDeviceResources();
+	}
 }
 
-void ExternalMesh::LoadMeshFromFile(const char* filePath)
+void ExternalMesh::CreateDeviceResources()
 {
-	// Load model with Assimp importer
+	if (!m_pImportedData)
+	{
+		return;
+	}
+
+	CreateVertexBuffer(m_pImportedData->createInfo);
+	m_pImportedData = nullptr;
+}
+
+bool ExternalMesh::HasPendingDeviceResources() const
+{
+	return m_pImportedData != nullptr;
+}
+
+size_t ExternalMesh::GetPendingDataSize() const
+{
+	if (!m_pImportedData)
+	{
+		return 0;
+	}
+
+	const VertexBufferCreateInfo& createInfo = m_pImportedData->createInfo;
+	return sizeof(float) * ((size_t)createInfo.positionDataCount + createInfo.normalDataCount + createInfo.texcoordDataCount + createInfo.tangentDataCount + createInfo.bitangentDataCount)
+		+ sizeof(int) * (size_t)createInfo.indexDataCount;
+}
+
+void ExternalMesh::ImportMeshFromFile(const char* filePath)
+{
+	m_filePath.assign(filePath);
+	m_type = EBuiltInMeshType::External;
+
+	uint32_t processingFlags = MESH_PROCESSING_VERSION;
+	if (gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetMeshOverdrawOptimization())
+	{
+		processingFlags |= MESH_PROCESSING_OVERDRAW_BIT;
+	}
+
+	// Cached meshes are fed to vertex buffer creation straight from mapped file, without going through Assimp
+	MeshCacheKey cacheKey = {};
+	bool hasCacheKey = MeshCache::QuerySourceKey(filePath, IMPORT_FLAGS, processingFlags, cacheKey);
+
+	if (hasCacheKey)
+	{
+		auto pCachedData = std::make_unique<ImportedMeshData>();
+		if (pCachedData->meshCache.Open(MeshCache::GetCacheFilePath(filePath), cacheKey))
+		{
+			m_subMeshes = pCachedData->meshCache.GetSubMeshes();
+			m_lods = pCachedData->meshCache.GetLODs();
+			m_clusters.Assign(pCachedData->meshCache.GetClusters().data(), pCachedData->meshCache.GetClusters().size());
+			m_bounds = pCachedData->meshCache.GetBounds();
+
+			pCachedData->createInfo = pCachedData->meshCache.GetVertexBufferCreateInfo();
+			BuildOccluderGeometry(pCachedData->createInfo.pPositionData, nullptr, pCachedData->createInfo.pIndexData);
+			m_pImportedData = std::move(pCachedData);
+			return;
+		}
+	}
 
-	// Alert: check these import flags when models seem incorrect
-	const aiScene* scene = gImporter.ReadFile(filePath, aiProcessPreset_TargetRealtime_Quality | aiProcess_PreTransformVertices | aiProcess_FlipUVs);
+	// Load model with Assimp importer, one importer per load so that meshes can be imported on several threads at once
+
+	Assimp::Importer importer;
+	const aiScene* scene = importer.ReadFile(filePath, IMPORT_FLAGS);
 
 	if (!scene)
 	{
@@ -118,7 +185,225 @@ void ExternalMesh::LoadMeshFromFile(const char* filePath)
 		}
 	}
 
-	m_filePath.assign(filePath);
-	m_type = EBuiltInMeshType::External;
-	CreateVertexBufferFromVertices(vertices, normals, texcoords, tangents, bitangents, indices);
+	// Bounds are computed before optimization rewrites indices into the remapped vertex order
+	ComputeBounds(vertices.data(), indices.data());
+
+	// Coarser levels are simplified from the imported order, and follow the vertex order chosen for the full-detail level below
+	std::vector<std::vector<std::vector<int>>> lodIndices;
+	GenerateLODs(indices, vertices, (unsigned int)totalNumVertices, lodIndices);
+
+	// Submesh indices are relative to their base vertex, so each of them is optimized on its own
+	// Vertices are not moved here, the reordering is applied when they are interleaved into vertex buffer
+	std::vector<uint32_t> vertexRemap(totalNumVertices);
+	for (uint32_t i = 0; i < totalNumVertices; ++i)
+	{
+		vertexRemap[i] = i;
+	}
+
+	bool useShortIndices = true;
+	std::vector<MeshCluster> clusters;
+	MeshCacheStatistics statisticsBefore = {};
+	MeshCacheStatistics statisticsAfter = {};
+
+	for (int i = 0; i < totalNumSubMeshes; ++i)
+	{
+		unsigned int numVertices = scene->mMeshes[i]->mNumVertices;
+		unsigned int baseVertex = m_subMeshes[i].m_baseVertex;
+
+		if (m_subMeshes[i].m_numIndices == 0)
+		{
+			continue;
+		}
+
+		int* pSubMeshIndices = &indices[m_subMeshes[i].m_baseIndex];
+
+		for (auto& levelIndices : lodIndices)
+		{
+			auto& subMeshLODIndices = levelIndices[i];
+			MeshOptimizer::OptimizeVertexCache(subMeshLODIndices.data(), (uint32_t)subMeshLODIndices.size(), numVertices);
+			if (gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetMeshOverdrawOptimization())
+			{
+				MeshOptimizer::OptimizeOverdraw(subMeshLODIndices.data(), (uint32_t)subMeshLODIndices.size(), &vertices[(size_t)baseVertex * 3], numVertices, OVERDRAW_CACHE_THRESHOLD);
+			}
+		}
+
+		OptimizeSubMesh(pSubMeshIndices, m_subMeshes[i].m_numIndices, numVertices, baseVertex, vertices.data(), vertexRemap.data(), statisticsBefore, statisticsAfter);
+
+		// Clusters follow the final triangle order, so they must be built after optimization
+		m_subMeshes[i].m_firstCluster = (unsigned int)clusters.size();
+		MeshClusterBuilder::Build(pSubMeshIndices, m_subMeshes[i].m_numIndices, m_subMeshes[i].m_baseIndex, baseVertex, vertices.data(), vertexRemap.data(), clusters);
+		m_subMeshes[i].m_clusterCount = (unsigned int)clusters.size() - m_subMeshes[i].m_firstCluster;
+
+		if (!lodIndices.empty())
+		{
+			std::vector<int> newVertexIndices(numVertices);
+			for (unsigned int j = 0; j < numVertices; ++j)
+			{
+				newVertexIndices[vertexRemap[baseVertex + j] - baseVertex] = (int)j;
+			}
+
+			for (auto& levelIndices : lodIndices)
+			{
+				for (int& index : levelIndices[i])
+				{
+					index = newVertexIndices[index];
+				}
+			}
+		}
+
+		useShortIndices &= numVertices < 65536;
+	}
+
+#if defined(_DEBUG)
+	std::cout << "Mesh optimization: " << filePath << ", ACMR " << statisticsBefore.transformedVertices / float(totalNumIndices / 3)
+		<< " -> " << statisticsAfter.transformedVertices / float(totalNumIndices / 3) << ", " << (useShortIndices ? 16 : 32) << "-bit indices, " << clusters.size() << " clusters" << std::endl;
+#endif
+
+	m_clusters.Assign(clusters.data(), clusters.size());
+
+	// Coarser levels are appended after the full-detail indices, level by level
+	for (size_t lod = 0; lod < lodIndices.size(); ++lod)
+	{
+		for (size_t i = 0; i < totalNumSubMeshes; ++i)
+		{
+			m_lods[lod].subMeshes[i].m_baseIndex = (unsigned int)indices.size();
+			indices.insert(indices.end(), lodIndices[lod][i].begin(), lodIndices[lod][i].end());
+		}
+	}
+
+	BuildOccluderGeometry(vertices.data(), vertexRemap.data(), indices.data());
+
+	// Imported data is kept until device resources are created
+	m_pImportedData = std::make_unique<ImportedMeshData>();
+	m_pImportedData->indices = std::move(indices);
+	m_pImportedData->positions = std::move(vertices);
+	m_pImportedData->normals = std::move(normals);
+	m_pImportedData->texcoords = std::move(texcoords);
+	m_pImportedData->tangents = std::move(tangents);
+	m_pImportedData->bitangents = std::move(bitangents);
+	m_pImportedData->vertexRemap = std::move(vertexRemap);
+
+	VertexBufferCreateInfo& createInfo = m_pImportedData->createInfo;
+
+	createInfo.pIndexData = m_pImportedData->indices.data();
+	createInfo.indexDataCount = static_cast<uint32_t>(m_pImportedData->indices.size());
+	createInfo.useShortIndices = useShortIndices;
+	createInfo.pPositionData = m_pImportedData->positions.data();
+	createInfo.positionDataCount = static_cast<uint32_t>(m_pImportedData->positions.size());
+	createInfo.pNormalData = m_pImportedData->normals.data();
+	createInfo.normalDataCount = static_cast<uint32_t>(m_pImportedData->normals.size());
+	createInfo.pTexcoordData = m_pImportedData->texcoords.data();
+	createInfo.texcoordDataCount = static_cast<uint32_t>(m_pImportedData->texcoords.size());
+	createInfo.pTangentData = m_pImportedData->tangents.data();
+	createInfo.tangentDataCount = static_cast<uint32_t>(m_pImportedData->tangents.size());
+	createInfo.pBitangentData = m_pImportedData->bitangents.data();
+	createInfo.bitangentDataCount = static_cast<uint32_t>(m_pImportedData->bitangents.size());
+	createInfo.pVertexRemap = m_pImportedData->vertexRemap.data();
+
+	if (hasCacheKey && !MeshCache::Write(MeshCache::GetCacheFilePath(filePath), cacheKey, createInfo, m_subMeshes, m_lods, clusters, m_bounds))
+	{
+		std::cerr << "Failed to write mesh cache: " << filePath << std::endl;
+	}
+}
+
+void ExternalMesh::GenerateLODs(const std::vector<int>& indices, const std::vector<float>& positions, unsigned int totalNumVertices, std::vector<std::vector<std::vector<int>>>& outLODIndices)
+{
+	m_lods.clear();
+	outLODIndices.clear();
+
+	std::vector<std::vector<int>> previousIndices(m_subMeshes.size());
+	size_t previousTriangleCount = 0;
+	for (size_t i = 0; i < m_subMeshes.size(); ++i)
+	{
+		previousIndices[i].assign(indices.begin() + m_subMeshes[i].m_baseIndex, indices.begin() + m_subMeshes[i].m_baseIndex + m_subMeshes[i].m_numIndices);
+		previousTriangleCount += m_subMeshes[i].m_numIndices / 3;
+	}
+
+#if defined(_DEBUG)
+	static const bool simplifierChecked = MeshSimplifier::SelfCheck(); // Once per run, failures are reported by the check itself
+	(void)simplifierChecked;
+
+	std::stringstream triangleCounts;
+	triangleCounts << previousTriangleCount;
+#endif
+
+	float previousError = 0.0f;
+	while (m_lods.size() + 1 < MAX_LOD_COUNT)
+	{
+		MeshLOD lod = {};
+		lod.subMeshes = m_subMeshes;
+		lod.error = previousError;
+
+		std::vector<std::vector<int>> levelIndices(m_subMeshes.size());
+		size_t triangleCount = 0;
+
+		// Each level is simplified from the previous one, so errors add up
+		for (size_t i = 0; i < m_subMeshes.size(); ++i)
+		{
+			unsigned int baseVertex = m_subMeshes[i].m_baseVertex;
+			unsigned int numVertices = (i + 1 < m_subMeshes.size() ? m_subMeshes[i + 1].m_baseVertex : totalNumVertices) - baseVertex;
+			const std::vector<int>& sourceIndices = previousIndices[i];
+
+			if (sourceIndices.size() / 3 < MIN_LOD_TRIANGLES)
+			{
+				levelIndices[i] = sourceIndices;
+			}
+			else
+			{
+				uint32_t targetIndexCount = (uint32_t)(sourceIndices.size() / 6 * 3);
+				float error = MeshSimplifier::Simplify(sourceIndices.data(), (uint32_t)sourceIndices.size(), &positions[(size_t)baseVertex * 3], numVertices, targetIndexCount, levelIndices[i]);
+				lod.error = std::max(lod.error, previousError + error);
+			}
+
+			lod.subMeshes[i].m_numIndices = (unsigned int)levelIndices[i].size();
+			triangleCount += levelIndices[i].size() / 3;
+		}
+
+		if (triangleCount > previousTriangleCount * MIN_LOD_REDUCTION)
+		{
+			break;
+		}
+
+#if defined(_DEBUG)
+		triangleCounts << " / " << triangleCount;
+#endif
+
+		m_lods.emplace_back(lod);
+		outLODIndices.emplace_back(levelIndices);
+		previousIndices = std::move(levelIndices);
+		previousTriangleCount = triangleCount;
+		previousError = lod.error;
+	}
+
+#if defined(_DEBUG)
+	std::cout << "Mesh LODs: " << m_filePath << ", triangles " << triangleCounts.str() << ", coarsest error " << previousError << std::endl;
+#endif
+}
+
+void ExternalMesh::OptimizeSubMesh(int* pIndices, unsigned int numIndices, unsigned int numVertices, unsigned int baseVertex, const float* pPositions, uint32_t* pVertexRemap,
+	MeshCacheStatistics& statisticsBefore, MeshCacheStatistics& statisticsAfter)
+{
+	// Statistics are only reported in debug builds
+#if defined(_DEBUG)
+	statisticsBefore.transformedVertices += MeshOptimizer::AnalyzeVertexCache(pIndices, numIndices, numVertices).transformedVertices;
+#endif
+
+	MeshOptimizer::OptimizeVertexCache(pIndices, numIndices, numVertices);
+
+	if (gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetMeshOverdrawOptimization())
+	{
+		MeshOptimizer::OptimizeOverdraw(pIndices, numIndices, &pPositions[baseVertex * 3], numVertices, OVERDRAW_CACHE_THRESHOLD);
+	}
+
+	std::vector<uint32_t> remap;
+	MeshOptimizer::OptimizeVertexFetch(pIndices, numIndices, numVertices, remap);
+
+	for (unsigned int i = 0; i < numVertices; ++i)
+	{
+		pVertexRemap[baseVertex + i] = baseVertex + remap[i];
+	}
+
+#if defined(_DEBUG)
+	statisticsAfter.transformedVertices += MeshOptimizer::AnalyzeVertexCache(pIndices, numIndices, numVertices).transformedVertices;
+#endif
 }
\ No newline at end of file
@@ -1,15 +1,55 @@
 #pragma once
 #include "Mesh.h"
+#include "MeshOptimizer.h"
+#include "MeshCache.h"
 
 namespace Engine
 {
 	class ExternalMesh : public Mesh
 	{
 	public:
-		ExternalMesh(const char* filePath);
+		// Import may run on any thread, while deferred device resources must be created later on the thread owning the device
+		ExternalMesh(const char* filePath, bool deferDeviceResources = false);
 		~ExternalMesh() = default;
 
+		void CreateDeviceResources();
+		bool HasPendingDeviceResources() const;
+		size_t GetPendingDataSize() const; // Size of imported data waiting to be uploaded, in bytes
+
+	private:
+		// Either owns the imported streams or keeps the mesh cache they are mapped from
+		struct ImportedMeshData
+		{
+			MeshCache			   meshCache;
+			std::vector<int>	   indices;
+			std::vector<float>	   positions;
+			std::vector<float>	   normals;
+			std::vector<float>	   texcoords;
+			std::vector<float>	   tangents;
+			std::vector<float>	   bitangents;
+			std::vector<uint32_t>  vertexRemap;
+			VertexBufferCreateInfo createInfo = {};
+		};
+
+		void ImportMeshFromFile(const char* filePath);
+		// Each level halves the triangles of the previous one, chain ends once simplification stops paying off
+		// Levels are indexed by [lod - 1][submesh], and refer to vertices in imported order like the full-detail indices
+		void GenerateLODs(const std::vector<int>& indices, const std::vector<float>& positions, unsigned int totalNumVertices, std::vector<std::vector<std::vector<int>>>& outLODIndices);
+		// Positions and vertex remap cover the whole mesh, vertex remap of the submesh range is filled for its new vertex order
+		void OptimizeSubMesh(int* pIndices, unsigned int numIndices, unsigned int numVertices, unsigned int baseVertex, const float* pPositions, uint32_t* pVertexRemap,
+			MeshCacheStatistics& statisticsBefore, MeshCacheStatistics& statisticsAfter);
+
 	private:
-		void LoadMeshFromFile(const char* filePath);
+		// Alert: check these import flags when models seem incorrect
+		static const uint32_t IMPORT_FLAGS;
+		// Bump the version whenever post-import processing changes, so that stale mesh caches are rebuilt
+		static const uint32_t MESH_PROCESSING_VERSION = 3;
+		static const uint32_t MESH_PROCESSING_OVERDRAW_BIT = 1u << 31;
+
+		const float OVERDRAW_CACHE_THRESHOLD = 1.05f;
+		const float MIN_LOD_REDUCTION = 0.75f; // Level with more triangles than this fraction of the previous one is dropped and ends the chain
+		static const uint32_t MIN_LOD_TRIANGLES = 64; // Smaller submeshes are kept as they are in coarser levels
+
+		std::unique_ptr<ImportedMeshData> m_pImportedData;
 	};
 }
\ No newline at end of file
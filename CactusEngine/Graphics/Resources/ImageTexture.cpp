@@ -2,19 +2,42 @@
 #include "DrawingDevice.h"
 #include "Global.h"
 #include "GraphicsApplication.h"
+#include "TextureCooker.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb/stb_image.h>
 
 using namespace Engine;
 
-ImageTexture::ImageTexture(const char* filePath, EGPUType deviceType)
-	: Texture2D(ETexture2DSource::ImageTexture)
+ImageTexture::ImportedImageData::~ImportedImageData()
 {
-	LoadAndCreateTexture(filePath, deviceType);
+	if (pDecodedPixels)
+	{
+		stbi_image_free(pDecodedPixels);
+	}
 }
 
-void ImageTexture::LoadAndCreateTexture(const char* filePath, EGPUType deviceType)
+ImageTexture::ImageTexture(const char* filePath, EGPUType deviceType, bool deferDeviceResources, ETextureContent content, bool streamMips)
+	: Texture2D(ETexture2DSource::ImageTexture), m_deviceType(deviceType), m_streamMips(false), m_residentMip(0), m_requestedMip(0)
+{
+	LoadImageData(filePath, content);
+
+	// Only precomputed levels can be streamed, mipmap generated on device needs the full image
+	m_streamMips = streamMips && m_pImportedData->mipLevels > 0
+		&& gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetTextureStreamingBudget() > 0;
+	if (m_streamMips)
+	{
+		m_residentMip = GetTailMip();
+		m_requestedMip = m_residentMip;
+	}
+
+	if (!deferDeviceResources)
+	{
+		CreateDeviceResources();
+	}
+}
+
+void ImageTexture::LoadImageData(const char* filePath, ETextureContent content)
 {
 	m_pDevice = std::dynamic_pointer_cast<GraphicsApplication>(gpGlobal->GetCurrentApplication())->GetDrawingDevice();
 
@@ -24,10 +47,34 @@ void ImageTexture::LoadAndCreateTexture(const char* filePath, EGPUType deviceTyp
 		return;
 	}
 
+	m_filePath.assign(filePath);
+	m_pImportedData = std::make_unique<ImportedImageData>();
+
+	ETextureCompression compression = gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetTextureCompression();
+	if (compression != ETextureCompression::None && !m_pDevice->SupportTextureCompressionBC())
+	{
+		compression = ETextureCompression::None;
+	}
+
+	// Chosen format depends on image content, so only the settings are part of cache key
+	TextureCacheKey cacheKey = {};
+	std::string cacheFilePath = TextureCache::GetCacheFilePath(filePath);
+	bool hasCacheKey = compression != ETextureCompression::None
+		&& TextureCache::QuerySourceKey(filePath, (uint32_t)content | ((uint32_t)compression << 8), TextureCooker::COOK_VERSION, cacheKey);
+
+	if (hasCacheKey && m_pImportedData->textureCache.Open(cacheFilePath, cacheKey))
+	{
+		m_width = m_pImportedData->textureCache.GetWidth();
+		m_height = m_pImportedData->textureCache.GetHeight();
+		m_pImportedData->format = m_pImportedData->textureCache.GetFormat();
+		m_pImportedData->mipLevels = m_pImportedData->textureCache.GetMipLevels();
+		return;
+	}
+
 	int texWidth, texHeight, texChannels;
-	stbi_uc* imageData = stbi_load(filePath, &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+	unsigned char* pPixels = stbi_load(filePath, &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
 
-	if (!imageData)
+	if (!pPixels)
 	{
 		throw std::runtime_error("Failed to load texture image.");
 	}
@@ -35,21 +82,60 @@ void ImageTexture::LoadAndCreateTexture(const char* filePath, EGPUType deviceTyp
 	m_width = texWidth;
 	m_height = texHeight;
 
-	Texture2DCreateInfo createInfo = {};
-	createInfo.textureWidth = texWidth;
-	createInfo.textureHeight = texHeight;
-	createInfo.pTextureData = imageData;
-	createInfo.dataType = EDataType::UByte;
-	createInfo.format = ETextureFormat::RGBA8_SRGB; // Alert: this format might not be universal
-	createInfo.textureType = ETextureType::SampledImage;
-	createInfo.generateMipmap = true;
-	createInfo.initialLayout = EImageLayout::ShaderReadOnly;
-	createInfo.deviceType = deviceType;
+	if (compression == ETextureCompression::None)
+	{
+		m_pImportedData->pDecodedPixels = pPixels;
+		return;
+	}
 
-	m_pDevice->CreateTexture2D(createInfo, m_pTextureImpl);
+	m_pImportedData->format = TextureCooker::ChooseFormat(content, TextureCooker::HasAlpha(pPixels, m_width, m_height), compression);
+	m_pImportedData->mipLevels = TextureCooker::Cook(pPixels, m_width, m_height, content, m_pImportedData->format, m_pImportedData->cookedData);
+	stbi_image_free(pPixels);
 
-	m_filePath.assign(filePath);
-	stbi_image_free(imageData);
+	if (hasCacheKey && m_pImportedData->mipLevels <= TextureCache::MAX_MIP_LEVELS
+		&& TextureCache::Write(cacheFilePath, cacheKey, m_pImportedData->format, m_width, m_height, m_pImportedData->mipLevels, m_pImportedData->cookedData)
+		&& m_pImportedData->textureCache.Open(cacheFilePath, cacheKey))
+	{
+		// Levels are read back through the mapping from now on, streamed textures would otherwise hold the whole chain in memory
+		m_pImportedData->cookedData.clear();
+		m_pImportedData->cookedData.shrink_to_fit();
+	}
+}
+
+void ImageTexture::CreateDeviceResources()
+{
+	if (!m_pImportedData)
+	{
+		return;
+	}
+
+	CreateDeviceTexture(*m_pImportedData, m_residentMip, m_pTextureImpl);
+
+	if (m_streamMips)
+	{
+		m_pStreamingData = std::move(m_pImportedData);
+	}
+	m_pImportedData = nullptr;
+}
+
+bool ImageTexture::HasPendingDeviceResources() const
+{
+	return m_pImportedData != nullptr;
+}
+
+size_t ImageTexture::GetPendingDataSize() const
+{
+	if (!m_pImportedData)
+	{
+		return 0;
+	}
+
+	if (m_pImportedData->pDecodedPixels)
+	{
+		return 4 * (size_t)m_width * m_height;
+	}
+
+	return GetMipChainSize(m_residentMip);
 }
 
 std::shared_ptr<Texture2D> ImageTexture::GetTexture() const
@@ -57,6 +143,16 @@ std::shared_ptr<Texture2D> ImageTexture::GetTexture() const
 	return m_pTextureImpl;
 }
 
+uint32_t ImageTexture::GetSizeInByte() const
+{
+	uint32_t size = m_pTextureImpl ? m_pTextureImpl->GetSizeInByte() : 0;
+	if (m_pPendingTextureImpl)
+	{
+		size += m_pPendingTextureImpl->GetSizeInByte();
+	}
+	return size;
+}
+
 bool ImageTexture::HasSampler() const
 {
 	return m_pTextureImpl->HasSampler();
@@ -70,4 +166,122 @@ void ImageTexture::SetSampler(const std::shared_ptr<TextureSampler> pSampler)
 std::shared_ptr<TextureSampler> ImageTexture::GetSampler() const
 {
 	return m_pTextureImpl->GetSampler();
+}
+
+bool ImageTexture::IsStreamed() const
+{
+	return m_streamMips;
+}
+
+uint32_t ImageTexture::GetMipLevels() const
+{
+	const ImportedImageData* pImageData = m_pStreamingData ? m_pStreamingData.get() : m_pImportedData.get();
+	return pImageData ? std::max<uint32_t>(1, pImageData->mipLevels) : 1;
+}
+
+uint32_t ImageTexture::GetTailMip() const
+{
+	uint32_t tailMip = 0;
+	while (tailMip + 1 < GetMipLevels() && std::max(m_width, m_height) >> tailMip > STREAMING_TAIL_SIZE)
+	{
+		tailMip++;
+	}
+	return tailMip;
+}
+
+uint32_t ImageTexture::GetResidentMip() const
+{
+	return m_residentMip;
+}
+
+uint32_t ImageTexture::GetRequestedMip() const
+{
+	return m_requestedMip;
+}
+
+size_t ImageTexture::GetMipChainSize(uint32_t firstMip) const
+{
+	const ImportedImageData* pImageData = m_pStreamingData ? m_pStreamingData.get() : m_pImportedData.get();
+	if (!pImageData)
+	{
+		return 0;
+	}
+
+	size_t chainSize = 0;
+	for (uint32_t level = firstMip; level < pImageData->mipLevels; ++level)
+	{
+		chainSize += Texture2DCreateInfo::GetLevelDataSize(pImageData->format, std::max<uint32_t>(1, m_width >> level), std::max<uint32_t>(1, m_height >> level));
+	}
+	return chainSize;
+}
+
+void ImageTexture::RequestResidentMip(uint32_t firstMip)
+{
+	// Pending texture could still be written by transfer queue, so it's never replaced before completion
+	assert(m_streamMips && m_pStreamingData && !m_pPendingTextureImpl);
+
+	firstMip = std::min(firstMip, GetTailMip());
+	if (firstMip == m_residentMip)
+	{
+		return;
+	}
+
+	CreateDeviceTexture(*m_pStreamingData, firstMip, m_pPendingTextureImpl);
+	m_requestedMip = firstMip;
+}
+
+bool ImageTexture::IsResidencyChangeReady() const
+{
+	return m_pPendingTextureImpl && m_pDevice->IsTexture2DUploaded(m_pPendingTextureImpl);
+}
+
+std::shared_ptr<Texture2D> ImageTexture::ApplyResidencyChange()
+{
+	assert(IsResidencyChangeReady());
+
+	if (m_pTextureImpl->HasSampler())
+	{
+		m_pPendingTextureImpl->SetSampler(m_pTextureImpl->GetSampler());
+	}
+
+	auto pReplacedTexture = m_pTextureImpl;
+	m_pTextureImpl = m_pPendingTextureImpl;
+	m_pPendingTextureImpl = nullptr;
+	m_residentMip = m_requestedMip;
+
+	return pReplacedTexture;
+}
+
+void ImageTexture::CreateDeviceTexture(const ImportedImageData& imageData, uint32_t firstMip, std::shared_ptr<Texture2D>& pOutput) const
+{
+	Texture2DCreateInfo createInfo = {};
+	createInfo.textureWidth = std::max<uint32_t>(1, m_width >> firstMip);
+	createInfo.textureHeight = std::max<uint32_t>(1, m_height >> firstMip);
+	createInfo.pTextureData = GetLevelData(imageData, firstMip);
+	createInfo.dataType = EDataType::UByte;
+	createInfo.format = imageData.format; // Alert: uncompressed RGBA8_SRGB might not be universal
+	createInfo.textureType = ETextureType::SampledImage;
+	createInfo.generateMipmap = imageData.mipLevels == 0;
+	createInfo.mipLevels = imageData.mipLevels > 0 ? imageData.mipLevels - firstMip : 0;
+	createInfo.initialLayout = EImageLayout::ShaderReadOnly;
+	createInfo.deviceType = m_deviceType;
+
+	m_pDevice->CreateTexture2D(createInfo, pOutput);
+}
+
+const uint8_t* ImageTexture::GetLevelData(const ImportedImageData& imageData, uint32_t firstMip) const
+{
+	if (imageData.pDecodedPixels)
+	{
+		assert(firstMip == 0);
+		return imageData.pDecodedPixels;
+	}
+
+	// Levels are tightly packed from the largest one, so the chain from any level is contiguous
+	const uint8_t* pData = imageData.cookedData.empty() ? imageData.textureCache.GetData() : imageData.cookedData.data();
+	for (uint32_t level = 0; level < firstMip; ++level)
+	{
+		pData += Texture2DCreateInfo::GetLevelDataSize(imageData.format, std::max<uint32_t>(1, m_width >> level), std::max<uint32_t>(1, m_height >> level));
+	}
+	return pData;
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include "DrawingResources.h"
+#include "TextureCache.h"
 
 namespace Engine
 {
@@ -7,20 +8,67 @@ namespace Engine
 	class ImageTexture : public Texture2D
 	{
 	public:
-		ImageTexture(const char* filePath, EGPUType deviceType = EGPUType::Main);
+		// Decoding may run on any thread, while deferred device resources must be created later on the thread owning the device
+		// Unless compression is disabled in configuration, image is cooked into block compressed levels on first load and cached next to the source file
+		// Streamed textures only create their mip tail on device, higher levels are requested by texture streamer
+		ImageTexture(const char* filePath, EGPUType deviceType = EGPUType::Main, bool deferDeviceResources = false, ETextureContent content = ETextureContent::Color, bool streamMips = false);
 		~ImageTexture() = default;
 
+		void CreateDeviceResources();
+		bool HasPendingDeviceResources() const;
+		size_t GetPendingDataSize() const; // Size of image data waiting to be uploaded, in bytes
+
 		std::shared_ptr<Texture2D> GetTexture() const;
+		uint32_t GetSizeInByte() const override; // Device memory taken by resident levels, pending texture of a residency change included
 
 		bool HasSampler() const override;
 		void SetSampler(const std::shared_ptr<TextureSampler> pSampler) override;
 		std::shared_ptr<TextureSampler> GetSampler() const override;
 
+		// Mip streaming, only available for cooked textures when streaming is enabled in configuration
+		bool IsStreamed() const;
+		uint32_t GetMipLevels() const;
+		uint32_t GetTailMip() const;	  // Largest level that always stays resident
+		uint32_t GetResidentMip() const;  // Largest level on device
+		uint32_t GetRequestedMip() const; // Same as resident mip unless a change is pending
+		size_t GetMipChainSize(uint32_t firstMip) const; // Device memory taken by levels from firstMip to the smallest one, in bytes
+
+		// Device texture holding the levels from firstMip is created, and swapped in by ApplyResidencyChange once its upload completes
+		void RequestResidentMip(uint32_t firstMip);
+		bool IsResidencyChangeReady() const;
+		// Returns the replaced device texture, which may still be referenced by frames in flight
+		std::shared_ptr<Texture2D> ApplyResidencyChange();
+
+	public:
+		static const uint32_t STREAMING_TAIL_SIZE = 64; // Texels, levels no larger than this are never evicted
+
 	private:
-		void LoadAndCreateTexture(const char* filePath, EGPUType deviceType);
+		// Exactly one of the sources is used
+		struct ImportedImageData
+		{
+			~ImportedImageData();
+
+			TextureCache textureCache;		 // Mapped cooked levels
+			std::vector<uint8_t> cookedData; // Levels cooked by this load
+			unsigned char* pDecodedPixels = nullptr; // Uncompressed RGBA8, mipmap is generated on device
+			ETextureFormat format = ETextureFormat::RGBA8_SRGB;
+			uint32_t mipLevels = 0;
+		};
+
+		void LoadImageData(const char* filePath, ETextureContent content);
+		void CreateDeviceTexture(const ImportedImageData& imageData, uint32_t firstMip, std::shared_ptr<Texture2D>& pOutput) const;
+		const uint8_t* GetLevelData(const ImportedImageData& imageData, uint32_t firstMip) const;
 
 	private:
 		std::shared_ptr<DrawingDevice> m_pDevice;
 		std::shared_ptr<Texture2D> m_pTextureImpl;
+		EGPUType m_deviceType;
+		std::unique_ptr<ImportedImageData> m_pImportedData; // Released once texture is created
+
+		bool m_streamMips;
+		uint32_t m_residentMip;
+		uint32_t m_requestedMip;
+		std::shared_ptr<Texture2D> m_pPendingTextureImpl;
+		std::unique_ptr<ImportedImageData> m_pStreamingData; // Cooked levels kept for streamed textures, mapped from cache whenever possible
 	};
 }
\ No newline at end of file
@@ -1,9 +1,18 @@
 #include "Mesh.h"
+#include "Global.h"
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <tuple>
 
 using namespace Engine;
 
+// Limits how far vertices at sharp corners are pulled back, so that thin parts don't fold over
+static const float MIN_OCCLUDER_OFFSET_COSINE_INTERNAL = 0.25f;
+
 Mesh::Mesh(const std::shared_ptr<DrawingDevice> pDevice)
-	: m_pDevice(pDevice), m_type(EBuiltInMeshType::External), m_planeDimension(0, 0)
+	: m_pDevice(pDevice), m_type(EBuiltInMeshType::External), m_planeDimension(0, 0), m_bounds({ Vector3(0), Vector3(0) })
 {
 }
 
@@ -37,14 +46,76 @@ Vector2 Mesh::GetPlaneDimenstion() const
 	return m_planeDimension;
 }
 
-void Mesh::CreateVertexBufferFromVertices(std::vector<float>& positions, std::vector<float>& normals, std::vector<float>& texcoords, std::vector<float>& tangents, std::vector<float>& bitangents, std::vector<int>& indices)
+const BoundingBox& Mesh::GetBounds() const
 {
-	if (!m_pDevice)
+	return m_bounds;
+}
+
+const MeshClusterStreams& Mesh::GetClusters() const
+{
+	return m_clusters;
+}
+
+const OccluderGeometry& Mesh::GetOccluderGeometry() const
+{
+	return m_occluderGeometry;
+}
+
+const std::vector<SubMesh>* Mesh::GetSubMeshes(uint32_t lod) const
+{
+	if (lod == 0 || m_lods.empty())
 	{
-		throw std::runtime_error("Device is not assigned.");
-		return;
+		return &m_subMeshes;
 	}
+	return &m_lods[std::min<size_t>(lod, m_lods.size()) - 1].subMeshes;
+}
+
+uint32_t Mesh::GetLODCount() const
+{
+	return (uint32_t)m_lods.size() + 1;
+}
+
+float Mesh::GetLODError(uint32_t lod) const
+{
+	return lod == 0 || m_lods.empty() ? 0.0f : m_lods[std::min<size_t>(lod, m_lods.size()) - 1].error;
+}
 
+uint32_t Mesh::SelectLOD(float pixelsPerUnit, uint32_t currentLOD) const
+{
+	float threshold = gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetMeshLODThreshold();
+	if (threshold <= 0.0f || m_lods.empty())
+	{
+		return 0;
+	}
+
+	uint32_t targetLOD = 0;
+	for (uint32_t lod = GetLODCount() - 1; lod > 0; --lod)
+	{
+		if (GetLODError(lod) * pixelsPerUnit <= threshold)
+		{
+			targetLOD = lod;
+			break;
+		}
+	}
+
+	currentLOD = std::min(currentLOD, GetLODCount() - 1);
+	if (targetLOD <= currentLOD)
+	{
+		return targetLOD;
+	}
+
+	for (uint32_t lod = targetLOD; lod > currentLOD; --lod)
+	{
+		if (GetLODError(lod) * pixelsPerUnit <= threshold * LOD_SWITCH_HYSTERESIS)
+		{
+			return lod;
+		}
+	}
+	return currentLOD;
+}
+
+void Mesh::CreateVertexBufferFromVertices(std::vector<float>& positions, std::vector<float>& normals, std::vector<float>& texcoords, std::vector<float>& tangents, std::vector<float>& bitangents, std::vector<int>& indices)
+{
 	VertexBufferCreateInfo createInfo = {};
 
 	createInfo.pIndexData = indices.data();
@@ -60,5 +131,150 @@ void Mesh::CreateVertexBufferFromVertices(std::vector<float>& positions, std::ve
 	createInfo.pBitangentData = bitangents.data();
 	createInfo.bitangentDataCount = static_cast<uint32_t>(bitangents.size());
 
-	m_pDevice->CreateVertexBuffer(createInfo, m_pVertexBuffer);
+	CreateVertexBuffer(createInfo);
+}
+
+void Mesh::CreateVertexBuffer(VertexBufferCreateInfo& createInfo)
+{
+	if (!m_pDevice)
+	{
+		throw std::runtime_error("Device is not assigned.");
+		return;
+	}
+
+	createInfo.vertexFormat = gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetVertexFormat();
+	createInfo.ComputePositionDequantization();
+
+	// Mesh is left without vertex buffer on failure, the same as a mesh that failed to import
+	if (!m_pDevice->CreateVertexBuffer(createInfo, m_pVertexBuffer))
+	{
+		return;
+	}
+	m_pVertexBuffer->SetPositionDequantization(createInfo.positionDecodeScale, createInfo.positionDecodeOffset);
+}
+
+void Mesh::ComputeBounds(const float* pPositions, const int* pIndices)
+{
+	for (size_t i = 0; i < m_subMeshes.size(); ++i)
+	{
+		auto& subMesh = m_subMeshes[i];
+		subMesh.m_bounds = { Vector3(0), Vector3(0) };
+
+		for (unsigned int j = 0; j < subMesh.m_numIndices; ++j)
+		{
+			const float* pPosition = &pPositions[(size_t)(subMesh.m_baseVertex + pIndices[subMesh.m_baseIndex + j]) * 3];
+			Vector3 position(pPosition[0], pPosition[1], pPosition[2]);
+
+			subMesh.m_bounds.minPoint = j == 0 ? position : glm::min(subMesh.m_bounds.minPoint, position);
+			subMesh.m_bounds.maxPoint = j == 0 ? position : glm::max(subMesh.m_bounds.maxPoint, position);
+		}
+
+		m_bounds.minPoint = i == 0 ? subMesh.m_bounds.minPoint : glm::min(m_bounds.minPoint, subMesh.m_bounds.minPoint);
+		m_bounds.maxPoint = i == 0 ? subMesh.m_bounds.maxPoint : glm::max(m_bounds.maxPoint, subMesh.m_bounds.maxPoint);
+	}
+}
+
+void Mesh::BuildOccluderGeometry(const float* pPositions, const uint32_t* pVertexRemap, const int* pIndices)
+{
+	m_occluderGeometry.positions.clear();
+	m_occluderGeometry.indices.clear();
+
+	const std::vector<SubMesh>* pSubMeshes = nullptr;
+	float error = 0.0f;
+	for (uint32_t lod = 0; lod < GetLODCount() && pSubMeshes == nullptr; ++lod)
+	{
+		size_t triangleCount = 0;
+		for (auto& subMesh : *GetSubMeshes(lod))
+		{
+			triangleCount += subMesh.m_numIndices / 3;
+		}
+
+		if (triangleCount <= MAX_OCCLUDER_TRIANGLES)
+		{
+			pSubMeshes = GetSubMeshes(lod);
+			error = GetLODError(lod);
+		}
+	}
+
+	if (pSubMeshes == nullptr)
+	{
+#if defined(_DEBUG)
+		std::cout << "Mesh is too detailed to be an occluder: " << m_filePath << std::endl;
+#endif
+		return;
+	}
+
+	// Only vertices referenced by the chosen level are kept, welded by position so that pulling back doesn't open cracks along seams
+	std::map<std::tuple<float, float, float>, uint32_t> occluderVertices;
+	for (auto& subMesh : *pSubMeshes)
+	{
+		for (unsigned int i = 0; i < subMesh.m_numIndices; ++i)
+		{
+			uint32_t vertex = subMesh.m_baseVertex + (uint32_t)pIndices[subMesh.m_baseIndex + i];
+			const float* pPosition = &pPositions[(size_t)(pVertexRemap != nullptr ? pVertexRemap[vertex] : vertex) * 3];
+			auto result = occluderVertices.emplace(std::make_tuple(pPosition[0], pPosition[1], pPosition[2]), (uint32_t)occluderVertices.size());
+
+			if (result.second)
+			{
+				m_occluderGeometry.positions.insert(m_occluderGeometry.positions.end(), pPosition, pPosition + 3);
+			}
+			m_occluderGeometry.indices.emplace_back(result.first->second);
+		}
+	}
+
+	if (error <= 0.0f)
+	{
+		return;
+	}
+
+	auto getPosition = [this](uint32_t vertex)
+	{
+		return Vector3(m_occluderGeometry.positions[vertex * 3], m_occluderGeometry.positions[vertex * 3 + 1], m_occluderGeometry.positions[vertex * 3 + 2]);
+	};
+
+	// Counter-clockwise triangles are front-facing, so their normals point out of the surface
+	size_t vertexCount = m_occluderGeometry.positions.size() / 3;
+	std::vector<Vector3> faceNormals(m_occluderGeometry.indices.size() / 3, Vector3(0));
+	std::vector<Vector3> vertexNormals(vertexCount, Vector3(0));
+	for (size_t i = 0; i < faceNormals.size(); ++i)
+	{
+		const uint32_t* pTriangle = &m_occluderGeometry.indices[i * 3];
+		Vector3 normal = glm::cross(getPosition(pTriangle[1]) - getPosition(pTriangle[0]), getPosition(pTriangle[2]) - getPosition(pTriangle[0]));
+		float length = glm::length(normal);
+		if (length > 0.0f)
+		{
+			faceNormals[i] = normal / length;
+		}
+
+		for (uint32_t j = 0; j < 3; ++j)
+		{
+			vertexNormals[pTriangle[j]] += normal; // Area weighted
+		}
+	}
+
+	for (auto& normal : vertexNormals)
+	{
+		float length = glm::length(normal);
+		normal = length > 0.0f ? normal / length : Vector3(0);
+	}
+
+	// Averaged normal is slanted against faces meeting at a corner, distance is stretched so that every face moves back by the full error
+	std::vector<float> minCosines(vertexCount, 1.0f);
+	for (size_t i = 0; i < faceNormals.size(); ++i)
+	{
+		for (uint32_t j = 0; j < 3; ++j)
+		{
+			uint32_t vertex = m_occluderGeometry.indices[i * 3 + j];
+			minCosines[vertex] = std::min(minCosines[vertex], glm::dot(vertexNormals[vertex], faceNormals[i]));
+		}
+	}
+
+	for (size_t i = 0; i < vertexCount; ++i)
+	{
+		Vector3 offset = vertexNormals[i] * (error / std::max(minCosines[i], MIN_OCCLUDER_OFFSET_COSINE_INTERNAL));
+		for (uint32_t j = 0; j < 3; ++j)
+		{
+			m_occluderGeometry.positions[i * 3 + j] -= offset[j];
+		}
+	}
 }
@@ -1,16 +1,40 @@
 #pragma once
 #include "DrawingResources.h"
 #include "DrawingDevice.h"
+#include "MeshClusterBuilder.h"
 #include <memory>
 #include <vector>
 
 namespace Engine
 {
+	struct BoundingBox
+	{
+		Vector3 minPoint;
+		Vector3 maxPoint;
+	};
+
 	struct SubMesh
 	{
 		unsigned int m_numIndices;
 		unsigned int m_baseIndex;
 		unsigned int m_baseVertex;
+		BoundingBox	 m_bounds; // In mesh space
+		unsigned int m_firstCluster; // Clusters of full-detail level only
+		unsigned int m_clusterCount;
+	};
+
+	// Reduced level of detail, indexing into the same vertices as the full-detail submeshes
+	struct MeshLOD
+	{
+		std::vector<SubMesh> subMeshes; // Same count, base vertices and bounds as the full-detail ones
+		float error; // Largest deviation from the full-detail surface, in mesh space
+	};
+
+	// Copy of a mesh's positions kept in system memory, rasterized by software occlusion culling
+	struct OccluderGeometry
+	{
+		std::vector<float> positions; // In mesh space
+		std::vector<uint32_t> indices;
 	};
 
 	class Mesh
@@ -20,23 +44,50 @@ namespace Engine
 
 		std::shared_ptr<VertexBuffer> GetVertexBuffer() const;
 		const std::vector<SubMesh>* GetSubMeshes() const;
+		const std::vector<SubMesh>* GetSubMeshes(uint32_t lod) const; // Out of range levels fall back to the coarsest one
 		unsigned int GetSubmeshCount() const;
 		const char* GetFilePath() const;
 		EBuiltInMeshType GetMeshType() const;
 		Vector2 GetPlaneDimenstion() const;
+		const BoundingBox& GetBounds() const;
+		const MeshClusterStreams& GetClusters() const; // Empty for meshes that weren't partitioned
+		const OccluderGeometry& GetOccluderGeometry() const;
+
+		uint32_t GetLODCount() const; // Full-detail level included
+		float GetLODError(uint32_t lod) const;
+		// Picks the coarsest level whose error stays below the configured threshold on screen, pixelsPerUnit is the projected size of one mesh-space unit
+		// Coarser level is only taken once its error is clearly below the threshold, so that level doesn't flicker around the switching distance
+		uint32_t SelectLOD(float pixelsPerUnit, uint32_t currentLOD) const;
+
+	public:
+		static const uint32_t MAX_LOD_COUNT = 8;
 
 	protected:
 		Mesh(const std::shared_ptr<DrawingDevice> pDevice);
 
 		void CreateVertexBufferFromVertices(std::vector<float>& positions, std::vector<float>& normals, std::vector<float>& texcoords, std::vector<float>& tangents, std::vector<float>& bitangents, std::vector<int>& indices);
+		void CreateVertexBuffer(VertexBufferCreateInfo& createInfo); // Vertex format is filled according to graphics configuration
+		// Submeshes must be set up first, indices are relative to their base vertex
+		void ComputeBounds(const float* pPositions, const int* pIndices);
+		// Submeshes and levels must be set up first, takes the finest level within the triangle limit, or leaves the geometry empty if there's none
+		// Coarser levels are pulled back along their normals by their error, so that the occluder never sticks out of the real surface
+		// Vertex remap maps a vertex of the buffer to its entry in positions, it can be null
+		void BuildOccluderGeometry(const float* pPositions, const uint32_t* pVertexRemap, const int* pIndices);
 
 	protected:
 		std::shared_ptr<DrawingDevice> m_pDevice;
 		std::shared_ptr<VertexBuffer> m_pVertexBuffer;
 		std::vector<SubMesh> m_subMeshes;
+		std::vector<MeshLOD> m_lods; // Coarser levels following the full-detail one
+		MeshClusterStreams m_clusters;
+		OccluderGeometry m_occluderGeometry;
 
 		std::string m_filePath;
 		EBuiltInMeshType m_type;
 		Vector2 m_planeDimension;
+		BoundingBox m_bounds;
+
+		const float LOD_SWITCH_HYSTERESIS = 0.75f;
+		const size_t MAX_OCCLUDER_TRIANGLES = 8192; // Occluders are rasterized on CPU every frame
 	};
 }
\ No newline at end of file
@@ -0,0 +1,310 @@
+#include "MeshCache.h"
+
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+
+using namespace Engine;
+
+namespace
+{
+	// Appends raw bytes at given alignment and returns their offset in buffer
+	uint64_t AppendCacheData(std::vector<uint8_t>& buffer, const void* pData, size_t size, size_t alignment)
+	{
+		size_t offset = (buffer.size() + alignment - 1) / alignment * alignment;
+		buffer.resize(offset + size);
+		if (pData != nullptr && size > 0)
+		{
+			memcpy(buffer.data() + offset, pData, size);
+		}
+		return offset;
+	}
+
+	// Gathers one attribute stream into its final vertex order while appending it
+	uint64_t AppendCacheStream(std::vector<uint8_t>& buffer, const float* pData, uint32_t componentCount, uint32_t vertexCount, const uint32_t* pVertexRemap)
+	{
+		uint64_t offset = AppendCacheData(buffer, nullptr, sizeof(float) * componentCount * vertexCount, 16); // Only reserves space
+		float* pDst = reinterpret_cast<float*>(buffer.data() + offset);
+
+		for (uint32_t i = 0; i < vertexCount; ++i)
+		{
+			uint32_t srcVertex = pVertexRemap != nullptr ? pVertexRemap[i] : i;
+			memcpy(&pDst[(size_t)i * componentCount], &pData[(size_t)srcVertex * componentCount], sizeof(float) * componentCount);
+		}
+		return offset;
+	}
+}
+
+bool MeshCache::Open(const std::string& cacheFilePath, const MeshCacheKey& key)
+{
+	Close();
+
+	if (!m_cacheFile.Open(cacheFilePath.c_str()))
+	{
+		return false;
+	}
+
+	const uint8_t* pData = m_cacheFile.GetData();
+	size_t fileSize = m_cacheFile.GetSize();
+
+	if (fileSize < sizeof(CacheHeader))
+	{
+		Close();
+		return false;
+	}
+
+	memcpy(&m_header, pData, sizeof(CacheHeader));
+
+	if (m_header.magic != CACHE_FILE_MAGIC || m_header.version != CACHE_FILE_VERSION
+		|| m_header.key.sourceSize != key.sourceSize || m_header.key.sourceWriteTime != key.sourceWriteTime
+		|| m_header.key.importFlags != key.importFlags || m_header.key.processingFlags != key.processingFlags)
+	{
+		Close();
+		return false;
+	}
+
+	auto isInRange = [fileSize](uint64_t offset, uint64_t size)
+	{
+		return offset <= fileSize && size <= fileSize - offset;
+	};
+
+	const uint32_t componentCounts[5] = { 3, 3, 2, 3, 3 };
+	for (uint32_t i = 0; i < 5; ++i)
+	{
+		if (!isInRange(m_header.streamOffsets[i], sizeof(float) * componentCounts[i] * (uint64_t)m_header.vertexCount) || m_header.streamOffsets[i] % 16 != 0)
+		{
+			Close();
+			return false;
+		}
+	}
+
+	if (!isInRange(m_header.indexOffset, sizeof(int) * (uint64_t)m_header.indexCount) || m_header.indexOffset % sizeof(int) != 0 || m_header.lodCount >= Mesh::MAX_LOD_COUNT
+		|| !isInRange(m_header.subMeshOffset, sizeof(CacheSubMesh) * (uint64_t)m_header.subMeshCount * (m_header.lodCount + 1))
+		|| !isInRange(m_header.clusterOffset, sizeof(MeshCluster) * (uint64_t)m_header.clusterCount))
+	{
+		Close();
+		return false;
+	}
+
+	m_subMeshes.resize(m_header.subMeshCount);
+	m_lods.resize(m_header.lodCount);
+	for (uint32_t lod = 0; lod <= m_header.lodCount; ++lod)
+	{
+		auto& subMeshes = lod == 0 ? m_subMeshes : m_lods[lod - 1].subMeshes;
+		subMeshes.resize(m_header.subMeshCount);
+
+		for (uint32_t i = 0; i < m_header.subMeshCount; ++i)
+		{
+			CacheSubMesh cacheSubMesh = {};
+			memcpy(&cacheSubMesh, pData + m_header.subMeshOffset + sizeof(CacheSubMesh) * ((size_t)lod * m_header.subMeshCount + i), sizeof(CacheSubMesh));
+
+			if ((uint64_t)cacheSubMesh.baseIndex + cacheSubMesh.numIndices > m_header.indexCount || cacheSubMesh.baseVertex > m_header.vertexCount
+				|| (uint64_t)cacheSubMesh.firstCluster + cacheSubMesh.clusterCount > m_header.clusterCount)
+			{
+				Close();
+				return false;
+			}
+
+			subMeshes[i].m_numIndices = cacheSubMesh.numIndices;
+			subMeshes[i].m_baseIndex = cacheSubMesh.baseIndex;
+			subMeshes[i].m_baseVertex = cacheSubMesh.baseVertex;
+			subMeshes[i].m_firstCluster = cacheSubMesh.firstCluster;
+			subMeshes[i].m_clusterCount = cacheSubMesh.clusterCount;
+			subMeshes[i].m_bounds.minPoint = Vector3(cacheSubMesh.boundsMin[0], cacheSubMesh.boundsMin[1], cacheSubMesh.boundsMin[2]);
+			subMeshes[i].m_bounds.maxPoint = Vector3(cacheSubMesh.boundsMax[0], cacheSubMesh.boundsMax[1], cacheSubMesh.boundsMax[2]);
+		}
+
+		if (lod > 0)
+		{
+			m_lods[lod - 1].error = m_header.lodErrors[lod - 1];
+		}
+	}
+
+	m_clusters.resize(m_header.clusterCount);
+	for (uint32_t i = 0; i < m_header.clusterCount; ++i)
+	{
+		memcpy(&m_clusters[i], pData + m_header.clusterOffset + sizeof(MeshCluster) * i, sizeof(MeshCluster));
+
+		if ((uint64_t)m_clusters[i].baseIndex + m_clusters[i].numIndices > m_header.indexCount)
+		{
+			Close();
+			return false;
+		}
+	}
+
+	m_bounds.minPoint = Vector3(m_header.boundsMin[0], m_header.boundsMin[1], m_header.boundsMin[2]);
+	m_bounds.maxPoint = Vector3(m_header.boundsMax[0], m_header.boundsMax[1], m_header.boundsMax[2]);
+
+	return true;
+}
+
+void MeshCache::Close()
+{
+	m_cacheFile.Close();
+	m_header = {};
+	m_subMeshes.clear();
+	m_lods.clear();
+	m_clusters.clear();
+	m_bounds = {};
+}
+
+VertexBufferCreateInfo MeshCache::GetVertexBufferCreateInfo() const
+{
+	assert(m_cacheFile.IsOpen());
+
+	// Alert: create info takes mutable pointers, but the mapping is read-only and must never be written through them
+	auto getStream = [this](uint32_t index)
+	{
+		return const_cast<float*>(reinterpret_cast<const float*>(m_cacheFile.GetData() + m_header.streamOffsets[index]));
+	};
+
+	VertexBufferCreateInfo createInfo = {};
+
+	createInfo.pIndexData = const_cast<int*>(reinterpret_cast<const int*>(m_cacheFile.GetData() + m_header.indexOffset));
+	createInfo.indexDataCount = m_header.indexCount;
+	createInfo.useShortIndices = m_header.useShortIndices != 0;
+	createInfo.pPositionData = getStream(0);
+	createInfo.positionDataCount = m_header.vertexCount * 3;
+	createInfo.pNormalData = getStream(1);
+	createInfo.normalDataCount = m_header.vertexCount * 3;
+	createInfo.pTexcoordData = getStream(2);
+	createInfo.texcoordDataCount = m_header.vertexCount * 2;
+	createInfo.pTangentData = getStream(3);
+	createInfo.tangentDataCount = m_header.vertexCount * 3;
+	createInfo.pBitangentData = getStream(4);
+	createInfo.bitangentDataCount = m_header.vertexCount * 3;
+
+	return createInfo;
+}
+
+const std::vector<SubMesh>& MeshCache::GetSubMeshes() const
+{
+	return m_subMeshes;
+}
+
+const std::vector<MeshLOD>& MeshCache::GetLODs() const
+{
+	return m_lods;
+}
+
+const std::vector<MeshCluster>& MeshCache::GetClusters() const
+{
+	return m_clusters;
+}
+
+const BoundingBox& MeshCache::GetBounds() const
+{
+	return m_bounds;
+}
+
+bool MeshCache::Write(const std::string& cacheFilePath, const MeshCacheKey& key, const VertexBufferCreateInfo& createInfo, const std::vector<SubMesh>& subMeshes, const std::vector<MeshLOD>& lods, const std::vector<MeshCluster>& clusters, const BoundingBox& bounds)
+{
+	uint32_t vertexCount = createInfo.positionDataCount / 3;
+
+	// Every stream is expected to be complete, as produced by importer
+	if (createInfo.normalDataCount != vertexCount * 3 || createInfo.texcoordDataCount != vertexCount * 2
+		|| createInfo.tangentDataCount != vertexCount * 3 || createInfo.bitangentDataCount != vertexCount * 3)
+	{
+		return false;
+	}
+
+	if (lods.size() >= Mesh::MAX_LOD_COUNT)
+	{
+		return false;
+	}
+
+	CacheHeader header = {};
+	header.magic = CACHE_FILE_MAGIC;
+	header.version = CACHE_FILE_VERSION;
+	header.key = key;
+	header.vertexCount = vertexCount;
+	header.indexCount = createInfo.indexDataCount;
+	header.subMeshCount = (uint32_t)subMeshes.size();
+	header.useShortIndices = createInfo.useShortIndices ? 1 : 0;
+	header.lodCount = (uint32_t)lods.size();
+	header.clusterCount = (uint32_t)clusters.size();
+	for (size_t i = 0; i < lods.size(); ++i)
+	{
+		header.lodErrors[i] = lods[i].error;
+	}
+	memcpy(header.boundsMin, &bounds.minPoint, sizeof(header.boundsMin));
+	memcpy(header.boundsMax, &bounds.maxPoint, sizeof(header.boundsMax));
+
+	std::vector<uint8_t> buffer(sizeof(CacheHeader));
+
+	header.streamOffsets[0] = AppendCacheStream(buffer, createInfo.pPositionData, 3, vertexCount, createInfo.pVertexRemap);
+	header.streamOffsets[1] = AppendCacheStream(buffer, createInfo.pNormalData, 3, vertexCount, createInfo.pVertexRemap);
+	header.streamOffsets[2] = AppendCacheStream(buffer, createInfo.pTexcoordData, 2, vertexCount, createInfo.pVertexRemap);
+	header.streamOffsets[3] = AppendCacheStream(buffer, createInfo.pTangentData, 3, vertexCount, createInfo.pVertexRemap);
+	header.streamOffsets[4] = AppendCacheStream(buffer, createInfo.pBitangentData, 3, vertexCount, createInfo.pVertexRemap);
+	header.indexOffset = AppendCacheData(buffer, createInfo.pIndexData, sizeof(int) * createInfo.indexDataCount, 16);
+
+	std::vector<CacheSubMesh> cacheSubMeshes;
+	for (size_t lod = 0; lod <= lods.size(); ++lod)
+	{
+		const auto& lodSubMeshes = lod == 0 ? subMeshes : lods[lod - 1].subMeshes;
+		assert(lodSubMeshes.size() == subMeshes.size());
+
+		for (auto& subMesh : lodSubMeshes)
+		{
+			CacheSubMesh cacheSubMesh = {};
+			cacheSubMesh.numIndices = subMesh.m_numIndices;
+			cacheSubMesh.baseIndex = subMesh.m_baseIndex;
+			cacheSubMesh.baseVertex = subMesh.m_baseVertex;
+			cacheSubMesh.firstCluster = subMesh.m_firstCluster;
+			cacheSubMesh.clusterCount = subMesh.m_clusterCount;
+			memcpy(cacheSubMesh.boundsMin, &subMesh.m_bounds.minPoint, sizeof(cacheSubMesh.boundsMin));
+			memcpy(cacheSubMesh.boundsMax, &subMesh.m_bounds.maxPoint, sizeof(cacheSubMesh.boundsMax));
+			cacheSubMeshes.emplace_back(cacheSubMesh);
+		}
+	}
+	header.subMeshOffset = AppendCacheData(buffer, cacheSubMeshes.data(), sizeof(CacheSubMesh) * cacheSubMeshes.size(), sizeof(uint32_t));
+	header.clusterOffset = AppendCacheData(buffer, clusters.data(), sizeof(MeshCluster) * clusters.size(), sizeof(uint32_t));
+
+	memcpy(buffer.data(), &header, sizeof(CacheHeader));
+
+	// Written under a temporary name first, so that an interrupted write never leaves a cache file that passes validation
+	std::string tempFilePath = cacheFilePath + ".tmp";
+	std::ofstream file(tempFilePath, std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		std::cerr << "Failed to open mesh cache file for writing: " << tempFilePath << std::endl;
+		return false;
+	}
+
+	file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+	file.close();
+
+	std::error_code errorCode;
+	std::filesystem::rename(tempFilePath, cacheFilePath, errorCode);
+	if (errorCode)
+	{
+		std::filesystem::remove(tempFilePath, errorCode);
+		return false;
+	}
+
+	return true;
+}
+
+std::string MeshCache::GetCacheFilePath(const char* sourceFilePath)
+{
+	return std::string(sourceFilePath) + ".cemesh";
+}
+
+bool MeshCache::QuerySourceKey(const char* sourceFilePath, uint32_t importFlags, uint32_t processingFlags, MeshCacheKey& outKey)
+{
+	std::error_code errorCode;
+
+	outKey = {};
+	outKey.importFlags = importFlags;
+	outKey.processingFlags = processingFlags;
+
+	outKey.sourceSize = (uint64_t)std::filesystem::file_size(sourceFilePath, errorCode);
+	if (errorCode)
+	{
+		return false;
+	}
+
+	outKey.sourceWriteTime = (int64_t)std::filesystem::last_write_time(sourceFilePath, errorCode).time_since_epoch().count();
+	return !errorCode;
+}
\ No newline at end of file
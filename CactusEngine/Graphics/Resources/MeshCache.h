@@ -0,0 +1,89 @@
+#pragma once
+#include "NoCopy.h"
+#include "MemoryMappedFile.h"
+#include "Mesh.h"
+
+#include <string>
+#include <vector>
+
+namespace Engine
+{
+	// Identifies the source file and every setting that affects imported data
+	struct MeshCacheKey
+	{
+		uint64_t sourceSize;
+		int64_t	 sourceWriteTime;
+		uint32_t importFlags;
+		uint32_t processingFlags;
+	};
+
+	// Binary file holding final vertex streams, indices, submesh tables of every LOD, clusters and bounds of an imported mesh
+	// Streams are handed to vertex buffer creation straight from mapped memory, so loading involves no parsing
+	class MeshCache : public NoCopy
+	{
+	public:
+		MeshCache() = default;
+		~MeshCache() = default;
+
+		// Fails if cache file is missing, malformed or was built from a different key
+		bool Open(const std::string& cacheFilePath, const MeshCacheKey& key);
+		void Close();
+
+		// Pointers refer to mapped file, they are only valid until the cache is closed
+		VertexBufferCreateInfo GetVertexBufferCreateInfo() const;
+		const std::vector<SubMesh>& GetSubMeshes() const;
+		const std::vector<MeshLOD>& GetLODs() const;
+		const std::vector<MeshCluster>& GetClusters() const;
+		const BoundingBox& GetBounds() const;
+
+		// Vertex remap of create info is applied while writing, so cached streams are already in their final order
+		static bool Write(const std::string& cacheFilePath, const MeshCacheKey& key, const VertexBufferCreateInfo& createInfo, const std::vector<SubMesh>& subMeshes, const std::vector<MeshLOD>& lods, const std::vector<MeshCluster>& clusters, const BoundingBox& bounds);
+
+		static std::string GetCacheFilePath(const char* sourceFilePath);
+		static bool QuerySourceKey(const char* sourceFilePath, uint32_t importFlags, uint32_t processingFlags, MeshCacheKey& outKey);
+
+	public:
+		static const uint32_t CACHE_FILE_MAGIC = 0x434D4543; // "CEMC"
+		static const uint32_t CACHE_FILE_VERSION = 3;
+
+	private:
+		// All offsets are relative to the beginning of cache file, streams are 16-byte aligned
+		struct CacheHeader
+		{
+			uint32_t	 magic;
+			uint32_t	 version;
+			MeshCacheKey key;
+			uint32_t	 vertexCount;
+			uint32_t	 indexCount;
+			uint32_t	 subMeshCount; // Per level
+			uint32_t	 useShortIndices;
+			uint32_t	 lodCount;	   // Coarser levels, their submeshes follow the full-detail ones in the table
+			float		 lodErrors[Mesh::MAX_LOD_COUNT - 1];
+			uint32_t	 clusterCount;
+			float		 boundsMin[3];
+			float		 boundsMax[3];
+			uint64_t	 streamOffsets[5]; // Position, normal, texcoord, tangent, bitangent
+			uint64_t	 indexOffset;
+			uint64_t	 subMeshOffset;
+			uint64_t	 clusterOffset;
+		};
+
+		struct CacheSubMesh
+		{
+			uint32_t numIndices;
+			uint32_t baseIndex;
+			uint32_t baseVertex;
+			uint32_t firstCluster;
+			uint32_t clusterCount;
+			float	 boundsMin[3];
+			float	 boundsMax[3];
+		};
+
+		MemoryMappedFile m_cacheFile;
+		CacheHeader m_header = {};
+		std::vector<SubMesh> m_subMeshes;
+		std::vector<MeshLOD> m_lods;
+		std::vector<MeshCluster> m_clusters;
+		BoundingBox m_bounds = {};
+	};
+}
\ No newline at end of file
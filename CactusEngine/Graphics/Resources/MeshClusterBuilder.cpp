@@ -0,0 +1,195 @@
+#include "MeshClusterBuilder.h"
+#include <cmath>
+#include <algorithm>
+
+using namespace Engine;
+
+static void ComputeClusterBounds_Internal(const float* const* ppPositions, uint32_t triangleCount, MeshCluster& cluster)
+{
+	// Sphere around the box of the cluster, which is tight enough for clusters this small
+	float minPoint[3] = { ppPositions[0][0], ppPositions[0][1], ppPositions[0][2] };
+	float maxPoint[3] = { minPoint[0], minPoint[1], minPoint[2] };
+	for (uint32_t i = 1; i < triangleCount * 3; ++i)
+	{
+		for (uint32_t k = 0; k < 3; ++k)
+		{
+			minPoint[k] = std::min(minPoint[k], ppPositions[i][k]);
+			maxPoint[k] = std::max(maxPoint[k], ppPositions[i][k]);
+		}
+	}
+
+	float radiusSquared = 0.0f;
+	for (uint32_t k = 0; k < 3; ++k)
+	{
+		cluster.center[k] = (minPoint[k] + maxPoint[k]) * 0.5f;
+	}
+	for (uint32_t i = 0; i < triangleCount * 3; ++i)
+	{
+		float dx = ppPositions[i][0] - cluster.center[0];
+		float dy = ppPositions[i][1] - cluster.center[1];
+		float dz = ppPositions[i][2] - cluster.center[2];
+		radiusSquared = std::max(radiusSquared, dx * dx + dy * dy + dz * dz);
+	}
+	cluster.radius = std::sqrt(radiusSquared);
+
+	// Counter-clockwise triangles face the direction of their cross product
+	std::vector<float> normals;
+	normals.reserve((size_t)triangleCount * 3);
+	float axis[3] = { 0.0f, 0.0f, 0.0f };
+
+	for (uint32_t i = 0; i < triangleCount; ++i)
+	{
+		const float* p0 = ppPositions[i * 3];
+		const float* p1 = ppPositions[i * 3 + 1];
+		const float* p2 = ppPositions[i * 3 + 2];
+
+		float e0[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+		float e1[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+		float normal[3] = { e0[1] * e1[2] - e0[2] * e1[1], e0[2] * e1[0] - e0[0] * e1[2], e0[0] * e1[1] - e0[1] * e1[0] };
+
+		float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		if (length <= 0.0f)
+		{
+			continue;
+		}
+
+		// Weighted by area in the sum
+		for (uint32_t k = 0; k < 3; ++k)
+		{
+			axis[k] += normal[k];
+			normals.emplace_back(normal[k] / length);
+		}
+	}
+
+	cluster.coneAxis[0] = cluster.coneAxis[1] = cluster.coneAxis[2] = 0.0f;
+	cluster.coneCutoff = 1.0f;
+
+	float axisLength = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+	if (axisLength <= 0.0f)
+	{
+		return;
+	}
+
+	float minDot = 1.0f;
+	for (size_t i = 0; i < normals.size(); i += 3)
+	{
+		minDot = std::min(minDot, (normals[i] * axis[0] + normals[i + 1] * axis[1] + normals[i + 2] * axis[2]) / axisLength);
+	}
+
+	// Triangles spreading over a hemisphere or more can't be backfacing all at once
+	if (minDot <= 0.0f)
+	{
+		return;
+	}
+
+	for (uint32_t k = 0; k < 3; ++k)
+	{
+		cluster.coneAxis[k] = axis[k] / axisLength;
+	}
+	cluster.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+}
+
+void MeshClusterStreams::Assign(const MeshCluster* pClusters, size_t count)
+{
+	centerX.resize(count);
+	centerY.resize(count);
+	centerZ.resize(count);
+	radius.resize(count);
+	coneAxisX.resize(count);
+	coneAxisY.resize(count);
+	coneAxisZ.resize(count);
+	coneCutoff.resize(count);
+	baseIndices.resize(count);
+	numIndices.resize(count);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		centerX[i] = pClusters[i].center[0];
+		centerY[i] = pClusters[i].center[1];
+		centerZ[i] = pClusters[i].center[2];
+		radius[i] = pClusters[i].radius;
+		coneAxisX[i] = pClusters[i].coneAxis[0];
+		coneAxisY[i] = pClusters[i].coneAxis[1];
+		coneAxisZ[i] = pClusters[i].coneAxis[2];
+		coneCutoff[i] = pClusters[i].coneCutoff;
+		baseIndices[i] = pClusters[i].baseIndex;
+		numIndices[i] = pClusters[i].numIndices;
+	}
+}
+
+size_t MeshClusterStreams::GetCount() const
+{
+	return baseIndices.size();
+}
+
+void MeshClusterBuilder::Build(const int* pIndices, uint32_t indexCount, uint32_t baseIndex, uint32_t baseVertex, const float* pPositions, const uint32_t* pVertexRemap, std::vector<MeshCluster>& outClusters)
+{
+	auto getPosition = [pPositions, pVertexRemap, baseVertex](int index)
+	{
+		uint32_t vertex = baseVertex + (uint32_t)index;
+		return &pPositions[(size_t)(pVertexRemap != nullptr ? pVertexRemap[vertex] : vertex) * 3];
+	};
+
+	int clusterVertices[MAX_CLUSTER_VERTICES];
+	uint32_t clusterVertexCount = 0;
+	uint32_t clusterBegin = 0;
+	const float* trianglePositions[MAX_CLUSTER_TRIANGLES * 3];
+
+	auto emitCluster = [&](uint32_t end)
+	{
+		MeshCluster cluster = {};
+		cluster.baseIndex = baseIndex + clusterBegin;
+		cluster.numIndices = end - clusterBegin;
+
+		for (uint32_t i = clusterBegin; i < end; ++i)
+		{
+			trianglePositions[i - clusterBegin] = getPosition(pIndices[i]);
+		}
+		ComputeClusterBounds_Internal(trianglePositions, cluster.numIndices / 3, cluster);
+
+		outClusters.emplace_back(cluster);
+	};
+
+	for (uint32_t i = 0; i + 2 < indexCount; i += 3)
+	{
+		// Vertices of this triangle not yet in the cluster
+		int newVertices[3];
+		uint32_t newVertexCount = 0;
+		for (uint32_t k = 0; k < 3; ++k)
+		{
+			int vertex = pIndices[i + k];
+			if (std::find(clusterVertices, clusterVertices + clusterVertexCount, vertex) == clusterVertices + clusterVertexCount
+				&& std::find(newVertices, newVertices + newVertexCount, vertex) == newVertices + newVertexCount)
+			{
+				newVertices[newVertexCount++] = vertex;
+			}
+		}
+
+		if (clusterVertexCount + newVertexCount > MAX_CLUSTER_VERTICES || i - clusterBegin >= MAX_CLUSTER_TRIANGLES * 3)
+		{
+			emitCluster(i);
+			clusterBegin = i;
+			clusterVertexCount = 0;
+
+			newVertexCount = 0;
+			for (uint32_t k = 0; k < 3; ++k)
+			{
+				int vertex = pIndices[i + k];
+				if (std::find(newVertices, newVertices + newVertexCount, vertex) == newVertices + newVertexCount)
+				{
+					newVertices[newVertexCount++] = vertex;
+				}
+			}
+		}
+
+		for (uint32_t k = 0; k < newVertexCount; ++k)
+		{
+			clusterVertices[clusterVertexCount++] = newVertices[k];
+		}
+	}
+
+	if (clusterBegin < indexCount / 3 * 3)
+	{
+		emitCluster(indexCount / 3 * 3);
+	}
+}
\ No newline at end of file
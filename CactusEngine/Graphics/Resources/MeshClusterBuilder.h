@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Engine
+{
+	// Run of consecutive triangles in index buffer, culled as a whole
+	struct MeshCluster
+	{
+		uint32_t baseIndex;
+		uint32_t numIndices;
+		float	 center[3];	  // Bounding sphere in mesh space
+		float	 radius;
+		float	 coneAxis[3]; // Average facing of the triangles
+		float	 coneCutoff;  // Sine of the largest angle between a triangle and the axis, 1 when triangles face too many directions to be culled together
+	};
+
+	// Cluster attributes split into one array each, so that several clusters are tested at once
+	struct MeshClusterStreams
+	{
+		void Assign(const MeshCluster* pClusters, size_t count);
+		size_t GetCount() const;
+
+		std::vector<float> centerX;
+		std::vector<float> centerY;
+		std::vector<float> centerZ;
+		std::vector<float> radius;
+		std::vector<float> coneAxisX;
+		std::vector<float> coneAxisY;
+		std::vector<float> coneAxisZ;
+		std::vector<float> coneCutoff;
+		std::vector<uint32_t> baseIndices;
+		std::vector<uint32_t> numIndices;
+	};
+
+	// Partitions triangles of a submesh in their existing order, so that cache optimization is kept and every cluster can be drawn as an index range
+	class MeshClusterBuilder
+	{
+	public:
+		// Indices are relative to base vertex, baseIndex is where they start in index buffer
+		// Vertex remap maps a vertex of the buffer to its entry in positions, as produced by MeshOptimizer::OptimizeVertexFetch, it can be null
+		static void Build(const int* pIndices, uint32_t indexCount, uint32_t baseIndex, uint32_t baseVertex, const float* pPositions, const uint32_t* pVertexRemap, std::vector<MeshCluster>& outClusters);
+
+	public:
+		static const uint32_t MAX_CLUSTER_VERTICES = 64;
+		static const uint32_t MAX_CLUSTER_TRIANGLES = 124;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,236 @@
+#include "MeshClusterCuller.h"
+#include "Mesh.h"
+#include <cmath>
+#include <algorithm>
+#include <thread>
+#include <future>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define MESH_CLUSTER_SSE
+#include <xmmintrin.h>
+#endif
+
+using namespace Engine;
+
+static void AppendRange_Internal(std::vector<DrawRange>& ranges, uint32_t baseIndex, uint32_t numIndices)
+{
+	if (!ranges.empty() && ranges.back().baseIndex + ranges.back().numIndices == baseIndex)
+	{
+		ranges.back().numIndices += numIndices;
+		return;
+	}
+	ranges.push_back({ baseIndex, numIndices });
+}
+
+static bool IsClusterVisible_Internal(const MeshClusterStreams& clusters, uint32_t index, const ClusterCullingView& view)
+{
+	float x = clusters.centerX[index];
+	float y = clusters.centerY[index];
+	float z = clusters.centerZ[index];
+	float radius = clusters.radius[index];
+
+	for (const Vector4& plane : view.planes)
+	{
+		if (plane.x * x + plane.y * y + plane.z * z + plane.w < -radius)
+		{
+			return false;
+		}
+	}
+
+	if (view.cullBackfaces)
+	{
+		float dx = x - view.cameraPosition.x;
+		float dy = y - view.cameraPosition.y;
+		float dz = z - view.cameraPosition.z;
+		float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+		// Every triangle faces away when view direction stays within the cone, widened by the sphere
+		if (dx * clusters.coneAxisX[index] + dy * clusters.coneAxisY[index] + dz * clusters.coneAxisZ[index] >= clusters.coneCutoff[index] * distance + radius)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void CullTask_Internal(ClusterCullingTask& task)
+{
+	const MeshClusterStreams& clusters = task.pMesh->GetClusters();
+	const std::vector<SubMesh>* pSubMeshes = task.pMesh->GetSubMeshes();
+	ClusterCullingResult& result = *task.pResult;
+
+	result.ranges.clear();
+	result.subMeshRangeOffsets.resize(pSubMeshes->size() + 1);
+
+	for (size_t i = 0; i < pSubMeshes->size(); ++i)
+	{
+		result.subMeshRangeOffsets[i] = (uint32_t)result.ranges.size();
+		MeshClusterCuller::CullClusters(clusters, pSubMeshes->at(i).m_firstCluster, pSubMeshes->at(i).m_clusterCount, task.view, result.ranges);
+	}
+	result.subMeshRangeOffsets[pSubMeshes->size()] = (uint32_t)result.ranges.size();
+	result.isValid = true;
+}
+
+ClusterCullingView MeshClusterCuller::CreateView(const Matrix4x4& viewProjection, const Matrix4x4& modelMatrix, const Vector3& cameraPosition)
+{
+	ClusterCullingView view = {};
+
+	// Planes are extracted from the combined matrix, which puts them straight into mesh space
+	Matrix4x4 mvp = viewProjection * modelMatrix;
+	Vector4 rows[4];
+	for (int i = 0; i < 4; ++i)
+	{
+		rows[i] = Vector4(mvp[0][i], mvp[1][i], mvp[2][i], mvp[3][i]);
+	}
+
+	view.planes[0] = rows[3] + rows[0];
+	view.planes[1] = rows[3] - rows[0];
+	view.planes[2] = rows[3] + rows[1];
+	view.planes[3] = rows[3] - rows[1];
+	view.planes[4] = rows[3] + rows[2];
+	view.planes[5] = rows[3] - rows[2];
+
+	for (auto& plane : view.planes)
+	{
+		float length = glm::length(Vector3(plane));
+		plane = length > 0.0f ? plane / length : Vector4(0.0f, 0.0f, 0.0f, 1.0f);
+	}
+
+	view.cameraPosition = Vector3(glm::inverse(modelMatrix) * Vector4(cameraPosition, 1.0f));
+
+	// Cones are built from mesh-space normals, any shear, non-uniform scale or mirroring would tilt them
+	float scaleX = glm::length(Vector3(modelMatrix[0]));
+	float scaleY = glm::length(Vector3(modelMatrix[1]));
+	float scaleZ = glm::length(Vector3(modelMatrix[2]));
+	float minScale = std::min(scaleX, std::min(scaleY, scaleZ));
+	float maxScale = std::max(scaleX, std::max(scaleY, scaleZ));
+	view.cullBackfaces = minScale > 0.0f && maxScale / minScale < 1.01f && glm::dot(glm::cross(Vector3(modelMatrix[0]), Vector3(modelMatrix[1])), Vector3(modelMatrix[2])) > 0.0f;
+
+	return view;
+}
+
+void MeshClusterCuller::Cull(std::vector<ClusterCullingTask>& tasks)
+{
+	size_t totalClusterCount = 0;
+	for (auto& task : tasks)
+	{
+		totalClusterCount += task.pMesh->GetClusters().GetCount();
+	}
+
+	size_t workerCount = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), totalClusterCount / MIN_CLUSTERS_PER_WORKER));
+	size_t clustersPerWorker = (totalClusterCount + workerCount - 1) / workerCount;
+
+	// Tasks are split into contiguous runs of roughly equal cluster counts, calling thread takes the first one
+	std::vector<std::future<void>> workers;
+	size_t runBegin = 0;
+	size_t runClusterCount = 0;
+	size_t firstRunEnd = tasks.size();
+
+	for (size_t i = 0; i < tasks.size(); ++i)
+	{
+		runClusterCount += tasks[i].pMesh->GetClusters().GetCount();
+		if (runClusterCount < clustersPerWorker && i + 1 < tasks.size())
+		{
+			continue;
+		}
+
+		if (runBegin == 0)
+		{
+			firstRunEnd = i + 1;
+		}
+		else
+		{
+			ClusterCullingTask* pRun = &tasks[runBegin];
+			size_t runLength = i + 1 - runBegin;
+			workers.emplace_back(std::async(std::launch::async, [pRun, runLength]()
+				{
+					for (size_t j = 0; j < runLength; ++j)
+					{
+						CullTask_Internal(pRun[j]);
+					}
+				}));
+		}
+
+		runBegin = i + 1;
+		runClusterCount = 0;
+	}
+
+	for (size_t i = 0; i < firstRunEnd; ++i)
+	{
+		CullTask_Internal(tasks[i]);
+	}
+
+	for (auto& worker : workers)
+	{
+		worker.wait();
+	}
+}
+
+void MeshClusterCuller::CullClusters(const MeshClusterStreams& clusters, uint32_t firstCluster, uint32_t clusterCount, const ClusterCullingView& view, std::vector<DrawRange>& outRanges)
+{
+	uint32_t index = firstCluster;
+	uint32_t end = firstCluster + clusterCount;
+
+#if defined(MESH_CLUSTER_SSE)
+	__m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+	for (int i = 0; i < 6; ++i)
+	{
+		planeX[i] = _mm_set1_ps(view.planes[i].x);
+		planeY[i] = _mm_set1_ps(view.planes[i].y);
+		planeZ[i] = _mm_set1_ps(view.planes[i].z);
+		planeW[i] = _mm_set1_ps(view.planes[i].w);
+	}
+
+	__m128 cameraX = _mm_set1_ps(view.cameraPosition.x);
+	__m128 cameraY = _mm_set1_ps(view.cameraPosition.y);
+	__m128 cameraZ = _mm_set1_ps(view.cameraPosition.z);
+	__m128 zero = _mm_setzero_ps();
+
+	for (; index + 4 <= end; index += 4)
+	{
+		__m128 x = _mm_loadu_ps(&clusters.centerX[index]);
+		__m128 y = _mm_loadu_ps(&clusters.centerY[index]);
+		__m128 z = _mm_loadu_ps(&clusters.centerZ[index]);
+		__m128 radius = _mm_loadu_ps(&clusters.radius[index]);
+		__m128 negativeRadius = _mm_sub_ps(zero, radius);
+
+		__m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (int i = 0; i < 6; ++i)
+		{
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[i], x), _mm_mul_ps(planeY[i], y)), _mm_add_ps(_mm_mul_ps(planeZ[i], z), planeW[i]));
+			visible = _mm_and_ps(visible, _mm_cmpge_ps(distance, negativeRadius));
+		}
+
+		if (view.cullBackfaces)
+		{
+			__m128 dx = _mm_sub_ps(x, cameraX);
+			__m128 dy = _mm_sub_ps(y, cameraY);
+			__m128 dz = _mm_sub_ps(z, cameraZ);
+			__m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+
+			__m128 facing = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, _mm_loadu_ps(&clusters.coneAxisX[index])), _mm_mul_ps(dy, _mm_loadu_ps(&clusters.coneAxisY[index]))),
+				_mm_mul_ps(dz, _mm_loadu_ps(&clusters.coneAxisZ[index])));
+			__m128 limit = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&clusters.coneCutoff[index]), distance), radius);
+			visible = _mm_andnot_ps(_mm_cmpge_ps(facing, limit), visible);
+		}
+
+		int mask = _mm_movemask_ps(visible);
+		for (uint32_t i = 0; i < 4; ++i)
+		{
+			if (mask & (1 << i))
+			{
+				AppendRange_Internal(outRanges, clusters.baseIndices[index + i], clusters.numIndices[index + i]);
+			}
+		}
+	}
+#endif
+
+	for (; index < end; ++index)
+	{
+		if (IsClusterVisible_Internal(clusters, index, view))
+		{
+			AppendRange_Internal(outRanges, clusters.baseIndices[index], clusters.numIndices[index]);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+#include "BasicMathTypes.h"
+#include "MeshClusterBuilder.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Engine
+{
+	class Mesh;
+
+	struct DrawRange
+	{
+		uint32_t baseIndex;
+		uint32_t numIndices;
+	};
+
+	// Index ranges left to draw for every submesh of one mesh
+	struct ClusterCullingResult
+	{
+		std::vector<DrawRange> ranges;
+		std::vector<uint32_t> subMeshRangeOffsets; // Ranges of submesh i are [offsets[i], offsets[i + 1])
+		bool isValid = false; // Submeshes are drawn whole otherwise
+	};
+
+	// Frustum and camera transformed into mesh space
+	struct ClusterCullingView
+	{
+		Vector4 planes[6]; // Normalized, pointing inwards
+		Vector3 cameraPosition;
+		bool	cullBackfaces; // Normal cones only stay valid under rotation and uniform scale
+	};
+
+	struct ClusterCullingTask
+	{
+		const Mesh*			  pMesh;
+		ClusterCullingView	  view;
+		ClusterCullingResult* pResult;
+	};
+
+	// Tests bounding spheres of mesh clusters against view frustum and their normal cones against camera position
+	// Clusters are tested four at a time with SSE where available, tasks are spread over worker threads by their cluster counts
+	class MeshClusterCuller
+	{
+	public:
+		static ClusterCullingView CreateView(const Matrix4x4& viewProjection, const Matrix4x4& modelMatrix, const Vector3& cameraPosition);
+		static void Cull(std::vector<ClusterCullingTask>& tasks);
+		// Visible clusters in [firstCluster, firstCluster + clusterCount) are appended to output, neighbouring ones are merged into one range
+		static void CullClusters(const MeshClusterStreams& clusters, uint32_t firstCluster, uint32_t clusterCount, const ClusterCullingView& view, std::vector<DrawRange>& outRanges);
+
+	public:
+		static const uint32_t MIN_CLUSTERS_PER_WORKER = 4096; // Fewer clusters are culled on calling thread only
+	};
+}
\ No newline at end of file
@@ -0,0 +1,410 @@
+#include "MeshOptimizer.h"
+#include <cmath>
+#include <algorithm>
+#include <cassert>
+
+using namespace Engine;
+
+// Timestamp based FIFO cache, a vertex stays in cache until cacheSize more misses happened after it was loaded
+struct FIFOCacheSimulator_Internal
+{
+	FIFOCacheSimulator_Internal(uint32_t vertexCount, uint32_t size)
+		: timestamps(vertexCount, 0), cacheSize(size), timestamp(size + 1)
+	{
+	}
+
+	bool Access(uint32_t vertex)
+	{
+		if (timestamp - timestamps[vertex] > cacheSize)
+		{
+			timestamps[vertex] = timestamp++;
+			return false;
+		}
+		return true;
+	}
+
+	void Reset()
+	{
+		timestamp += cacheSize + 1;
+	}
+
+	std::vector<uint32_t> timestamps;
+	uint32_t cacheSize;
+	uint32_t timestamp;
+};
+
+static float ForsythVertexScore_Internal(int cachePosition, uint32_t remainingValence)
+{
+	if (remainingValence == 0)
+	{
+		return -1.0f; // No triangle needs this vertex anymore
+	}
+
+	float score = 0.0f;
+	if (cachePosition >= 0)
+	{
+		// Vertices of the last triangle get a fixed score, so that the next triangle doesn't simply reuse the same edge
+		score = cachePosition < 3 ? 0.75f : std::pow(1.0f - (cachePosition - 3) / float(MeshOptimizer::OPTIMIZED_CACHE_SIZE - 3), 1.5f);
+	}
+
+	// Boost vertices with few remaining triangles to get rid of lone triangles
+	return score + 2.0f * std::pow((float)remainingValence, -0.5f);
+}
+
+void MeshOptimizer::OptimizeVertexCache(int* pIndices, uint32_t indexCount, uint32_t vertexCount)
+{
+	assert(indexCount % 3 == 0);
+	uint32_t triangleCount = indexCount / 3;
+
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	// Triangles adjacent to each vertex, emitted ones are swapped to the end of each list
+	std::vector<uint32_t> remainingValence(vertexCount, 0);
+	for (uint32_t i = 0; i < indexCount; ++i)
+	{
+		remainingValence[pIndices[i]]++;
+	}
+
+	std::vector<uint32_t> adjacencyOffsets(vertexCount, 0);
+	for (uint32_t i = 1; i < vertexCount; ++i)
+	{
+		adjacencyOffsets[i] = adjacencyOffsets[i - 1] + remainingValence[i - 1];
+	}
+
+	std::vector<uint32_t> adjacentTriangles(indexCount);
+	std::vector<uint32_t> fillCounts(vertexCount, 0);
+	for (uint32_t i = 0; i < indexCount; ++i)
+	{
+		uint32_t vertex = pIndices[i];
+		adjacentTriangles[adjacencyOffsets[vertex] + fillCounts[vertex]++] = i / 3;
+	}
+
+	std::vector<int> cachePositions(vertexCount, -1);
+	std::vector<float> vertexScores(vertexCount);
+	for (uint32_t i = 0; i < vertexCount; ++i)
+	{
+		vertexScores[i] = ForsythVertexScore_Internal(-1, remainingValence[i]);
+	}
+
+	std::vector<float> triangleScores(triangleCount);
+	for (uint32_t i = 0; i < triangleCount; ++i)
+	{
+		triangleScores[i] = vertexScores[pIndices[i * 3]] + vertexScores[pIndices[i * 3 + 1]] + vertexScores[pIndices[i * 3 + 2]];
+	}
+
+	std::vector<bool> isEmitted(triangleCount, false);
+	std::vector<int> optimizedIndices;
+	optimizedIndices.reserve(indexCount);
+
+	// Extra 3 entries hold the vertices that are pushed out by the latest triangle
+	std::vector<uint32_t> cache;
+	std::vector<uint32_t> nextCache;
+	cache.reserve(OPTIMIZED_CACHE_SIZE + 3);
+	nextCache.reserve(OPTIMIZED_CACHE_SIZE + 3);
+
+	uint32_t inputCursor = 0;
+	int64_t bestTriangle = std::max_element(triangleScores.begin(), triangleScores.end()) - triangleScores.begin();
+
+	while (bestTriangle >= 0)
+	{
+		isEmitted[bestTriangle] = true;
+
+		const int* pTriangle = &pIndices[bestTriangle * 3];
+		nextCache.assign(pTriangle, pTriangle + 3);
+
+		for (uint32_t i = 0; i < 3; ++i)
+		{
+			uint32_t vertex = pTriangle[i];
+			optimizedIndices.emplace_back((int)vertex);
+
+			uint32_t* pAdjacency = &adjacentTriangles[adjacencyOffsets[vertex]];
+			uint32_t* pLast = pAdjacency + remainingValence[vertex] - 1;
+			*std::find(pAdjacency, pLast + 1, (uint32_t)bestTriangle) = *pLast;
+			*pLast = (uint32_t)bestTriangle;
+			remainingValence[vertex]--;
+		}
+
+		for (auto vertex : cache)
+		{
+			if (vertex != (uint32_t)pTriangle[0] && vertex != (uint32_t)pTriangle[1] && vertex != (uint32_t)pTriangle[2])
+			{
+				nextCache.emplace_back(vertex);
+			}
+		}
+
+		// Rescore vertices that moved in or out of cache, and their remaining triangles
+		bestTriangle = -1;
+		float bestScore = -1.0f;
+
+		for (uint32_t i = 0; i < nextCache.size(); ++i)
+		{
+			uint32_t vertex = nextCache[i];
+			cachePositions[vertex] = i < OPTIMIZED_CACHE_SIZE ? (int)i : -1;
+
+			float scoreDelta = ForsythVertexScore_Internal(cachePositions[vertex], remainingValence[vertex]) - vertexScores[vertex];
+			vertexScores[vertex] += scoreDelta;
+
+			for (uint32_t j = 0; j < remainingValence[vertex]; ++j)
+			{
+				uint32_t triangle = adjacentTriangles[adjacencyOffsets[vertex] + j];
+				triangleScores[triangle] += scoreDelta;
+			}
+		}
+
+		for (uint32_t i = 0; i < nextCache.size() && i < OPTIMIZED_CACHE_SIZE; ++i)
+		{
+			uint32_t vertex = nextCache[i];
+			for (uint32_t j = 0; j < remainingValence[vertex]; ++j)
+			{
+				uint32_t triangle = adjacentTriangles[adjacencyOffsets[vertex] + j];
+				if (triangleScores[triangle] > bestScore)
+				{
+					bestScore = triangleScores[triangle];
+					bestTriangle = triangle;
+				}
+			}
+		}
+
+		if (nextCache.size() > OPTIMIZED_CACHE_SIZE)
+		{
+			nextCache.resize(OPTIMIZED_CACHE_SIZE);
+		}
+		std::swap(cache, nextCache);
+
+		// Nothing in cache is connected to the rest, continue with the next triangle in input order
+		if (bestTriangle < 0)
+		{
+			while (inputCursor < triangleCount && isEmitted[inputCursor])
+			{
+				inputCursor++;
+			}
+			bestTriangle = inputCursor < triangleCount ? (int64_t)inputCursor : -1;
+		}
+	}
+
+	assert(optimizedIndices.size() == indexCount);
+	std::copy(optimizedIndices.begin(), optimizedIndices.end(), pIndices);
+}
+
+void MeshOptimizer::OptimizeOverdraw(int* pIndices, uint32_t indexCount, const float* pPositions, uint32_t vertexCount, float threshold)
+{
+	// Simplified from "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw" by Sander et al.
+
+	assert(indexCount % 3 == 0);
+	uint32_t triangleCount = indexCount / 3;
+
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	FIFOCacheSimulator_Internal cacheSimulator(vertexCount, SIMULATED_CACHE_SIZE);
+
+	auto triangleMisses = [&cacheSimulator, pIndices](uint32_t triangle)
+	{
+		uint32_t misses = 0;
+		for (uint32_t i = 0; i < 3; ++i)
+		{
+			misses += cacheSimulator.Access(pIndices[triangle * 3 + i]) ? 0 : 1;
+		}
+		return misses;
+	};
+
+	// Hard boundaries are where the cache is fully flushed, reordering there costs nothing
+	std::vector<uint32_t> hardClusters;
+	for (uint32_t i = 0; i < triangleCount; ++i)
+	{
+		if (triangleMisses(i) == 3)
+		{
+			hardClusters.emplace_back(i);
+		}
+	}
+	hardClusters.emplace_back(triangleCount);
+
+	// Soft boundaries split hard clusters where the cache efficiency so far is already close enough to the whole cluster
+	std::vector<uint32_t> clusters;
+	for (uint32_t i = 0; i + 1 < hardClusters.size(); ++i)
+	{
+		uint32_t start = hardClusters[i];
+		uint32_t end = hardClusters[i + 1];
+
+		cacheSimulator.Reset();
+		uint32_t clusterMisses = 0;
+		for (uint32_t j = start; j < end; ++j)
+		{
+			clusterMisses += triangleMisses(j);
+		}
+		float clusterThreshold = threshold * clusterMisses / float(end - start);
+
+		cacheSimulator.Reset();
+		clusters.emplace_back(start);
+
+		uint32_t runningMisses = 0;
+		uint32_t runningTriangles = 0;
+		for (uint32_t j = start; j < end; ++j)
+		{
+			runningMisses += triangleMisses(j);
+			runningTriangles++;
+
+			if (j + 1 < end && runningMisses / float(runningTriangles) <= clusterThreshold)
+			{
+				clusters.emplace_back(j + 1);
+				cacheSimulator.Reset();
+				runningMisses = 0;
+				runningTriangles = 0;
+			}
+		}
+	}
+	clusters.emplace_back(triangleCount);
+
+	uint32_t clusterCount = (uint32_t)clusters.size() - 1;
+
+	auto position = [pPositions](int vertex, uint32_t component)
+	{
+		return pPositions[vertex * 3 + component];
+	};
+
+	// Area weighted centroid and normal of each cluster
+	float meshCentroid[3] = { 0, 0, 0 };
+	float meshArea = 0;
+	std::vector<float> clusterData(clusterCount * 6, 0.0f);
+
+	for (uint32_t i = 0; i < clusterCount; ++i)
+	{
+		float* pCentroid = &clusterData[i * 6];
+		float* pNormal = &clusterData[i * 6 + 3];
+		float clusterArea = 0;
+
+		for (uint32_t j = clusters[i]; j < clusters[i + 1]; ++j)
+		{
+			int a = pIndices[j * 3], b = pIndices[j * 3 + 1], c = pIndices[j * 3 + 2];
+
+			float edge0[3], edge1[3];
+			for (uint32_t k = 0; k < 3; ++k)
+			{
+				edge0[k] = position(b, k) - position(a, k);
+				edge1[k] = position(c, k) - position(a, k);
+			}
+
+			float normal[3] =
+			{
+				edge0[1] * edge1[2] - edge0[2] * edge1[1],
+				edge0[2] * edge1[0] - edge0[0] * edge1[2],
+				edge0[0] * edge1[1] - edge0[1] * edge1[0]
+			};
+			float area = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+
+			for (uint32_t k = 0; k < 3; ++k)
+			{
+				float center = (position(a, k) + position(b, k) + position(c, k)) / 3.0f;
+				pCentroid[k] += center * area;
+				meshCentroid[k] += center * area;
+				pNormal[k] += normal[k];
+			}
+			clusterArea += area;
+		}
+
+		for (uint32_t k = 0; k < 3; ++k)
+		{
+			pCentroid[k] = clusterArea > 0 ? pCentroid[k] / clusterArea : 0;
+		}
+		meshArea += clusterArea;
+	}
+
+	for (uint32_t k = 0; k < 3; ++k)
+	{
+		meshCentroid[k] = meshArea > 0 ? meshCentroid[k] / meshArea : 0;
+	}
+
+	// Clusters facing away from mesh center are more likely to occlude others
+	std::vector<float> sortKeys(clusterCount);
+	for (uint32_t i = 0; i < clusterCount; ++i)
+	{
+		const float* pCentroid = &clusterData[i * 6];
+		const float* pNormal = &clusterData[i * 6 + 3];
+
+		float normalLength = std::sqrt(pNormal[0] * pNormal[0] + pNormal[1] * pNormal[1] + pNormal[2] * pNormal[2]);
+		float dot = 0;
+		for (uint32_t k = 0; k < 3; ++k)
+		{
+			dot += (pCentroid[k] - meshCentroid[k]) * pNormal[k];
+		}
+		sortKeys[i] = normalLength > 0 ? dot / normalLength : 0;
+	}
+
+	std::vector<uint32_t> clusterOrder(clusterCount);
+	for (uint32_t i = 0; i < clusterCount; ++i)
+	{
+		clusterOrder[i] = i;
+	}
+	std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&sortKeys](uint32_t lhs, uint32_t rhs) { return sortKeys[lhs] > sortKeys[rhs]; });
+
+	std::vector<int> sortedIndices;
+	sortedIndices.reserve(indexCount);
+	for (auto cluster : clusterOrder)
+	{
+		sortedIndices.insert(sortedIndices.end(), pIndices + clusters[cluster] * 3, pIndices + clusters[cluster + 1] * 3);
+	}
+
+	std::copy(sortedIndices.begin(), sortedIndices.end(), pIndices);
+}
+
+void MeshOptimizer::OptimizeVertexFetch(int* pIndices, uint32_t indexCount, uint32_t vertexCount, std::vector<uint32_t>& outRemap)
+{
+	const uint32_t UNASSIGNED = (uint32_t)-1;
+	std::vector<uint32_t> oldToNew(vertexCount, UNASSIGNED);
+
+	outRemap.clear();
+	outRemap.reserve(vertexCount);
+
+	for (uint32_t i = 0; i < indexCount; ++i)
+	{
+		uint32_t vertex = pIndices[i];
+		if (oldToNew[vertex] == UNASSIGNED)
+		{
+			oldToNew[vertex] = (uint32_t)outRemap.size();
+			outRemap.emplace_back(vertex);
+		}
+		pIndices[i] = (int)oldToNew[vertex];
+	}
+
+	// Unreferenced vertices are kept at the end, so that vertex count and base vertex of the submesh don't change
+	for (uint32_t i = 0; i < vertexCount; ++i)
+	{
+		if (oldToNew[i] == UNASSIGNED)
+		{
+			outRemap.emplace_back(i);
+		}
+	}
+}
+
+MeshCacheStatistics MeshOptimizer::AnalyzeVertexCache(const int* pIndices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize)
+{
+	FIFOCacheSimulator_Internal cacheSimulator(vertexCount, cacheSize);
+	std::vector<bool> isReferenced(vertexCount, false);
+
+	MeshCacheStatistics statistics = {};
+	uint32_t referencedVertices = 0;
+
+	for (uint32_t i = 0; i < indexCount; ++i)
+	{
+		if (!cacheSimulator.Access(pIndices[i]))
+		{
+			statistics.transformedVertices++;
+		}
+
+		if (!isReferenced[pIndices[i]])
+		{
+			isReferenced[pIndices[i]] = true;
+			referencedVertices++;
+		}
+	}
+
+	statistics.acmr = indexCount > 0 ? statistics.transformedVertices / float(indexCount / 3) : 0;
+	statistics.atvr = referencedVertices > 0 ? statistics.transformedVertices / float(referencedVertices) : 0;
+
+	return statistics;
+}
\ No newline at end of file
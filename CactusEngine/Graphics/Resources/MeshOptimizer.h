@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace Engine
+{
+	struct MeshCacheStatistics
+	{
+		uint32_t transformedVertices;
+		float	 acmr; // Average cache miss ratio, transformed vertices per triangle, 3.0 is the worst and ~0.5 is the best for regular grids
+		float	 atvr; // Average transformed vertex ratio, transformed vertices per referenced vertex, 1.0 is optimal
+	};
+
+	// Post-import processing of a single submesh, indices are relative to its first vertex
+	class MeshOptimizer
+	{
+	public:
+		// Reorders triangles for post-transform vertex cache with Tom Forsyth's linear-speed algorithm
+		static void OptimizeVertexCache(int* pIndices, uint32_t indexCount, uint32_t vertexCount);
+		// Should be applied after OptimizeVertexCache, clusters of cache-optimized triangles are sorted so that outer facing ones are drawn first
+		// Threshold controls how much vertex cache efficiency could be traded, e.g. 1.05 allows 5% worse ACMR within a cluster
+		static void OptimizeOverdraw(int* pIndices, uint32_t indexCount, const float* pPositions, uint32_t vertexCount, float threshold);
+		// Reorders vertices by first use, outRemap maps new vertex index to the original one and indices are rewritten in place
+		// Vertex data is left untouched, the remap is applied when it's interleaved by VertexStreamBuilder
+		static void OptimizeVertexFetch(int* pIndices, uint32_t indexCount, uint32_t vertexCount, std::vector<uint32_t>& outRemap);
+
+		// Simulates a FIFO cache, which is closer to actual hardware than the LRU cache assumed by the optimization
+		static MeshCacheStatistics AnalyzeVertexCache(const int* pIndices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize = SIMULATED_CACHE_SIZE);
+
+	public:
+		static const uint32_t SIMULATED_CACHE_SIZE = 16;
+		static const uint32_t OPTIMIZED_CACHE_SIZE = 32;
+	};
+}
\ No newline at end of file
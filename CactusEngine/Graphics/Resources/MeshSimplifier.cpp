@@ -0,0 +1,655 @@
+#include "MeshSimplifier.h"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+#include <unordered_map>
+
+using namespace Engine;
+
+static const uint32_t INVALID_VERTEX_INTERNAL = (uint32_t)-1;
+
+enum class EVertexKind_Internal : uint8_t
+{
+	Manifold = 0, // Collapses onto any neighbour
+	Border,		  // Has one incoming and one outgoing open edge, collapses along them only
+	Seam,		  // Shares its position with exactly one other vertex, both of them collapse together along the seam
+	Locked		  // Anything more complex, never collapses
+};
+
+// Sum of weighted planes as a symmetric 4x4 matrix, evaluates to the weighted squared distance of a point from them
+struct Quadric_Internal
+{
+	void AddPlane(double nx, double ny, double nz, double d, double w)
+	{
+		a00 += w * nx * nx;
+		a11 += w * ny * ny;
+		a22 += w * nz * nz;
+		a10 += w * ny * nx;
+		a20 += w * nz * nx;
+		a21 += w * nz * ny;
+		b0 += w * nx * d;
+		b1 += w * ny * d;
+		b2 += w * nz * d;
+		c += w * d * d;
+		weight += w;
+	}
+
+	void Add(const Quadric_Internal& other)
+	{
+		a00 += other.a00;
+		a11 += other.a11;
+		a22 += other.a22;
+		a10 += other.a10;
+		a20 += other.a20;
+		a21 += other.a21;
+		b0 += other.b0;
+		b1 += other.b1;
+		b2 += other.b2;
+		c += other.c;
+		weight += other.weight;
+	}
+
+	// Normalized by total weight, so that the error is a mean squared distance regardless of triangle sizes
+	double Evaluate(const float* pPosition) const
+	{
+		double x = pPosition[0], y = pPosition[1], z = pPosition[2];
+		double error = a00 * x * x + a11 * y * y + a22 * z * z + 2.0 * (a10 * x * y + a20 * x * z + a21 * y * z) + 2.0 * (b0 * x + b1 * y + b2 * z) + c;
+		return weight > 0.0 ? std::fabs(error) / weight : 0.0;
+	}
+
+	double a00 = 0.0, a11 = 0.0, a22 = 0.0, a10 = 0.0, a20 = 0.0, a21 = 0.0;
+	double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+	double c = 0.0;
+	double weight = 0.0;
+};
+
+// Per-vertex lists in one array, either outgoing half-edge targets or adjacent triangles
+struct VertexAdjacency_Internal
+{
+	// Remap redirects vertices before they are recorded, e.g. to merge vertices of the same position
+	void BuildEdges(const std::vector<uint32_t>& indices, uint32_t vertexCount, const uint32_t* pRemap)
+	{
+		Build(indices, vertexCount, pRemap, true);
+	}
+
+	void BuildTriangles(const std::vector<uint32_t>& indices, uint32_t vertexCount)
+	{
+		Build(indices, vertexCount, nullptr, false);
+	}
+
+	bool HasEdge(uint32_t from, uint32_t to) const
+	{
+		for (uint32_t i = offsets[from]; i < offsets[from + 1]; ++i)
+		{
+			if (items[i] == to)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	std::vector<uint32_t> offsets;
+	std::vector<uint32_t> items;
+
+private:
+	void Build(const std::vector<uint32_t>& indices, uint32_t vertexCount, const uint32_t* pRemap, bool recordEdges)
+	{
+		auto map = [pRemap](uint32_t vertex) { return pRemap != nullptr ? pRemap[vertex] : vertex; };
+
+		offsets.assign((size_t)vertexCount + 1, 0);
+		for (uint32_t index : indices)
+		{
+			offsets[map(index) + 1]++;
+		}
+		for (uint32_t i = 0; i < vertexCount; ++i)
+		{
+			offsets[i + 1] += offsets[i];
+		}
+
+		items.resize(indices.size());
+		std::vector<uint32_t> writeOffsets(offsets.begin(), offsets.end() - 1);
+
+		for (size_t i = 0; i < indices.size(); ++i)
+		{
+			size_t triangleBase = i - i % 3;
+			uint32_t next = indices[triangleBase + (i + 1) % 3];
+			items[writeOffsets[map(indices[i])]++] = recordEdges ? map(next) : (uint32_t)(i / 3);
+		}
+	}
+};
+
+struct PositionKey_Internal
+{
+	bool operator==(const PositionKey_Internal& other) const
+	{
+		return bits[0] == other.bits[0] && bits[1] == other.bits[1] && bits[2] == other.bits[2];
+	}
+
+	uint32_t bits[3];
+};
+
+struct PositionKeyHasher_Internal
+{
+	size_t operator()(const PositionKey_Internal& key) const
+	{
+		return (size_t)((key.bits[0] * 73856093u) ^ (key.bits[1] * 19349663u) ^ (key.bits[2] * 83492791u));
+	}
+};
+
+// Maps every vertex to the first one at the same position, and links vertices at the same position into a ring
+static void BuildPositionRemap_Internal(const float* pPositions, uint32_t vertexCount, std::vector<uint32_t>& outRemap, std::vector<uint32_t>& outWedges)
+{
+	std::unordered_map<PositionKey_Internal, uint32_t, PositionKeyHasher_Internal> firstVertices;
+	firstVertices.reserve(vertexCount);
+
+	outRemap.resize(vertexCount);
+	outWedges.resize(vertexCount);
+
+	for (uint32_t i = 0; i < vertexCount; ++i)
+	{
+		PositionKey_Internal key = {};
+		memcpy(key.bits, &pPositions[(size_t)i * 3], sizeof(key.bits));
+
+		uint32_t first = firstVertices.emplace(key, i).first->second;
+		outRemap[i] = first;
+
+		// Inserted right after the first vertex of the ring
+		outWedges[i] = first == i ? i : outWedges[first];
+		outWedges[first] = i;
+	}
+}
+
+static void ComputeNormal_Internal(const float* p0, const float* p1, const float* p2, double* pOutNormal)
+{
+	double e0[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+	double e1[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+
+	pOutNormal[0] = e0[1] * e1[2] - e0[2] * e1[1];
+	pOutNormal[1] = e0[2] * e1[0] - e0[0] * e1[2];
+	pOutNormal[2] = e0[0] * e1[1] - e0[1] * e1[0];
+}
+
+float MeshSimplifier::Simplify(const int* pIndices, uint32_t indexCount, const float* pPositions, uint32_t vertexCount, uint32_t targetIndexCount, std::vector<int>& outIndices)
+{
+	std::vector<uint32_t> indices(pIndices, pIndices + indexCount);
+	auto getPosition = [pPositions](uint32_t vertex) { return &pPositions[(size_t)vertex * 3]; };
+
+	std::vector<uint32_t> positionRemap;
+	std::vector<uint32_t> wedges;
+	BuildPositionRemap_Internal(pPositions, vertexCount, positionRemap, wedges);
+
+	// Edges without a twin in opposite direction are open, they lie on a border if even their positions have no twin, otherwise on a seam
+
+	VertexAdjacency_Internal edges;
+	VertexAdjacency_Internal positionEdges;
+	edges.BuildEdges(indices, vertexCount, nullptr);
+	positionEdges.BuildEdges(indices, vertexCount, positionRemap.data());
+
+	std::vector<uint32_t> openTargets(vertexCount, INVALID_VERTEX_INTERNAL);
+	std::vector<uint32_t> openSources(vertexCount, INVALID_VERTEX_INTERNAL);
+	std::vector<uint8_t> openOutCounts(vertexCount, 0);
+	std::vector<uint8_t> openInCounts(vertexCount, 0);
+	std::vector<bool> onBorder(vertexCount, false);
+	std::vector<bool> onSeam(vertexCount, false);
+
+	for (uint32_t from = 0; from < vertexCount; ++from)
+	{
+		for (uint32_t i = edges.offsets[from]; i < edges.offsets[from + 1]; ++i)
+		{
+			uint32_t to = edges.items[i];
+			if (edges.HasEdge(to, from))
+			{
+				continue;
+			}
+
+			openTargets[from] = to;
+			openSources[to] = from;
+			openOutCounts[from] = (uint8_t)std::min(openOutCounts[from] + 1, 255);
+			openInCounts[to] = (uint8_t)std::min(openInCounts[to] + 1, 255);
+
+			bool isBorder = !positionEdges.HasEdge(positionRemap[to], positionRemap[from]);
+			(isBorder ? onBorder : onSeam)[from] = true;
+			(isBorder ? onBorder : onSeam)[to] = true;
+		}
+	}
+
+	std::vector<EVertexKind_Internal> kinds(vertexCount, EVertexKind_Internal::Locked);
+	for (uint32_t i = 0; i < vertexCount; ++i)
+	{
+		bool hasSingleOpenChain = openOutCounts[i] == 1 && openInCounts[i] == 1;
+
+		if (wedges[i] == i)
+		{
+			if (openOutCounts[i] == 0 && openInCounts[i] == 0)
+			{
+				kinds[i] = EVertexKind_Internal::Manifold;
+			}
+			else if (hasSingleOpenChain && !onSeam[i])
+			{
+				kinds[i] = EVertexKind_Internal::Border;
+			}
+		}
+		else if (wedges[wedges[i]] == i)
+		{
+			uint32_t twin = wedges[i];
+			if (hasSingleOpenChain && openOutCounts[twin] == 1 && openInCounts[twin] == 1 && !onBorder[i] && !onBorder[twin])
+			{
+				kinds[i] = EVertexKind_Internal::Seam;
+			}
+		}
+	}
+
+	// Quadrics are shared by vertices at the same position, they start from planes of adjacent triangles weighted by area
+	// Open edges add planes perpendicular to their triangle, which penalize moving away from borders and seams
+
+	std::vector<Quadric_Internal> quadrics(vertexCount);
+	for (size_t i = 0; i < indices.size(); i += 3)
+	{
+		const float* triangle[3] = { getPosition(indices[i]), getPosition(indices[i + 1]), getPosition(indices[i + 2]) };
+
+		double normal[3];
+		ComputeNormal_Internal(triangle[0], triangle[1], triangle[2], normal);
+		double length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		if (length <= 0.0)
+		{
+			continue;
+		}
+		normal[0] /= length;
+		normal[1] /= length;
+		normal[2] /= length;
+
+		double d = -(normal[0] * triangle[0][0] + normal[1] * triangle[0][1] + normal[2] * triangle[0][2]);
+		for (uint32_t k = 0; k < 3; ++k)
+		{
+			quadrics[positionRemap[indices[i + k]]].AddPlane(normal[0], normal[1], normal[2], d, length * 0.5);
+		}
+
+		for (uint32_t k = 0; k < 3; ++k)
+		{
+			uint32_t from = indices[i + k];
+			uint32_t to = indices[i + (k + 1) % 3];
+			if (edges.HasEdge(to, from))
+			{
+				continue;
+			}
+
+			const float* p0 = triangle[k];
+			const float* p1 = triangle[(k + 1) % 3];
+			double edge[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+			double edgeLengthSquared = edge[0] * edge[0] + edge[1] * edge[1] + edge[2] * edge[2];
+
+			double edgeNormal[3] = { edge[1] * normal[2] - edge[2] * normal[1], edge[2] * normal[0] - edge[0] * normal[2], edge[0] * normal[1] - edge[1] * normal[0] };
+			double edgeNormalLength = std::sqrt(edgeNormal[0] * edgeNormal[0] + edgeNormal[1] * edgeNormal[1] + edgeNormal[2] * edgeNormal[2]);
+			if (edgeNormalLength <= 0.0)
+			{
+				continue;
+			}
+			edgeNormal[0] /= edgeNormalLength;
+			edgeNormal[1] /= edgeNormalLength;
+			edgeNormal[2] /= edgeNormalLength;
+
+			double edgeD = -(edgeNormal[0] * p0[0] + edgeNormal[1] * p0[1] + edgeNormal[2] * p0[2]);
+			quadrics[positionRemap[from]].AddPlane(edgeNormal[0], edgeNormal[1], edgeNormal[2], edgeD, edgeLengthSquared * BOUNDARY_WEIGHT);
+			quadrics[positionRemap[to]].AddPlane(edgeNormal[0], edgeNormal[1], edgeNormal[2], edgeD, edgeLengthSquared * BOUNDARY_WEIGHT);
+		}
+	}
+
+	// Seam vertex moves together with its twin, which has to collapse onto the twin at target position
+	auto findSeamTwinTarget = [&](uint32_t vertex, uint32_t target)
+	{
+		uint32_t twin = wedges[vertex];
+		if (openTargets[twin] != INVALID_VERTEX_INTERNAL && positionRemap[openTargets[twin]] == positionRemap[target])
+		{
+			return openTargets[twin];
+		}
+		if (openSources[twin] != INVALID_VERTEX_INTERNAL && positionRemap[openSources[twin]] == positionRemap[target])
+		{
+			return openSources[twin];
+		}
+		return INVALID_VERTEX_INTERNAL;
+	};
+
+	auto canCollapse = [&](uint32_t vertex, uint32_t target)
+	{
+		if (positionRemap[vertex] == positionRemap[target])
+		{
+			return false;
+		}
+
+		bool alongOpenEdge = openTargets[vertex] == target || openSources[vertex] == target;
+
+		switch (kinds[vertex])
+		{
+		case EVertexKind_Internal::Manifold:
+			return true;
+		case EVertexKind_Internal::Border:
+			return alongOpenEdge && (kinds[target] == EVertexKind_Internal::Border || kinds[target] == EVertexKind_Internal::Locked);
+		case EVertexKind_Internal::Seam:
+			return alongOpenEdge && (kinds[target] == EVertexKind_Internal::Seam || kinds[target] == EVertexKind_Internal::Locked)
+				&& findSeamTwinTarget(vertex, target) != INVALID_VERTEX_INTERNAL;
+		default:
+			return false;
+		}
+	};
+
+	VertexAdjacency_Internal triangles;
+
+	// Any remaining triangle around the vertex turning over once it moves to target rejects the collapse
+	auto hasTriangleFlip = [&](uint32_t vertex, uint32_t target)
+	{
+		const float* pTargetPosition = getPosition(target);
+
+		for (uint32_t i = triangles.offsets[vertex]; i < triangles.offsets[vertex + 1]; ++i)
+		{
+			const uint32_t* pTriangle = &indices[(size_t)triangles.items[i] * 3];
+			if (pTriangle[0] == target || pTriangle[1] == target || pTriangle[2] == target)
+			{
+				continue;
+			}
+
+			const float* before[3] = { getPosition(pTriangle[0]), getPosition(pTriangle[1]), getPosition(pTriangle[2]) };
+			const float* after[3] = { before[0], before[1], before[2] };
+			for (uint32_t k = 0; k < 3; ++k)
+			{
+				if (pTriangle[k] == vertex)
+				{
+					after[k] = pTargetPosition;
+				}
+			}
+
+			double normalBefore[3];
+			double normalAfter[3];
+			ComputeNormal_Internal(before[0], before[1], before[2], normalBefore);
+			ComputeNormal_Internal(after[0], after[1], after[2], normalAfter);
+
+			if (normalBefore[0] * normalAfter[0] + normalBefore[1] * normalAfter[1] + normalBefore[2] * normalAfter[2] <= 0.0)
+			{
+				return true;
+			}
+		}
+		return false;
+	};
+
+	// Open chain of the target is reconnected past the collapsed vertex
+	auto relinkOpenEdges = [&](uint32_t vertex, uint32_t target)
+	{
+		if (openTargets[vertex] == target)
+		{
+			openSources[target] = openSources[vertex];
+			openTargets[openSources[vertex]] = target;
+		}
+		else
+		{
+			openTargets[target] = openTargets[vertex];
+			openSources[openTargets[vertex]] = target;
+		}
+	};
+
+	struct Collapse
+	{
+		uint32_t vertex;
+		uint32_t target;
+		double	 error;
+	};
+
+	std::vector<uint32_t> collapseRemap(vertexCount);
+	std::vector<bool> lockedInPass(vertexCount);
+	std::vector<uint32_t> bestTargets(vertexCount);
+	std::vector<double> bestErrors(vertexCount);
+	std::vector<Collapse> collapses;
+	double maxError = 0.0;
+
+	// Every pass collapses a batch of independent edges in order of error, and rebuilds triangles afterwards
+	for (uint32_t pass = 0; pass < MAX_PASS_COUNT && indices.size() > targetIndexCount; ++pass)
+	{
+		triangles.BuildTriangles(indices, vertexCount);
+
+		std::fill(bestTargets.begin(), bestTargets.end(), INVALID_VERTEX_INTERNAL);
+		for (size_t i = 0; i < indices.size(); ++i)
+		{
+			uint32_t from = indices[i];
+			uint32_t to = indices[i - i % 3 + (i + 1) % 3];
+
+			const uint32_t directions[2][2] = { { from, to }, { to, from } };
+			for (auto& direction : directions)
+			{
+				uint32_t vertex = direction[0];
+				uint32_t target = direction[1];
+
+				if (!canCollapse(vertex, target))
+				{
+					continue;
+				}
+
+				double error = quadrics[positionRemap[vertex]].Evaluate(getPosition(target));
+				if (bestTargets[vertex] == INVALID_VERTEX_INTERNAL || error < bestErrors[vertex])
+				{
+					bestTargets[vertex] = target;
+					bestErrors[vertex] = error;
+				}
+			}
+		}
+
+		collapses.clear();
+		for (uint32_t i = 0; i < vertexCount; ++i)
+		{
+			// Seam pairs are listed once, from the lower vertex
+			if (bestTargets[i] != INVALID_VERTEX_INTERNAL && (kinds[i] != EVertexKind_Internal::Seam || i < wedges[i]))
+			{
+				collapses.push_back({ i, bestTargets[i], bestErrors[i] });
+			}
+		}
+
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& lhs, const Collapse& rhs) { return lhs.error < rhs.error; });
+
+		for (uint32_t i = 0; i < vertexCount; ++i)
+		{
+			collapseRemap[i] = i;
+		}
+		std::fill(lockedInPass.begin(), lockedInPass.end(), false);
+
+		size_t removalGoal = (indices.size() - targetIndexCount) / 3;
+		size_t removedTriangles = 0;
+		uint32_t collapseCount = 0;
+
+		for (auto& collapse : collapses)
+		{
+			if (removedTriangles >= removalGoal)
+			{
+				break;
+			}
+
+			uint32_t vertex = collapse.vertex;
+			uint32_t target = collapse.target;
+			bool isSeam = kinds[vertex] == EVertexKind_Internal::Seam;
+			uint32_t twin = isSeam ? wedges[vertex] : vertex;
+			uint32_t twinTarget = isSeam ? findSeamTwinTarget(vertex, target) : target;
+
+			if (lockedInPass[vertex] || lockedInPass[target] || lockedInPass[twin] || lockedInPass[twinTarget]
+				|| hasTriangleFlip(vertex, target) || (isSeam && hasTriangleFlip(twin, twinTarget)))
+			{
+				continue;
+			}
+
+			collapseRemap[vertex] = target;
+			if (kinds[vertex] != EVertexKind_Internal::Manifold)
+			{
+				relinkOpenEdges(vertex, target);
+			}
+			if (isSeam)
+			{
+				collapseRemap[twin] = twinTarget;
+				relinkOpenEdges(twin, twinTarget);
+			}
+
+			quadrics[positionRemap[target]].Add(quadrics[positionRemap[vertex]]);
+
+			// Vertices at both positions are left alone for the rest of this pass, so that every collapse sees unchanged neighbours
+			for (uint32_t locked : { vertex, target })
+			{
+				uint32_t wedge = locked;
+				do
+				{
+					lockedInPass[wedge] = true;
+					wedge = wedges[wedge];
+				} while (wedge != locked);
+			}
+
+			maxError = std::max(maxError, collapse.error);
+			removedTriangles += kinds[vertex] == EVertexKind_Internal::Border ? 1 : 2;
+			collapseCount++;
+		}
+
+		if (collapseCount == 0)
+		{
+			break;
+		}
+
+		size_t writeIndex = 0;
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			uint32_t v0 = collapseRemap[indices[i]];
+			uint32_t v1 = collapseRemap[indices[i + 1]];
+			uint32_t v2 = collapseRemap[indices[i + 2]];
+
+			if (v0 != v1 && v1 != v2 && v0 != v2)
+			{
+				indices[writeIndex++] = v0;
+				indices[writeIndex++] = v1;
+				indices[writeIndex++] = v2;
+			}
+		}
+		indices.resize(writeIndex);
+	}
+
+	outIndices.assign(indices.begin(), indices.end());
+	return (float)std::sqrt(maxError);
+}
+
+#if defined(_DEBUG)
+static const uint32_t SELF_CHECK_LOD_COUNT_INTERNAL = 4;
+static const float SELF_CHECK_MAX_ERROR_INTERNAL = 0.1f; // Sphere has unit radius and plane has unit extent
+
+// Builds levels the same way as mesh import does, each one from the previous with half of its triangles
+// Deviation from the source surface is sampled at triangle centroids and edge midpoints of every level
+static bool CheckLODChain_Internal(const char* pName, const std::vector<int>& indices, const std::vector<float>& positions, float (*getDistance)(const float*))
+{
+	std::vector<int> previousIndices = indices;
+	float previousError = 0.0f;
+
+	for (uint32_t lod = 1; lod <= SELF_CHECK_LOD_COUNT_INTERNAL; ++lod)
+	{
+		std::vector<int> levelIndices;
+		float error = previousError + MeshSimplifier::Simplify(previousIndices.data(), (uint32_t)previousIndices.size(), positions.data(), (uint32_t)positions.size() / 3,
+			(uint32_t)(previousIndices.size() / 6 * 3), levelIndices);
+
+		float deviation = 0.0f;
+		for (size_t i = 0; i < levelIndices.size(); i += 3)
+		{
+			const float* p[3] = { &positions[levelIndices[i] * 3], &positions[levelIndices[i + 1] * 3], &positions[levelIndices[i + 2] * 3] };
+
+			float centroid[3];
+			for (uint32_t c = 0; c < 3; ++c)
+			{
+				centroid[c] = (p[0][c] + p[1][c] + p[2][c]) / 3.0f;
+			}
+			deviation = std::max(deviation, getDistance(centroid));
+
+			for (uint32_t e = 0; e < 3; ++e)
+			{
+				float midpoint[3];
+				for (uint32_t c = 0; c < 3; ++c)
+				{
+					midpoint[c] = (p[e][c] + p[(e + 1) % 3][c]) * 0.5f;
+				}
+				deviation = std::max(deviation, getDistance(midpoint));
+			}
+		}
+
+		if (levelIndices.size() >= previousIndices.size() || error > SELF_CHECK_MAX_ERROR_INTERNAL || deviation > SELF_CHECK_MAX_ERROR_INTERNAL)
+		{
+			std::cerr << "MeshSimplifier: Self check failed on " << pName << " level " << lod << ", triangles " << previousIndices.size() / 3 << " -> " << levelIndices.size() / 3
+				<< ", error " << error << ", deviation " << deviation << std::endl;
+			return false;
+		}
+
+		previousIndices = std::move(levelIndices);
+		previousError = error;
+	}
+
+	return true;
+}
+
+bool MeshSimplifier::SelfCheck()
+{
+	const uint32_t gridSize = 32;
+	const uint32_t ringCount = 32;
+	const uint32_t segmentCount = 64;
+	const float pi = 3.14159265f;
+
+	std::vector<int> indices;
+	std::vector<float> positions;
+
+	// Flat grid of unit extent, every collapse keeps it exactly flat
+	for (uint32_t y = 0; y <= gridSize; ++y)
+	{
+		for (uint32_t x = 0; x <= gridSize; ++x)
+		{
+			positions.insert(positions.end(), { (float)x / gridSize, (float)y / gridSize, 0.0f });
+		}
+	}
+	for (uint32_t y = 0; y < gridSize; ++y)
+	{
+		for (uint32_t x = 0; x < gridSize; ++x)
+		{
+			int corner = (int)(y * (gridSize + 1) + x);
+			indices.insert(indices.end(), { corner, corner + 1, corner + (int)gridSize + 2, corner, corner + (int)gridSize + 2, corner + (int)gridSize + 1 });
+		}
+	}
+
+	bool passed = CheckLODChain_Internal("plane", indices, positions, [](const float* pPoint) { return std::fabs(pPoint[2]); });
+
+	// Closed unit sphere without seams, poles are single vertices
+	indices.clear();
+	positions.clear();
+
+	positions.insert(positions.end(), { 0.0f, 0.0f, 1.0f });
+	for (uint32_t ring = 1; ring < ringCount; ++ring)
+	{
+		float theta = pi * ring / ringCount;
+		for (uint32_t segment = 0; segment < segmentCount; ++segment)
+		{
+			float phi = 2.0f * pi * segment / segmentCount;
+			positions.insert(positions.end(), { std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta) });
+		}
+	}
+	positions.insert(positions.end(), { 0.0f, 0.0f, -1.0f });
+
+	int southPole = (int)(positions.size() / 3 - 1);
+	for (uint32_t segment = 0; segment < segmentCount; ++segment)
+	{
+		int current = 1 + (int)segment;
+		int next = 1 + (int)((segment + 1) % segmentCount);
+		indices.insert(indices.end(), { 0, current, next });
+
+		for (uint32_t ring = 1; ring + 1 < ringCount; ++ring)
+		{
+			int ringOffset = (int)((ring - 1) * segmentCount);
+			int nextRingOffset = ringOffset + (int)segmentCount;
+			indices.insert(indices.end(), { ringOffset + current, nextRingOffset + current, nextRingOffset + next, ringOffset + current, nextRingOffset + next, ringOffset + next });
+		}
+
+		int lastRingOffset = (int)((ringCount - 2) * segmentCount);
+		indices.insert(indices.end(), { lastRingOffset + current, southPole, lastRingOffset + next });
+	}
+
+	passed &= CheckLODChain_Internal("sphere", indices, positions, [](const float* pPoint)
+		{
+			return std::fabs(std::sqrt(pPoint[0] * pPoint[0] + pPoint[1] * pPoint[1] + pPoint[2] * pPoint[2]) - 1.0f);
+		});
+
+	return passed;
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace Engine
+{
+	// Quadric error edge collapse of a single submesh, indices are relative to its first vertex
+	// Vertices are only collapsed onto their neighbours and never moved, so simplified indices keep sharing the vertex data of the source
+	class MeshSimplifier
+	{
+	public:
+		// Collapses cheapest edges first until index count drops to target, or no further collapse is allowed
+		// Open borders and seams, where vertices share a position but differ in normal or texcoord, are only collapsed along themselves
+		// Returns the largest deviation from the source surface, in the unit of positions
+		static float Simplify(const int* pIndices, uint32_t indexCount, const float* pPositions, uint32_t vertexCount, uint32_t targetIndexCount, std::vector<int>& outIndices);
+
+#if defined(_DEBUG)
+		// Simplifies a tessellated plane and sphere level by level, checks that every level has fewer triangles and stays close to the source surface
+		static bool SelfCheck();
+#endif
+
+	public:
+		static const uint32_t MAX_PASS_COUNT = 64;
+		static const uint32_t BOUNDARY_WEIGHT = 10; // Extra weight of edge quadrics that keep borders and seams in place
+	};
+}
\ No newline at end of file
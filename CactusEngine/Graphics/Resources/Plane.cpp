@@ -56,6 +56,8 @@ Plane::Plane(uint64_t dimLength, uint64_t dimWidth)
 	m_subMeshes[0].m_baseIndex = 0;
 	m_subMeshes[0].m_baseVertex = 0;
 	m_subMeshes[0].m_numIndices = (unsigned int)vertexIndices.size();
+	ComputeBounds(positions.data(), vertexIndices.data());
+	BuildOccluderGeometry(positions.data(), nullptr, vertexIndices.data());
 
 	m_type = EBuiltInMeshType::Plane;
 	m_planeDimension = Vector2(dimLength, dimWidth);
@@ -0,0 +1,444 @@
+#include "SoftwareOcclusionCuller.h"
+#include "Mesh.h"
+#include <cmath>
+#include <iostream>
+#include <algorithm>
+#include <thread>
+#include <future>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define SOFTWARE_OCCLUSION_SSE
+#include <xmmintrin.h>
+#endif
+
+using namespace Engine;
+
+// Splits [0, count) into runs of roughly equal weight, the end of each run is returned
+template<typename TWeight>
+static std::vector<size_t> SplitWork_Internal(size_t count, size_t workerCount, TWeight getWeight)
+{
+	size_t totalWeight = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		totalWeight += getWeight(i);
+	}
+
+	std::vector<size_t> runEnds;
+	size_t weight = 0;
+	for (size_t i = 0; i < count && runEnds.size() + 1 < workerCount; ++i)
+	{
+		weight += getWeight(i);
+		if (weight * workerCount >= totalWeight * (runEnds.size() + 1))
+		{
+			runEnds.emplace_back(i + 1);
+		}
+	}
+	runEnds.emplace_back(count);
+
+	return runEnds;
+}
+
+void SoftwareOcclusionCuller::Rasterize(const Matrix4x4& viewProjection, const std::vector<OccluderInstance>& occluders)
+{
+	m_viewProjection = viewProjection;
+	m_depthBuffer.assign((size_t)BUFFER_WIDTH * BUFFER_HEIGHT, 0.0f);
+
+	size_t triangleCount = 0;
+	for (auto& occluder : occluders)
+	{
+		triangleCount += occluder.pGeometry->indices.size() / 3;
+	}
+
+	size_t workerCount = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), triangleCount / MIN_TRIANGLES_PER_WORKER));
+	std::vector<size_t> runEnds = SplitWork_Internal(occluders.size(), workerCount, [&occluders](size_t i) { return occluders[i].pGeometry->indices.size() / 3; });
+	uint32_t runCount = (uint32_t)runEnds.size();
+
+	m_triangleBins.resize(runEnds.size());
+	for (auto& bins : m_triangleBins)
+	{
+		bins.triangles.clear();
+		for (auto& tileBin : bins.tileBins)
+		{
+			tileBin.clear();
+		}
+	}
+
+	// Triangles are set up in parallel first, calling thread takes the first run
+	std::vector<std::future<void>> workers;
+	for (size_t i = 1; i < runEnds.size(); ++i)
+	{
+		workers.emplace_back(std::async(std::launch::async, [this, &occluders, &runEnds, i]()
+			{
+				SetupTriangles(occluders.data() + runEnds[i - 1], runEnds[i] - runEnds[i - 1], m_triangleBins[i]);
+			}));
+	}
+
+	SetupTriangles(occluders.data(), runEnds[0], m_triangleBins[0]);
+
+	for (auto& worker : workers)
+	{
+		worker.wait();
+	}
+	workers.clear();
+
+	// Then every tile is filled by exactly one worker, so depth buffer writes never overlap
+	const uint32_t tileCount = TILE_COUNT_X * TILE_COUNT_Y;
+	for (size_t i = 1; i < runEnds.size(); ++i)
+	{
+		workers.emplace_back(std::async(std::launch::async, [this, i, runCount, tileCount]()
+			{
+				for (uint32_t tile = (uint32_t)i; tile < tileCount; tile += runCount)
+				{
+					RasterizeTile(tile);
+				}
+			}));
+	}
+
+	for (uint32_t tile = 0; tile < tileCount; tile += runCount)
+	{
+		RasterizeTile(tile);
+	}
+
+	for (auto& worker : workers)
+	{
+		worker.wait();
+	}
+}
+
+void SoftwareOcclusionCuller::Test(std::vector<OcclusionQuery>& queries) const
+{
+	size_t workerCount = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), queries.size() / MIN_QUERIES_PER_WORKER));
+	size_t queriesPerWorker = (queries.size() + workerCount - 1) / workerCount;
+
+	auto testRange = [this, &queries](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; ++i)
+		{
+			queries[i].isOccluded = IsOccluded(queries[i]);
+		}
+	};
+
+	std::vector<std::future<void>> workers;
+	for (size_t i = 1; i < workerCount; ++i)
+	{
+		size_t begin = std::min(queries.size(), i * queriesPerWorker);
+		size_t end = std::min(queries.size(), begin + queriesPerWorker);
+		workers.emplace_back(std::async(std::launch::async, testRange, begin, end));
+	}
+
+	testRange(0, std::min(queries.size(), queriesPerWorker));
+
+	for (auto& worker : workers)
+	{
+		worker.wait();
+	}
+}
+
+void SoftwareOcclusionCuller::SetupTriangles(const OccluderInstance* pOccluders, size_t occluderCount, TriangleBins& bins) const
+{
+	std::vector<Vector4> clipPositions;
+
+	for (size_t i = 0; i < occluderCount; ++i)
+	{
+		const OccluderGeometry& geometry = *pOccluders[i].pGeometry;
+		Matrix4x4 mvp = m_viewProjection * pOccluders[i].modelMatrix;
+
+		clipPositions.resize(geometry.positions.size() / 3);
+		for (size_t j = 0; j < clipPositions.size(); ++j)
+		{
+			clipPositions[j] = mvp * Vector4(geometry.positions[j * 3], geometry.positions[j * 3 + 1], geometry.positions[j * 3 + 2], 1.0f);
+		}
+
+		for (size_t j = 0; j + 2 < geometry.indices.size(); j += 3)
+		{
+			Vector4 triangle[3] = { clipPositions[geometry.indices[j]], clipPositions[geometry.indices[j + 1]], clipPositions[geometry.indices[j + 2]] };
+
+			// Triangles entirely outside of one frustum plane are dropped
+			bool isOutside = false;
+			for (int axis = 0; axis < 3 && !isOutside; ++axis)
+			{
+				isOutside = (triangle[0][axis] > triangle[0].w && triangle[1][axis] > triangle[1].w && triangle[2][axis] > triangle[2].w)
+					|| (triangle[0][axis] < -triangle[0].w && triangle[1][axis] < -triangle[1].w && triangle[2][axis] < -triangle[2].w);
+			}
+			if (isOutside)
+			{
+				continue;
+			}
+
+			float nearDistances[3] = { triangle[0].z + triangle[0].w, triangle[1].z + triangle[1].w, triangle[2].z + triangle[2].w };
+			if (nearDistances[0] >= 0.0f && nearDistances[1] >= 0.0f && nearDistances[2] >= 0.0f)
+			{
+				SetupTriangle(triangle, bins);
+				continue;
+			}
+
+			// Clipped against near plane only, the rest is handled by clamping to buffer
+			Vector4 polygon[4];
+			uint32_t polygonSize = 0;
+			for (uint32_t k = 0; k < 3; ++k)
+			{
+				uint32_t next = (k + 1) % 3;
+				if (nearDistances[k] >= 0.0f)
+				{
+					polygon[polygonSize++] = triangle[k];
+				}
+				if ((nearDistances[k] >= 0.0f) != (nearDistances[next] >= 0.0f))
+				{
+					float t = nearDistances[k] / (nearDistances[k] - nearDistances[next]);
+					polygon[polygonSize++] = triangle[k] + (triangle[next] - triangle[k]) * t;
+				}
+			}
+
+			for (uint32_t k = 1; k + 1 < polygonSize; ++k)
+			{
+				Vector4 fan[3] = { polygon[0], polygon[k], polygon[k + 1] };
+				SetupTriangle(fan, bins);
+			}
+		}
+	}
+}
+
+void SoftwareOcclusionCuller::SetupTriangle(const Vector4* pClipPositions, TriangleBins& bins) const
+{
+	float x[3], y[3], invW[3];
+	for (uint32_t i = 0; i < 3; ++i)
+	{
+		invW[i] = 1.0f / pClipPositions[i].w;
+		x[i] = (pClipPositions[i].x * invW[i] * 0.5f + 0.5f) * BUFFER_WIDTH;
+		y[i] = (pClipPositions[i].y * invW[i] * 0.5f + 0.5f) * BUFFER_HEIGHT;
+	}
+
+	// Counter-clockwise triangles are front-facing, back faces are culled like they are on GPU
+	float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+	if (!(area > 0.0f))
+	{
+		return;
+	}
+
+	// Texels whose centers may be covered
+	TriangleSetup setup = {};
+	setup.minX = std::max(0, (int)std::ceil(std::min(x[0], std::min(x[1], x[2])) - 0.5f));
+	setup.maxX = std::min((int)BUFFER_WIDTH - 1, (int)std::floor(std::max(x[0], std::max(x[1], x[2])) - 0.5f));
+	setup.minY = std::max(0, (int)std::ceil(std::min(y[0], std::min(y[1], y[2])) - 0.5f));
+	setup.maxY = std::min((int)BUFFER_HEIGHT - 1, (int)std::floor(std::max(y[0], std::max(y[1], y[2])) - 0.5f));
+
+	if (setup.minX > setup.maxX || setup.minY > setup.maxY)
+	{
+		return;
+	}
+
+	// Edge i is opposite to vertex i, its function is positive inside and equals area at that vertex
+	for (uint32_t i = 0; i < 3; ++i)
+	{
+		uint32_t a = (i + 1) % 3;
+		uint32_t b = (i + 2) % 3;
+		setup.edgeA[i] = y[a] - y[b];
+		setup.edgeB[i] = x[b] - x[a];
+
+		// Offset is taken from the same end in both triangles sharing the edge, so their functions are exact negations and no texel slips between them
+		uint32_t origin = (x[a] < x[b] || (x[a] == x[b] && y[a] < y[b])) ? a : b;
+		setup.edgeC[i] = -(setup.edgeA[i] * x[origin] + setup.edgeB[i] * y[origin]);
+
+		setup.depthA += setup.edgeA[i] * invW[i] / area;
+		setup.depthB += setup.edgeB[i] * invW[i] / area;
+		setup.depthC += setup.edgeC[i] * invW[i] / area;
+	}
+
+	uint32_t triangleIndex = (uint32_t)bins.triangles.size();
+	bins.triangles.emplace_back(setup);
+
+	for (uint32_t tileY = setup.minY / TILE_HEIGHT; tileY <= setup.maxY / TILE_HEIGHT; ++tileY)
+	{
+		for (uint32_t tileX = setup.minX / TILE_WIDTH; tileX <= setup.maxX / TILE_WIDTH; ++tileX)
+		{
+			bins.tileBins[tileY * TILE_COUNT_X + tileX].emplace_back(triangleIndex);
+		}
+	}
+}
+
+void SoftwareOcclusionCuller::RasterizeTile(uint32_t tileIndex)
+{
+	int tileMinX = (int)(tileIndex % TILE_COUNT_X * TILE_WIDTH);
+	int tileMinY = (int)(tileIndex / TILE_COUNT_X * TILE_HEIGHT);
+	float* pTile = &m_depthBuffer[(size_t)tileIndex * TILE_WIDTH * TILE_HEIGHT];
+
+	for (auto& bins : m_triangleBins)
+	{
+		for (uint32_t triangleIndex : bins.tileBins[tileIndex])
+		{
+			const TriangleSetup& setup = bins.triangles[triangleIndex];
+
+			// Starts at a multiple of 4, tile width is one too, so texel groups never cross tiles
+			int minX = std::max(setup.minX, tileMinX) & ~3;
+			int maxX = std::min(setup.maxX, tileMinX + (int)TILE_WIDTH - 1);
+			int minY = std::max(setup.minY, tileMinY);
+			int maxY = std::min(setup.maxY, tileMinY + (int)TILE_HEIGHT - 1);
+
+			for (int texelY = minY; texelY <= maxY; ++texelY)
+			{
+				float centerY = texelY + 0.5f;
+				float* pRow = pTile + (size_t)(texelY - tileMinY) * TILE_WIDTH;
+
+#if defined(SOFTWARE_OCCLUSION_SSE)
+				// Edge functions are evaluated from scratch at every texel rather than stepped, stepping would accumulate different rounding in neighbouring triangles
+				__m128 laneOffsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+				__m128 edgeA[3], edgeRow[3];
+				for (uint32_t i = 0; i < 3; ++i)
+				{
+					edgeA[i] = _mm_set1_ps(setup.edgeA[i]);
+					edgeRow[i] = _mm_set1_ps(setup.edgeB[i] * centerY + setup.edgeC[i]);
+				}
+				__m128 depthA = _mm_set1_ps(setup.depthA);
+				__m128 depthRow = _mm_set1_ps(setup.depthB * centerY + setup.depthC);
+				__m128 zero = _mm_setzero_ps();
+
+				for (int texelX = minX; texelX <= maxX; texelX += 4)
+				{
+					__m128 centerX = _mm_add_ps(_mm_set1_ps((float)texelX), laneOffsets);
+					__m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA[0], centerX), edgeRow[0]), zero);
+					inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA[1], centerX), edgeRow[1]), zero));
+					inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA[2], centerX), edgeRow[2]), zero));
+					__m128 depth = _mm_add_ps(_mm_mul_ps(depthA, centerX), depthRow);
+
+					// Stored depth is never negative, so texels outside can simply be written as 0 through max
+					__m128 stored = _mm_loadu_ps(pRow + (texelX - tileMinX));
+					_mm_storeu_ps(pRow + (texelX - tileMinX), _mm_max_ps(stored, _mm_and_ps(inside, depth)));
+				}
+#else
+				for (int texelX = minX; texelX <= maxX; ++texelX)
+				{
+					float centerX = texelX + 0.5f;
+					if (setup.edgeA[0] * centerX + (setup.edgeB[0] * centerY + setup.edgeC[0]) >= 0.0f
+						&& setup.edgeA[1] * centerX + (setup.edgeB[1] * centerY + setup.edgeC[1]) >= 0.0f
+						&& setup.edgeA[2] * centerX + (setup.edgeB[2] * centerY + setup.edgeC[2]) >= 0.0f)
+					{
+						pRow[texelX - tileMinX] = std::max(pRow[texelX - tileMinX], setup.depthA * centerX + setup.depthB * centerY + setup.depthC);
+					}
+				}
+#endif
+			}
+		}
+	}
+}
+
+bool SoftwareOcclusionCuller::IsOccluded(const OcclusionQuery& query) const
+{
+	Matrix4x4 mvp = m_viewProjection * query.modelMatrix;
+
+	float minX = (float)BUFFER_WIDTH, maxX = 0.0f;
+	float minY = (float)BUFFER_HEIGHT, maxY = 0.0f;
+	float nearestDepth = 0.0f;
+
+	for (uint32_t i = 0; i < 8; ++i)
+	{
+		Vector3 corner((i & 1) ? query.pBounds->maxPoint.x : query.pBounds->minPoint.x,
+			(i & 2) ? query.pBounds->maxPoint.y : query.pBounds->minPoint.y,
+			(i & 4) ? query.pBounds->maxPoint.z : query.pBounds->minPoint.z);
+		Vector4 clipPosition = mvp * Vector4(corner, 1.0f);
+
+		if (clipPosition.z + clipPosition.w < 0.0f || clipPosition.w <= 0.0f)
+		{
+			return false;
+		}
+
+		float invW = 1.0f / clipPosition.w;
+		float x = (clipPosition.x * invW * 0.5f + 0.5f) * BUFFER_WIDTH;
+		float y = (clipPosition.y * invW * 0.5f + 0.5f) * BUFFER_HEIGHT;
+
+		minX = std::min(minX, x);
+		maxX = std::max(maxX, x);
+		minY = std::min(minY, y);
+		maxY = std::max(maxY, y);
+		nearestDepth = std::max(nearestDepth, invW);
+	}
+
+	// Every texel the box touches must hold something closer than its nearest corner
+	int texelMinX = std::max(0, (int)std::floor(minX));
+	int texelMaxX = std::min((int)BUFFER_WIDTH - 1, (int)std::floor(maxX));
+	int texelMinY = std::max(0, (int)std::floor(minY));
+	int texelMaxY = std::min((int)BUFFER_HEIGHT - 1, (int)std::floor(maxY));
+
+	if (texelMinX > texelMaxX || texelMinY > texelMaxY)
+	{
+		return false;
+	}
+
+	for (int texelY = texelMinY; texelY <= texelMaxY; ++texelY)
+	{
+		int tileY = texelY / (int)TILE_HEIGHT;
+
+		for (int tileX = texelMinX / (int)TILE_WIDTH; tileX <= texelMaxX / (int)TILE_WIDTH; ++tileX)
+		{
+			int tileMinX = tileX * (int)TILE_WIDTH;
+			const float* pRow = &m_depthBuffer[((size_t)tileY * TILE_COUNT_X + tileX) * TILE_WIDTH * TILE_HEIGHT + (size_t)(texelY - tileY * (int)TILE_HEIGHT) * TILE_WIDTH];
+
+			int rowMinX = std::max(texelMinX, tileMinX);
+			int rowMaxX = std::min(texelMaxX, tileMinX + (int)TILE_WIDTH - 1);
+
+#if defined(SOFTWARE_OCCLUSION_SSE)
+			__m128 nearest = _mm_set1_ps(nearestDepth);
+			for (int texelX = rowMinX & ~3; texelX <= rowMaxX; texelX += 4)
+			{
+				int laneMask = 0xF;
+				if (texelX < rowMinX)
+				{
+					laneMask &= 0xF << (rowMinX - texelX);
+				}
+				if (texelX + 3 > rowMaxX)
+				{
+					laneMask &= 0xF >> (texelX + 3 - rowMaxX);
+				}
+
+				if (_mm_movemask_ps(_mm_cmple_ps(_mm_loadu_ps(pRow + (texelX - tileMinX)), nearest)) & laneMask)
+				{
+					return false;
+				}
+			}
+#else
+			for (int texelX = rowMinX; texelX <= rowMaxX; ++texelX)
+			{
+				if (pRow[texelX - tileMinX] <= nearestDepth)
+				{
+					return false;
+				}
+			}
+#endif
+		}
+	}
+
+	return true;
+}
+
+#if defined(_DEBUG)
+bool SoftwareOcclusionCuller::SelfCheck()
+{
+	// Counter-clockwise as seen from the camera
+	OccluderGeometry quad;
+	quad.positions = { -1.0f, -1.0f, 0.0f, 1.0f, -1.0f, 0.0f, 1.0f, 1.0f, 0.0f, -1.0f, 1.0f, 0.0f };
+	quad.indices = { 0, 1, 2, 0, 2, 3 };
+
+	Matrix4x4 viewProjection = glm::perspective(60.0f * D2R, (float)BUFFER_WIDTH / BUFFER_HEIGHT, 0.1f, 100.0f) * glm::lookAt(Vector3(0.0f, 0.0f, 4.0f), Vector3(0.0f), UP);
+
+	SoftwareOcclusionCuller culler;
+	culler.Rasterize(viewProjection, { { &quad, Matrix4x4(1.0f) } });
+
+	const BoundingBox behind = { Vector3(-0.5f, -0.5f, -2.0f), Vector3(0.5f, 0.5f, -1.0f) };
+	const BoundingBox beside = { Vector3(1.5f, -0.5f, -2.0f), Vector3(2.5f, 0.5f, -1.0f) };
+	const BoundingBox inFront = { Vector3(-0.5f, -0.5f, 1.0f), Vector3(0.5f, 0.5f, 2.0f) };
+
+	std::vector<OcclusionQuery> queries =
+	{
+		{ &behind, Matrix4x4(1.0f), false },
+		{ &beside, Matrix4x4(1.0f), true },
+		{ &inFront, Matrix4x4(1.0f), true }
+	};
+	culler.Test(queries);
+
+	bool passed = queries[0].isOccluded && !queries[1].isOccluded && !queries[2].isOccluded;
+	if (!passed)
+	{
+		std::cerr << "SoftwareOcclusionCuller: Self check failed, occluded behind " << queries[0].isOccluded << ", beside " << queries[1].isOccluded << ", in front " << queries[2].isOccluded << std::endl;
+	}
+	return passed;
+}
+#endif
\ No newline at end of file
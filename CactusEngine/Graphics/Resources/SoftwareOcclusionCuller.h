@@ -0,0 +1,89 @@
+#pragma once
+#include "BasicMathTypes.h"
+#include "NoCopy.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Engine
+{
+	struct BoundingBox;
+	struct OccluderGeometry;
+
+	struct OccluderInstance
+	{
+		const OccluderGeometry* pGeometry;
+		Matrix4x4 modelMatrix;
+	};
+
+	struct OcclusionQuery
+	{
+		const BoundingBox* pBounds; // In mesh space
+		Matrix4x4 modelMatrix;
+		bool	  isOccluded;
+	};
+
+	// Rasterizes designated occluders into a small depth buffer on CPU, then tests bounding boxes of other meshes against it
+	// Buffer is split into tiles, triangles are set up and binned by several workers before each tile is filled by one of them, four texels at a time with SSE where available
+	// Reciprocal of clip w is stored as depth, it interpolates linearly in screen space; larger values are closer, empty texels hold 0
+	class SoftwareOcclusionCuller : public NoCopy
+	{
+	public:
+		SoftwareOcclusionCuller() = default;
+		~SoftwareOcclusionCuller() = default;
+
+		// Clears depth buffer and fills it with the occluders seen through given view projection
+		void Rasterize(const Matrix4x4& viewProjection, const std::vector<OccluderInstance>& occluders);
+		// Only the part of a box inside the buffer is tested, boxes crossing near plane or entirely off screen are never reported occluded
+		void Test(std::vector<OcclusionQuery>& queries) const;
+
+#if defined(_DEBUG)
+		// Rasterizes a quad facing the camera, checks that a box behind it is occluded while boxes beside and in front of it are not
+		static bool SelfCheck();
+#endif
+
+	public:
+		static const uint32_t BUFFER_WIDTH = 256;
+		static const uint32_t BUFFER_HEIGHT = 128;
+		static const uint32_t TILE_WIDTH = 32; // Multiple of 4
+		static const uint32_t TILE_HEIGHT = 16;
+		static const uint32_t TILE_COUNT_X = BUFFER_WIDTH / TILE_WIDTH;
+		static const uint32_t TILE_COUNT_Y = BUFFER_HEIGHT / TILE_HEIGHT;
+
+		static const uint32_t MIN_TRIANGLES_PER_WORKER = 2048;
+		static const uint32_t MIN_QUERIES_PER_WORKER = 256;
+
+	private:
+		// Edge functions and depth plane in buffer texel coordinates
+		struct TriangleSetup
+		{
+			float edgeA[3];
+			float edgeB[3];
+			float edgeC[3];
+			float depthA;
+			float depthB;
+			float depthC;
+			int	  minX;
+			int	  maxX;
+			int	  minY;
+			int	  maxY;
+		};
+
+		// Written by one setup worker, so that binning needs no synchronization
+		struct TriangleBins
+		{
+			std::vector<TriangleSetup> triangles;
+			std::vector<uint32_t> tileBins[TILE_COUNT_X * TILE_COUNT_Y]; // Triangle indices
+		};
+
+		void SetupTriangles(const OccluderInstance* pOccluders, size_t occluderCount, TriangleBins& bins) const;
+		void SetupTriangle(const Vector4* pClipPositions, TriangleBins& bins) const;
+		void RasterizeTile(uint32_t tileIndex);
+		bool IsOccluded(const OcclusionQuery& query) const;
+
+	private:
+		Matrix4x4 m_viewProjection = Matrix4x4(1.0f);
+		std::vector<float> m_depthBuffer; // Tile by tile, rows within a tile are contiguous
+		std::vector<TriangleBins> m_triangleBins; // One per setup worker, kept to reuse their storage
+	};
+}
\ No newline at end of file
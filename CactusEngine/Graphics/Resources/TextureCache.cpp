@@ -0,0 +1,186 @@
+#include "TextureCache.h"
+#include "DrawingResources.h"
+
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+
+using namespace Engine;
+
+bool TextureCache::Open(const std::string& cacheFilePath, const TextureCacheKey& key)
+{
+	Close();
+
+	if (!m_cacheFile.Open(cacheFilePath.c_str()))
+	{
+		return false;
+	}
+
+	const uint8_t* pData = m_cacheFile.GetData();
+	size_t fileSize = m_cacheFile.GetSize();
+
+	if (fileSize < sizeof(CacheHeader))
+	{
+		Close();
+		return false;
+	}
+
+	memcpy(&m_header, pData, sizeof(CacheHeader));
+
+	if (m_header.magic != CACHE_FILE_MAGIC || m_header.version != CACHE_FILE_VERSION
+		|| m_header.key.sourceSize != key.sourceSize || m_header.key.sourceWriteTime != key.sourceWriteTime
+		|| m_header.key.cookFlags != key.cookFlags || m_header.key.cookVersion != key.cookVersion
+		|| m_header.format >= (uint32_t)ETextureFormat::COUNT || m_header.width == 0 || m_header.height == 0
+		|| m_header.mipLevels == 0 || m_header.mipLevels > MAX_MIP_LEVELS)
+	{
+		Close();
+		return false;
+	}
+
+	auto isInRange = [fileSize](uint64_t offset, uint64_t size)
+	{
+		return offset <= fileSize && size <= fileSize - offset;
+	};
+
+	// Levels must be contiguous and match their expected sizes, since they are uploaded as one tightly packed block
+	uint64_t expectedOffset = m_header.levels[0].offset;
+	for (uint32_t level = 0; level < m_header.mipLevels; ++level)
+	{
+		uint32_t levelWidth = std::max<uint32_t>(1, m_header.width >> level);
+		uint32_t levelHeight = std::max<uint32_t>(1, m_header.height >> level);
+		const CacheLevel& cacheLevel = m_header.levels[level];
+
+		if (cacheLevel.offset != expectedOffset || !isInRange(cacheLevel.offset, cacheLevel.size)
+			|| cacheLevel.size != Texture2DCreateInfo::GetLevelDataSize((ETextureFormat)m_header.format, levelWidth, levelHeight))
+		{
+			Close();
+			return false;
+		}
+		expectedOffset += cacheLevel.size;
+	}
+
+	return true;
+}
+
+void TextureCache::Close()
+{
+	m_cacheFile.Close();
+	m_header = {};
+}
+
+ETextureFormat TextureCache::GetFormat() const
+{
+	return (ETextureFormat)m_header.format;
+}
+
+uint32_t TextureCache::GetWidth() const
+{
+	return m_header.width;
+}
+
+uint32_t TextureCache::GetHeight() const
+{
+	return m_header.height;
+}
+
+uint32_t TextureCache::GetMipLevels() const
+{
+	return m_header.mipLevels;
+}
+
+const uint8_t* TextureCache::GetData() const
+{
+	assert(m_cacheFile.IsOpen());
+	return m_cacheFile.GetData() + m_header.levels[0].offset;
+}
+
+size_t TextureCache::GetDataSize() const
+{
+	if (m_header.mipLevels == 0)
+	{
+		return 0;
+	}
+
+	const CacheLevel& lastLevel = m_header.levels[m_header.mipLevels - 1];
+	return (size_t)(lastLevel.offset + lastLevel.size - m_header.levels[0].offset);
+}
+
+bool TextureCache::Write(const std::string& cacheFilePath, const TextureCacheKey& key, ETextureFormat format, uint32_t width, uint32_t height, uint32_t mipLevels, const std::vector<uint8_t>& data)
+{
+	if (mipLevels == 0 || mipLevels > MAX_MIP_LEVELS)
+	{
+		return false;
+	}
+
+	CacheHeader header = {};
+	header.magic = CACHE_FILE_MAGIC;
+	header.version = CACHE_FILE_VERSION;
+	header.key = key;
+	header.format = (uint32_t)format;
+	header.width = width;
+	header.height = height;
+	header.mipLevels = mipLevels;
+
+	// Level data starts 16-byte aligned, which is enough for any block format
+	uint64_t offset = (sizeof(CacheHeader) + 15) / 16 * 16;
+	for (uint32_t level = 0; level < mipLevels; ++level)
+	{
+		header.levels[level].offset = offset;
+		header.levels[level].size = Texture2DCreateInfo::GetLevelDataSize(format, std::max<uint32_t>(1, width >> level), std::max<uint32_t>(1, height >> level));
+		offset += header.levels[level].size;
+	}
+
+	if (offset - header.levels[0].offset != data.size())
+	{
+		return false;
+	}
+
+	std::vector<uint8_t> buffer((size_t)header.levels[0].offset, 0);
+	memcpy(buffer.data(), &header, sizeof(CacheHeader));
+
+	// Written under a temporary name first, so that an interrupted write never leaves a cache file that passes validation
+	std::string tempFilePath = cacheFilePath + ".tmp";
+	std::ofstream file(tempFilePath, std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		std::cerr << "Failed to open texture cache file for writing: " << tempFilePath << std::endl;
+		return false;
+	}
+
+	file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+	file.write(reinterpret_cast<const char*>(data.data()), data.size());
+	file.close();
+
+	std::error_code errorCode;
+	std::filesystem::rename(tempFilePath, cacheFilePath, errorCode);
+	if (errorCode)
+	{
+		std::filesystem::remove(tempFilePath, errorCode);
+		return false;
+	}
+
+	return true;
+}
+
+std::string TextureCache::GetCacheFilePath(const char* sourceFilePath)
+{
+	return std::string(sourceFilePath) + ".cetex";
+}
+
+bool TextureCache::QuerySourceKey(const char* sourceFilePath, uint32_t cookFlags, uint32_t cookVersion, TextureCacheKey& outKey)
+{
+	std::error_code errorCode;
+
+	outKey = {};
+	outKey.cookFlags = cookFlags;
+	outKey.cookVersion = cookVersion;
+
+	outKey.sourceSize = (uint64_t)std::filesystem::file_size(sourceFilePath, errorCode);
+	if (errorCode)
+	{
+		return false;
+	}
+
+	outKey.sourceWriteTime = (int64_t)std::filesystem::last_write_time(sourceFilePath, errorCode).time_since_epoch().count();
+	return !errorCode;
+}
\ No newline at end of file
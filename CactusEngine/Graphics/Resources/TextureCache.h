@@ -0,0 +1,72 @@
+#pragma once
+#include "NoCopy.h"
+#include "MemoryMappedFile.h"
+#include "SharedTypes.h"
+
+#include <string>
+#include <vector>
+
+namespace Engine
+{
+	// Identifies the source image and every setting that affects cooked data
+	struct TextureCacheKey
+	{
+		uint64_t sourceSize;
+		int64_t	 sourceWriteTime;
+		uint32_t cookFlags;
+		uint32_t cookVersion;
+	};
+
+	// Binary file holding a cooked texture with its full mip chain, laid out like a KTX2 level index
+	// Levels are stored from the largest one and back to back, so the whole chain is handed to texture creation straight from mapped memory
+	class TextureCache : public NoCopy
+	{
+	public:
+		TextureCache() = default;
+		~TextureCache() = default;
+
+		// Fails if cache file is missing, malformed or was built from a different key
+		bool Open(const std::string& cacheFilePath, const TextureCacheKey& key);
+		void Close();
+
+		ETextureFormat GetFormat() const;
+		uint32_t GetWidth() const;
+		uint32_t GetHeight() const;
+		uint32_t GetMipLevels() const;
+		// Pointer refers to mapped file, it is only valid until the cache is closed
+		const uint8_t* GetData() const;
+		size_t GetDataSize() const; // Of all levels
+
+		static bool Write(const std::string& cacheFilePath, const TextureCacheKey& key, ETextureFormat format, uint32_t width, uint32_t height, uint32_t mipLevels, const std::vector<uint8_t>& data);
+
+		static std::string GetCacheFilePath(const char* sourceFilePath);
+		static bool QuerySourceKey(const char* sourceFilePath, uint32_t cookFlags, uint32_t cookVersion, TextureCacheKey& outKey);
+
+	public:
+		static const uint32_t CACHE_FILE_MAGIC = 0x58544543; // "CETX"
+		static const uint32_t CACHE_FILE_VERSION = 2; // Stored texture format is an ETextureFormat value, bump this when that enum changes
+		static const uint32_t MAX_MIP_LEVELS = 16;
+
+	private:
+		struct CacheLevel
+		{
+			uint64_t offset; // Relative to the beginning of cache file
+			uint64_t size;
+		};
+
+		struct CacheHeader
+		{
+			uint32_t		magic;
+			uint32_t		version;
+			TextureCacheKey key;
+			uint32_t		format;
+			uint32_t		width;
+			uint32_t		height;
+			uint32_t		mipLevels;
+			CacheLevel		levels[MAX_MIP_LEVELS];
+		};
+
+		MemoryMappedFile m_cacheFile;
+		CacheHeader m_header = {};
+	};
+}
\ No newline at end of file
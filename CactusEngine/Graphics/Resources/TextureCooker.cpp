@@ -0,0 +1,617 @@
+#include "TextureCooker.h"
+#include "DrawingResources.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <future>
+#include <iostream>
+#include <thread>
+
+using namespace Engine;
+
+namespace
+{
+	// RGBA8 texels of a single mip level
+	struct ImageLevel
+	{
+		uint32_t width;
+		uint32_t height;
+		std::vector<uint8_t> pixels;
+	};
+
+	struct SRGBTable
+	{
+		SRGBTable()
+		{
+			for (uint32_t i = 0; i < 256; ++i)
+			{
+				float value = i / 255.0f;
+				toLinear[i] = value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+			}
+		}
+
+		float toLinear[256];
+	};
+
+	const SRGBTable& GetSRGBTable()
+	{
+		static const SRGBTable table;
+		return table;
+	}
+
+	uint8_t LinearToSRGB(float value)
+	{
+		value = std::min(std::max(value, 0.0f), 1.0f);
+		float encoded = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+		return (uint8_t)(encoded * 255.0f + 0.5f);
+	}
+
+	uint8_t UnitToByte(float value)
+	{
+		return (uint8_t)std::min(std::max(value * 255.0f + 0.5f, 0.0f), 255.0f);
+	}
+
+	// 2x2 box filter, last row and column are repeated for odd sizes
+	void Downsample(const ImageLevel& src, ImageLevel& dst, ETextureContent content)
+	{
+		const SRGBTable& srgbTable = GetSRGBTable();
+
+		dst.width = std::max<uint32_t>(1, src.width / 2);
+		dst.height = std::max<uint32_t>(1, src.height / 2);
+		dst.pixels.resize(4 * (size_t)dst.width * dst.height);
+
+		for (uint32_t y = 0; y < dst.height; ++y)
+		{
+			uint32_t y0 = std::min(2 * y, src.height - 1);
+			uint32_t y1 = std::min(2 * y + 1, src.height - 1);
+
+			for (uint32_t x = 0; x < dst.width; ++x)
+			{
+				uint32_t x0 = std::min(2 * x, src.width - 1);
+				uint32_t x1 = std::min(2 * x + 1, src.width - 1);
+
+				const uint8_t* taps[4] =
+				{
+					&src.pixels[4 * ((size_t)y0 * src.width + x0)],
+					&src.pixels[4 * ((size_t)y0 * src.width + x1)],
+					&src.pixels[4 * ((size_t)y1 * src.width + x0)],
+					&src.pixels[4 * ((size_t)y1 * src.width + x1)]
+				};
+				uint8_t* pDst = &dst.pixels[4 * ((size_t)y * dst.width + x)];
+
+				switch (content)
+				{
+				case ETextureContent::Color:
+				{
+					// Averaging sRGB values directly would darken every level
+					for (uint32_t c = 0; c < 3; ++c)
+					{
+						float sum = srgbTable.toLinear[taps[0][c]] + srgbTable.toLinear[taps[1][c]] + srgbTable.toLinear[taps[2][c]] + srgbTable.toLinear[taps[3][c]];
+						pDst[c] = LinearToSRGB(sum * 0.25f);
+					}
+					pDst[3] = (uint8_t)((taps[0][3] + taps[1][3] + taps[2][3] + taps[3][3] + 2) / 4);
+					break;
+				}
+				case ETextureContent::NormalMap:
+				{
+					float normal[3] = { 0, 0, 0 };
+					for (uint32_t i = 0; i < 4; ++i)
+					{
+						for (uint32_t c = 0; c < 3; ++c)
+						{
+							normal[c] += taps[i][c] / 127.5f - 1.0f;
+						}
+					}
+
+					float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+					if (length > 1e-6f)
+					{
+						for (uint32_t c = 0; c < 3; ++c)
+						{
+							pDst[c] = UnitToByte(normal[c] / length * 0.5f + 0.5f);
+						}
+					}
+					else
+					{
+						// Opposite normals cancel out, flat surface is the least noticeable result
+						pDst[0] = 128;
+						pDst[1] = 128;
+						pDst[2] = 255;
+					}
+					pDst[3] = (uint8_t)((taps[0][3] + taps[1][3] + taps[2][3] + taps[3][3] + 2) / 4);
+					break;
+				}
+				default:
+					for (uint32_t c = 0; c < 4; ++c)
+					{
+						pDst[c] = (uint8_t)((taps[0][c] + taps[1][c] + taps[2][c] + taps[3][c] + 2) / 4);
+					}
+					break;
+				}
+			}
+		}
+	}
+
+	// Texels outside of level are clamped to its edge
+	void FetchBlock(const ImageLevel& level, uint32_t blockX, uint32_t blockY, float outTexels[16][4])
+	{
+		for (uint32_t ty = 0; ty < 4; ++ty)
+		{
+			uint32_t y = std::min(blockY * 4 + ty, level.height - 1);
+			for (uint32_t tx = 0; tx < 4; ++tx)
+			{
+				uint32_t x = std::min(blockX * 4 + tx, level.width - 1);
+				const uint8_t* pTexel = &level.pixels[4 * ((size_t)y * level.width + x)];
+				for (uint32_t c = 0; c < 4; ++c)
+				{
+					outTexels[ty * 4 + tx][c] = pTexel[c];
+				}
+			}
+		}
+	}
+
+	// Endpoints are the extremes of texels projected on their principal axis, which is found by power iteration on covariance matrix
+	void FindEndpoints(const float texels[16][4], uint32_t channelCount, float outMin[4], float outMax[4])
+	{
+		float mean[4] = { 0, 0, 0, 0 };
+		for (uint32_t i = 0; i < 16; ++i)
+		{
+			for (uint32_t c = 0; c < channelCount; ++c)
+			{
+				mean[c] += texels[i][c] / 16.0f;
+			}
+		}
+
+		float covariance[4][4] = {};
+		for (uint32_t i = 0; i < 16; ++i)
+		{
+			for (uint32_t a = 0; a < channelCount; ++a)
+			{
+				for (uint32_t b = 0; b < channelCount; ++b)
+				{
+					covariance[a][b] += (texels[i][a] - mean[a]) * (texels[i][b] - mean[b]);
+				}
+			}
+		}
+
+		// Starting from the row of largest variance avoids an initial guess orthogonal to the axis
+		uint32_t largestChannel = 0;
+		for (uint32_t c = 1; c < channelCount; ++c)
+		{
+			if (covariance[c][c] > covariance[largestChannel][largestChannel])
+			{
+				largestChannel = c;
+			}
+		}
+
+		float axis[4] = { 0, 0, 0, 0 };
+		for (uint32_t c = 0; c < channelCount; ++c)
+		{
+			axis[c] = covariance[largestChannel][c];
+		}
+
+		for (uint32_t iteration = 0; iteration < 8; ++iteration)
+		{
+			float next[4] = { 0, 0, 0, 0 };
+			float largest = 0;
+			for (uint32_t a = 0; a < channelCount; ++a)
+			{
+				for (uint32_t b = 0; b < channelCount; ++b)
+				{
+					next[a] += covariance[a][b] * axis[b];
+				}
+				largest = std::max(largest, std::abs(next[a]));
+			}
+
+			if (largest == 0)
+			{
+				break;
+			}
+
+			for (uint32_t c = 0; c < channelCount; ++c)
+			{
+				axis[c] = next[c] / largest;
+			}
+		}
+
+		float length = 0;
+		for (uint32_t c = 0; c < channelCount; ++c)
+		{
+			length += axis[c] * axis[c];
+		}
+		length = std::sqrt(length);
+
+		float minProjection = 0;
+		float maxProjection = 0;
+		if (length > 1e-6f)
+		{
+			for (uint32_t c = 0; c < channelCount; ++c)
+			{
+				axis[c] /= length;
+			}
+
+			minProjection = FLT_MAX;
+			maxProjection = -FLT_MAX;
+			for (uint32_t i = 0; i < 16; ++i)
+			{
+				float projection = 0;
+				for (uint32_t c = 0; c < channelCount; ++c)
+				{
+					projection += (texels[i][c] - mean[c]) * axis[c];
+				}
+				minProjection = std::min(minProjection, projection);
+				maxProjection = std::max(maxProjection, projection);
+			}
+		}
+
+		for (uint32_t c = 0; c < 4; ++c)
+		{
+			outMin[c] = c < channelCount ? std::min(std::max(mean[c] + axis[c] * minProjection, 0.0f), 255.0f) : 255.0f;
+			outMax[c] = c < channelCount ? std::min(std::max(mean[c] + axis[c] * maxProjection, 0.0f), 255.0f) : 255.0f;
+		}
+	}
+
+	uint32_t FindNearest(const float texel[4], const float palette[][4], uint32_t paletteSize, uint32_t channelCount)
+	{
+		uint32_t nearest = 0;
+		float nearestDistance = FLT_MAX;
+		for (uint32_t i = 0; i < paletteSize; ++i)
+		{
+			float distance = 0;
+			for (uint32_t c = 0; c < channelCount; ++c)
+			{
+				distance += (texel[c] - palette[i][c]) * (texel[c] - palette[i][c]);
+			}
+			if (distance < nearestDistance)
+			{
+				nearest = i;
+				nearestDistance = distance;
+			}
+		}
+		return nearest;
+	}
+
+	uint16_t PackRGB565(const float color[4])
+	{
+		uint32_t r = (uint32_t)(color[0] * 31.0f / 255.0f + 0.5f);
+		uint32_t g = (uint32_t)(color[1] * 63.0f / 255.0f + 0.5f);
+		uint32_t b = (uint32_t)(color[2] * 31.0f / 255.0f + 0.5f);
+		return (uint16_t)((r << 11) | (g << 5) | b);
+	}
+
+	void UnpackRGB565(uint16_t packed, float outColor[4])
+	{
+		uint32_t r = (packed >> 11) & 31;
+		uint32_t g = (packed >> 5) & 63;
+		uint32_t b = packed & 31;
+		outColor[0] = (float)((r << 3) | (r >> 2));
+		outColor[1] = (float)((g << 2) | (g >> 4));
+		outColor[2] = (float)((b << 3) | (b >> 2));
+		outColor[3] = 255.0f;
+	}
+
+	// BC1 block, also the color half of BC3, always in four-color mode
+	void EncodeColorBlock(const float texels[16][4], uint8_t* pOutput)
+	{
+		float minColor[4], maxColor[4];
+		FindEndpoints(texels, 3, minColor, maxColor);
+
+		uint16_t color0 = PackRGB565(maxColor);
+		uint16_t color1 = PackRGB565(minColor);
+		if (color0 < color1)
+		{
+			std::swap(color0, color1);
+		}
+
+		// Equal endpoints select three-color mode, where index 0 still decodes to the first endpoint
+		uint32_t indices = 0;
+		if (color0 != color1)
+		{
+			float palette[4][4];
+			UnpackRGB565(color0, palette[0]);
+			UnpackRGB565(color1, palette[1]);
+			for (uint32_t c = 0; c < 3; ++c)
+			{
+				palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3.0f;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3.0f;
+			}
+
+			for (uint32_t i = 0; i < 16; ++i)
+			{
+				indices |= FindNearest(texels[i], palette, 4, 3) << (2 * i);
+			}
+		}
+
+		pOutput[0] = (uint8_t)(color0 & 0xFF);
+		pOutput[1] = (uint8_t)(color0 >> 8);
+		pOutput[2] = (uint8_t)(color1 & 0xFF);
+		pOutput[3] = (uint8_t)(color1 >> 8);
+		for (uint32_t i = 0; i < 4; ++i)
+		{
+			pOutput[4 + i] = (uint8_t)(indices >> (8 * i));
+		}
+	}
+
+	// BC4 block, also the alpha half of BC3 and each half of BC5, always in eight-value mode
+	void EncodeSingleChannelBlock(const float texels[16][4], uint32_t channel, uint8_t* pOutput)
+	{
+		float minValue = 255.0f;
+		float maxValue = 0.0f;
+		for (uint32_t i = 0; i < 16; ++i)
+		{
+			minValue = std::min(minValue, texels[i][channel]);
+			maxValue = std::max(maxValue, texels[i][channel]);
+		}
+
+		uint8_t value0 = (uint8_t)(maxValue + 0.5f);
+		uint8_t value1 = (uint8_t)(minValue + 0.5f);
+
+		uint64_t indices = 0;
+		if (value0 > value1)
+		{
+			float palette[8][4] = {};
+			palette[0][0] = value0;
+			palette[1][0] = value1;
+			for (uint32_t i = 1; i < 7; ++i)
+			{
+				palette[i + 1][0] = ((7 - i) * value0 + i * value1) / 7.0f;
+			}
+
+			for (uint32_t i = 0; i < 16; ++i)
+			{
+				float texel[4] = { texels[i][channel], 0, 0, 0 };
+				indices |= (uint64_t)FindNearest(texel, palette, 8, 1) << (3 * i);
+			}
+		}
+
+		pOutput[0] = value0;
+		pOutput[1] = value1;
+		for (uint32_t i = 0; i < 6; ++i)
+		{
+			pOutput[2 + i] = (uint8_t)(indices >> (8 * i));
+		}
+	}
+
+	void WriteBits(uint8_t* pBlock, uint32_t& bitOffset, uint32_t value, uint32_t bitCount)
+	{
+		for (uint32_t i = 0; i < bitCount; ++i, ++bitOffset)
+		{
+			if ((value >> i) & 1)
+			{
+				pBlock[bitOffset >> 3] |= (uint8_t)(1 << (bitOffset & 7));
+			}
+		}
+	}
+
+	// Mode 6 endpoints are 7 bits per channel plus a shared lowest bit, the p-bit that fits better is chosen
+	void QuantizeBC7Mode6Endpoint(const float color[4], uint32_t outEndpoint[4], uint32_t& outPBit)
+	{
+		float bestError = FLT_MAX;
+		for (uint32_t pBit = 0; pBit < 2; ++pBit)
+		{
+			uint32_t endpoint[4];
+			float error = 0;
+			for (uint32_t c = 0; c < 4; ++c)
+			{
+				endpoint[c] = (uint32_t)std::min(std::max((color[c] - pBit) / 2.0f + 0.5f, 0.0f), 127.0f);
+				float decoded = (float)(endpoint[c] * 2 + pBit);
+				error += (decoded - color[c]) * (decoded - color[c]);
+			}
+
+			if (error < bestError)
+			{
+				bestError = error;
+				outPBit = pBit;
+				memcpy(outEndpoint, endpoint, sizeof(endpoint));
+			}
+		}
+	}
+
+	// Single subset with 4-bit indices on RGBA, the mode that suits smooth color and alpha best
+	void EncodeBC7Mode6Block(const float texels[16][4], uint8_t* pOutput)
+	{
+		static const uint32_t weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+		float minColor[4], maxColor[4];
+		FindEndpoints(texels, 4, minColor, maxColor);
+
+		uint32_t endpoints[2][4];
+		uint32_t pBits[2];
+		QuantizeBC7Mode6Endpoint(maxColor, endpoints[0], pBits[0]);
+		QuantizeBC7Mode6Endpoint(minColor, endpoints[1], pBits[1]);
+
+		float palette[16][4];
+		for (uint32_t i = 0; i < 16; ++i)
+		{
+			for (uint32_t c = 0; c < 4; ++c)
+			{
+				uint32_t decoded0 = endpoints[0][c] * 2 + pBits[0];
+				uint32_t decoded1 = endpoints[1][c] * 2 + pBits[1];
+				palette[i][c] = (float)(((64 - weights[i]) * decoded0 + weights[i] * decoded1 + 32) >> 6);
+			}
+		}
+
+		uint32_t indices[16];
+		for (uint32_t i = 0; i < 16; ++i)
+		{
+			indices[i] = FindNearest(texels[i], palette, 16, 4);
+		}
+
+		// Highest bit of the first index is implicitly zero, endpoints are swapped when it's set
+		if (indices[0] & 8)
+		{
+			std::swap(endpoints[0], endpoints[1]);
+			std::swap(pBits[0], pBits[1]);
+			for (uint32_t i = 0; i < 16; ++i)
+			{
+				indices[i] = 15 - indices[i];
+			}
+		}
+
+		memset(pOutput, 0, 16);
+		uint32_t bitOffset = 0;
+		WriteBits(pOutput, bitOffset, 1 << 6, 7);
+		for (uint32_t c = 0; c < 4; ++c)
+		{
+			WriteBits(pOutput, bitOffset, endpoints[0][c], 7);
+			WriteBits(pOutput, bitOffset, endpoints[1][c], 7);
+		}
+		WriteBits(pOutput, bitOffset, pBits[0], 1);
+		WriteBits(pOutput, bitOffset, pBits[1], 1);
+		for (uint32_t i = 0; i < 16; ++i)
+		{
+			WriteBits(pOutput, bitOffset, indices[i], i == 0 ? 3 : 4);
+		}
+		assert(bitOffset == 128);
+	}
+
+	void EncodeBlockRows(const ImageLevel& level, ETextureFormat format, uint8_t* pOutput, uint32_t beginRow, uint32_t endRow)
+	{
+		uint32_t blocksPerRow = (level.width + 3) / 4;
+		size_t blockSize = Texture2DCreateInfo::GetLevelDataSize(format, 4, 4);
+
+		float texels[16][4];
+		for (uint32_t blockY = beginRow; blockY < endRow; ++blockY)
+		{
+			for (uint32_t blockX = 0; blockX < blocksPerRow; ++blockX)
+			{
+				uint8_t* pBlock = pOutput + ((size_t)blockY * blocksPerRow + blockX) * blockSize;
+				FetchBlock(level, blockX, blockY, texels);
+
+				switch (format)
+				{
+				case ETextureFormat::BC1_SRGB:
+					EncodeColorBlock(texels, pBlock);
+					break;
+				case ETextureFormat::BC3_SRGB:
+					EncodeSingleChannelBlock(texels, 3, pBlock);
+					EncodeColorBlock(texels, pBlock + 8);
+					break;
+				case ETextureFormat::BC4_UNORM:
+					EncodeSingleChannelBlock(texels, 0, pBlock);
+					break;
+				case ETextureFormat::BC5_UNORM:
+					EncodeSingleChannelBlock(texels, 0, pBlock);
+					EncodeSingleChannelBlock(texels, 1, pBlock + 8);
+					break;
+				case ETextureFormat::BC7_SRGB:
+					EncodeBC7Mode6Block(texels, pBlock);
+					break;
+				default:
+					std::cerr << "Unhandled block compressed format: " << (uint32_t)format << std::endl;
+					return;
+				}
+			}
+		}
+	}
+
+	void EncodeLevel(const ImageLevel& level, ETextureFormat format, uint8_t* pOutput)
+	{
+		uint32_t blockRows = (level.height + 3) / 4;
+
+		size_t workerCount = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), blockRows / TextureCooker::MIN_BLOCK_ROWS_PER_WORKER));
+		uint32_t rowsPerWorker = (uint32_t)((blockRows + workerCount - 1) / workerCount);
+
+		// Each worker encodes a contiguous range of block rows, calling thread takes the first one
+		std::vector<std::future<void>> workers;
+		for (size_t worker = 1; worker < workerCount; ++worker)
+		{
+			uint32_t begin = (uint32_t)worker * rowsPerWorker;
+			uint32_t end = std::min(begin + rowsPerWorker, blockRows);
+
+			workers.emplace_back(std::async(std::launch::async, [&level, format, pOutput, begin, end]()
+				{
+					EncodeBlockRows(level, format, pOutput, begin, end);
+				}));
+		}
+
+		EncodeBlockRows(level, format, pOutput, 0, std::min(rowsPerWorker, blockRows));
+
+		for (auto& worker : workers)
+		{
+			worker.wait();
+		}
+	}
+}
+
+ETextureFormat TextureCooker::ChooseFormat(ETextureContent content, bool hasAlpha, ETextureCompression compression)
+{
+	assert(compression != ETextureCompression::None);
+
+	switch (content)
+	{
+	// Alert: shaders sample normal maps and masks the same way as uncompressed sRGB image textures, which BC5 and BC4 would break
+	case ETextureContent::NormalMap:
+		return ETextureFormat::BC7_SRGB; // BC1 endpoints are too coarse for normals
+	case ETextureContent::Mask:
+		return ETextureFormat::BC1_SRGB;
+	default:
+		if (compression == ETextureCompression::HighQuality)
+		{
+			return ETextureFormat::BC7_SRGB;
+		}
+		return hasAlpha ? ETextureFormat::BC3_SRGB : ETextureFormat::BC1_SRGB;
+	}
+}
+
+bool TextureCooker::HasAlpha(const uint8_t* pPixels, uint32_t width, uint32_t height)
+{
+	size_t texelCount = (size_t)width * height;
+	for (size_t i = 0; i < texelCount; ++i)
+	{
+		if (pPixels[4 * i + 3] != 255)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+uint32_t TextureCooker::Cook(const uint8_t* pPixels, uint32_t width, uint32_t height, ETextureContent content, ETextureFormat format, std::vector<uint8_t>& outData)
+{
+	assert(Texture2DCreateInfo::IsBlockCompressed(format));
+
+	uint32_t mipLevels = GetMipLevelCount(width, height);
+
+	size_t dataSize = 0;
+	for (uint32_t level = 0; level < mipLevels; ++level)
+	{
+		dataSize += Texture2DCreateInfo::GetLevelDataSize(format, std::max<uint32_t>(1, width >> level), std::max<uint32_t>(1, height >> level));
+	}
+	outData.resize(dataSize);
+
+	ImageLevel currLevel = {};
+	currLevel.width = width;
+	currLevel.height = height;
+	currLevel.pixels.assign(pPixels, pPixels + 4 * (size_t)width * height);
+
+	// Every level is filtered from the previous one, before it gets encoded
+	size_t dataOffset = 0;
+	for (uint32_t level = 0; level < mipLevels; ++level)
+	{
+		if (level > 0)
+		{
+			ImageLevel nextLevel = {};
+			Downsample(currLevel, nextLevel, content);
+			currLevel = std::move(nextLevel);
+		}
+
+		EncodeLevel(currLevel, format, outData.data() + dataOffset);
+		dataOffset += Texture2DCreateInfo::GetLevelDataSize(format, currLevel.width, currLevel.height);
+	}
+
+	return mipLevels;
+}
+
+uint32_t TextureCooker::GetMipLevelCount(uint32_t width, uint32_t height)
+{
+	uint32_t mipLevels = 1;
+	for (uint32_t size = std::max(width, height); size > 1; size >>= 1)
+	{
+		mipLevels++;
+	}
+	return mipLevels;
+}
\ No newline at end of file
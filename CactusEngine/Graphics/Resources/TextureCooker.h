@@ -0,0 +1,28 @@
+#pragma once
+#include "SharedTypes.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Engine
+{
+	// Offline processing of decoded image textures: builds the full mip chain and encodes every level into a block compressed format
+	// Input is always RGBA8 as decoded by image loader, output levels are tightly packed from the largest one
+	class TextureCooker
+	{
+	public:
+		// BC7 for high quality color and normal maps, BC1/BC3 for compact color and BC1 for masks, whose channels are all kept
+		static ETextureFormat ChooseFormat(ETextureContent content, bool hasAlpha, ETextureCompression compression);
+		static bool HasAlpha(const uint8_t* pPixels, uint32_t width, uint32_t height);
+
+		// Mips of color textures are filtered in linear space, normals are renormalized after filtering
+		// Returns number of levels written to outData
+		static uint32_t Cook(const uint8_t* pPixels, uint32_t width, uint32_t height, ETextureContent content, ETextureFormat format, std::vector<uint8_t>& outData);
+
+		static uint32_t GetMipLevelCount(uint32_t width, uint32_t height);
+
+	public:
+		static const uint32_t COOK_VERSION = 2; // Should be increased whenever encoded output changes
+		static const uint32_t MIN_BLOCK_ROWS_PER_WORKER = 8;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,266 @@
+#include "TextureStreamer.h"
+#include "ImageTexture.h"
+#include "Mesh.h"
+#include "Global.h"
+#include "TransformComponent.h"
+#include "MeshFilterComponent.h"
+#include "MaterialComponent.h"
+#include "CameraComponent.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace Engine;
+
+TextureStreamer::TextureStreamer(const std::shared_ptr<ECSWorld> pWorld)
+	: m_pWorld(pWorld),
+	m_frameIndex(0),
+	m_statistics{}
+{
+}
+
+void TextureStreamer::Tick()
+{
+	m_frameIndex++;
+
+	m_retiredTextures.erase(std::remove_if(m_retiredTextures.begin(), m_retiredTextures.end(),
+		[this](const std::pair<std::shared_ptr<Texture2D>, uint64_t>& retiredTexture)
+		{
+			return m_frameIndex >= retiredTexture.second + TEXTURE_RELEASE_LATENCY;
+		}), m_retiredTextures.end());
+
+	ApplyResidencyChanges();
+	GatherRequirements();
+	UpdateResidency();
+	UpdateStatistics();
+}
+
+const TextureStreamingStatistics& TextureStreamer::GetStatistics() const
+{
+	return m_statistics;
+}
+
+void TextureStreamer::ApplyResidencyChanges()
+{
+	for (auto itr = m_streamedTextures.begin(); itr != m_streamedTextures.end();)
+	{
+		auto pTexture = itr->second.pTexture.lock();
+		if (!pTexture)
+		{
+			itr = m_streamedTextures.erase(itr);
+			continue;
+		}
+
+		if (pTexture->IsResidencyChangeReady())
+		{
+			m_retiredTextures.emplace_back(pTexture->ApplyResidencyChange(), m_frameIndex);
+		}
+
+		// Requirements are gathered again every frame, textures out of use fall back to their tail
+		itr->second.requiredMip = pTexture->GetTailMip();
+		++itr;
+	}
+}
+
+void TextureStreamer::GatherRequirements()
+{
+	auto pCamera = m_pWorld->FindEntityWithTag(EEntityTag::MainCamera);
+	if (!pCamera)
+	{
+		return;
+	}
+
+	auto pCameraComp = std::static_pointer_cast<CameraComponent>(pCamera->GetComponent(EComponentType::Camera));
+	auto pCameraTransform = std::static_pointer_cast<TransformComponent>(pCamera->GetComponent(EComponentType::Transform));
+	if (!pCameraComp || !pCameraTransform)
+	{
+		return;
+	}
+
+	Vector3 cameraPos = pCameraTransform->GetPosition();
+	float pixelsPerUnit = gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetWindowHeight() * 0.5f / std::tan(pCameraComp->GetFOV() * 0.5f);
+
+	auto pEntityList = m_pWorld->GetEntityList();
+	for (auto itr = pEntityList->begin(); itr != pEntityList->end(); ++itr)
+	{
+		auto pTransformComp = std::static_pointer_cast<TransformComponent>(itr->second->GetComponent(EComponentType::Transform));
+		auto pMeshFilterComp = std::static_pointer_cast<MeshFilterComponent>(itr->second->GetComponent(EComponentType::MeshFilter));
+		auto pMaterialComp = std::static_pointer_cast<MaterialComponent>(itr->second->GetComponent(EComponentType::Material));
+
+		if (!pTransformComp || !pMeshFilterComp || !pMaterialComp || !pMeshFilterComp->GetMesh())
+		{
+			continue;
+		}
+
+		// Bounding sphere around the box, scaled by the largest axis of model transform
+		const BoundingBox& bounds = pMeshFilterComp->GetMesh()->GetBounds();
+		Matrix4x4 modelMat = pTransformComp->GetModelMatrix();
+		float maxScale = std::max(glm::length(Vector3(modelMat[0])), std::max(glm::length(Vector3(modelMat[1])), glm::length(Vector3(modelMat[2]))));
+		Vector3 center = Vector3(modelMat * Vector4((bounds.minPoint + bounds.maxPoint) * 0.5f, 1.0f));
+		float radius = glm::length(bounds.maxPoint - bounds.minPoint) * 0.5f * maxScale;
+
+		// Camera inside of the sphere requires the largest level
+		float distance = glm::length(center - cameraPos) - radius;
+		float projectedSize = distance > pCameraComp->GetNearClip() ? 2.0f * radius * pixelsPerUnit / distance : FLT_MAX;
+
+		for (auto& material : pMaterialComp->GetMaterialList())
+		{
+			for (auto& texture : material.second->GetTextureList())
+			{
+				RequireTexture(texture.second, projectedSize);
+			}
+		}
+	}
+}
+
+void TextureStreamer::RequireTexture(const std::shared_ptr<Texture2D>& pTexture, float projectedSize)
+{
+	if (!pTexture || pTexture->QuerySource() != ETexture2DSource::ImageTexture)
+	{
+		return;
+	}
+
+	auto pImageTexture = std::static_pointer_cast<ImageTexture>(pTexture);
+	if (!pImageTexture->IsStreamed() || pImageTexture->HasPendingDeviceResources())
+	{
+		return;
+	}
+
+	auto itr = m_streamedTextures.find(pImageTexture.get());
+	if (itr == m_streamedTextures.end())
+	{
+		StreamedTexture streamedTexture = {};
+		streamedTexture.pTexture = pImageTexture;
+		streamedTexture.requiredMip = pImageTexture->GetTailMip();
+		itr = m_streamedTextures.emplace(pImageTexture.get(), streamedTexture).first;
+	}
+
+	// One level for every halving of on-screen size
+	float texelRatio = std::max(pImageTexture->GetWidth(), pImageTexture->GetHeight()) / std::max(projectedSize, 1.0f);
+	uint32_t requiredMip = texelRatio > 1.0f ? (uint32_t)std::log2(texelRatio) : 0;
+
+	itr->second.requiredMip = std::min(itr->second.requiredMip, requiredMip);
+	itr->second.lastRequiredFrame = m_frameIndex;
+}
+
+void TextureStreamer::UpdateResidency()
+{
+	size_t budget = (size_t)gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetTextureStreamingBudget() * 1024 * 1024;
+
+	// Pending changes are accounted at their requested size, since both textures are held until the swap
+	size_t committedSize = 0;
+	std::vector<std::pair<std::shared_ptr<ImageTexture>, StreamedTexture*>> upgrades;
+	std::vector<std::pair<std::shared_ptr<ImageTexture>, StreamedTexture*>> evictionCandidates;
+
+	for (auto& streamedTexture : m_streamedTextures)
+	{
+		auto pTexture = streamedTexture.second.pTexture.lock();
+		if (!pTexture)
+		{
+			continue;
+		}
+
+		committedSize += pTexture->GetMipChainSize(pTexture->GetRequestedMip());
+
+		if (pTexture->GetRequestedMip() != pTexture->GetResidentMip())
+		{
+			continue;
+		}
+
+		if (streamedTexture.second.requiredMip < pTexture->GetResidentMip())
+		{
+			upgrades.emplace_back(pTexture, &streamedTexture.second);
+		}
+		else if (streamedTexture.second.requiredMip > pTexture->GetResidentMip())
+		{
+			evictionCandidates.emplace_back(pTexture, &streamedTexture.second);
+		}
+	}
+
+	// Most missing detail is served first, and least recently needed levels are dropped first
+	typedef std::pair<std::shared_ptr<ImageTexture>, StreamedTexture*> Candidate;
+	std::sort(upgrades.begin(), upgrades.end(), [](const Candidate& lhs, const Candidate& rhs)
+		{
+			return lhs.first->GetResidentMip() - lhs.second->requiredMip > rhs.first->GetResidentMip() - rhs.second->requiredMip;
+		});
+	std::sort(evictionCandidates.begin(), evictionCandidates.end(), [](const Candidate& lhs, const Candidate& rhs)
+		{
+			return lhs.second->lastRequiredFrame < rhs.second->lastRequiredFrame;
+		});
+
+	size_t frameUploadSize = 0;
+	auto nextEviction = evictionCandidates.begin();
+
+	for (auto& upgrade : upgrades)
+	{
+		if (frameUploadSize >= MAX_UPLOAD_SIZE_PER_FRAME)
+		{
+			break;
+		}
+
+		auto& pTexture = upgrade.first;
+		size_t residentSize = pTexture->GetMipChainSize(pTexture->GetResidentMip());
+
+		while (committedSize + pTexture->GetMipChainSize(upgrade.second->requiredMip) - residentSize > budget && nextEviction != evictionCandidates.end())
+		{
+			auto& pVictim = nextEviction->first;
+			size_t victimSize = pVictim->GetMipChainSize(pVictim->GetResidentMip());
+
+			pVictim->RequestResidentMip(nextEviction->second->requiredMip);
+			committedSize -= victimSize - pVictim->GetMipChainSize(pVictim->GetRequestedMip());
+			frameUploadSize += pVictim->GetMipChainSize(pVictim->GetRequestedMip());
+
+			m_statistics.requestCount++;
+			m_statistics.evictionCount++;
+			++nextEviction;
+		}
+
+		// Falls back to the largest level that still fits
+		uint32_t targetMip = upgrade.second->requiredMip;
+		while (targetMip < pTexture->GetResidentMip() && committedSize + pTexture->GetMipChainSize(targetMip) - residentSize > budget)
+		{
+			targetMip++;
+		}
+
+		if (targetMip < pTexture->GetResidentMip())
+		{
+			pTexture->RequestResidentMip(targetMip);
+			committedSize += pTexture->GetMipChainSize(targetMip) - residentSize;
+			frameUploadSize += pTexture->GetMipChainSize(targetMip);
+
+			m_statistics.requestCount++;
+		}
+	}
+}
+
+void TextureStreamer::UpdateStatistics()
+{
+	m_statistics.streamedTextureCount = (uint32_t)m_streamedTextures.size();
+	m_statistics.pendingTextureCount = 0;
+	m_statistics.unsatisfiedTextureCount = 0;
+	m_statistics.residentSize = 0;
+	m_statistics.requiredSize = 0;
+	m_statistics.budget = (size_t)gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetTextureStreamingBudget() * 1024 * 1024;
+
+	for (auto& streamedTexture : m_streamedTextures)
+	{
+		auto pTexture = streamedTexture.second.pTexture.lock();
+		if (!pTexture)
+		{
+			continue;
+		}
+
+		m_statistics.residentSize += pTexture->GetMipChainSize(pTexture->GetResidentMip());
+		m_statistics.requiredSize += pTexture->GetMipChainSize(streamedTexture.second.requiredMip);
+
+		if (pTexture->GetRequestedMip() != pTexture->GetResidentMip())
+		{
+			m_statistics.pendingTextureCount++;
+		}
+		if (pTexture->GetRequestedMip() > streamedTexture.second.requiredMip)
+		{
+			m_statistics.unsatisfiedTextureCount++;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+#pragma once
+#include "ECSWorld.h"
+#include "NoCopy.h"
+
+#include <unordered_map>
+#include <vector>
+
+namespace Engine
+{
+	class ImageTexture;
+	class Texture2D;
+
+	struct TextureStreamingStatistics
+	{
+		uint32_t streamedTextureCount;
+		uint32_t pendingTextureCount;	  // Waiting for uploads to complete
+		uint32_t unsatisfiedTextureCount; // Resident with less detail than required, because of the budget
+		size_t	 residentSize;			  // Bytes
+		size_t	 requiredSize;			  // Bytes that would be resident if every requirement is met
+		size_t	 budget;				  // Bytes
+		uint64_t requestCount;			  // Since start, including evictions
+		uint64_t evictionCount;
+	};
+
+	// Keeps image textures referenced by materials resident at the detail they are seen with
+	// Required mip of each texture is estimated from projected screen size of the entities using it, assuming their UVs span the texture once
+	// Higher levels are uploaded asynchronously within a per-frame limit, and levels of the least recently needed textures are dropped when budget is exceeded
+	class TextureStreamer : public NoCopy
+	{
+	public:
+		TextureStreamer(const std::shared_ptr<ECSWorld> pWorld);
+		~TextureStreamer() = default;
+
+		// Must be called once per frame on the thread owning the drawing device, before the frame is drawn
+		void Tick();
+
+		const TextureStreamingStatistics& GetStatistics() const;
+
+	public:
+		static const size_t MAX_UPLOAD_SIZE_PER_FRAME = 16 * 1024 * 1024; // At least one request is made every frame regardless
+		const uint64_t TEXTURE_RELEASE_LATENCY = 4; // Frames, replaced device textures may still be read by in-flight commands
+
+	private:
+		struct StreamedTexture
+		{
+			std::weak_ptr<ImageTexture> pTexture;
+			uint32_t requiredMip;
+			uint64_t lastRequiredFrame; // Last frame it was used by an entity in view
+		};
+
+		void ApplyResidencyChanges();
+		void GatherRequirements();
+		void RequireTexture(const std::shared_ptr<Texture2D>& pTexture, float projectedSize);
+		void UpdateResidency();
+		void UpdateStatistics();
+
+	private:
+		std::shared_ptr<ECSWorld> m_pWorld;
+
+		std::unordered_map<const ImageTexture*, StreamedTexture> m_streamedTextures;
+		std::vector<std::pair<std::shared_ptr<Texture2D>, uint64_t>> m_retiredTextures; // Texture - frame it was replaced
+
+		uint64_t m_frameIndex;
+		TextureStreamingStatistics m_statistics;
+	};
+}
\ No newline at end of file
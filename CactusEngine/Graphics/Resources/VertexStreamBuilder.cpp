@@ -0,0 +1,299 @@
+#include "VertexStreamBuilder.h"
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <thread>
+#include <future>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define VERTEX_STREAM_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace Engine;
+
+static uint16_t FloatToHalf_Internal(float value)
+{
+	uint32_t bits = 0;
+	memcpy(&bits, &value, sizeof(float));
+
+	uint32_t sign = (bits >> 16) & 0x8000;
+	int32_t exponent = (int32_t)((bits >> 23) & 0xff) - 127 + 15;
+	uint32_t mantissa = bits & 0x7fffff;
+
+	if (exponent <= 0)
+	{
+		if (exponent < -10)
+		{
+			return (uint16_t)sign; // Too small even for subnormal
+		}
+
+		mantissa |= 0x800000;
+		uint32_t shift = (uint32_t)(14 - exponent);
+		return (uint16_t)(sign | ((mantissa + (1u << (shift - 1))) >> shift));
+	}
+
+	if (exponent >= 31)
+	{
+		return (uint16_t)(sign | 0x7c00); // Alert: NaN is turned into infinity
+	}
+
+	// Rounding could carry into exponent, which still produces the correct result
+	return (uint16_t)((sign | ((uint32_t)exponent << 10) | (mantissa >> 13)) + ((mantissa >> 12) & 1));
+}
+
+static int8_t FloatToSnorm8_Internal(float value)
+{
+	return (int8_t)std::round(std::min(std::max(value, -1.0f), 1.0f) * 127.0f);
+}
+
+static int16_t FloatToSnorm16_Internal(float value)
+{
+	return (int16_t)std::round(std::min(std::max(value, -1.0f), 1.0f) * 32767.0f);
+}
+
+static uint16_t FloatToUnorm16_Internal(float value)
+{
+	return (uint16_t)std::round(std::min(std::max(value, 0.0f), 1.0f) * 65535.0f);
+}
+
+// Streams shorter than position stream read as zero
+static Vector3 ReadDirection_Internal(const float* pData, uint32_t dataCount, uint32_t srcVertex)
+{
+	return srcVertex < dataCount / 3 ? Vector3(pData[srcVertex * 3], pData[srcVertex * 3 + 1], pData[srcVertex * 3 + 2]) : Vector3(0);
+}
+
+// Projects direction onto the octahedron and unfolds its lower half, this is reversed by DecodeOctahedral in vertex shaders
+static Vector2 EncodeOctahedral_Internal(const Vector3& direction)
+{
+	float sum = std::abs(direction.x) + std::abs(direction.y) + std::abs(direction.z);
+	if (sum <= 0.0f)
+	{
+		return Vector2(0); // Decodes to +Z
+	}
+
+	Vector2 encoded = Vector2(direction.x / sum, direction.y / sum);
+	if (direction.z < 0.0f)
+	{
+		encoded = Vector2((1.0f - std::abs(encoded.y)) * (encoded.x >= 0.0f ? 1.0f : -1.0f), (1.0f - std::abs(encoded.x)) * (encoded.y >= 0.0f ? 1.0f : -1.0f));
+	}
+	return encoded;
+}
+
+// Bitangent is rebuilt in vertex shaders as cross(normal, tangent) * sign
+static void EncodeTangentFrame_Internal(const VertexBufferCreateInfo& createInfo, uint32_t srcVertex, Vector2& outNormal, Vector2& outTangent, float& outBitangentSign)
+{
+	Vector3 normal = ReadDirection_Internal(createInfo.pNormalData, createInfo.normalDataCount, srcVertex);
+	Vector3 tangent = ReadDirection_Internal(createInfo.pTangentData, createInfo.tangentDataCount, srcVertex);
+	Vector3 bitangent = ReadDirection_Internal(createInfo.pBitangentData, createInfo.bitangentDataCount, srcVertex);
+
+	outNormal = EncodeOctahedral_Internal(normal);
+	outTangent = EncodeOctahedral_Internal(tangent);
+	outBitangentSign = glm::dot(glm::cross(normal, tangent), bitangent) < 0.0f ? -1.0f : 1.0f;
+}
+
+static void WriteVertexFull_Internal(const VertexBufferCreateInfo& createInfo, uint8_t* pDst, uint32_t srcVertex)
+{
+	float* pVertex = (float*)pDst;
+	memset(pVertex, 0, VertexBufferCreateInfo::interleavedStride);
+
+	memcpy(&pVertex[0], &createInfo.pPositionData[srcVertex * 3], 3 * sizeof(float));
+
+	Vector2 normal, tangent;
+	float bitangentSign;
+	EncodeTangentFrame_Internal(createInfo, srcVertex, normal, tangent, bitangentSign);
+
+	pVertex[3] = normal.x;
+	pVertex[4] = normal.y;
+
+	if (srcVertex < createInfo.texcoordDataCount / 2)
+	{
+		memcpy(&pVertex[5], &createInfo.pTexcoordData[srcVertex * 2], 2 * sizeof(float));
+	}
+
+	pVertex[7] = tangent.x;
+	pVertex[8] = tangent.y;
+	pVertex[9] = bitangentSign;
+}
+
+// Position is written relative to position decode offset and multiplied by inverse of decode scale, which is zero for flat axes
+static void WriteVertexCompact_Internal(const VertexBufferCreateInfo& createInfo, uint8_t* pDst, uint32_t srcVertex, const Vector3& positionInverseScale)
+{
+	memset(pDst, 0, VertexBufferCreateInfo::compactInterleavedStride);
+
+	Vector3 position = (Vector3(createInfo.pPositionData[srcVertex * 3], createInfo.pPositionData[srcVertex * 3 + 1], createInfo.pPositionData[srcVertex * 3 + 2])
+		- createInfo.positionDecodeOffset) * positionInverseScale;
+
+	uint16_t* pPosition = (uint16_t*)(pDst + VertexBufferCreateInfo::positionOffset);
+	pPosition[0] = FloatToUnorm16_Internal(position.x);
+	pPosition[1] = FloatToUnorm16_Internal(position.y);
+	pPosition[2] = FloatToUnorm16_Internal(position.z);
+
+	Vector2 normal, tangent;
+	float bitangentSign;
+	EncodeTangentFrame_Internal(createInfo, srcVertex, normal, tangent, bitangentSign);
+
+	int16_t* pNormal = (int16_t*)(pDst + VertexBufferCreateInfo::compactNormalOffset);
+	pNormal[0] = FloatToSnorm16_Internal(normal.x);
+	pNormal[1] = FloatToSnorm16_Internal(normal.y);
+
+	if (srcVertex < createInfo.texcoordDataCount / 2)
+	{
+		uint16_t halfTexcoord[2] = { FloatToHalf_Internal(createInfo.pTexcoordData[srcVertex * 2]), FloatToHalf_Internal(createInfo.pTexcoordData[srcVertex * 2 + 1]) };
+		memcpy(pDst + VertexBufferCreateInfo::compactTexcoordOffset, halfTexcoord, sizeof(halfTexcoord));
+	}
+
+	int8_t* pTangent = (int8_t*)(pDst + VertexBufferCreateInfo::compactTangentOffset);
+	pTangent[0] = FloatToSnorm8_Internal(tangent.x);
+	pTangent[1] = FloatToSnorm8_Internal(tangent.y);
+	pTangent[2] = FloatToSnorm8_Internal(bitangentSign);
+}
+
+#if defined(VERTEX_STREAM_SSE2)
+// Positions are loaded 4 floats at a time, so these require a following source vertex to read into, and texcoords are read without checking stream length
+// Stores of an attribute could spill into the next attribute, which is written afterwards, but never into the next vertex
+// Octahedral encoding is done on scalars, it's shared with the fallback path
+
+static void WriteVertexFull_SSE2(const VertexBufferCreateInfo& createInfo, uint8_t* pDst, uint32_t srcVertex)
+{
+	_mm_storeu_ps((float*)(pDst + VertexBufferCreateInfo::positionOffset), _mm_loadu_ps(&createInfo.pPositionData[srcVertex * 3]));
+
+	Vector2 normal, tangent;
+	float bitangentSign;
+	EncodeTangentFrame_Internal(createInfo, srcVertex, normal, tangent, bitangentSign);
+
+	memcpy(pDst + VertexBufferCreateInfo::normalOffset, &normal, 2 * sizeof(float));
+	_mm_storel_epi64((__m128i*)(pDst + VertexBufferCreateInfo::texcoordOffset), _mm_loadl_epi64((const __m128i*)&createInfo.pTexcoordData[srcVertex * 2]));
+
+	float packedTangent[3] = { tangent.x, tangent.y, bitangentSign };
+	memcpy(pDst + VertexBufferCreateInfo::tangentOffset, packedTangent, sizeof(packedTangent));
+}
+
+// Round to nearest even, based on Fabian Giesen's float to half conversion
+static __m128i FloatToHalf_SSE2(__m128 value)
+{
+	const __m128i c_f16max = _mm_set1_epi32((127 + 16) << 23);
+	const __m128i c_nanbit = _mm_set1_epi32(0x200);
+	const __m128i c_infinity = _mm_set1_epi32(0x7c00);
+	const __m128i c_minNormal = _mm_set1_epi32((127 - 14) << 23);
+	const __m128i c_subnormalMagic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+	const __m128i c_normalBias = _mm_set1_epi32(0xfff - ((127 - 15) << 23));
+
+	__m128 sign = _mm_and_ps(_mm_castsi128_ps(_mm_set1_epi32((int)0x80000000)), value);
+	__m128 absValue = _mm_xor_ps(value, sign);
+	__m128i absBits = _mm_castps_si128(absValue);
+
+	__m128i isNaN = _mm_castps_si128(_mm_cmpunord_ps(absValue, absValue));
+	__m128i isRegular = _mm_cmpgt_epi32(c_f16max, absBits);
+	__m128i special = _mm_or_si128(_mm_and_si128(isNaN, c_nanbit), c_infinity);
+
+	__m128i isSubnormal = _mm_cmpgt_epi32(c_minNormal, absBits);
+	__m128i subnormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(absValue, _mm_castsi128_ps(c_subnormalMagic))), c_subnormalMagic);
+
+	__m128i mantissaOdd = _mm_srai_epi32(_mm_slli_epi32(absBits, 31 - 13), 31);
+	__m128i normal = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(absBits, c_normalBias), mantissaOdd), 13);
+
+	__m128i nonSpecial = _mm_or_si128(_mm_and_si128(subnormal, isSubnormal), _mm_andnot_si128(isSubnormal, normal));
+	__m128i joined = _mm_or_si128(_mm_and_si128(nonSpecial, isRegular), _mm_andnot_si128(isRegular, special));
+
+	return _mm_or_si128(joined, _mm_srli_epi32(_mm_castps_si128(sign), 16));
+}
+
+static void WriteVertexCompact_SSE2(const VertexBufferCreateInfo& createInfo, uint8_t* pDst, uint32_t srcVertex, __m128 positionOffset, __m128 positionInverseScale)
+{
+	// The 4th lane belongs to the next vertex, it's dropped so that padding is zero
+	__m128 position = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&createInfo.pPositionData[srcVertex * 3]), positionOffset), positionInverseScale);
+	position = _mm_and_ps(_mm_min_ps(_mm_max_ps(position, _mm_setzero_ps()), _mm_set1_ps(1.0f)), _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1)));
+
+	// There is no unsigned saturating pack before SSE4.1, so values are biased into signed range and back
+	__m128i scaled = _mm_sub_epi32(_mm_cvtps_epi32(_mm_mul_ps(position, _mm_set1_ps(65535.0f))), _mm_set1_epi32(32768));
+	__m128i packed = _mm_xor_si128(_mm_packs_epi32(scaled, scaled), _mm_set1_epi16((short)0x8000));
+	_mm_storel_epi64((__m128i*)(pDst + VertexBufferCreateInfo::positionOffset), packed);
+
+	Vector2 normal, tangent;
+	float bitangentSign;
+	EncodeTangentFrame_Internal(createInfo, srcVertex, normal, tangent, bitangentSign);
+
+	int16_t packedNormal[2] = { FloatToSnorm16_Internal(normal.x), FloatToSnorm16_Internal(normal.y) };
+	memcpy(pDst + VertexBufferCreateInfo::compactNormalOffset, packedNormal, sizeof(packedNormal));
+
+	__m128i halfTexcoord = FloatToHalf_SSE2(_mm_castsi128_ps(_mm_loadl_epi64((const __m128i*)&createInfo.pTexcoordData[srcVertex * 2])));
+	int32_t packedTexcoord = _mm_cvtsi128_si32(_mm_shufflelo_epi16(halfTexcoord, _MM_SHUFFLE(3, 3, 2, 0)));
+	memcpy(pDst + VertexBufferCreateInfo::compactTexcoordOffset, &packedTexcoord, sizeof(int32_t));
+
+	int8_t packedTangent[4] = { FloatToSnorm8_Internal(tangent.x), FloatToSnorm8_Internal(tangent.y), FloatToSnorm8_Internal(bitangentSign), 0 };
+	memcpy(pDst + VertexBufferCreateInfo::compactTangentOffset, packedTangent, sizeof(packedTangent));
+}
+#endif
+
+static void WriteRange_Internal(const VertexBufferCreateInfo& createInfo, uint8_t* pDst, uint32_t begin, uint32_t end)
+{
+	uint32_t vertexCount = createInfo.positionDataCount / 3;
+	uint32_t stride = createInfo.GetInterleavedStride();
+	bool isCompact = createInfo.vertexFormat == EVertexFormat::Compact;
+
+	Vector3 positionInverseScale = Vector3(0);
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		if (createInfo.positionDecodeScale[axis] > 0.0f)
+		{
+			positionInverseScale[axis] = 1.0f / createInfo.positionDecodeScale[axis];
+		}
+	}
+
+#if defined(VERTEX_STREAM_SSE2)
+	bool hasTexcoords = createInfo.texcoordDataCount / 2 >= vertexCount;
+	__m128 positionOffset_SSE2 = _mm_setr_ps(createInfo.positionDecodeOffset.x, createInfo.positionDecodeOffset.y, createInfo.positionDecodeOffset.z, 0.0f);
+	__m128 positionInverseScale_SSE2 = _mm_setr_ps(positionInverseScale.x, positionInverseScale.y, positionInverseScale.z, 0.0f);
+#endif
+
+	for (uint32_t i = begin; i < end; ++i)
+	{
+		uint32_t srcVertex = createInfo.pVertexRemap != nullptr ? createInfo.pVertexRemap[i] : i;
+		uint8_t* pVertex = pDst + (size_t)stride * i;
+
+#if defined(VERTEX_STREAM_SSE2)
+		if (hasTexcoords && srcVertex + 1 < vertexCount)
+		{
+			isCompact ? WriteVertexCompact_SSE2(createInfo, pVertex, srcVertex, positionOffset_SSE2, positionInverseScale_SSE2) : WriteVertexFull_SSE2(createInfo, pVertex, srcVertex);
+			continue;
+		}
+#endif
+
+		isCompact ? WriteVertexCompact_Internal(createInfo, pVertex, srcVertex, positionInverseScale) : WriteVertexFull_Internal(createInfo, pVertex, srcVertex);
+	}
+}
+
+size_t VertexStreamBuilder::GetOutputSize(const VertexBufferCreateInfo& createInfo)
+{
+	return (size_t)createInfo.GetInterleavedStride() * (createInfo.positionDataCount / 3);
+}
+
+void VertexStreamBuilder::Write(const VertexBufferCreateInfo& createInfo, void* pDst)
+{
+	uint32_t vertexCount = createInfo.positionDataCount / 3;
+	uint8_t* pOutput = (uint8_t*)pDst;
+
+	size_t workerCount = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), vertexCount / MIN_VERTICES_PER_WORKER));
+	uint32_t verticesPerWorker = (uint32_t)((vertexCount + workerCount - 1) / workerCount);
+
+	// Each worker writes a contiguous range of output vertices, calling thread takes the first one
+	std::vector<std::future<void>> workers;
+	for (size_t worker = 1; worker < workerCount; ++worker)
+	{
+		uint32_t begin = (uint32_t)worker * verticesPerWorker;
+		uint32_t end = std::min(begin + verticesPerWorker, vertexCount);
+
+		workers.emplace_back(std::async(std::launch::async, [&createInfo, pOutput, begin, end]()
+			{
+				WriteRange_Internal(createInfo, pOutput, begin, end);
+			}));
+	}
+
+	WriteRange_Internal(createInfo, pOutput, 0, std::min(verticesPerWorker, vertexCount));
+
+	for (auto& worker : workers)
+	{
+		worker.wait();
+	}
+}
\ No newline at end of file
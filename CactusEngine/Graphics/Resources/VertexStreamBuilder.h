@@ -0,0 +1,19 @@
+#pragma once
+#include "DrawingResources.h"
+#include <cstdint>
+
+namespace Engine
+{
+	// Interleaves separate attribute streams of VertexBufferCreateInfo into the layout of its vertex format
+	// Output goes straight into mapped device memory, so there is no intermediate copy of the interleaved data
+	class VertexStreamBuilder
+	{
+	public:
+		static size_t GetOutputSize(const VertexBufferCreateInfo& createInfo);
+		// Destination should be at least GetOutputSize bytes, it doesn't need to be aligned
+		static void Write(const VertexBufferCreateInfo& createInfo, void* pDst);
+
+	public:
+		static const uint32_t MIN_VERTICES_PER_WORKER = 32768; // Smaller meshes are written on calling thread only
+	};
+}
\ No newline at end of file
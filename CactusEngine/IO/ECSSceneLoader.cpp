@@ -0,0 +1,304 @@
+#include "ECSSceneLoader.h"
+#include "ResourceManager.h"
+#include "DrawingDevice.h"
+#include "ExternalMesh.h"
+#include "ImageTexture.h"
+#include "MeshFilterComponent.h"
+#include "MaterialComponent.h"
+
+#include <json/json.h>
+#include <algorithm>
+#include <thread>
+
+using namespace Engine;
+
+ECSSceneLoader::ECSSceneLoader(const std::shared_ptr<ECSWorld> pWorld, const std::shared_ptr<DrawingDevice> pDevice, const std::shared_ptr<ResourceManager> pResourceManager)
+	: m_pWorld(pWorld),
+	m_pDevice(pDevice),
+	m_pResourceManager(pResourceManager),
+	m_activeImportCount(0),
+	m_frameUploadSize(0),
+	m_requestedResourceCount(0),
+	m_completedResourceCount(0)
+{
+	// One hardware thread is left to the main loop
+	m_maxConcurrentImports = std::max<uint32_t>(1, std::thread::hardware_concurrency() - 1);
+}
+
+void ECSSceneLoader::LoadSceneAsync(const char* fileAddress)
+{
+	if (m_sceneParseResult.valid())
+	{
+		m_nextSceneAddress.assign(fileAddress);
+		return;
+	}
+
+	std::string sceneAddress(fileAddress);
+	m_sceneParseResult = std::async(std::launch::async, [sceneAddress]()
+		{
+			auto pRoot = std::make_shared<Json::Value>();
+			return ParseECSSceneJson(sceneAddress.c_str(), *pRoot) ? pRoot : nullptr;
+		});
+}
+
+void ECSSceneLoader::Tick()
+{
+	TickSceneParsing();
+
+	m_frameUploadSize = 0;
+	TickLoadJobs(m_meshJobs);
+	TickLoadJobs(m_textureJobs);
+}
+
+bool ECSSceneLoader::IsLoading() const
+{
+	return m_sceneParseResult.valid() || m_completedResourceCount < m_requestedResourceCount;
+}
+
+float ECSSceneLoader::GetProgress() const
+{
+	if (m_sceneParseResult.valid())
+	{
+		return 0.0f;
+	}
+
+	return m_requestedResourceCount > 0 ? m_completedResourceCount / (float)m_requestedResourceCount : 1.0f;
+}
+
+uint32_t ECSSceneLoader::GetPendingResourceCount() const
+{
+	return (uint32_t)(m_meshJobs.size() + m_textureJobs.size());
+}
+
+void ECSSceneLoader::RequestMesh(const std::string& filePath, const std::shared_ptr<MeshFilterComponent> pMeshFilterComp)
+{
+	// Render nodes skip entities without mesh, so an empty mesh filter serves as placeholder
+	pMeshFilterComp->SetMesh(nullptr);
+
+	auto pMesh = m_pResourceManager->FindMesh(m_pResourceManager->InternFileAsset(filePath));
+	if (pMesh)
+	{
+		Assign(pMesh, pMeshFilterComp);
+		return;
+	}
+
+	AddTarget(m_meshJobs, filePath, pMeshFilterComp);
+}
+
+void ECSSceneLoader::RequestTexture(const std::string& filePath, const std::shared_ptr<Material> pMaterial, EMaterialTextureType type)
+{
+	auto pTexture = m_pResourceManager->FindTexture(m_pResourceManager->InternFileAsset(filePath, (uint32_t)Material::GetTextureContent(type)));
+	if (pTexture)
+	{
+		pMaterial->SetTexture(type, pTexture);
+		return;
+	}
+
+	// Placeholder keeps the material feature key unchanged, so the same pipeline variant is used before and after the swap
+	pMaterial->SetTexture(type, GetPlaceholderTexture(type));
+
+	TextureTarget target = {};
+	target.pMaterial = pMaterial;
+	target.type = type;
+	auto& job = AddTarget(m_textureJobs, filePath, target);
+	if (job.state == ELoadState::Queued && job.targets.size() == 1)
+	{
+		job.content = Material::GetTextureContent(type);
+	}
+}
+
+void ECSSceneLoader::TickSceneParsing()
+{
+	if (!m_sceneParseResult.valid() || m_sceneParseResult.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+	{
+		return;
+	}
+
+	auto pRoot = m_sceneParseResult.get();
+
+	// Only the latest request is built, intermediate ones are dropped
+	if (!m_nextSceneAddress.empty())
+	{
+		std::string nextSceneAddress = m_nextSceneAddress;
+		m_nextSceneAddress.clear();
+		LoadSceneAsync(nextSceneAddress.c_str());
+		return;
+	}
+
+	if (!pRoot)
+	{
+		return;
+	}
+
+	m_pWorld->ClearEntities();
+
+	for (auto& job : m_meshJobs)
+	{
+		job.targets.clear();
+	}
+	for (auto& job : m_textureJobs)
+	{
+		job.targets.clear();
+	}
+	m_requestedResourceCount = 0;
+	m_completedResourceCount = 0;
+
+	BuildECSWorldFromJson(m_pWorld, *pRoot, *this);
+}
+
+template<typename TJob>
+void ECSSceneLoader::TickLoadJobs(std::vector<TJob>& jobs)
+{
+	for (auto itr = jobs.begin(); itr != jobs.end();)
+	{
+		auto& job = *itr;
+
+		if (job.state == ELoadState::Importing && job.importResult.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+		{
+			job.pResource = job.importResult.get();
+			job.state = ELoadState::Imported;
+			m_activeImportCount--;
+		}
+
+		// Device resources are created on this thread, their amount per frame is limited to keep frame time steady
+		if (job.state == ELoadState::Imported && m_frameUploadSize < MAX_UPLOAD_SIZE_PER_FRAME)
+		{
+			m_frameUploadSize += job.pResource->GetPendingDataSize();
+			job.pResource->CreateDeviceResources();
+			job.state = ELoadState::Uploading;
+		}
+
+		if (job.state == ELoadState::Uploading && IsUploaded(job.pResource))
+		{
+			auto pResource = AddToResourceList(job);
+			for (auto& target : job.targets)
+			{
+				Assign(pResource, target);
+			}
+
+			if (!job.targets.empty())
+			{
+				m_completedResourceCount++;
+			}
+
+			itr = jobs.erase(itr);
+			continue;
+		}
+
+		if (job.state == ELoadState::Queued && m_activeImportCount < m_maxConcurrentImports)
+		{
+			LaunchImport(job);
+			job.state = ELoadState::Importing;
+			m_activeImportCount++;
+		}
+
+		++itr;
+	}
+}
+
+template<typename TJob, typename TTarget>
+TJob& ECSSceneLoader::AddTarget(std::vector<TJob>& jobs, const std::string& filePath, const TTarget& target)
+{
+	auto itr = std::find_if(jobs.begin(), jobs.end(), [&filePath](const TJob& job) { return job.filePath == filePath; });
+
+	if (itr == jobs.end())
+	{
+		jobs.emplace_back();
+		itr = jobs.end() - 1;
+		itr->filePath = filePath;
+		itr->state = ELoadState::Queued;
+	}
+
+	// Jobs left over from previous scene count again once they are requested
+	if (itr->targets.empty())
+	{
+		m_requestedResourceCount++;
+	}
+	itr->targets.emplace_back(target);
+
+	return *itr;
+}
+
+void ECSSceneLoader::LaunchImport(MeshLoadJob& job)
+{
+	std::string filePath = job.filePath;
+	job.importResult = std::async(std::launch::async, [filePath]()
+		{
+			return std::make_shared<ExternalMesh>(filePath.c_str(), true);
+		});
+}
+
+void ECSSceneLoader::LaunchImport(TextureLoadJob& job)
+{
+	std::string filePath = job.filePath;
+	ETextureContent content = job.content;
+	job.importResult = std::async(std::launch::async, [filePath, content]()
+		{
+			return std::make_shared<ImageTexture>(filePath.c_str(), EGPUType::Main, true, content, true);
+		});
+}
+
+bool ECSSceneLoader::IsUploaded(const std::shared_ptr<ExternalMesh>& pMesh) const
+{
+	// Mesh that failed to import has no vertex buffer, there is nothing to wait for
+	return !pMesh->GetVertexBuffer() || m_pDevice->IsVertexBufferUploaded(pMesh->GetVertexBuffer());
+}
+
+bool ECSSceneLoader::IsUploaded(const std::shared_ptr<ImageTexture>& pTexture) const
+{
+	return m_pDevice->IsTexture2DUploaded(pTexture);
+}
+
+void ECSSceneLoader::Assign(const std::shared_ptr<Mesh>& pMesh, const std::shared_ptr<MeshFilterComponent>& pMeshFilterComp) const
+{
+	// Mesh that failed to import keeps the placeholder, render nodes expect every assigned mesh to have a vertex buffer
+	if (!pMesh->GetVertexBuffer())
+	{
+		return;
+	}
+
+	pMeshFilterComp->SetMesh(pMesh);
+}
+
+void ECSSceneLoader::Assign(const std::shared_ptr<Texture2D>& pTexture, const TextureTarget& target) const
+{
+	target.pMaterial->SetTexture(target.type, pTexture);
+}
+
+std::shared_ptr<Mesh> ECSSceneLoader::AddToResourceList(const MeshLoadJob& job) const
+{
+	return m_pResourceManager->AddMesh(m_pResourceManager->InternFileAsset(job.filePath), job.pResource);
+}
+
+std::shared_ptr<Texture2D> ECSSceneLoader::AddToResourceList(const TextureLoadJob& job) const
+{
+	return m_pResourceManager->AddTexture(m_pResourceManager->InternFileAsset(job.filePath, (uint32_t)job.content), job.pResource);
+}
+
+std::shared_ptr<Texture2D> ECSSceneLoader::GetPlaceholderTexture(EMaterialTextureType type)
+{
+	bool isNormalTexture = type == EMaterialTextureType::Normal;
+	auto& pPlaceholder = isNormalTexture ? m_pPlaceholderNormalTexture : m_pPlaceholderTexture;
+
+	if (!pPlaceholder)
+	{
+		// Alert: normal maps are loaded as sRGB like other image textures, 188 is decoded to roughly 0.5, which leaves surface normal unperturbed
+		const uint8_t whiteTexel[4] = { 255, 255, 255, 255 };
+		const uint8_t flatNormalTexel[4] = { 188, 188, 255, 255 };
+
+		Texture2DCreateInfo createInfo = {};
+		createInfo.textureWidth = 1;
+		createInfo.textureHeight = 1;
+		createInfo.pTextureData = isNormalTexture ? flatNormalTexel : whiteTexel;
+		createInfo.dataType = EDataType::UByte;
+		createInfo.format = ETextureFormat::RGBA8_SRGB;
+		createInfo.textureType = ETextureType::SampledImage;
+		createInfo.generateMipmap = false;
+		createInfo.initialLayout = EImageLayout::ShaderReadOnly;
+		createInfo.deviceType = EGPUType::Main;
+
+		m_pDevice->CreateTexture2D(createInfo, pPlaceholder);
+	}
+
+	return pPlaceholder;
+}
\ No newline at end of file
@@ -0,0 +1,114 @@
+#pragma once
+#include "ECSSceneReader.h"
+#include "NoCopy.h"
+
+#include <future>
+#include <string>
+#include <vector>
+
+namespace Engine
+{
+	class DrawingDevice;
+	class ExternalMesh;
+	class ImageTexture;
+	class Mesh;
+	class ResourceManager;
+	class Texture2D;
+
+	// Streams scenes in without blocking the frame
+	// Scene file is parsed and external resources are imported and decoded by background workers, entities are created with placeholder resources
+	// Actual resources are created on device a few per frame, and swapped in once their uploads are complete
+	class ECSSceneLoader : public ECSSceneResourceResolver, public NoCopy
+	{
+	public:
+		ECSSceneLoader(const std::shared_ptr<ECSWorld> pWorld, const std::shared_ptr<DrawingDevice> pDevice, const std::shared_ptr<ResourceManager> pResourceManager);
+		~ECSSceneLoader() = default; // Waits for running workers
+
+		// Current entities are cleared once the new scene file is parsed
+		// Resources still loading for the previous scene are finished and cached, but no longer assigned
+		void LoadSceneAsync(const char* fileAddress);
+		// Must be called once per frame on the thread owning the drawing device
+		void Tick();
+
+		bool IsLoading() const;
+		float GetProgress() const; // Fraction of resources requested by the current scene that are in place
+		uint32_t GetPendingResourceCount() const;
+
+		void RequestMesh(const std::string& filePath, const std::shared_ptr<MeshFilterComponent> pMeshFilterComp) override;
+		void RequestTexture(const std::string& filePath, const std::shared_ptr<Material> pMaterial, EMaterialTextureType type) override;
+
+	public:
+		static const size_t MAX_UPLOAD_SIZE_PER_FRAME = 32 * 1024 * 1024; // At least one resource is created every frame regardless
+
+	private:
+		enum class ELoadState
+		{
+			Queued = 0,
+			Importing,
+			Imported,
+			Uploading
+		};
+
+		struct TextureTarget
+		{
+			std::shared_ptr<Material> pMaterial;
+			EMaterialTextureType	  type;
+		};
+
+		template<typename TResource, typename TTarget>
+		struct LoadJob
+		{
+			std::string filePath;
+			ELoadState	state;
+			std::future<std::shared_ptr<TResource>> importResult;
+			std::shared_ptr<TResource> pResource;
+			std::vector<TTarget> targets; // Emptied when scene is switched before the resource is ready
+		};
+
+		typedef LoadJob<ExternalMesh, std::shared_ptr<MeshFilterComponent>> MeshLoadJob;
+
+		struct TextureLoadJob : public LoadJob<ImageTexture, TextureTarget>
+		{
+			ETextureContent content = ETextureContent::Color; // Decided by the slot that first requested the texture
+		};
+
+		void TickSceneParsing();
+		template<typename TJob>
+		void TickLoadJobs(std::vector<TJob>& jobs);
+		template<typename TJob, typename TTarget>
+		TJob& AddTarget(std::vector<TJob>& jobs, const std::string& filePath, const TTarget& target);
+
+		void LaunchImport(MeshLoadJob& job);
+		void LaunchImport(TextureLoadJob& job);
+		bool IsUploaded(const std::shared_ptr<ExternalMesh>& pMesh) const;
+		bool IsUploaded(const std::shared_ptr<ImageTexture>& pTexture) const;
+		void Assign(const std::shared_ptr<Mesh>& pMesh, const std::shared_ptr<MeshFilterComponent>& pMeshFilterComp) const;
+		void Assign(const std::shared_ptr<Texture2D>& pTexture, const TextureTarget& target) const;
+		// Returns the registered resource, which is not the loaded one if the same asset got registered elsewhere in the meantime
+		std::shared_ptr<Mesh> AddToResourceList(const MeshLoadJob& job) const;
+		std::shared_ptr<Texture2D> AddToResourceList(const TextureLoadJob& job) const;
+
+		std::shared_ptr<Texture2D> GetPlaceholderTexture(EMaterialTextureType type);
+
+	private:
+		std::shared_ptr<ECSWorld> m_pWorld;
+		std::shared_ptr<DrawingDevice> m_pDevice;
+		std::shared_ptr<ResourceManager> m_pResourceManager;
+
+		std::future<std::shared_ptr<Json::Value>> m_sceneParseResult;
+		std::string m_nextSceneAddress; // Requested while another scene file is being parsed
+
+		std::vector<MeshLoadJob> m_meshJobs;
+		std::vector<TextureLoadJob> m_textureJobs;
+
+		uint32_t m_maxConcurrentImports;
+		uint32_t m_activeImportCount;
+		size_t	 m_frameUploadSize;
+
+		uint32_t m_requestedResourceCount;
+		uint32_t m_completedResourceCount;
+
+		std::shared_ptr<Texture2D> m_pPlaceholderTexture;
+		std::shared_ptr<Texture2D> m_pPlaceholderNormalTexture;
+	};
+}
\ No newline at end of file
@@ -12,10 +12,67 @@
 #include "StandardEntity.h"
 #include "ScriptSelector.h"
 #include "ExternalMesh.h"
+#include "ImageTexture.h"
 #include "Plane.h"
+#include "GraphicsApplication.h"
 
 namespace Engine
 {
+	namespace
+	{
+		// Loads every resource on the spot, the scene is complete once reading returns
+		class ImmediateResourceResolver : public ECSSceneResourceResolver
+		{
+		public:
+			ImmediateResourceResolver(const std::shared_ptr<ResourceManager> pResourceManager)
+				: m_pResourceManager(pResourceManager)
+			{
+			}
+
+			void RequestMesh(const std::string& filePath, const std::shared_ptr<MeshFilterComponent> pMeshFilterComp) override
+			{
+				AssetID id = m_pResourceManager->InternFileAsset(filePath);
+				std::shared_ptr<Mesh> pMesh = m_pResourceManager->FindMesh(id);
+				if (!pMesh)
+				{
+					pMesh = m_pResourceManager->AddMesh(id, std::make_shared<ExternalMesh>(filePath.c_str()));
+				}
+				pMeshFilterComp->SetMesh(pMesh);
+			}
+
+			void RequestTexture(const std::string& filePath, const std::shared_ptr<Material> pMaterial, EMaterialTextureType type) override
+			{
+				ETextureContent content = Material::GetTextureContent(type);
+				AssetID id = m_pResourceManager->InternFileAsset(filePath, (uint32_t)content);
+				std::shared_ptr<Texture2D> pTexture = m_pResourceManager->FindTexture(id);
+				if (!pTexture)
+				{
+					pTexture = m_pResourceManager->AddTexture(id, std::make_shared<ImageTexture>(filePath.c_str(), EGPUType::Main, false, content, true));
+				}
+				pMaterial->SetTexture(type, pTexture);
+			}
+
+		private:
+			std::shared_ptr<ResourceManager> m_pResourceManager;
+		};
+
+		// Planes of the same dimension share one mesh
+		std::shared_ptr<Mesh> GetPlaneMesh(uint32_t dimLength, uint32_t dimWidth)
+		{
+			auto pResourceManager = std::dynamic_pointer_cast<GraphicsApplication>(gpGlobal->GetCurrentApplication())->GetResourceManager();
+
+			const uint32_t dimensions[2] = { dimLength, dimWidth };
+			AssetID id = pResourceManager->InternContentAsset("Plane", dimensions, sizeof(dimensions));
+
+			std::shared_ptr<Mesh> pMesh = pResourceManager->FindMesh(id);
+			if (!pMesh)
+			{
+				pMesh = pResourceManager->AddMesh(id, std::make_shared<Plane>(dimLength, dimWidth));
+			}
+			return pMesh;
+		}
+	}
+
 	bool ReadECSWorldFromJson(std::shared_ptr<ECSWorld> pWorld, const char* fileAddress)
 	{
 		if (!pWorld)
@@ -23,6 +80,20 @@ namespace Engine
 			return false;
 		}
 
+		Json::Value root;
+		if (!ParseECSSceneJson(fileAddress, root))
+		{
+			return false;
+		}
+
+		ImmediateResourceResolver resolver(std::dynamic_pointer_cast<GraphicsApplication>(gpGlobal->GetCurrentApplication())->GetResourceManager());
+		BuildECSWorldFromJson(pWorld, root, resolver);
+
+		return true;
+	}
+
+	bool ParseECSSceneJson(const char* fileAddress, Json::Value& root)
+	{
 		// Initialize readers
 
 		std::ifstream fileReader;
@@ -35,7 +106,6 @@ namespace Engine
 		}
 
 		Json::CharReaderBuilder builder;
-		Json::Value root;
 
 		JSONCPP_STRING errs;
 		if (!parseFromStream(builder, fileReader, &root, &errs))
@@ -44,6 +114,11 @@ namespace Engine
 			return false;
 		}
 
+		return true;
+	}
+
+	void BuildECSWorldFromJson(std::shared_ptr<ECSWorld> pWorld, const Json::Value& root, ECSSceneResourceResolver& resolver)
+	{
 		// Resolve the json structure and construct ECS world
 
 		int entityCount = root["entityCount"].asInt();
@@ -93,6 +168,7 @@ namespace Engine
 
 				auto pMeshRendererComp = std::make_shared<MeshRendererComponent>();
 				pMeshRendererComp->SetRenderer((ERendererType)(component["rendererType"].asInt()));
+				pMeshRendererComp->SetOccluder(component["occluder"].asBool());
 
 				components.push(pMeshRendererComp);
 			}
@@ -100,23 +176,16 @@ namespace Engine
 			{
 				Json::Value component = entity["meshFilter"];
 
+				auto pMeshFilterComp = pWorld->CreateComponent<MeshFilterComponent>();
+
 				bool attachMesh = true;
-				std::shared_ptr<Mesh> pMesh = nullptr;
 				switch ((EBuiltInMeshType)(component["type"].asInt()))
 				{
 				case EBuiltInMeshType::External:
-					if (ResourceManagement::LoadedMeshes.find(component["filePath"].asString()) == ResourceManagement::LoadedMeshes.end())
-					{
-						pMesh = std::make_shared<ExternalMesh>(component["filePath"].asCString());
-						ResourceManagement::LoadedMeshes.emplace(component["filePath"].asString(), pMesh);
-					}
-					else
-					{
-						pMesh = ResourceManagement::LoadedMeshes.at(component["filePath"].asString());
-					}
+					resolver.RequestMesh(component["filePath"].asString(), pMeshFilterComp);
 					break;
 				case EBuiltInMeshType::Plane:
-					pMesh = std::make_shared<Plane>(component["planeDimension"]["x"].asUInt(), component["planeDimension"]["y"].asUInt());
+					pMeshFilterComp->SetMesh(GetPlaneMesh(component["planeDimension"]["x"].asUInt(), component["planeDimension"]["y"].asUInt()));
 					break;
 				default:
 					std::cout << "ECSSceneReader: Unhandled mesh type: " << component["type"].asInt() << std::endl;
@@ -124,11 +193,8 @@ namespace Engine
 					break;
 				}
 
-				if (attachMesh && pMesh != nullptr)
+				if (attachMesh)
 				{
-					auto pMeshFilterComp = pWorld->CreateComponent<MeshFilterComponent>();
-					pMeshFilterComp->SetMesh(pMesh);
-
 					components.push(pMeshFilterComp);
 				}
 			}
@@ -164,17 +230,7 @@ namespace Engine
 					{
 						if (subComponent[pathTypes[i]])
 						{
-							std::shared_ptr<Texture2D> pTexture = nullptr;
-							if (ResourceManagement::LoadedImageTextures.find(subComponent[pathTypes[i]].asString()) == ResourceManagement::LoadedImageTextures.end())
-							{
-								pTexture = std::make_shared<ImageTexture>(subComponent[pathTypes[i]].asCString());
-								ResourceManagement::LoadedImageTextures.emplace(subComponent[pathTypes[i]].asString(), pTexture);
-							}
-							else
-							{
-								pTexture = ResourceManagement::LoadedImageTextures.at(subComponent[pathTypes[i]].asString());
-							}
-							pMaterial->SetTexture((EMaterialTextureType)((uint32_t)EMaterialTextureType::Albedo + i), pTexture); // Alert: here the check sequence must be consistent with enum sequence
+							resolver.RequestTexture(subComponent[pathTypes[i]].asString(), pMaterial, (EMaterialTextureType)((uint32_t)EMaterialTextureType::Albedo + i)); // Alert: here the check sequence must be consistent with enum sequence
 						}
 					}
 
@@ -251,7 +307,5 @@ namespace Engine
 
 			pEntity->SetEntityTag((EEntityTag)(entity["tag"].asInt()));
 		}
-
-		return true;
 	}
 }
\ No newline at end of file
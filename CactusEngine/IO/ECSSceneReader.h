@@ -1,7 +1,31 @@
 #pragma once
 #include "ECSWorld.h"
+#include "BuiltInShaderType.h"
+#include <string>
+
+namespace Json
+{
+	class Value;
+}
 
 namespace Engine
 {
+	class MeshFilterComponent;
+	class Material;
+
+	// Decides when external resources referenced by a scene are loaded, they may be assigned right away or once they are ready
+	class ECSSceneResourceResolver
+	{
+	public:
+		virtual ~ECSSceneResourceResolver() = default;
+
+		virtual void RequestMesh(const std::string& filePath, const std::shared_ptr<MeshFilterComponent> pMeshFilterComp) = 0;
+		virtual void RequestTexture(const std::string& filePath, const std::shared_ptr<Material> pMaterial, EMaterialTextureType type) = 0;
+	};
+
 	extern bool ReadECSWorldFromJson(std::shared_ptr<ECSWorld> pWorld, const char* fileAddress);
+
+	// Reading split in two steps, so that parsing could be done off the main thread
+	extern bool ParseECSSceneJson(const char* fileAddress, Json::Value& root);
+	extern void BuildECSWorldFromJson(std::shared_ptr<ECSWorld> pWorld, const Json::Value& root, ECSSceneResourceResolver& resolver);
 }
\ No newline at end of file
@@ -78,6 +78,7 @@ namespace Engine
 					Json::Value component;
 
 					component["rendererType"] = (uint32_t)pMeshRendererComp->GetRendererType();
+					component["occluder"] = pMeshRendererComp->IsOccluder();
 
 					entity["meshRenderer"] = component;
 					break;
@@ -88,6 +89,10 @@ namespace Engine
 					Json::Value component;
 
 					auto pMesh = pMeshFilterComp->GetMesh();
+					if (!pMesh)
+					{
+						break; // Mesh is still being loaded
+					}
 
 					component["type"] = (uint32_t)pMesh->GetMeshType();
 
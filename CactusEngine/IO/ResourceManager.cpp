@@ -0,0 +1,227 @@
+#include "ResourceManager.h"
+#include "Global.h"
+#include "Mesh.h"
+#include "ImageTexture.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+
+using namespace Engine;
+
+namespace
+{
+	// FNV-1a
+	uint64_t HashBytes(const void* pData, size_t size, uint64_t hash = 14695981039346656037ull)
+	{
+		const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+		for (size_t i = 0; i < size; ++i)
+		{
+			hash ^= pBytes[i];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+}
+
+ResourceManager::ResourceManager()
+	: m_hitCount(0),
+	m_missCount(0),
+	m_evictionCount(0),
+	m_frameIndex(0)
+{
+}
+
+AssetID ResourceManager::InternFileAsset(const std::string& filePath, uint32_t variant)
+{
+	std::string name = std::filesystem::path(filePath).lexically_normal().generic_string();
+	if (variant != 0)
+	{
+		name += "#" + std::to_string(variant);
+	}
+	return Intern(name);
+}
+
+AssetID ResourceManager::InternContentAsset(const char* generatorName, const void* pParameters, size_t parameterSize)
+{
+	// Parameters are kept in hexadecimal, so that the interned name fully identifies the content
+	static const char HEX_DIGITS[] = "0123456789abcdef";
+
+	std::string name = std::string(generatorName) + ":";
+	const uint8_t* pBytes = static_cast<const uint8_t*>(pParameters);
+	for (size_t i = 0; i < parameterSize; ++i)
+	{
+		name += HEX_DIGITS[pBytes[i] >> 4];
+		name += HEX_DIGITS[pBytes[i] & 0xF];
+	}
+	return Intern(name);
+}
+
+std::string ResourceManager::GetAssetName(AssetID id) const
+{
+	std::lock_guard<std::mutex> guard(m_mutex);
+
+	auto itr = m_assetNames.find(id);
+	return itr != m_assetNames.end() ? itr->second : std::string();
+}
+
+std::shared_ptr<Mesh> ResourceManager::FindMesh(AssetID id)
+{
+	return std::static_pointer_cast<Mesh>(Find(id, EResourceType::Mesh));
+}
+
+std::shared_ptr<Texture2D> ResourceManager::FindTexture(AssetID id)
+{
+	return std::static_pointer_cast<Texture2D>(Find(id, EResourceType::Texture));
+}
+
+std::shared_ptr<Mesh> ResourceManager::AddMesh(AssetID id, const std::shared_ptr<Mesh> pMesh)
+{
+	return std::static_pointer_cast<Mesh>(Add(id, EResourceType::Mesh, pMesh));
+}
+
+std::shared_ptr<Texture2D> ResourceManager::AddTexture(AssetID id, const std::shared_ptr<Texture2D> pTexture)
+{
+	return std::static_pointer_cast<Texture2D>(Add(id, EResourceType::Texture, pTexture));
+}
+
+void ResourceManager::Trim()
+{
+	size_t budget = (size_t)gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetResourceCacheBudget() * 1024 * 1024;
+
+	std::lock_guard<std::mutex> guard(m_mutex);
+
+	m_frameIndex++;
+
+	m_retiredResources.erase(std::remove_if(m_retiredResources.begin(), m_retiredResources.end(),
+		[this](const std::pair<std::shared_ptr<void>, uint64_t>& retiredResource)
+		{
+			return m_frameIndex >= retiredResource.second + RESOURCE_RELEASE_LATENCY;
+		}), m_retiredResources.end());
+
+	size_t residentSize = 0;
+	for (auto& entry : m_entries)
+	{
+		residentSize += GetResourceSize(entry.second);
+	}
+
+	// Walks from the least recently used end, referenced resources are skipped since evicting them would free nothing
+	for (auto itr = m_lruList.rbegin(); itr != m_lruList.rend() && residentSize > budget;)
+	{
+		auto entryItr = m_entries.find(*itr);
+		if (entryItr->second.pResource.use_count() > 1)
+		{
+			++itr;
+			continue;
+		}
+
+		residentSize -= GetResourceSize(entryItr->second);
+		m_retiredResources.emplace_back(entryItr->second.pResource, m_frameIndex);
+		m_entries.erase(entryItr);
+		itr = std::list<AssetID>::reverse_iterator(m_lruList.erase(std::next(itr).base()));
+		m_evictionCount++;
+	}
+}
+
+void ResourceManager::Clear()
+{
+	std::lock_guard<std::mutex> guard(m_mutex);
+
+	m_entries.clear();
+	m_lruList.clear();
+	m_retiredResources.clear();
+}
+
+ResourceCacheStatistics ResourceManager::GetStatistics() const
+{
+	ResourceCacheStatistics statistics = {};
+	statistics.budget = (size_t)gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetResourceCacheBudget() * 1024 * 1024;
+
+	std::lock_guard<std::mutex> guard(m_mutex);
+
+	statistics.residentCount = (uint32_t)m_entries.size();
+	for (auto& entry : m_entries)
+	{
+		statistics.residentSize += GetResourceSize(entry.second);
+		if (entry.second.pResource.use_count() > 1)
+		{
+			statistics.referencedCount++;
+		}
+	}
+	statistics.hitCount = m_hitCount;
+	statistics.missCount = m_missCount;
+	statistics.evictionCount = m_evictionCount;
+
+	return statistics;
+}
+
+AssetID ResourceManager::Intern(const std::string& name)
+{
+	AssetID id = HashBytes(name.data(), name.size());
+
+	std::lock_guard<std::mutex> guard(m_mutex);
+
+	auto itr = m_assetNames.emplace(id, name).first;
+	if (itr->second != name)
+	{
+		std::cerr << "Asset ID collision between " << itr->second << " and " << name << std::endl;
+	}
+	return id;
+}
+
+std::shared_ptr<void> ResourceManager::Find(AssetID id, EResourceType type)
+{
+	std::lock_guard<std::mutex> guard(m_mutex);
+
+	auto itr = m_entries.find(id);
+	if (itr == m_entries.end() || itr->second.type != type)
+	{
+		m_missCount++;
+		return nullptr;
+	}
+
+	m_lruList.splice(m_lruList.begin(), m_lruList, itr->second.lruPosition);
+	m_hitCount++;
+
+	return itr->second.pResource;
+}
+
+std::shared_ptr<void> ResourceManager::Add(AssetID id, EResourceType type, const std::shared_ptr<void> pResource)
+{
+	std::lock_guard<std::mutex> guard(m_mutex);
+
+	// Another thread might have finished loading the same asset first
+	auto itr = m_entries.find(id);
+	if (itr != m_entries.end())
+	{
+		assert(itr->second.type == type);
+		m_lruList.splice(m_lruList.begin(), m_lruList, itr->second.lruPosition);
+		return itr->second.pResource;
+	}
+
+	m_lruList.emplace_front(id);
+
+	CacheEntry entry = {};
+	entry.type = type;
+	entry.pResource = pResource;
+	entry.lruPosition = m_lruList.begin();
+	m_entries.emplace(id, entry);
+
+	return pResource;
+}
+
+size_t ResourceManager::GetResourceSize(const CacheEntry& entry) const
+{
+	switch (entry.type)
+	{
+	case EResourceType::Mesh:
+	{
+		auto pVertexBuffer = std::static_pointer_cast<Mesh>(entry.pResource)->GetVertexBuffer();
+		return pVertexBuffer ? pVertexBuffer->GetSizeInByte() : 0;
+	}
+	case EResourceType::Texture:
+		return std::static_pointer_cast<Texture2D>(entry.pResource)->GetSizeInByte();
+	default:
+		return 0;
+	}
+}
\ No newline at end of file
@@ -1,18 +1,95 @@
 #pragma once
-#include <unordered_map>
+#include "NoCopy.h"
 
-#include "Mesh.h"
-#include "ImageTexture.h"
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace Engine
 {
-	namespace ResourceManagement
+	class Mesh;
+	class Texture2D;
+
+	// 64-bit hash of the canonical name of an asset, names are interned so that hash collisions can be detected
+	typedef uint64_t AssetID;
+
+	struct ResourceCacheStatistics
 	{
-		typedef std::unordered_map<std::string, std::shared_ptr<Texture2D>> FileTextureList; // TODO: use hased strings instead of strings
-		typedef std::unordered_map<std::string, std::shared_ptr<Mesh>> FileMeshList;
+		uint32_t residentCount;
+		uint32_t referencedCount; // Still used outside of the cache, cannot be evicted
+		size_t	 residentSize;	  // Bytes
+		size_t	 budget;		  // Bytes
+		uint64_t hitCount;
+		uint64_t missCount;
+		uint64_t evictionCount;
+	};
+
+	// Engine-wide registry of loaded meshes and textures, so that each asset is loaded once regardless of which scene or loader asks for it
+	// Entries stay cached after their last user releases them, the least recently used ones are evicted once total size exceeds the budget
+	// All functions are thread-safe
+	class ResourceManager : public NoCopy
+	{
+	public:
+		ResourceManager();
+		~ResourceManager() = default;
+
+		// Paths are normalized first, so that different spellings of the same file share an ID
+		// Variant tells apart resources built differently from the same file, e.g. textures cooked for different content
+		AssetID InternFileAsset(const std::string& filePath, uint32_t variant = 0);
+		// For procedural resources, identified by the parameters they are generated from
+		AssetID InternContentAsset(const char* generatorName, const void* pParameters, size_t parameterSize);
+		std::string GetAssetName(AssetID id) const;
+
+		std::shared_ptr<Mesh> FindMesh(AssetID id);
+		std::shared_ptr<Texture2D> FindTexture(AssetID id);
+		// Returns the resource already registered with the ID if there is one, the new resource otherwise
+		std::shared_ptr<Mesh> AddMesh(AssetID id, const std::shared_ptr<Mesh> pMesh);
+		std::shared_ptr<Texture2D> AddTexture(AssetID id, const std::shared_ptr<Texture2D> pTexture);
+
+		// Evicts unreferenced resources until the budget is met, sizes of textures change with streaming so this is done periodically
+		// Must be called once per frame, evicted resources are only released after their device objects can no longer be in use
+		void Trim();
+		void Clear();
+
+		ResourceCacheStatistics GetStatistics() const;
+
+	public:
+		const uint64_t RESOURCE_RELEASE_LATENCY = 4; // Frames, evicted resources may still be read by in-flight commands
+
+	private:
+		enum class EResourceType
+		{
+			Mesh = 0,
+			Texture
+		};
+
+		struct CacheEntry
+		{
+			EResourceType type;
+			std::shared_ptr<void> pResource; // Only owner left when use count is 1
+			std::list<AssetID>::iterator lruPosition;
+		};
+
+		AssetID Intern(const std::string& name);
+		std::shared_ptr<void> Find(AssetID id, EResourceType type);
+		std::shared_ptr<void> Add(AssetID id, EResourceType type, const std::shared_ptr<void> pResource);
+		size_t GetResourceSize(const CacheEntry& entry) const;
+
+	private:
+		std::unordered_map<AssetID, std::string> m_assetNames;
+		std::unordered_map<AssetID, CacheEntry> m_entries;
+		std::list<AssetID> m_lruList; // Most recently used first
+		std::vector<std::pair<std::shared_ptr<void>, uint64_t>> m_retiredResources; // Resource - frame it was evicted
+
+		uint64_t m_hitCount;
+		uint64_t m_missCount;
+		uint64_t m_evictionCount;
+		uint64_t m_frameIndex;
 
-		// Record already external resources to prevent duplicate loading
-		static FileTextureList LoadedImageTextures;
-		static FileMeshList LoadedMeshes;
-	}
+		mutable std::mutex m_mutex;
+	};
 }
\ No newline at end of file
@@ -5,6 +5,8 @@
 #include "MeshRendererComponent.h"
 #include "CameraComponent.h"
 #include "LightComponent.h"
+#include "MeshFilterComponent.h"
+#include "TransformComponent.h"
 #include "GraphicsApplication.h"
 #include "BuiltInResourcesPath.h"
 
@@ -35,6 +37,10 @@ void DrawingSystem::Initialize()
 {
 	LoadShaders();
 	BuildRenderGraphs();
+
+#if defined(_DEBUG)
+	SoftwareOcclusionCuller::SelfCheck();
+#endif
 }
 
 void DrawingSystem::ShutDown()
@@ -50,6 +56,9 @@ void DrawingSystem::FrameBegin()
 void DrawingSystem::Tick()
 {
 	BuildRenderTask();
+	SelectMeshLODs();
+	CullOccludedEntities();
+	CullMeshClusters();
 	ExecuteRenderTask();
 }
 
@@ -178,6 +187,177 @@ void DrawingSystem::BuildRenderTask()
 	}
 }
 
+void DrawingSystem::SelectMeshLODs()
+{
+	auto pCamera = m_pECSWorld->FindEntityWithTag(EEntityTag::MainCamera);
+	if (!pCamera)
+	{
+		return;
+	}
+
+	auto pCameraComp = std::static_pointer_cast<CameraComponent>(pCamera->GetComponent(EComponentType::Camera));
+	auto pCameraTransform = std::static_pointer_cast<TransformComponent>(pCamera->GetComponent(EComponentType::Transform));
+	if (!pCameraComp || !pCameraTransform)
+	{
+		return;
+	}
+
+	Vector3 cameraPos = pCameraTransform->GetPosition();
+	float pixelsPerUnit = gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetWindowHeight() * 0.5f / std::tan(pCameraComp->GetFOV() * 0.5f);
+
+	for (auto& renderList : m_renderTaskTable)
+	{
+		for (auto& pEntity : renderList.second)
+		{
+			auto pTransformComp = std::static_pointer_cast<TransformComponent>(pEntity->GetComponent(EComponentType::Transform));
+			auto pMeshFilterComp = std::static_pointer_cast<MeshFilterComponent>(pEntity->GetComponent(EComponentType::MeshFilter));
+
+			if (!pTransformComp || !pMeshFilterComp || !pMeshFilterComp->GetMesh())
+			{
+				continue;
+			}
+
+			auto pMesh = pMeshFilterComp->GetMesh();
+			if (pMesh->GetLODCount() <= 1)
+			{
+				continue;
+			}
+
+			// Bounding sphere around the box, scaled by the largest axis of model transform
+			const BoundingBox& bounds = pMesh->GetBounds();
+			Matrix4x4 modelMat = pTransformComp->GetModelMatrix();
+			float maxScale = std::max(glm::length(Vector3(modelMat[0])), std::max(glm::length(Vector3(modelMat[1])), glm::length(Vector3(modelMat[2]))));
+			Vector3 center = Vector3(modelMat * Vector4((bounds.minPoint + bounds.maxPoint) * 0.5f, 1.0f));
+			float radius = glm::length(bounds.maxPoint - bounds.minPoint) * 0.5f * maxScale;
+
+			// Camera inside of the sphere always gets full detail
+			float distance = glm::length(center - cameraPos) - radius;
+			uint32_t lod = distance > pCameraComp->GetNearClip()
+				? pMesh->SelectLOD(maxScale * pixelsPerUnit / distance, pMeshFilterComp->GetLODIndex())
+				: 0;
+
+			pMeshFilterComp->SetLODIndex(lod);
+		}
+	}
+}
+
+void DrawingSystem::CullOccludedEntities()
+{
+	m_occluders.clear();
+	m_occlusionQueries.clear();
+	m_occludees.clear();
+
+	Matrix4x4 viewProjection = Matrix4x4(1.0f);
+	Vector3 cameraPos = Vector3(0.0f);
+	bool isEnabled = gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetOcclusionCulling() && GetMainCameraView(viewProjection, cameraPos);
+
+	for (auto& renderList : m_renderTaskTable)
+	{
+		for (auto& pEntity : renderList.second)
+		{
+			auto pMeshFilterComp = std::static_pointer_cast<MeshFilterComponent>(pEntity->GetComponent(EComponentType::MeshFilter));
+			if (!pMeshFilterComp)
+			{
+				continue;
+			}
+
+			pMeshFilterComp->SetOccluded(false);
+
+			auto pTransformComp = std::static_pointer_cast<TransformComponent>(pEntity->GetComponent(EComponentType::Transform));
+			auto pMeshRendererComp = std::static_pointer_cast<MeshRendererComponent>(pEntity->GetComponent(EComponentType::MeshRenderer));
+			auto pMesh = pMeshFilterComp->GetMesh();
+			if (!isEnabled || !pTransformComp || !pMesh)
+			{
+				continue;
+			}
+
+			// Occluders are always drawn, testing them against their own depth would be pointless
+			if (pMeshRendererComp && pMeshRendererComp->IsOccluder() && !pMesh->GetOccluderGeometry().indices.empty())
+			{
+				m_occluders.push_back({ &pMesh->GetOccluderGeometry(), pTransformComp->GetModelMatrix() });
+			}
+			else
+			{
+				m_occlusionQueries.push_back({ &pMesh->GetBounds(), pTransformComp->GetModelMatrix(), false });
+				m_occludees.emplace_back(pMeshFilterComp.get());
+			}
+		}
+	}
+
+	if (m_occluders.empty() || m_occlusionQueries.empty())
+	{
+		return;
+	}
+
+	m_occlusionCuller.Rasterize(viewProjection, m_occluders);
+	m_occlusionCuller.Test(m_occlusionQueries);
+
+	for (size_t i = 0; i < m_occlusionQueries.size(); ++i)
+	{
+		m_occludees[i]->SetOccluded(m_occlusionQueries[i].isOccluded);
+	}
+}
+
+void DrawingSystem::CullMeshClusters()
+{
+	m_clusterCullingTasks.clear();
+
+	Matrix4x4 viewProjection = Matrix4x4(1.0f);
+	Vector3 cameraPos = Vector3(0.0f);
+	bool hasCamera = GetMainCameraView(viewProjection, cameraPos);
+
+	for (auto& renderList : m_renderTaskTable)
+	{
+		for (auto& pEntity : renderList.second)
+		{
+			auto pMeshFilterComp = std::static_pointer_cast<MeshFilterComponent>(pEntity->GetComponent(EComponentType::MeshFilter));
+			if (!pMeshFilterComp)
+			{
+				continue;
+			}
+
+			// Coarser levels have no clusters, they are drawn whole
+			pMeshFilterComp->GetClusterCullingResult().isValid = false;
+
+			auto pTransformComp = std::static_pointer_cast<TransformComponent>(pEntity->GetComponent(EComponentType::Transform));
+			auto pMesh = pMeshFilterComp->GetMesh();
+			if (!hasCamera || !pTransformComp || !pMesh || pMesh->GetClusters().GetCount() == 0 || pMeshFilterComp->GetLODIndex() != 0 || pMeshFilterComp->IsOccluded())
+			{
+				continue;
+			}
+
+			ClusterCullingTask task = {};
+			task.pMesh = pMesh.get();
+			task.view = MeshClusterCuller::CreateView(viewProjection, pTransformComp->GetModelMatrix(), cameraPos);
+			task.pResult = &pMeshFilterComp->GetClusterCullingResult();
+			m_clusterCullingTasks.emplace_back(task);
+		}
+	}
+
+	MeshClusterCuller::Cull(m_clusterCullingTasks);
+}
+
+bool DrawingSystem::GetMainCameraView(Matrix4x4& outViewProjection, Vector3& outPosition) const
+{
+	auto pCamera = m_pECSWorld->FindEntityWithTag(EEntityTag::MainCamera);
+	auto pCameraComp = pCamera ? std::static_pointer_cast<CameraComponent>(pCamera->GetComponent(EComponentType::Camera)) : nullptr;
+	auto pCameraTransform = pCamera ? std::static_pointer_cast<TransformComponent>(pCamera->GetComponent(EComponentType::Transform)) : nullptr;
+	if (!pCameraComp || !pCameraTransform)
+	{
+		return false;
+	}
+
+	// Same matrices as camera passes use
+	outPosition = pCameraTransform->GetPosition();
+	Matrix4x4 viewMat = glm::lookAt(outPosition, outPosition + pCameraTransform->GetForwardDirection(), UP);
+	Matrix4x4 projectionMat = glm::perspective(pCameraComp->GetFOV(),
+		gpGlobal->GetConfiguration<GraphicsConfiguration>(EConfigurationType::Graphics)->GetWindowAspect(),
+		pCameraComp->GetNearClip(), pCameraComp->GetFarClip());
+	outViewProjection = projectionMat * viewMat;
+
+	return true;
+}
+
 void DrawingSystem::ExecuteRenderTask()
 {
 	auto pCamera = m_pECSWorld->FindEntityWithTag(EEntityTag::MainCamera);
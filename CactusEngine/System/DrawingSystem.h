@@ -5,9 +5,13 @@
 #include "Global.h"
 #include "BuiltInShaderType.h"
 #include "NoCopy.h"
+#include "MeshClusterCuller.h"
+#include "SoftwareOcclusionCuller.h"
 
 namespace Engine
 {
+	class MeshFilterComponent;
+
 	typedef std::unordered_map<ERendererType, std::shared_ptr<IRenderer>> RendererTable;
 	typedef std::unordered_map<ERendererType, std::vector<std::shared_ptr<IEntity>>> RenderTaskTable;
 
@@ -49,6 +53,10 @@ namespace Engine
 		bool LoadShaders();
 		void BuildRenderGraphs();
 		void BuildRenderTask();
+		void SelectMeshLODs(); // From projected size of entity bounds as seen by main camera
+		void CullOccludedEntities(); // Against designated occluders, as seen by main camera
+		void CullMeshClusters(); // Against main camera, for entities drawn at full detail
+		bool GetMainCameraView(Matrix4x4& outViewProjection, Vector3& outPosition) const;
 		void ExecuteRenderTask();
 
 	private:
@@ -59,5 +67,12 @@ namespace Engine
 
 		RendererTable	m_rendererTable;
 		RenderTaskTable m_renderTaskTable;
+
+		std::vector<ClusterCullingTask> m_clusterCullingTasks; // Kept to reuse its storage
+
+		SoftwareOcclusionCuller m_occlusionCuller;
+		std::vector<OccluderInstance> m_occluders;
+		std::vector<OcclusionQuery> m_occlusionQueries;
+		std::vector<MeshFilterComponent*> m_occludees; // Receive results of queries at the same index
 	};
 }
\ No newline at end of file
@@ -0,0 +1,133 @@
+#include "MemoryMappedFile.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace Engine;
+
+MemoryMappedFile::MemoryMappedFile()
+	: m_pData(nullptr), m_size(0)
+#if defined(_WIN32)
+	, m_fileHandle(INVALID_HANDLE_VALUE), m_mappingHandle(nullptr)
+#else
+	, m_fileDescriptor(-1)
+#endif
+{
+
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+	Close();
+}
+
+bool MemoryMappedFile::Open(const char* filePath)
+{
+	Close();
+
+#if defined(_WIN32)
+	m_fileHandle = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (m_fileHandle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize = {};
+	if (!GetFileSizeEx(m_fileHandle, &fileSize) || fileSize.QuadPart == 0)
+	{
+		Close();
+		return false;
+	}
+
+	m_mappingHandle = CreateFileMappingA(m_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_mappingHandle == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	m_pData = static_cast<const uint8_t*>(MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	m_size = (size_t)fileSize.QuadPart;
+#else
+	m_fileDescriptor = open(filePath, O_RDONLY);
+	if (m_fileDescriptor < 0)
+	{
+		return false;
+	}
+
+	struct stat fileStat = {};
+	if (fstat(m_fileDescriptor, &fileStat) != 0 || fileStat.st_size == 0)
+	{
+		Close();
+		return false;
+	}
+
+	void* pMapped = mmap(nullptr, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, m_fileDescriptor, 0);
+	m_pData = pMapped == MAP_FAILED ? nullptr : static_cast<const uint8_t*>(pMapped);
+	m_size = (size_t)fileStat.st_size;
+#endif
+
+	if (m_pData == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void MemoryMappedFile::Close()
+{
+#if defined(_WIN32)
+	if (m_pData != nullptr)
+	{
+		UnmapViewOfFile(m_pData);
+	}
+	if (m_mappingHandle != nullptr)
+	{
+		CloseHandle(m_mappingHandle);
+		m_mappingHandle = nullptr;
+	}
+	if (m_fileHandle != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(m_fileHandle);
+		m_fileHandle = INVALID_HANDLE_VALUE;
+	}
+#else
+	if (m_pData != nullptr)
+	{
+		munmap(const_cast<uint8_t*>(m_pData), m_size);
+	}
+	if (m_fileDescriptor >= 0)
+	{
+		close(m_fileDescriptor);
+		m_fileDescriptor = -1;
+	}
+#endif
+
+	m_pData = nullptr;
+	m_size = 0;
+}
+
+bool MemoryMappedFile::IsOpen() const
+{
+	return m_pData != nullptr;
+}
+
+const uint8_t* MemoryMappedFile::GetData() const
+{
+	return m_pData;
+}
+
+size_t MemoryMappedFile::GetSize() const
+{
+	return m_size;
+}
\ No newline at end of file